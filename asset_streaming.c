@@ -0,0 +1,872 @@
+// Asset streaming. request_asset() returns at once with a handle; a small pool of streaming threads (separate from
+// the job system -- these block on the disk, frame jobs must never queue behind them) reads the file and
+// decodes it into upload ready parts, and the render thread hands decoded assets to the uploader a few per frame
+// in update_asset_streaming(). Nothing here waits: the first frame goes out while assets are still on disk, and
+// the scene fills in as they become resident.
+//
+//   QUEUED    -- in the pending heap, highest priority first (request order among equals)
+//   LOADING   -- a streaming thread has it: map the file, run the kind's decode function
+//   DECODED   -- in the ready heap, waiting for upload budget
+//   UPLOADING -- buffers created, parts copied through the staging ring, possibly over several frames
+//   RESIDENT  -- the last copy's ticket completed, the parts' buffers can be used
+//   FAILED    -- unreadable or didn't decode, failure_reason says why
+//
+// The per-frame budget caps both the bytes handed to the uploader and the assets started, so a burst of
+// completed loads is spread over frames instead of showing up as one long frame. A part bigger than the budget
+// simply continues on the next frame.
+//
+// release_asset() works in every state: queued / decoded / failed assets are dropped on the spot, a loading one
+// when its thread finishes with it, an uploading one once its copies are done, and a resident one once the
+// frames that might use its buffers have completed. Either way the handle goes stale straight away (get_asset()
+// returns NULL) and the slot is reused.
+//
+// Decoding is per kind: meshes are .mesh files from mesh_conditioner (validated, split into vertex and index
+// parts), blobs are copied into one storage buffer. Compressed formats slot in as more decode functions.
+//
+// NOTE: everything but the streaming threads is render thread only. The heaps and asset states are behind
+// the mutex; decoded data and the Vulkan objects are owned by whichever side has the asset in its state.
+//
+// Unity built -- included by vulkan_renderer.c after the uploader, needs the platform layer's file map, threads,
+// semaphores, mutex and atomics, and mesh_format.c.
+
+#define MAX_STREAMED_ASSETS				1024
+#define MAX_ASSET_PARTS					2
+#define MAX_STREAMING_THREADS			8
+#define ASSET_PATH_CAPACITY				512
+#define ASSET_STREAM_BUDGET_BYTES		( 8ull * 1024 * 1024 )			// per frame, well under the staging ring
+#define ASSET_STREAM_BUDGET_ASSETS		4								// uploads started per frame
+
+typedef enum {
+
+	ASSET_STATE_FREE,
+	ASSET_STATE_QUEUED,
+	ASSET_STATE_LOADING,
+	ASSET_STATE_DECODED,
+	ASSET_STATE_UPLOADING,
+	ASSET_STATE_RESIDENT,
+	ASSET_STATE_FAILED,
+	ASSET_STATE_RETIRED,						// released, buffers wait for retire_frame_number to complete
+
+} Asset_State;
+
+typedef enum {
+
+	ASSET_KIND_MESH,
+	ASSET_KIND_BLOB,
+
+} Asset_Kind;
+
+typedef struct {
+
+	uint32_t	index;
+	uint32_t	generation;						// 0 is never handed out -- a zeroed handle is "no asset"
+
+} Asset_Handle;
+
+typedef struct {
+
+	void				*data;					// decoded, freed once uploaded
+	VkDeviceSize		size;
+	VkBufferUsageFlags	usage_flags;
+	VkBuffer			buffer;
+	Vulkan_Allocation	allocation;
+	VkDeviceSize		bytes_uploaded;
+
+} Asset_Part;
+
+typedef struct {
+
+	Asset_State			state;
+	Asset_Kind			kind;
+	uint32_t			generation;
+	char				path[ASSET_PATH_CAPACITY];
+	float				priority;				// higher goes first
+	uint64_t			sequence;				// request order, breaks priority ties
+	int32_t				heap_index;				// in the pending or ready heap, -1 otherwise
+	bool				cancel_requested;		// LOADING / UPLOADING -- drop it as soon as that's over
+	char				*failure_reason;		// FAILED
+
+	Asset_Part			parts[MAX_ASSET_PARTS];
+	uint32_t			count_of_parts;
+	Mesh_File_Header	mesh;					// ASSET_KIND_MESH -- counts, index size, dequantization
+
+	uint64_t			upload_ticket;			// of the last chunk
+	uint64_t			retire_frame_number;
+	uint64_t			request_time;
+	uint64_t			bytes_read;
+
+} Asset;
+
+typedef bool Asset_Decode_Function( Asset *asset, void *file_data, uint64_t file_size );
+
+typedef struct {
+
+	uint32_t	assets[MAX_STREAMED_ASSETS];
+	uint32_t	count;
+
+} Asset_Heap;
+
+typedef struct {
+
+	Vulkan_Memory_Allocator	*memory;
+	Vulkan_Uploader			*uploader;
+
+	Asset					assets[MAX_STREAMED_ASSETS];
+	uint32_t				free_slots[MAX_STREAMED_ASSETS];
+	uint32_t				count_of_free_slots;
+	uint64_t				next_sequence;
+
+	Platform_Mutex			mutex;				// heaps, states, cancel flags and the counters the threads bump
+	Asset_Heap				pending;			// QUEUED
+	Asset_Heap				ready;				// DECODED
+	Platform_Semaphore		work_available;		// one signal per request -- a thread that finds the heap empty goes back to sleep
+	Platform_Thread			threads[MAX_STREAMING_THREADS];
+	uint32_t				count_of_threads;
+	volatile int32_t		shutting_down;
+
+	uint32_t				uploading[MAX_STREAMED_ASSETS];		// render thread only, in upload order
+	uint32_t				count_of_uploading;
+	uint32_t				retired[MAX_STREAMED_ASSETS];
+	uint32_t				count_of_retired;
+
+	uint64_t				budget_bytes;
+	uint32_t				budget_assets;
+
+	uint64_t				count_of_requests;
+	uint64_t				count_of_resident;
+	uint64_t				count_of_failed;
+	uint64_t				count_of_cancelled;
+	uint64_t				bytes_read;
+	uint64_t				bytes_uploaded;
+	uint64_t				count_of_budget_limited_frames;		// frames that left decoded data waiting
+	uint32_t				peak_pending;
+	uint64_t				total_latency;		// request to resident, nanoseconds
+	uint64_t				min_latency;
+	uint64_t				max_latency;
+
+} Asset_Streamer;
+
+// pending / ready order: priority, then request order
+bool
+asset_goes_before( Asset_Streamer *streamer, uint32_t a, uint32_t b )
+{
+	Asset *first;
+	Asset *second;
+	first  = &streamer->assets[a];
+	second = &streamer->assets[b];
+
+	if ( first->priority != second->priority ) {
+		return first->priority > second->priority;
+	}
+
+	return first->sequence < second->sequence;
+}
+
+void
+swap_asset_heap_entries( Asset_Streamer *streamer, Asset_Heap *heap, uint32_t i, uint32_t j )
+{
+	uint32_t asset;
+	asset 			 = heap->assets[i];
+	heap->assets[i]  = heap->assets[j];
+	heap->assets[j]  = asset;
+
+	streamer->assets[heap->assets[i]].heap_index = (int32_t)i;
+	streamer->assets[heap->assets[j]].heap_index = (int32_t)j;
+
+	return;
+}
+
+void
+sift_asset_heap( Asset_Streamer *streamer, Asset_Heap *heap, uint32_t position )
+{
+	// up
+	while ( position > 0 ) {
+		uint32_t parent;
+		parent = ( position - 1 ) / 2;
+		if ( !asset_goes_before( streamer, heap->assets[position], heap->assets[parent] ) ) {
+			break;
+		}
+
+		swap_asset_heap_entries( streamer, heap, position, parent );
+		position = parent;
+	}
+
+	// down
+	for ( ;; ) {
+		uint32_t first_child;
+		uint32_t best;
+		first_child = position * 2 + 1;
+		best 		= position;
+
+		if ( first_child < heap->count && asset_goes_before( streamer, heap->assets[first_child], heap->assets[best] ) ) {
+			best = first_child;
+		}
+		if ( first_child + 1 < heap->count && asset_goes_before( streamer, heap->assets[first_child + 1], heap->assets[best] ) ) {
+			best = first_child + 1;
+		}
+
+		if ( best == position ) {
+			break;
+		}
+
+		swap_asset_heap_entries( streamer, heap, position, best );
+		position = best;
+	}
+
+	return;
+}
+
+void
+push_asset_heap( Asset_Streamer *streamer, Asset_Heap *heap, uint32_t asset_index )
+{
+	heap->assets[heap->count] = asset_index;
+	streamer->assets[asset_index].heap_index = (int32_t)heap->count;
+	heap->count += 1;
+
+	sift_asset_heap( streamer, heap, heap->count - 1 );
+
+	return;
+}
+
+void
+remove_asset_heap( Asset_Streamer *streamer, Asset_Heap *heap, uint32_t asset_index )
+{
+	uint32_t position;
+	position = (uint32_t)streamer->assets[asset_index].heap_index;
+
+	heap->count -= 1;
+	if ( position != heap->count ) {
+		swap_asset_heap_entries( streamer, heap, position, heap->count );
+		sift_asset_heap( streamer, heap, position );
+	}
+
+	streamer->assets[asset_index].heap_index = -1;
+
+	return;
+}
+
+// UINT32_MAX when empty
+uint32_t
+pop_asset_heap( Asset_Streamer *streamer, Asset_Heap *heap )
+{
+	if ( heap->count == 0 ) {
+		return UINT32_MAX;
+	}
+
+	uint32_t asset_index;
+	asset_index = heap->assets[0];
+	remove_asset_heap( streamer, heap, asset_index );
+
+	return asset_index;
+}
+
+void
+free_asset_parts( Asset *asset )
+{
+	for ( uint32_t p = 0; p < asset->count_of_parts; ++p ) {
+		free( asset->parts[p].data );
+		asset->parts[p].data = NULL;
+	}
+
+	return;
+}
+
+// NOTE: caller holds the mutex
+void
+free_asset_slot( Asset_Streamer *streamer, uint32_t asset_index )
+{
+	Asset *asset;
+	asset = &streamer->assets[asset_index];
+
+	asset->state 	   = ASSET_STATE_FREE;
+	asset->generation += 1;
+	if ( asset->generation == 0 ) {
+		asset->generation = 1;
+	}
+
+	streamer->free_slots[streamer->count_of_free_slots++] = asset_index;
+
+	return;
+}
+
+bool
+decode_mesh_asset( Asset *asset, void *file_data, uint64_t file_size )
+{
+	Mesh_File_Header *header;
+	header = validate_mesh_file( file_data, file_size, &asset->failure_reason );
+	if ( !header ) {
+		return false;
+	}
+
+	if ( header->count_of_vertices == 0 || header->count_of_indices == 0 ) {
+		asset->failure_reason = "empty mesh";
+		return false;
+	}
+
+	asset->mesh = *header;
+
+	Asset_Part *vertices;
+	vertices = &asset->parts[0];
+	vertices->size 		  = (VkDeviceSize)header->count_of_vertices * header->vertex_stride;
+	vertices->usage_flags = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	vertices->data 		  = malloc( (size_t)vertices->size );
+
+	Asset_Part *indices;
+	indices = &asset->parts[1];
+	indices->size 		 = (VkDeviceSize)header->count_of_indices * header->index_size;
+	indices->usage_flags = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	indices->data 		 = malloc( (size_t)indices->size );
+
+	asset->count_of_parts = 2;
+	if ( !vertices->data || !indices->data ) {
+		asset->failure_reason = "out of memory";
+		return false;
+	}
+
+	memcpy( vertices->data, get_mesh_vertices( header ), (size_t)vertices->size );
+	memcpy( indices->data, get_mesh_indices( header ), (size_t)indices->size );
+
+	return true;
+}
+
+bool
+decode_blob_asset( Asset *asset, void *file_data, uint64_t file_size )
+{
+	// NOTE: a zero sized buffer isn't valid Vulkan
+	if ( file_size == 0 ) {
+		asset->failure_reason = "empty file";
+		return false;
+	}
+
+	Asset_Part *blob;
+	blob = &asset->parts[0];
+	blob->size 		  = file_size;
+	blob->usage_flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	blob->data 		  = malloc( (size_t)file_size );
+
+	asset->count_of_parts = 1;
+	if ( !blob->data ) {
+		asset->failure_reason = "out of memory";
+		return false;
+	}
+
+	memcpy( blob->data, file_data, (size_t)file_size );
+
+	return true;
+}
+
+Asset_Decode_Function *asset_decode_functions[] = {
+	decode_mesh_asset,							// ASSET_KIND_MESH
+	decode_blob_asset,							// ASSET_KIND_BLOB
+};
+
+void
+asset_streaming_thread( void *streamer_as_void )
+{
+	Asset_Streamer *streamer;
+	streamer = (Asset_Streamer *)streamer_as_void;
+
+	for ( ;; ) {
+		platform_wait_semaphore( &streamer->work_available );
+		if ( platform_atomic_load_32( &streamer->shutting_down ) ) {
+			break;
+		}
+
+		platform_lock_mutex( &streamer->mutex );
+		uint32_t asset_index;
+		asset_index = pop_asset_heap( streamer, &streamer->pending );
+		if ( asset_index != UINT32_MAX ) {
+			streamer->assets[asset_index].state = ASSET_STATE_LOADING;
+		}
+		platform_unlock_mutex( &streamer->mutex );
+
+		// cancelled before anyone got to it -- the signal was for that one
+		if ( asset_index == UINT32_MAX ) {
+			continue;
+		}
+
+		// NOTE: path, kind and parts are ours until the state leaves LOADING
+		Asset *asset;
+		asset = &streamer->assets[asset_index];
+
+		bool decoded = false;
+		Platform_File_Map file_map;
+		if ( platform_map_file_for_reading( asset->path, &file_map ) ) {
+			asset->bytes_read = file_map.size;
+			decoded = asset_decode_functions[asset->kind]( asset, file_map.data, file_map.size );
+			platform_unmap_file( &file_map );
+		}
+		else {
+			asset->failure_reason = "unable to read the file";
+		}
+
+		platform_lock_mutex( &streamer->mutex );
+		streamer->bytes_read += asset->bytes_read;
+
+		if ( asset->cancel_requested ) {
+			free_asset_parts( asset );
+			free_asset_slot( streamer, asset_index );
+			streamer->count_of_cancelled += 1;
+		}
+		else if ( !decoded ) {
+			free_asset_parts( asset );
+			asset->count_of_parts = 0;
+			asset->state 		  = ASSET_STATE_FAILED;
+			streamer->count_of_failed += 1;
+		}
+		else {
+			asset->state = ASSET_STATE_DECODED;
+			push_asset_heap( streamer, &streamer->ready, asset_index );
+		}
+		platform_unlock_mutex( &streamer->mutex );
+	}
+
+	return;
+}
+
+// count_of_threads 0 picks 2 -- loads are mostly waiting on the disk, a couple in flight keeps it busy
+void
+create_asset_streamer( Asset_Streamer *streamer, Vulkan_Memory_Allocator *memory, Vulkan_Uploader *uploader, uint32_t count_of_threads )
+{
+	memset( streamer, 0, sizeof (Asset_Streamer) );
+
+	streamer->memory 		= memory;
+	streamer->uploader 		= uploader;
+	streamer->budget_bytes  = ASSET_STREAM_BUDGET_BYTES;
+	streamer->budget_assets = ASSET_STREAM_BUDGET_ASSETS;
+	streamer->min_latency 	= UINT64_MAX;
+
+	for ( uint32_t i = 0; i < MAX_STREAMED_ASSETS; ++i ) {
+		streamer->assets[i].generation = 1;
+		streamer->assets[i].heap_index = -1;
+		streamer->free_slots[i] 	   = MAX_STREAMED_ASSETS - 1 - i;
+	}
+	streamer->count_of_free_slots = MAX_STREAMED_ASSETS;
+
+	platform_create_mutex( &streamer->mutex );
+	platform_create_semaphore( &streamer->work_available, 0 );
+
+	if ( count_of_threads == 0 ) {
+		count_of_threads = 2;
+	}
+
+	if ( count_of_threads > MAX_STREAMING_THREADS ) {
+		count_of_threads = MAX_STREAMING_THREADS;
+	}
+
+	streamer->count_of_threads = count_of_threads;
+	for ( uint32_t i = 0; i < count_of_threads; ++i ) {
+		if ( !platform_create_thread( &streamer->threads[i], asset_streaming_thread, streamer ) ) {
+			fprintf( stdout, "Unable to start asset streaming thread %u\n", i );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	return;
+}
+
+// NOTE: caller holds the mutex
+Asset *
+find_asset( Asset_Streamer *streamer, Asset_Handle handle )
+{
+	if ( handle.index >= MAX_STREAMED_ASSETS ) {
+		return NULL;
+	}
+
+	Asset *asset;
+	asset = &streamer->assets[handle.index];
+	if ( asset->generation != handle.generation || asset->state == ASSET_STATE_FREE || asset->state == ASSET_STATE_RETIRED ||
+		 asset->cancel_requested ) {
+		return NULL;
+	}
+
+	return asset;
+}
+
+// NULL once released. Only RESIDENT / FAILED stay put -- the earlier states move on behind the caller's back.
+Asset *
+get_asset( Asset_Streamer *streamer, Asset_Handle handle )
+{
+	platform_lock_mutex( &streamer->mutex );
+
+	Asset *asset;
+	asset = find_asset( streamer, handle );
+
+	platform_unlock_mutex( &streamer->mutex );
+
+	return asset;
+}
+
+// Never blocks. Out of slots is fatal, like the other fixed size tables.
+Asset_Handle
+request_asset( Asset_Streamer *streamer, char *path, Asset_Kind kind, float priority )
+{
+	if ( strlen( path ) >= ASSET_PATH_CAPACITY ) {
+		fprintf( stdout, "Asset path too long: %s\n", path );
+		exit( EXIT_FAILURE );
+	}
+
+	platform_lock_mutex( &streamer->mutex );
+
+	if ( streamer->count_of_free_slots == 0 ) {
+		fprintf( stdout, "Out of asset slots (%u)\n", MAX_STREAMED_ASSETS );
+		exit( EXIT_FAILURE );
+	}
+
+	uint32_t asset_index;
+	asset_index = streamer->free_slots[--streamer->count_of_free_slots];
+
+	Asset *asset;
+	asset = &streamer->assets[asset_index];
+	strcpy( asset->path, path );
+	asset->state 			= ASSET_STATE_QUEUED;
+	asset->kind 			= kind;
+	asset->priority 		= priority;
+	asset->sequence 		= streamer->next_sequence++;
+	asset->cancel_requested = false;
+	asset->failure_reason 	= NULL;
+	asset->count_of_parts 	= 0;
+	asset->bytes_read 		= 0;
+	asset->upload_ticket 	= 0;
+	asset->request_time 	= platform_get_timestamp_in_nanoseconds();
+	memset( asset->parts, 0, sizeof (asset->parts) );
+
+	push_asset_heap( streamer, &streamer->pending, asset_index );
+	streamer->count_of_requests += 1;
+	if ( streamer->pending.count > streamer->peak_pending ) {
+		streamer->peak_pending = streamer->pending.count;
+	}
+
+	Asset_Handle handle;
+	handle.index 	  = asset_index;
+	handle.generation = asset->generation;
+
+	platform_unlock_mutex( &streamer->mutex );
+
+	platform_signal_semaphore( &streamer->work_available, 1 );
+
+	return handle;
+}
+
+// Reorders a queued or decoded asset -- the camera moved, something got closer
+void
+set_asset_priority( Asset_Streamer *streamer, Asset_Handle handle, float priority )
+{
+	platform_lock_mutex( &streamer->mutex );
+
+	Asset *asset;
+	asset = find_asset( streamer, handle );
+	if ( asset ) {
+		asset->priority = priority;
+		if ( asset->state == ASSET_STATE_QUEUED ) {
+			sift_asset_heap( streamer, &streamer->pending, (uint32_t)asset->heap_index );
+		}
+		else if ( asset->state == ASSET_STATE_DECODED ) {
+			sift_asset_heap( streamer, &streamer->ready, (uint32_t)asset->heap_index );
+		}
+	}
+
+	platform_unlock_mutex( &streamer->mutex );
+
+	return;
+}
+
+// Render thread, any state -- see the top of the file. last_submitted_frame_number is the last frame that could
+// have used a resident asset's buffers.
+void
+release_asset( Asset_Streamer *streamer, Asset_Handle handle, uint64_t last_submitted_frame_number )
+{
+	platform_lock_mutex( &streamer->mutex );
+
+	Asset *asset;
+	asset = find_asset( streamer, handle );
+	if ( asset ) {
+		switch ( asset->state ) {
+			case ASSET_STATE_QUEUED: {
+				remove_asset_heap( streamer, &streamer->pending, handle.index );
+				free_asset_slot( streamer, handle.index );
+				streamer->count_of_cancelled += 1;
+			} break;
+
+			case ASSET_STATE_DECODED: {
+				remove_asset_heap( streamer, &streamer->ready, handle.index );
+				free_asset_parts( asset );
+				free_asset_slot( streamer, handle.index );
+				streamer->count_of_cancelled += 1;
+			} break;
+
+			// the streaming thread / update_asset_streaming() drop it when they're done with it
+			case ASSET_STATE_LOADING:
+			case ASSET_STATE_UPLOADING: {
+				asset->cancel_requested = true;
+			} break;
+
+			case ASSET_STATE_RESIDENT: {
+				asset->state 			   = ASSET_STATE_RETIRED;
+				asset->retire_frame_number = last_submitted_frame_number;
+				streamer->retired[streamer->count_of_retired++] = handle.index;
+			} break;
+
+			case ASSET_STATE_FAILED: {
+				free_asset_slot( streamer, handle.index );
+			} break;
+
+			default: {
+			} break;
+		}
+	}
+
+	platform_unlock_mutex( &streamer->mutex );
+
+	return;
+}
+
+void
+destroy_asset_buffers( Asset_Streamer *streamer, Asset *asset )
+{
+	for ( uint32_t p = 0; p < asset->count_of_parts; ++p ) {
+		if ( asset->parts[p].buffer != VK_NULL_HANDLE ) {
+			destroy_vulkan_buffer( streamer->memory, asset->parts[p].buffer, &asset->parts[p].allocation );
+			asset->parts[p].buffer = VK_NULL_HANDLE;
+		}
+	}
+
+	return;
+}
+
+// Copies as much of the asset as the budget left allows. true when every part has been handed over.
+bool
+continue_asset_upload( Asset_Streamer *streamer, Asset *asset, uint64_t *budget_bytes )
+{
+	for ( uint32_t p = 0; p < asset->count_of_parts; ++p ) {
+		Asset_Part *part;
+		part = &asset->parts[p];
+
+		while ( part->bytes_uploaded < part->size ) {
+			if ( *budget_bytes == 0 ) {
+				return false;
+			}
+
+			VkDeviceSize chunk_size;
+			chunk_size = part->size - part->bytes_uploaded;
+			if ( chunk_size > *budget_bytes ) {
+				chunk_size = *budget_bytes;
+			}
+
+			asset->upload_ticket = upload_to_buffer( streamer->uploader, part->buffer, part->bytes_uploaded,
+													 (uint8_t *)part->data + part->bytes_uploaded, chunk_size );
+			part->bytes_uploaded 	 += chunk_size;
+			*budget_bytes 			 -= chunk_size;
+			streamer->bytes_uploaded += chunk_size;
+		}
+	}
+
+	return true;
+}
+
+// Once per frame on the render thread, before the frame's uploads are submitted
+void
+update_asset_streaming( Asset_Streamer *streamer, uint64_t last_completed_frame_number )
+{
+	// released assets whose last frame is done
+	for ( uint32_t i = 0; i < streamer->count_of_retired; ) {
+		Asset *asset;
+		asset = &streamer->assets[streamer->retired[i]];
+		if ( asset->retire_frame_number > last_completed_frame_number ) {
+			++i;
+			continue;
+		}
+
+		destroy_asset_buffers( streamer, asset );
+
+		platform_lock_mutex( &streamer->mutex );
+		free_asset_slot( streamer, streamer->retired[i] );
+		platform_unlock_mutex( &streamer->mutex );
+
+		streamer->retired[i] = streamer->retired[--streamer->count_of_retired];
+	}
+
+	uint64_t budget_bytes;
+	uint32_t budget_assets;
+	budget_bytes  = streamer->budget_bytes;
+	budget_assets = streamer->budget_assets;
+
+	// uploads already under way, in the order they started: finish handing them over, then see if they landed
+	for ( uint32_t i = 0; i < streamer->count_of_uploading; ) {
+		uint32_t asset_index;
+		asset_index = streamer->uploading[i];
+
+		Asset *asset;
+		asset = &streamer->assets[asset_index];
+
+		platform_lock_mutex( &streamer->mutex );
+		bool cancelled;
+		cancelled = asset->cancel_requested;
+		platform_unlock_mutex( &streamer->mutex );
+
+		// NOTE: a cancelled asset issues no more chunks, it only waits for the ones already in flight --
+		// the budget goes to the next asset
+		bool handed_over;
+		handed_over = cancelled || continue_asset_upload( streamer, asset, &budget_bytes );
+		if ( !handed_over || !upload_is_complete( streamer->uploader, asset->upload_ticket ) ) {
+			++i;
+			continue;
+		}
+
+		free_asset_parts( asset );
+
+		uint64_t now;
+		now = platform_get_timestamp_in_nanoseconds();
+
+		platform_lock_mutex( &streamer->mutex );
+		if ( asset->cancel_requested ) {
+			// NOTE: never resident, so no frame has used the buffers
+			destroy_asset_buffers( streamer, asset );
+			free_asset_slot( streamer, asset_index );
+			streamer->count_of_cancelled += 1;
+		}
+		else {
+			uint64_t latency;
+			latency = now - asset->request_time;
+
+			asset->state = ASSET_STATE_RESIDENT;
+			streamer->count_of_resident += 1;
+			streamer->total_latency 	+= latency;
+			if ( latency < streamer->min_latency ) {
+				streamer->min_latency = latency;
+			}
+			if ( latency > streamer->max_latency ) {
+				streamer->max_latency = latency;
+			}
+		}
+		platform_unlock_mutex( &streamer->mutex );
+
+		streamer->uploading[i] = streamer->uploading[--streamer->count_of_uploading];
+	}
+
+	// then new ones, best first, while there's budget
+	while ( budget_assets > 0 && budget_bytes > 0 ) {
+		platform_lock_mutex( &streamer->mutex );
+		uint32_t asset_index;
+		asset_index = pop_asset_heap( streamer, &streamer->ready );
+		if ( asset_index != UINT32_MAX ) {
+			streamer->assets[asset_index].state = ASSET_STATE_UPLOADING;
+		}
+		platform_unlock_mutex( &streamer->mutex );
+
+		if ( asset_index == UINT32_MAX ) {
+			break;
+		}
+
+		Asset *asset;
+		asset = &streamer->assets[asset_index];
+		for ( uint32_t p = 0; p < asset->count_of_parts; ++p ) {
+			asset->parts[p].buffer = create_vulkan_buffer( streamer->memory, asset->parts[p].size,
+														   asset->parts[p].usage_flags | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+														   VULKAN_MEMORY_USAGE_GPU_ONLY, &asset->parts[p].allocation );
+		}
+
+		continue_asset_upload( streamer, asset, &budget_bytes );
+		streamer->uploading[streamer->count_of_uploading++] = asset_index;
+		budget_assets -= 1;
+	}
+
+	platform_lock_mutex( &streamer->mutex );
+	if ( streamer->ready.count > 0 ) {
+		streamer->count_of_budget_limited_frames += 1;
+	}
+	platform_unlock_mutex( &streamer->mutex );
+
+	return;
+}
+
+// NOTE: device idle -- whatever is still in flight is dropped, resident assets are freed
+void
+destroy_asset_streamer( Asset_Streamer *streamer )
+{
+	platform_atomic_store_32( &streamer->shutting_down, 1 );
+	platform_signal_semaphore( &streamer->work_available, streamer->count_of_threads );
+
+	for ( uint32_t i = 0; i < streamer->count_of_threads; ++i ) {
+		platform_join_thread( streamer->threads[i] );
+	}
+
+	for ( uint32_t i = 0; i < MAX_STREAMED_ASSETS; ++i ) {
+		Asset *asset;
+		asset = &streamer->assets[i];
+		if ( asset->state == ASSET_STATE_FREE ) {
+			continue;
+		}
+
+		free_asset_parts( asset );
+		destroy_asset_buffers( streamer, asset );
+	}
+
+	platform_destroy_semaphore( &streamer->work_available );
+	platform_destroy_mutex( &streamer->mutex );
+
+	return;
+}
+
+// "a.mesh;b.bin" -- in order of priority, .mesh files as meshes and anything else as a blob
+void
+request_asset_list( Asset_Streamer *streamer, char *list )
+{
+	char path[ASSET_PATH_CAPACITY];
+	float priority;
+	priority = 1000.0f;
+
+	while ( *list ) {
+		uint32_t length = 0;
+		while ( list[length] && list[length] != ';' ) {
+			length += 1;
+		}
+
+		if ( length > 0 && length < ASSET_PATH_CAPACITY ) {
+			memcpy( path, list, length );
+			path[length] = '\0';
+
+			Asset_Kind kind;
+			kind = ( length > 5 && strcmp( path + length - 5, ".mesh" ) == 0 ) ? ASSET_KIND_MESH : ASSET_KIND_BLOB;
+			request_asset( streamer, path, kind, priority );
+			priority -= 1.0f;
+		}
+
+		list += length;
+		if ( *list == ';' ) {
+			list += 1;
+		}
+	}
+
+	return;
+}
+
+void
+export_asset_streamer_as_json( Asset_Streamer *streamer, FILE *output, char *indentation )
+{
+	platform_lock_mutex( &streamer->mutex );
+
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"threads\": %u,\n", indentation, streamer->count_of_threads );
+	fprintf( output, "%s  \"budget_bytes_per_frame\": %llu,\n", indentation, (unsigned long long)streamer->budget_bytes );
+	fprintf( output, "%s  \"budget_assets_per_frame\": %u,\n", indentation, streamer->budget_assets );
+	fprintf( output, "%s  \"requests\": %llu,\n", indentation, (unsigned long long)streamer->count_of_requests );
+	fprintf( output, "%s  \"resident\": %llu,\n", indentation, (unsigned long long)streamer->count_of_resident );
+	fprintf( output, "%s  \"failed\": %llu,\n", indentation, (unsigned long long)streamer->count_of_failed );
+	fprintf( output, "%s  \"cancelled\": %llu,\n", indentation, (unsigned long long)streamer->count_of_cancelled );
+	fprintf( output, "%s  \"in_flight\": %u,\n", indentation, streamer->pending.count + streamer->ready.count + streamer->count_of_uploading );
+	fprintf( output, "%s  \"peak_pending\": %u,\n", indentation, streamer->peak_pending );
+	fprintf( output, "%s  \"bytes_read\": %llu,\n", indentation, (unsigned long long)streamer->bytes_read );
+	fprintf( output, "%s  \"bytes_uploaded\": %llu,\n", indentation, (unsigned long long)streamer->bytes_uploaded );
+	fprintf( output, "%s  \"budget_limited_frames\": %llu,\n", indentation, (unsigned long long)streamer->count_of_budget_limited_frames );
+	fprintf( output, "%s  \"latency_ms_min\": %.3f,\n", indentation,
+			 streamer->count_of_resident ? (double)streamer->min_latency / 1000000.0 : 0.0 );
+	fprintf( output, "%s  \"latency_ms_avg\": %.3f,\n", indentation,
+			 streamer->count_of_resident ? (double)streamer->total_latency / (double)streamer->count_of_resident / 1000000.0 : 0.0 );
+	fprintf( output, "%s  \"latency_ms_max\": %.3f\n", indentation, (double)streamer->max_latency / 1000000.0 );
+	fprintf( output, "%s}", indentation );
+
+	platform_unlock_mutex( &streamer->mutex );
+
+	return;
+}
@@ -0,0 +1,400 @@
+// Headless frame-throughput benchmark. Runs the regular clear / acquire / submit / present loop against a
+// headless surface for a fixed number of frames and writes the results as JSON, so it works on build hosts
+// without a display or a GPU (software ICD). For example, with lavapipe:
+//
+//     cc -O2 -o benchmark benchmark.c -ldl -lpthread -lm
+//     VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./benchmark --frames 2000
+//
+// Options:  --frames N  --warmup N  --width W  --height H  --validation  --output path
+//           --profile-csv path  --profile-json path    (per-frame CPU / GPU timings of the last 256 frames)
+//           --pipeline-cache path                      (run twice with the same path for warm vs cold startup)
+//           --startup-cache path                       (same, for the capability probe -- see the startup object)
+//           --device index|name  --device-benchmark    (device override / micro-benchmark tie break)
+//           --present-mode low_latency|vsync|adaptive  (present mode policy, default low_latency)
+//           --target-fps N  --latency-budget ms        (frame pacing -- see the pacing object)
+//           --bindless                                 (descriptor indexing resource arrays, if the device has them)
+//           --shader-directory path                    (where SPIR-V is loaded from, no hot reload in the benchmark)
+//           --stream "a.mesh;b.bin"                    (assets streamed in from the first frame on, in priority order)
+//           --gpu-scene N                              (N synthetic objects culled on the GPU every frame, needs cull.comp.spv)
+// Exits with EXIT_FAILURE if validation was on and reported any errors.
+
+#define PLATFORM_SURFACE_EXTENSION_NAME VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME
+
+#if defined( _WIN32 )
+#include "win32_platform.c"
+#else
+#include "linux_platform.c"
+#endif
+
+#include "vulkan_renderer.c"
+
+typedef struct {
+
+	uint32_t	count_of_frames;
+	uint32_t	count_of_warmup_frames;
+	uint32_t	width;
+	uint32_t	height;
+	bool		validation;
+	char		*output_path;			// NULL -- stdout
+	char		*profile_csv_path;		// NULL -- not written
+	char		*profile_json_path;		// NULL -- not written
+	char		*pipeline_cache_path;	// NULL -- PLAYGROUND_PIPELINE_CACHE, else not persisted
+	char		*startup_cache_path;	// NULL -- PLAYGROUND_STARTUP_CACHE, else not persisted
+	char		*device;				// NULL -- PLAYGROUND_DEVICE, else the best scored device
+	bool		device_benchmark;
+	bool		bindless;
+	char		*shader_directory;		// NULL -- PLAYGROUND_SHADER_DIRECTORY, else "shaders"
+	uint32_t	gpu_scene_object_count;	// 0 -- PLAYGROUND_GPU_SCENE, else no GPU scene
+	char		*stream_assets;			// NULL -- PLAYGROUND_STREAM, else nothing streamed
+	Present_Policy	present_policy;		// PLAYGROUND_PRESENT_MODE, else low latency
+	double		target_frames_per_second;	// 0 -- PLAYGROUND_TARGET_FPS, else no frame rate target
+	double		latency_budget_milliseconds;	// 0 -- PLAYGROUND_LATENCY_BUDGET_MS, else no latency target
+
+} Benchmark_Options;
+
+Benchmark_Options
+parse_benchmark_options( int argument_count, char **arguments )
+{
+	Benchmark_Options options = { 0 };
+	options.count_of_frames        = 1000;
+	options.count_of_warmup_frames = 10;
+	options.width                  = 640;
+	options.height                 = 480;
+	options.validation             = getenv( "PLAYGROUND_VALIDATION" ) != NULL;
+	options.pipeline_cache_path    = getenv( "PLAYGROUND_PIPELINE_CACHE" );
+	options.startup_cache_path     = getenv( "PLAYGROUND_STARTUP_CACHE" );
+	options.present_policy         = PRESENT_POLICY_LOW_LATENCY;
+	parse_present_policy( getenv( "PLAYGROUND_PRESENT_MODE" ), &options.present_policy );
+
+	for ( int i = 1; i < argument_count; ++i ) {
+		bool has_value = ( i + 1 < argument_count );
+
+		if ( strcmp( arguments[i], "--frames" ) == 0 && has_value ) {
+			options.count_of_frames = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--warmup" ) == 0 && has_value ) {
+			options.count_of_warmup_frames = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--width" ) == 0 && has_value ) {
+			options.width = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--height" ) == 0 && has_value ) {
+			options.height = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--output" ) == 0 && has_value ) {
+			options.output_path = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--profile-csv" ) == 0 && has_value ) {
+			options.profile_csv_path = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--profile-json" ) == 0 && has_value ) {
+			options.profile_json_path = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--pipeline-cache" ) == 0 && has_value ) {
+			options.pipeline_cache_path = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--startup-cache" ) == 0 && has_value ) {
+			options.startup_cache_path = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--device" ) == 0 && has_value ) {
+			options.device = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--device-benchmark" ) == 0 ) {
+			options.device_benchmark = true;
+		}
+		else if ( strcmp( arguments[i], "--bindless" ) == 0 ) {
+			options.bindless = true;
+		}
+		else if ( strcmp( arguments[i], "--shader-directory" ) == 0 && has_value ) {
+			options.shader_directory = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--stream" ) == 0 && has_value ) {
+			options.stream_assets = arguments[++i];
+		}
+		else if ( strcmp( arguments[i], "--gpu-scene" ) == 0 && has_value ) {
+			options.gpu_scene_object_count = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--target-fps" ) == 0 && has_value ) {
+			options.target_frames_per_second = strtod( arguments[++i], NULL );
+		}
+		else if ( strcmp( arguments[i], "--latency-budget" ) == 0 && has_value ) {
+			options.latency_budget_milliseconds = strtod( arguments[++i], NULL );
+		}
+		else if ( strcmp( arguments[i], "--present-mode" ) == 0 && has_value ) {
+			if ( !parse_present_policy( arguments[++i], &options.present_policy ) ) {
+				fprintf( stderr, "Unknown present mode policy: %s\n", arguments[i] );
+				exit( EXIT_FAILURE );
+			}
+		}
+		else if ( strcmp( arguments[i], "--validation" ) == 0 ) {
+			options.validation = true;
+		}
+		else {
+			fprintf( stderr, "Unknown or incomplete option: %s\n", arguments[i] );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	if ( options.count_of_frames == 0 || options.width == 0 || options.height == 0 ) {
+		fprintf( stderr, "Frame count and extent must be non-zero\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return options;
+}
+
+int
+compare_frame_times( const void *a, const void *b )
+{
+	uint64_t frame_time_a = *(const uint64_t *)a;
+	uint64_t frame_time_b = *(const uint64_t *)b;
+
+	if ( frame_time_a < frame_time_b ) {
+		return -1;
+	}
+
+	return frame_time_a > frame_time_b;
+}
+
+// NOTE: nearest rank on an already sorted array, result in milliseconds
+double
+frame_time_percentile_in_milliseconds( uint64_t *sorted_frame_times, uint32_t count_of_frame_times, double percentile )
+{
+	uint32_t rank;
+	rank = (uint32_t)( percentile / 100.0 * (double)count_of_frame_times + 0.5 );
+	if ( rank < 1 ) {
+		rank = 1;
+	}
+
+	if ( rank > count_of_frame_times ) {
+		rank = count_of_frame_times;
+	}
+
+	return (double)sorted_frame_times[rank - 1] / 1.0e6;
+}
+
+void
+write_frame_profiles( Frame_Profiler *profiler, char *path, bool as_json )
+{
+	FILE *output;
+	output = fopen( path, "w" );
+	if ( !output ) {
+		fprintf( stderr, "Unable to open %s for writing\n", path );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( as_json ) {
+		export_frame_profiles_as_json( profiler, output, "", true );
+		fprintf( output, "\n" );
+	}
+	else {
+		export_frame_profiles_as_csv( profiler, output );
+	}
+
+	fclose( output );
+
+	return;
+}
+
+static Vulkan_Context vulkan_context;
+
+int
+main( int argument_count, char **arguments )
+{
+	uint64_t process_start;
+	process_start = platform_get_timestamp_in_nanoseconds();
+
+	Benchmark_Options options;
+	options = parse_benchmark_options( argument_count, arguments );
+
+	Platform_Library vulkan_library_handle;
+	vulkan_library_handle = load_vulkan_library();
+
+	load_vulkan_entry_point( vulkan_library_handle );
+	load_vulkan_global_functions();
+
+	vulkan_context.validation_enabled  = options.validation;
+	vulkan_context.pipeline_cache_path = options.pipeline_cache_path;
+	vulkan_context.startup_cache_path  = options.startup_cache_path;
+	vulkan_context.device_override 	   = options.device;
+	vulkan_context.device_override_source = "--device";
+	vulkan_context.device_benchmark_enabled = options.device_benchmark;
+	vulkan_context.bindless_requested  = options.bindless;
+	vulkan_context.shader_directory    = options.shader_directory;
+	vulkan_context.gpu_scene_object_count = options.gpu_scene_object_count;
+	vulkan_context.stream_assets 		  = options.stream_assets;
+	vulkan_context.present_policy      = options.present_policy;
+	vulkan_context.target_frames_per_second    = options.target_frames_per_second;
+	vulkan_context.latency_budget_milliseconds = options.latency_budget_milliseconds;
+
+	initialize_vulkan_instance( &vulkan_context );
+
+	vulkan_context.surface 		       = create_vulkan_headless_surface( &vulkan_context );
+	vulkan_context.window_extent.width  = options.width;
+	vulkan_context.window_extent.height = options.height;
+
+	initialize_vulkan_device_and_swap_chain( &vulkan_context );
+
+	uint64_t startup_complete;
+	startup_complete = platform_get_timestamp_in_nanoseconds();
+
+	for ( uint32_t i = 0; i < options.count_of_warmup_frames; ++i ) {
+		draw( &vulkan_context );
+	}
+
+	uint64_t *frame_times;
+	frame_times = (uint64_t *)malloc( options.count_of_frames * sizeof (uint64_t) );
+	if ( !frame_times ) {
+		fprintf( stderr, "Unable to allocate space for frame times\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	uint64_t frames_submitted_before;
+	frames_submitted_before = vulkan_context.count_of_frames_submitted;
+
+	uint64_t loop_start;
+	loop_start = platform_get_timestamp_in_nanoseconds();
+
+	uint64_t previous_frame_end;
+	previous_frame_end = loop_start;
+
+	for ( uint32_t i = 0; i < options.count_of_frames; ++i ) {
+		draw( &vulkan_context );
+
+		uint64_t frame_end;
+		frame_end = platform_get_timestamp_in_nanoseconds();
+
+		frame_times[i]     = frame_end - previous_frame_end;
+		previous_frame_end = frame_end;
+	}
+
+	// the run isn't over until the GPU has drained what we queued
+	vulkan_context.dispatch.vkDeviceWaitIdle( vulkan_context.logical_device );
+
+	uint64_t loop_end;
+	loop_end = platform_get_timestamp_in_nanoseconds();
+
+	resolve_all_pending_frame_profiles( &vulkan_context );
+
+	// saved here rather than at shutdown so the save time makes it into the report
+	save_vulkan_pipeline_cache( &vulkan_context.pipeline_cache );
+
+	uint64_t frames_submitted;
+	frames_submitted = vulkan_context.count_of_frames_submitted - frames_submitted_before;
+
+	qsort( frame_times, options.count_of_frames, sizeof (uint64_t), compare_frame_times );
+
+	uint64_t sum_of_frame_times = 0;
+	for ( uint32_t i = 0; i < options.count_of_frames; ++i ) {
+		sum_of_frame_times += frame_times[i];
+	}
+
+	double total_seconds;
+	total_seconds = (double)( loop_end - loop_start ) / 1.0e9;
+
+	VkPhysicalDeviceProperties device_properties;
+	vkGetPhysicalDeviceProperties( vulkan_context.physical_device, &device_properties );
+
+	FILE *output;
+	output = stdout;
+	if ( options.output_path ) {
+		output = fopen( options.output_path, "w" );
+		if ( !output ) {
+			fprintf( stderr, "Unable to open %s for writing\n", options.output_path );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	fprintf( output, "{\n" );
+	fprintf( output, "  \"benchmark\": \"clear_present\",\n" );
+	fprintf( output, "  \"device\": \"%s\",\n", device_properties.deviceName );
+	fprintf( output, "  \"width\": %u,\n", vulkan_context.swap_chain_extent.width );
+	fprintf( output, "  \"height\": %u,\n", vulkan_context.swap_chain_extent.height );
+	fprintf( output, "  \"swap_chain_images\": %u,\n", vulkan_context.count_of_swap_chain_images );
+	fprintf( output, "  \"present_policy\": \"%s\",\n", present_policy_names[vulkan_context.present_policy] );
+	fprintf( output, "  \"present_mode\": \"%s\",\n", get_present_mode_name( vulkan_context.present_mode ) );
+	fprintf( output, "  \"max_frames_in_flight\": %u,\n", vulkan_context.max_frames_in_flight );
+	fprintf( output, "  \"peak_frames_in_flight\": %u,\n", vulkan_context.peak_frames_in_flight );
+	fprintf( output, "  \"frames\": %u,\n", options.count_of_frames );
+	fprintf( output, "  \"frames_submitted\": %llu,\n", (unsigned long long)frames_submitted );
+	fprintf( output, "  \"startup_ms\": %.3f,\n", (double)( startup_complete - process_start ) / 1.0e6 );
+	fprintf( output, "  \"startup\": " );
+	export_vulkan_startup_cache_as_json( &vulkan_context.startup_cache, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"total_seconds\": %.6f,\n", total_seconds );
+	fprintf( output, "  \"frames_per_second\": %.3f,\n", (double)frames_submitted / total_seconds );
+	fprintf( output, "  \"frame_time_ms\": {\n" );
+	fprintf( output, "    \"min\": %.4f,\n", (double)frame_times[0] / 1.0e6 );
+	fprintf( output, "    \"mean\": %.4f,\n", (double)sum_of_frame_times / (double)options.count_of_frames / 1.0e6 );
+	fprintf( output, "    \"p50\": %.4f,\n", frame_time_percentile_in_milliseconds( frame_times, options.count_of_frames, 50.0 ) );
+	fprintf( output, "    \"p99\": %.4f,\n", frame_time_percentile_in_milliseconds( frame_times, options.count_of_frames, 99.0 ) );
+	fprintf( output, "    \"max\": %.4f\n", (double)frame_times[options.count_of_frames - 1] / 1.0e6 );
+	fprintf( output, "  },\n" );
+	fprintf( output, "  \"validation_enabled\": %s,\n", vulkan_context.validation_enabled ? "true" : "false" );
+	fprintf( output, "  \"validation_errors\": %u,\n", vulkan_context.count_of_validation_errors );
+	fprintf( output, "  \"validation_warnings\": %u,\n", vulkan_context.count_of_validation_warnings );
+	fprintf( output, "  \"pacing\": " );
+	export_frame_pacer_as_json( &vulkan_context.pacer, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"profile\": " );
+	export_frame_profiles_as_json( &vulkan_context.profiler, output, "  ", false );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"memory\": " );
+	export_vulkan_memory_statistics_as_json( &vulkan_context.memory, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"device_selection\": " );
+	export_vulkan_device_selection_as_json( &vulkan_context.device_selection, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"frame_graph\": " );
+	export_frame_graph_as_json( &vulkan_context.frame_graph, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"queues\": " );
+	export_vulkan_queue_topology_as_json( &vulkan_context.queue_topology, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"pipeline_cache\": " );
+	export_vulkan_pipeline_cache_as_json( &vulkan_context.pipeline_cache, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"object_cache\": " );
+	export_vulkan_object_cache_as_json( &vulkan_context.object_cache, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"descriptors\": " );
+	export_vulkan_descriptor_allocator_as_json( &vulkan_context.descriptors, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"bindless\": " );
+	export_vulkan_bindless_as_json( &vulkan_context.bindless, vulkan_context.bindless_requested, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"shader_cache\": " );
+	export_vulkan_shader_cache_as_json( &vulkan_context.shader_cache, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"gpu_scene\": " );
+	export_vulkan_gpu_scene_as_json( &vulkan_context.gpu_scene, vulkan_context.gpu_scene_object_count > 0, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"streaming\": " );
+	export_asset_streamer_as_json( &vulkan_context.streamer, output, "  " );
+	fprintf( output, ",\n" );
+	fprintf( output, "  \"jobs\": " );
+	export_job_system_as_json( &vulkan_context.jobs, output, "  " );
+	fprintf( output, "\n}\n" );
+
+	if ( output != stdout ) {
+		fclose( output );
+	}
+
+	if ( options.profile_csv_path ) {
+		write_frame_profiles( &vulkan_context.profiler, options.profile_csv_path, false );
+	}
+
+	if ( options.profile_json_path ) {
+		write_frame_profiles( &vulkan_context.profiler, options.profile_json_path, true );
+	}
+
+	free( frame_times );
+	shutdown_vulkan_context( &vulkan_context );
+	unload_vulkan_library( vulkan_library_handle );
+
+	// NOTE: read after shutdown -- objects leaked at exit are reported when the device and instance go away
+	uint32_t count_of_validation_errors;
+	count_of_validation_errors = vulkan_context.count_of_validation_errors;
+
+	return count_of_validation_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
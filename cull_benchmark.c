@@ -0,0 +1,419 @@
+// CPU culling micro-benchmark. Culls a cloud of random bounding spheres and boxes against a camera frustum with
+// every kernel frustum_culling.c has for this CPU, checks each kernel's visible list against the scalar one, and
+// times the SIMD matrix products (and AVX2 when the CPU has it) against the scalar one. Prints JSON.
+//
+//     cc -O2 -o cull_benchmark cull_benchmark.c -ldl -lpthread -lm       (Linux)
+//     cl /O2 cull_benchmark.c                                            (Windows)
+//
+// Options:  --objects N       (bounding volumes of each kind, default 100000)
+//           --iterations N    (timed runs per kernel, the fastest one is reported, default 200)
+//           --output path     (JSON goes to stdout otherwise)
+// Exits with EXIT_FAILURE if a kernel's visible list differs from the scalar one.
+
+#if defined( _WIN32 )
+#include "win32_platform.c"
+#else
+#include "linux_platform.c"
+#endif
+
+#include <math.h>
+
+#include "vector_math.c"
+#include "frustum_culling.c"
+
+typedef struct {
+
+	uint32_t	count_of_objects;
+	uint32_t	count_of_iterations;
+	char		*output_path;
+
+} Cull_Benchmark_Options;
+
+typedef struct {
+
+	bool		available;
+	bool		matches;
+	uint32_t	count_of_visible;
+	double		best_nanoseconds;
+
+} Cull_Kernel_Result;
+
+// xorshift32 -- fixed seed, so every run culls the same scene
+float
+random_float( uint32_t *state, float low, float high )
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+
+	return low + ( high - low ) * (float)( *state >> 8 ) / 16777216.0f;
+}
+
+// Spheres and boxes share their centers, spread through a cube around the camera so roughly a sixth are in view
+void
+generate_cull_scene( Cull_Spheres *spheres, Cull_Boxes *boxes, uint32_t count )
+{
+	uint32_t state = 0x2545f491;
+
+	for ( uint32_t i = 0; i < count; ++i ) {
+		float x = random_float( &state, -500.0f, 500.0f );
+		float y = random_float( &state, -100.0f, 100.0f );
+		float z = random_float( &state, -500.0f, 500.0f );
+
+		float extent_x = random_float( &state, 0.5f, 4.0f );
+		float extent_y = random_float( &state, 0.5f, 4.0f );
+		float extent_z = random_float( &state, 0.5f, 4.0f );
+
+		spheres->center_x[i] = x;
+		spheres->center_y[i] = y;
+		spheres->center_z[i] = z;
+		spheres->radius[i] 	 = sqrtf( extent_x * extent_x + extent_y * extent_y + extent_z * extent_z );
+
+		boxes->min_x[i] = x - extent_x;
+		boxes->min_y[i] = y - extent_y;
+		boxes->min_z[i] = z - extent_z;
+		boxes->max_x[i] = x + extent_x;
+		boxes->max_y[i] = y + extent_y;
+		boxes->max_z[i] = z + extent_z;
+	}
+
+	return;
+}
+
+void
+run_cull_kernels( Frustum *frustum, Cull_Spheres *spheres, Cull_Boxes *boxes, bool use_boxes,
+				  uint32_t count_of_iterations, Cull_Kernel_Result *results )
+{
+	uint32_t count;
+	count = use_boxes ? boxes->count : spheres->count;
+
+	uint32_t *reference;
+	uint32_t *visible;
+	reference = (uint32_t *)malloc( (uint64_t)count * sizeof (uint32_t) );
+	visible   = (uint32_t *)malloc( (uint64_t)count * sizeof (uint32_t) );
+	if ( !reference || !visible ) {
+		fprintf( stdout, "Unable to allocate the visible lists\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	uint32_t count_of_reference;
+	count_of_reference = use_boxes ? cull_boxes( frustum, boxes, reference, CULL_KERNEL_SCALAR ) :
+									 cull_spheres( frustum, spheres, reference, CULL_KERNEL_SCALAR );
+
+	for ( uint32_t kernel = 0; kernel < COUNT_OF_CULL_KERNELS; ++kernel ) {
+		Cull_Kernel_Result *result;
+		result = &results[kernel];
+		memset( result, 0, sizeof (Cull_Kernel_Result) );
+
+		result->available = is_cull_kernel_available( (Cull_Kernel)kernel );
+		if ( !result->available ) {
+			continue;
+		}
+
+		result->best_nanoseconds = 1e30;
+		for ( uint32_t iteration = 0; iteration < count_of_iterations; ++iteration ) {
+			uint64_t start;
+			start = platform_get_timestamp_in_nanoseconds();
+
+			result->count_of_visible = use_boxes ? cull_boxes( frustum, boxes, visible, (Cull_Kernel)kernel ) :
+												   cull_spheres( frustum, spheres, visible, (Cull_Kernel)kernel );
+
+			uint64_t end;
+			end = platform_get_timestamp_in_nanoseconds();
+
+			if ( (double)( end - start ) < result->best_nanoseconds ) {
+				result->best_nanoseconds = (double)( end - start );
+			}
+		}
+
+		result->matches = ( result->count_of_visible == count_of_reference ) &&
+						  memcmp( visible, reference, (uint64_t)count_of_reference * sizeof (uint32_t) ) == 0;
+	}
+
+	free( reference );
+	free( visible );
+
+	return;
+}
+
+bool
+export_cull_kernel_results_as_json( Cull_Kernel_Result *results, uint32_t count_of_objects, FILE *file, char *indentation )
+{
+	bool all_match = true;
+
+	double scalar_nanoseconds;
+	scalar_nanoseconds = results[CULL_KERNEL_SCALAR].best_nanoseconds;
+
+	uint32_t count_of_exported = 0;
+	for ( uint32_t kernel = 0; kernel < COUNT_OF_CULL_KERNELS; ++kernel ) {
+		Cull_Kernel_Result *result;
+		result = &results[kernel];
+		if ( !result->available ) {
+			continue;
+		}
+
+		fprintf( file, "%s%s\"%s\": { \"visible\": %u, \"matches_scalar\": %s, \"ns_per_object\": %.3f, \"speedup\": %.2f }",
+				 count_of_exported ? ",\n" : "", indentation, cull_kernel_names[kernel], result->count_of_visible, result->matches ? "true" : "false",
+				 result->best_nanoseconds / (double)count_of_objects,
+				 ( result->best_nanoseconds > 0.0 ) ? scalar_nanoseconds / result->best_nanoseconds : 0.0 );
+
+		all_match = all_match && result->matches;
+		++count_of_exported;
+	}
+
+	return all_match;
+}
+
+// Matrix products are timed twice: over the whole batch, where a 100000 object batch is bound by memory and
+// every path lands close together, and over the first MAT4_RESIDENT_COUNT objects, which stay in the cache
+// between runs -- that one shows what the kernels themselves are worth
+#define MAT4_RESIDENT_COUNT		1024						// 3 x 64 KB of matrices
+
+typedef void Mat4_Batch_Function( Mat4 *parents, Mat4 *locals, Mat4 *results, uint32_t count );
+
+typedef struct {
+
+	double	resident_nanoseconds;							// per matrix, fastest run
+	double	streaming_nanoseconds;
+	float	max_error;										// against the scalar results
+
+} Mat4_Batch_Result;
+
+double
+time_mat4_batch( Mat4_Batch_Function *function, Mat4 *parents, Mat4 *locals, Mat4 *results, uint32_t count,
+				 uint32_t count_of_iterations )
+{
+	double best_nanoseconds = 1e30;
+	for ( uint32_t iteration = 0; iteration < count_of_iterations; ++iteration ) {
+		uint64_t start;
+		start = platform_get_timestamp_in_nanoseconds();
+		function( parents, locals, results, count );
+		uint64_t end;
+		end = platform_get_timestamp_in_nanoseconds();
+
+		best_nanoseconds = fmin( best_nanoseconds, (double)( end - start ) );
+	}
+
+	return best_nanoseconds / (double)count;
+}
+
+void
+run_mat4_batch( Mat4_Batch_Function *function, Mat4 *parents, Mat4 *locals, Mat4 *results, Mat4 *scalar_results,
+				uint32_t count, uint32_t count_of_iterations, Mat4_Batch_Result *result )
+{
+	uint32_t resident_count;
+	resident_count = count < MAT4_RESIDENT_COUNT ? count : MAT4_RESIDENT_COUNT;
+
+	result->resident_nanoseconds  = time_mat4_batch( function, parents, locals, results, resident_count, count_of_iterations );
+	result->streaming_nanoseconds = time_mat4_batch( function, parents, locals, results, count, count_of_iterations );
+
+	result->max_error = 0.0f;
+	if ( scalar_results ) {
+		for ( uint32_t i = 0; i < count; ++i ) {
+			for ( uint32_t k = 0; k < 16; ++k ) {
+				result->max_error = fmaxf( result->max_error, fabsf( results[i].m[k] - scalar_results[i].m[k] ) );
+			}
+		}
+	}
+
+	return;
+}
+
+void
+export_mat4_batch_result_as_json( char *name, Mat4_Batch_Result *result, Mat4_Batch_Result *scalar, FILE *file )
+{
+	fprintf( file, ",\n    \"%s\": { \"resident_ns_per_matrix\": %.3f, \"resident_speedup\": %.2f, \"streaming_ns_per_matrix\": %.3f, \"streaming_speedup\": %.2f, \"max_error\": %g }",
+			 name, result->resident_nanoseconds, ( result->resident_nanoseconds > 0.0 ) ? scalar->resident_nanoseconds / result->resident_nanoseconds : 0.0,
+			 result->streaming_nanoseconds, ( result->streaming_nanoseconds > 0.0 ) ? scalar->streaming_nanoseconds / result->streaming_nanoseconds : 0.0,
+			 result->max_error );
+
+	return;
+}
+
+Cull_Benchmark_Options
+parse_cull_benchmark_options( int argument_count, char **arguments )
+{
+	Cull_Benchmark_Options options = { 0 };
+	options.count_of_objects 	= 100000;
+	options.count_of_iterations = 200;
+
+	for ( int i = 1; i < argument_count; ++i ) {
+		bool has_value = ( i + 1 < argument_count );
+
+		if ( strcmp( arguments[i], "--objects" ) == 0 && has_value ) {
+			options.count_of_objects = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--iterations" ) == 0 && has_value ) {
+			options.count_of_iterations = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--output" ) == 0 && has_value ) {
+			options.output_path = arguments[++i];
+		}
+		else {
+			fprintf( stderr, "Unknown or incomplete option: %s\n", arguments[i] );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	if ( options.count_of_objects == 0 || options.count_of_iterations == 0 ) {
+		fprintf( stderr, "Usage: cull_benchmark [--objects N] [--iterations N] [--output path]\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return options;
+}
+
+int
+main( int argument_count, char **arguments )
+{
+	Cull_Benchmark_Options options;
+	options = parse_cull_benchmark_options( argument_count, arguments );
+
+	Cull_Kernel best_kernel;
+	best_kernel = initialize_frustum_culling();
+
+	uint32_t count;
+	count = options.count_of_objects;
+
+	Cull_Spheres spheres;
+	Cull_Boxes boxes;
+	create_cull_spheres( &spheres, count );
+	create_cull_boxes( &boxes, count );
+	generate_cull_scene( &spheres, &boxes, count );
+
+	// the renderer's camera setup, and the same frustum pulled out of its view-projection matrix -- they should agree
+	Vec3 position;
+	position = vec3( 10.0f, 5.0f, -20.0f );
+
+	float yaw 	 		= 0.7f;
+	float pitch  		= -0.2f;
+	float field_of_view = 1.0f;
+	float aspect_ratio 	= 16.0f / 9.0f;
+
+	Frustum frustum;
+	make_camera_frustum( &frustum, position, yaw, pitch, field_of_view, aspect_ratio, 0.1f, 600.0f );
+
+	Vec3 forward;
+	forward = vec3( cosf( pitch ) * sinf( yaw ), sinf( pitch ), -cosf( pitch ) * cosf( yaw ) );
+
+	Mat4 view;
+	Mat4 projection;
+	Mat4 view_projection;
+	view 			= mat4_look_at( position, vec3_add( position, forward ), vec3( 0.0f, 1.0f, 0.0f ) );
+	projection 		= mat4_perspective( field_of_view, aspect_ratio, 0.1f, 600.0f );
+	view_projection = mat4_multiply( &projection, &view );
+
+	Frustum matrix_frustum;
+	make_frustum_from_matrix( &matrix_frustum, &view_projection );
+
+	// NOTE: distances are relative -- the far plane's is hundreds of units, so compare against its size
+	float max_plane_error = 0.0f;
+	for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+		max_plane_error = fmaxf( max_plane_error, fabsf( frustum.normal_x[p] - matrix_frustum.normal_x[p] ) );
+		max_plane_error = fmaxf( max_plane_error, fabsf( frustum.normal_y[p] - matrix_frustum.normal_y[p] ) );
+		max_plane_error = fmaxf( max_plane_error, fabsf( frustum.normal_z[p] - matrix_frustum.normal_z[p] ) );
+		max_plane_error = fmaxf( max_plane_error, fabsf( frustum.distance[p] - matrix_frustum.distance[p] ) /
+												  fmaxf( 1.0f, fabsf( frustum.distance[p] ) ) );
+	}
+
+	Cull_Kernel_Result sphere_results[COUNT_OF_CULL_KERNELS];
+	Cull_Kernel_Result box_results[COUNT_OF_CULL_KERNELS];
+	run_cull_kernels( &frustum, &spheres, &boxes, false, options.count_of_iterations, sphere_results );
+	run_cull_kernels( &frustum, &spheres, &boxes, true, options.count_of_iterations, box_results );
+
+	// world matrices: a parent times a local transform per object
+	Mat4 *parents;
+	Mat4 *locals;
+	Mat4 *results;
+	Mat4 *scalar_results;
+	parents 	   = (Mat4 *)malloc( (uint64_t)count * sizeof (Mat4) );
+	locals 		   = (Mat4 *)malloc( (uint64_t)count * sizeof (Mat4) );
+	results 	   = (Mat4 *)malloc( (uint64_t)count * sizeof (Mat4) );
+	scalar_results = (Mat4 *)malloc( (uint64_t)count * sizeof (Mat4) );
+	if ( !parents || !locals || !results || !scalar_results ) {
+		fprintf( stdout, "Unable to allocate %u matrices\n", count );
+		exit( EXIT_FAILURE );
+	}
+
+	for ( uint32_t i = 0; i < count; ++i ) {
+		Quat rotation;
+		rotation   = quat_from_axis_angle( vec3( 0.0f, 1.0f, 0.0f ), (float)i * 0.01f );
+		parents[i] = mat4_compose( vec3( spheres.center_x[i], spheres.center_y[i], spheres.center_z[i] ), rotation, vec3( 1.0f, 1.0f, 1.0f ) );
+		locals[i]  = mat4_compose( vec3( 0.0f, 1.0f, 0.0f ), quat_identity(), vec3( boxes.max_x[i] - boxes.min_x[i], 1.0f, 1.0f ) );
+	}
+
+	Mat4_Batch_Result scalar_batch;
+	Mat4_Batch_Result simd_batch;
+	Mat4_Batch_Result avx2_batch;
+	run_mat4_batch( mat4_multiply_batch_scalar, parents, locals, scalar_results, NULL, count, options.count_of_iterations, &scalar_batch );
+	run_mat4_batch( mat4_multiply_batch, parents, locals, results, scalar_results, count, options.count_of_iterations, &simd_batch );
+
+	bool has_avx2 = false;
+#if defined( MATH_SSE )
+	has_avx2 = cpu_has_avx2();
+	if ( has_avx2 ) {
+		run_mat4_batch( mat4_multiply_batch_avx2, parents, locals, results, scalar_results, count, options.count_of_iterations, &avx2_batch );
+	}
+#endif
+
+	FILE *file = stdout;
+	if ( options.output_path ) {
+		file = fopen( options.output_path, "w" );
+		if ( !file ) {
+			fprintf( stdout, "Unable to open %s\n", options.output_path );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+#if defined( MATH_SSE )
+	char *math_path = "sse";
+#elif defined( MATH_NEON )
+	char *math_path = "neon";
+#else
+	char *math_path = "scalar_fallback";		// PLAYGROUND_MATH_SCALAR -- mat4_multiply_batch without SIMD
+#endif
+
+	fprintf( file, "{\n" );
+	fprintf( file, "  \"objects\": %u,\n", count );
+	fprintf( file, "  \"iterations\": %u,\n", options.count_of_iterations );
+	fprintf( file, "  \"best_kernel\": \"%s\",\n", cull_kernel_names[best_kernel] );
+	fprintf( file, "  \"frustum_matrix_vs_camera_error\": %g,\n", max_plane_error );
+
+	bool spheres_match;
+	bool boxes_match;
+	fprintf( file, "  \"spheres\": {\n" );
+	spheres_match = export_cull_kernel_results_as_json( sphere_results, count, file, "    " );
+	fprintf( file, "\n  },\n" );
+	fprintf( file, "  \"boxes\": {\n" );
+	boxes_match = export_cull_kernel_results_as_json( box_results, count, file, "    " );
+	fprintf( file, "\n  },\n" );
+
+	fprintf( file, "  \"mat4_multiply\": {\n" );
+	fprintf( file, "    \"resident_matrices\": %u,\n", count < MAT4_RESIDENT_COUNT ? count : MAT4_RESIDENT_COUNT );
+	fprintf( file, "    \"scalar\": { \"resident_ns_per_matrix\": %.3f, \"streaming_ns_per_matrix\": %.3f }",
+			 scalar_batch.resident_nanoseconds, scalar_batch.streaming_nanoseconds );
+	export_mat4_batch_result_as_json( math_path, &simd_batch, &scalar_batch, file );
+	if ( has_avx2 ) {
+		export_mat4_batch_result_as_json( "avx2", &avx2_batch, &scalar_batch, file );
+	}
+	fprintf( file, "\n  }\n" );
+	fprintf( file, "}\n" );
+
+	if ( file != stdout ) {
+		fclose( file );
+	}
+
+	free( parents );
+	free( locals );
+	free( results );
+	free( scalar_results );
+	destroy_cull_spheres( &spheres );
+	destroy_cull_boxes( &boxes );
+
+	if ( !spheres_match || !boxes_match ) {
+		fprintf( stdout, "A culling kernel disagreed with the scalar one\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return 0;
+}
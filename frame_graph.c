@@ -0,0 +1,673 @@
+// Frame graph. Passes declare which resources they touch and how (Frame_Graph_Usage); compiling the graph
+// walks the passes in order, tracks every resource's layout / last write / reads since that write, and works
+// out the barriers each pass actually needs:
+//
+//   read after write    -- memory dependency from the write to the reader's stage, once per reading stage
+//   write after read    -- execution dependency only, no access masks
+//   write after write   -- memory dependency from the last write
+//   layout change       -- image barrier from everything since the last transition
+//   read after read     -- nothing
+//
+// A batch is one vkCmdPipelineBarrier (all of its image barriers plus one global memory barrier for buffers,
+// stage masks OR'ed together) followed by one vkCmdExecuteCommands for all of its passes. Each barrier goes in
+// the earliest batch after the passes it waits for, so a pass only starts a new batch when it depends on a pass
+// in the newest one. Exported resources move into their final usage (the swap chain image to PRESENT_SRC) the
+// same way, in a trailing batch without passes when nothing earlier will do.
+//
+// Passes whose writes nobody reads (and that don't write an exported resource) are culled before compiling
+// and never get recorded. Compiling only looks at usages, not handles -- it happens once after the passes
+// change, the handles are bound every frame. export_frame_graph_as_json() dumps the compiled result.
+//
+// Unity built -- included by vulkan_renderer.c after the recording task types, before Vulkan_Context.
+
+#define MAX_FRAME_GRAPH_PASSES			MAX_RECORDING_TASKS		// every live pass is recorded as one task
+#define MAX_FRAME_GRAPH_RESOURCES		32
+#define MAX_FRAME_GRAPH_PASS_USES		8
+#define MAX_FRAME_GRAPH_BARRIERS		64
+#define MAX_FRAME_GRAPH_BATCHES			( MAX_FRAME_GRAPH_PASSES + 1 )
+
+typedef enum {
+
+	FRAME_GRAPH_USAGE_TRANSFER_READ,
+	FRAME_GRAPH_USAGE_TRANSFER_WRITE,
+	FRAME_GRAPH_USAGE_COLOR_ATTACHMENT_WRITE,
+	FRAME_GRAPH_USAGE_FRAGMENT_SHADER_READ,
+	FRAME_GRAPH_USAGE_COMPUTE_SHADER_READ,
+	FRAME_GRAPH_USAGE_COMPUTE_SHADER_WRITE,
+	FRAME_GRAPH_USAGE_COMPUTE_SHADER_READ_WRITE,		// atomics, read-modify-write
+	FRAME_GRAPH_USAGE_INDIRECT_READ,
+	FRAME_GRAPH_USAGE_VERTEX_READ,
+	FRAME_GRAPH_USAGE_PRESENT,
+	COUNT_OF_FRAME_GRAPH_USAGES
+
+} Frame_Graph_Usage;
+
+typedef struct {
+
+	char					*name;
+	VkPipelineStageFlags	stage;
+	VkAccessFlags			access;
+	VkImageLayout			layout;					// images only
+	bool					writes;
+
+} Frame_Graph_Usage_Info;
+
+Frame_Graph_Usage_Info frame_graph_usages[COUNT_OF_FRAME_GRAPH_USAGES] = {
+	{ "transfer_read", 			VK_PIPELINE_STAGE_TRANSFER_BIT, 				VK_ACCESS_TRANSFER_READ_BIT, 			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 		false },
+	{ "transfer_write", 		VK_PIPELINE_STAGE_TRANSFER_BIT, 				VK_ACCESS_TRANSFER_WRITE_BIT, 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 		true },
+	{ "color_attachment_write", VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 	VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 	VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 	true },
+	{ "fragment_shader_read", 	VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 			VK_ACCESS_SHADER_READ_BIT, 				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 	false },
+	{ "compute_shader_read", 	VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 			VK_ACCESS_SHADER_READ_BIT, 				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 	false },
+	{ "compute_shader_write", 	VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 			VK_ACCESS_SHADER_WRITE_BIT, 			VK_IMAGE_LAYOUT_GENERAL, 					true },
+	{ "compute_shader_read_write", VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 		VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true },
+	{ "indirect_read", 			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 			VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 	VK_IMAGE_LAYOUT_UNDEFINED, 					false },
+	{ "vertex_read", 			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 			VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, 	VK_IMAGE_LAYOUT_UNDEFINED, 					false },
+	{ "present", 				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 			0, 										VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 			false },
+};
+
+typedef enum {
+
+	FRAME_GRAPH_IMAGE,
+	FRAME_GRAPH_BUFFER
+
+} Frame_Graph_Resource_Kind;
+
+typedef struct {
+
+	char						*name;
+	Frame_Graph_Resource_Kind	kind;
+	VkImage						image;					// bound every frame
+	VkBuffer					buffer;
+	VkImageSubresourceRange		subresource_range;
+
+	VkImageLayout				initial_layout;
+	VkPipelineStageFlags		initial_stage;			// 0 -- the stage of its first use (what a semaphore wait on it should use)
+	bool						exported;				// used after the graph -- never culled, ends in final_usage
+	Frame_Graph_Usage			final_usage;
+
+	VkPipelineStageFlags		first_use_stage;		// compiled
+
+} Frame_Graph_Resource;
+
+typedef struct {
+
+	uint32_t					resource;
+	Frame_Graph_Usage			usage;
+
+} Frame_Graph_Use;
+
+typedef struct {
+
+	char						*name;
+	Record_Commands_Function	*record;
+	void						*data;
+	bool						has_side_effects;		// never culled, even when nothing reads what it writes
+
+	Frame_Graph_Use				uses[MAX_FRAME_GRAPH_PASS_USES];
+	uint32_t					count_of_uses;
+
+	bool						live;					// compiled
+	uint32_t					batch;
+
+} Frame_Graph_Pass;
+
+typedef struct {
+
+	uint32_t					resource;
+	uint32_t					batch;
+	VkAccessFlags				src_access;
+	VkAccessFlags				dst_access;
+	VkImageLayout				old_layout;				// images only
+	VkImageLayout				new_layout;
+
+} Frame_Graph_Barrier;
+
+typedef struct {
+
+	VkPipelineStageFlags		src_stages;				// 0 -- nothing to wait for, no vkCmdPipelineBarrier
+	VkPipelineStageFlags		dst_stages;
+	uint32_t					first_barrier;
+	uint32_t					count_of_barriers;
+	uint32_t					first_pass;				// index into live_passes
+	uint32_t					count_of_passes;
+
+} Frame_Graph_Batch;
+
+// what compiling knows about a resource at the current point of the walk
+typedef struct {
+
+	VkImageLayout				layout;
+	VkPipelineStageFlags		write_stage;
+	VkAccessFlags				write_access;
+	VkPipelineStageFlags		read_stages;			// since the last write
+	VkPipelineStageFlags		visible_stages;			// stages the last write has been made visible to
+	bool						used;
+	int32_t						last_batch;				// batch of the last pass that touched it, -1 -- none yet
+
+} Frame_Graph_Resource_State;
+
+typedef struct {
+
+	Frame_Graph_Resource		resources[MAX_FRAME_GRAPH_RESOURCES];
+	uint32_t					count_of_resources;
+	Frame_Graph_Pass			passes[MAX_FRAME_GRAPH_PASSES];
+	uint32_t					count_of_passes;
+	bool						compiled;
+
+	uint32_t					live_passes[MAX_FRAME_GRAPH_PASSES];		// execution order
+	uint32_t					count_of_live_passes;
+	Frame_Graph_Batch			batches[MAX_FRAME_GRAPH_BATCHES];
+	uint32_t					count_of_batches;
+	Frame_Graph_Barrier			barriers[MAX_FRAME_GRAPH_BARRIERS];
+	uint32_t					count_of_barriers;
+
+} Frame_Graph;
+
+uint32_t
+add_frame_graph_resource( Frame_Graph *graph, char *name, Frame_Graph_Resource_Kind kind )
+{
+	if ( graph->count_of_resources == MAX_FRAME_GRAPH_RESOURCES ) {
+		fprintf( stdout, "Too many frame graph resources, %s doesn't fit\n", name );
+		exit( EXIT_FAILURE );
+	}
+
+	Frame_Graph_Resource *resource;
+	resource = &graph->resources[graph->count_of_resources];
+	memset( resource, 0, sizeof (Frame_Graph_Resource) );
+	resource->name = name;
+	resource->kind = kind;
+
+	graph->compiled = false;
+
+	return graph->count_of_resources++;
+}
+
+// Color image with one mip and layer. Its contents coming in are whatever initial_layout says (UNDEFINED --
+// don't care); exported images end the frame in final_usage.
+uint32_t
+add_frame_graph_image( Frame_Graph *graph, char *name, VkImageLayout initial_layout, VkPipelineStageFlags initial_stage,
+					   bool exported, Frame_Graph_Usage final_usage )
+{
+	uint32_t resource_index;
+	resource_index = add_frame_graph_resource( graph, name, FRAME_GRAPH_IMAGE );
+
+	Frame_Graph_Resource *resource;
+	resource = &graph->resources[resource_index];
+	resource->subresource_range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	resource->subresource_range.levelCount = 1;
+	resource->subresource_range.layerCount = 1;
+	resource->initial_layout 			   = initial_layout;
+	resource->initial_stage  			   = initial_stage;
+	resource->exported 	     			   = exported;
+	resource->final_usage    			   = final_usage;
+
+	return resource_index;
+}
+
+uint32_t
+add_frame_graph_buffer( Frame_Graph *graph, char *name, bool exported )
+{
+	uint32_t resource_index;
+	resource_index = add_frame_graph_resource( graph, name, FRAME_GRAPH_BUFFER );
+	graph->resources[resource_index].exported = exported;
+
+	return resource_index;
+}
+
+// Passes execute on the GPU in the order they were added
+uint32_t
+add_frame_graph_pass( Frame_Graph *graph, char *name, Record_Commands_Function *record, void *data )
+{
+	if ( graph->count_of_passes == MAX_FRAME_GRAPH_PASSES ) {
+		fprintf( stdout, "Too many frame graph passes, %s doesn't fit\n", name );
+		exit( EXIT_FAILURE );
+	}
+
+	Frame_Graph_Pass *pass;
+	pass = &graph->passes[graph->count_of_passes];
+	memset( pass, 0, sizeof (Frame_Graph_Pass) );
+	pass->name   = name;
+	pass->record = record;
+	pass->data   = data;
+
+	graph->compiled = false;
+
+	return graph->count_of_passes++;
+}
+
+// For passes whose output leaves the graph some other way (a read back into host memory) -- never culled
+void
+set_frame_graph_pass_side_effects( Frame_Graph *graph, uint32_t pass_index )
+{
+	graph->passes[pass_index].has_side_effects = true;
+	graph->compiled = false;
+
+	return;
+}
+
+// NOTE: one usage per resource per pass -- a pass that reads and writes an image in place declares the write
+void
+use_frame_graph_resource( Frame_Graph *graph, uint32_t pass_index, uint32_t resource_index, Frame_Graph_Usage usage )
+{
+	Frame_Graph_Pass *pass;
+	pass = &graph->passes[pass_index];
+
+	for ( uint32_t i = 0; i < pass->count_of_uses; ++i ) {
+		if ( pass->uses[i].resource == resource_index ) {
+			fprintf( stdout, "Pass %s declares %s twice\n", pass->name, graph->resources[resource_index].name );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	if ( pass->count_of_uses == MAX_FRAME_GRAPH_PASS_USES ) {
+		fprintf( stdout, "Pass %s uses too many resources\n", pass->name );
+		exit( EXIT_FAILURE );
+	}
+
+	pass->uses[pass->count_of_uses].resource = resource_index;
+	pass->uses[pass->count_of_uses].usage    = usage;
+	pass->count_of_uses += 1;
+
+	graph->compiled = false;
+
+	return;
+}
+
+void
+bind_frame_graph_image( Frame_Graph *graph, uint32_t resource_index, VkImage image )
+{
+	graph->resources[resource_index].image = image;
+
+	return;
+}
+
+void
+bind_frame_graph_buffer( Frame_Graph *graph, uint32_t resource_index, VkBuffer buffer )
+{
+	graph->resources[resource_index].buffer = buffer;
+
+	return;
+}
+
+// Walks back from the exported resources: a pass lives if it has side effects or writes something a live
+// pass after it (or the outside world) reads
+void
+cull_frame_graph_passes( Frame_Graph *graph )
+{
+	bool needed[MAX_FRAME_GRAPH_RESOURCES];
+	for ( uint32_t i = 0; i < graph->count_of_resources; ++i ) {
+		needed[i] = graph->resources[i].exported;
+	}
+
+	for ( uint32_t p = graph->count_of_passes; p-- > 0; ) {
+		Frame_Graph_Pass *pass;
+		pass = &graph->passes[p];
+
+		pass->live = pass->has_side_effects;
+		for ( uint32_t i = 0; i < pass->count_of_uses; ++i ) {
+			if ( frame_graph_usages[pass->uses[i].usage].writes && needed[pass->uses[i].resource] ) {
+				pass->live = true;
+			}
+		}
+
+		if ( !pass->live ) {
+			continue;
+		}
+
+		for ( uint32_t i = 0; i < pass->count_of_uses; ++i ) {
+			if ( !frame_graph_usages[pass->uses[i].usage].writes ) {
+				needed[pass->uses[i].resource] = true;
+			}
+		}
+	}
+
+	graph->count_of_live_passes = 0;
+	for ( uint32_t p = 0; p < graph->count_of_passes; ++p ) {
+		if ( graph->passes[p].live ) {
+			graph->live_passes[graph->count_of_live_passes++] = p;
+		}
+	}
+
+	return;
+}
+
+// What one use of a resource has to wait for, worked out before the pass is placed in a batch
+typedef struct {
+
+	bool						needs_barrier;
+	bool						layout_change;
+	VkPipelineStageFlags		src_stages;
+	VkAccessFlags				src_access;
+	uint32_t					earliest_batch;			// first barrier point after everything it waits for
+
+} Frame_Graph_Dependency;
+
+Frame_Graph_Dependency
+find_frame_graph_dependency( Frame_Graph *graph, Frame_Graph_Resource_State *state, uint32_t resource_index, Frame_Graph_Usage usage )
+{
+	Frame_Graph_Usage_Info *info;
+	info = &frame_graph_usages[usage];
+
+	Frame_Graph_Resource *resource;
+	resource = &graph->resources[resource_index];
+
+	Frame_Graph_Dependency dependency = { 0 };
+	dependency.earliest_batch = (uint32_t)( state->last_batch + 1 );
+
+	// NOTE: an image whose initial stage is 0 comes in through a semaphore waited on at its first use's
+	// stage -- its first transition has to wait on that same stage to chain onto the semaphore
+	VkPipelineStageFlags write_stage;
+	write_stage = state->write_stage;
+	if ( !state->used && resource->kind == FRAME_GRAPH_IMAGE && resource->initial_stage == 0 ) {
+		write_stage = info->stage;
+	}
+
+	dependency.layout_change = ( resource->kind == FRAME_GRAPH_IMAGE && state->layout != info->layout );
+
+	if ( dependency.layout_change ) {
+		dependency.src_stages    = write_stage | state->read_stages;
+		dependency.src_access    = state->write_access;
+		dependency.needs_barrier = true;
+	}
+	else if ( info->writes ) {
+		if ( state->read_stages ) {
+			// reads already waited on the write before them, waiting on the reads chains onto it
+			dependency.src_stages    = state->read_stages;
+			dependency.needs_barrier = true;
+		}
+		else if ( write_stage ) {
+			dependency.src_stages    = write_stage;
+			dependency.src_access    = state->write_access;
+			dependency.needs_barrier = true;
+		}
+	}
+	else if ( state->write_access && !( state->visible_stages & info->stage ) ) {
+		dependency.src_stages    = write_stage;
+		dependency.src_access    = state->write_access;
+		dependency.needs_barrier = true;
+	}
+
+	// nothing before it at all -- still has to start after the top of the frame
+	if ( dependency.needs_barrier && dependency.src_stages == 0 ) {
+		dependency.src_stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+	}
+
+	return dependency;
+}
+
+// Puts the dependency's barrier in batch_index and moves the resource state on to after a use in pass_batch
+void
+commit_frame_graph_use( Frame_Graph *graph, Frame_Graph_Resource_State *state, uint32_t resource_index, Frame_Graph_Usage usage,
+						Frame_Graph_Dependency *dependency, uint32_t batch_index, uint32_t pass_batch )
+{
+	Frame_Graph_Usage_Info *info;
+	info = &frame_graph_usages[usage];
+
+	Frame_Graph_Resource *resource;
+	resource = &graph->resources[resource_index];
+
+	if ( !state->used ) {
+		state->used = true;
+		resource->first_use_stage = info->stage;
+	}
+
+	if ( dependency->needs_barrier ) {
+		Frame_Graph_Batch *batch;
+		batch = &graph->batches[batch_index];
+		batch->src_stages |= dependency->src_stages;
+		batch->dst_stages |= info->stage;
+
+		// write after read is a pure execution dependency -- no barrier struct needed
+		if ( dependency->layout_change || dependency->src_access ) {
+			if ( graph->count_of_barriers == MAX_FRAME_GRAPH_BARRIERS ) {
+				fprintf( stdout, "Too many frame graph barriers\n" );
+				exit( EXIT_FAILURE );
+			}
+
+			Frame_Graph_Barrier *barrier;
+			barrier = &graph->barriers[graph->count_of_barriers++];
+			barrier->resource   = resource_index;
+			barrier->batch      = batch_index;
+			barrier->src_access = dependency->src_access;
+			barrier->dst_access = info->access;
+			barrier->old_layout = state->layout;
+			barrier->new_layout = dependency->layout_change ? info->layout : state->layout;
+		}
+	}
+
+	if ( dependency->layout_change ) {
+		state->layout = info->layout;
+	}
+
+	if ( info->writes ) {
+		state->write_stage    = info->stage;
+		state->write_access   = info->access;
+		state->read_stages    = 0;
+		state->visible_stages = 0;
+	}
+	else {
+		state->read_stages |= info->stage;
+		if ( dependency->needs_barrier ) {
+			state->visible_stages |= info->stage;
+		}
+	}
+
+	state->last_batch = (int32_t)pass_batch;
+
+	return;
+}
+
+Frame_Graph_Batch *
+open_frame_graph_batch( Frame_Graph *graph )
+{
+	Frame_Graph_Batch *batch;
+	batch = &graph->batches[graph->count_of_batches++];
+	memset( batch, 0, sizeof (Frame_Graph_Batch) );
+
+	return batch;
+}
+
+// NOTE: a barrier goes in the earliest batch after everything it waits for -- often well before the pass
+// that needs it. A pass only opens a new batch when it depends on a pass in the newest one.
+void
+compile_frame_graph( Frame_Graph *graph )
+{
+	cull_frame_graph_passes( graph );
+
+	Frame_Graph_Resource_State states[MAX_FRAME_GRAPH_RESOURCES];
+	memset( states, 0, sizeof (states) );
+	for ( uint32_t i = 0; i < graph->count_of_resources; ++i ) {
+		states[i].layout      = graph->resources[i].initial_layout;
+		states[i].write_stage = graph->resources[i].initial_stage;
+		states[i].last_batch  = -1;
+		graph->resources[i].first_use_stage = 0;
+	}
+
+	graph->count_of_batches  = 0;
+	graph->count_of_barriers = 0;
+	open_frame_graph_batch( graph );
+
+	for ( uint32_t i = 0; i < graph->count_of_live_passes; ++i ) {
+		Frame_Graph_Pass *pass;
+		pass = &graph->passes[graph->live_passes[i]];
+
+		Frame_Graph_Dependency dependencies[MAX_FRAME_GRAPH_PASS_USES];
+		uint32_t pass_batch;
+		pass_batch = graph->count_of_batches - 1;
+		for ( uint32_t u = 0; u < pass->count_of_uses; ++u ) {
+			dependencies[u] = find_frame_graph_dependency( graph, &states[pass->uses[u].resource], pass->uses[u].resource, pass->uses[u].usage );
+			if ( dependencies[u].needs_barrier && dependencies[u].earliest_batch > pass_batch ) {
+				pass_batch = dependencies[u].earliest_batch;
+			}
+		}
+
+		if ( pass_batch == graph->count_of_batches ) {
+			open_frame_graph_batch( graph )->first_pass = i;
+		}
+
+		for ( uint32_t u = 0; u < pass->count_of_uses; ++u ) {
+			commit_frame_graph_use( graph, &states[pass->uses[u].resource], pass->uses[u].resource, pass->uses[u].usage,
+									&dependencies[u], dependencies[u].earliest_batch, pass_batch );
+		}
+
+		pass->batch = pass_batch;
+		graph->batches[pass_batch].count_of_passes += 1;
+	}
+
+	// exported resources move into their final usage after the last pass that touches them -- only needs a
+	// batch of its own when that pass is in the newest batch
+	for ( uint32_t i = 0; i < graph->count_of_resources; ++i ) {
+		if ( !graph->resources[i].exported || graph->resources[i].kind != FRAME_GRAPH_IMAGE ) {
+			continue;
+		}
+
+		Frame_Graph_Dependency dependency;
+		dependency = find_frame_graph_dependency( graph, &states[i], i, graph->resources[i].final_usage );
+		if ( !dependency.needs_barrier ) {
+			continue;
+		}
+
+		if ( dependency.earliest_batch == graph->count_of_batches ) {
+			open_frame_graph_batch( graph )->first_pass = graph->count_of_live_passes;
+		}
+
+		commit_frame_graph_use( graph, &states[i], i, graph->resources[i].final_usage, &dependency, dependency.earliest_batch, dependency.earliest_batch );
+	}
+
+	// group the barriers by batch, keeping their order within one
+	Frame_Graph_Barrier sorted_barriers[MAX_FRAME_GRAPH_BARRIERS];
+	uint32_t count_of_sorted_barriers = 0;
+	for ( uint32_t b = 0; b < graph->count_of_batches; ++b ) {
+		graph->batches[b].first_barrier = count_of_sorted_barriers;
+		for ( uint32_t i = 0; i < graph->count_of_barriers; ++i ) {
+			if ( graph->barriers[i].batch == b ) {
+				sorted_barriers[count_of_sorted_barriers++] = graph->barriers[i];
+			}
+		}
+		graph->batches[b].count_of_barriers = count_of_sorted_barriers - graph->batches[b].first_barrier;
+	}
+	memcpy( graph->barriers, sorted_barriers, count_of_sorted_barriers * sizeof (Frame_Graph_Barrier) );
+
+	graph->compiled = true;
+
+	return;
+}
+
+// One vkCmdPipelineBarrier for the whole batch, nothing when it has nothing to wait for
+void
+record_frame_graph_batch_barriers( Frame_Graph *graph, Vulkan_Device_Dispatch *dispatch, VkCommandBuffer command_buffer, uint32_t batch_index )
+{
+	Frame_Graph_Batch *batch;
+	batch = &graph->batches[batch_index];
+
+	if ( batch->src_stages == 0 ) {
+		return;
+	}
+
+	VkImageMemoryBarrier image_barriers[MAX_FRAME_GRAPH_BARRIERS];
+	uint32_t count_of_image_barriers = 0;
+
+	VkMemoryBarrier memory_barrier = { 0 };
+	memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+	for ( uint32_t i = 0; i < batch->count_of_barriers; ++i ) {
+		Frame_Graph_Barrier *barrier;
+		barrier = &graph->barriers[batch->first_barrier + i];
+
+		Frame_Graph_Resource *resource;
+		resource = &graph->resources[barrier->resource];
+
+		if ( resource->kind == FRAME_GRAPH_BUFFER ) {
+			memory_barrier.srcAccessMask |= barrier->src_access;
+			memory_barrier.dstAccessMask |= barrier->dst_access;
+			continue;
+		}
+
+		VkImageMemoryBarrier *image_barrier;
+		image_barrier = &image_barriers[count_of_image_barriers++];
+		memset( image_barrier, 0, sizeof (VkImageMemoryBarrier) );
+		image_barrier->sType 			   = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		image_barrier->srcAccessMask 	   = barrier->src_access;
+		image_barrier->dstAccessMask 	   = barrier->dst_access;
+		image_barrier->oldLayout 		   = barrier->old_layout;
+		image_barrier->newLayout 		   = barrier->new_layout;
+		image_barrier->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		image_barrier->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		image_barrier->image 			   = resource->image;
+		image_barrier->subresourceRange    = resource->subresource_range;
+	}
+
+	uint32_t count_of_memory_barriers;
+	count_of_memory_barriers = ( memory_barrier.srcAccessMask || memory_barrier.dstAccessMask ) ? 1 : 0;
+
+	dispatch->vkCmdPipelineBarrier( command_buffer, batch->src_stages, batch->dst_stages, 0,
+									count_of_memory_barriers, &memory_barrier,
+									0, NULL,
+									count_of_image_barriers, image_barriers );
+
+	return;
+}
+
+char *
+get_frame_graph_layout_name( VkImageLayout layout )
+{
+	switch ( layout ) {
+		case VK_IMAGE_LAYOUT_UNDEFINED:					return "undefined";
+		case VK_IMAGE_LAYOUT_GENERAL:					return "general";
+		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:	return "color_attachment";
+		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:	return "shader_read_only";
+		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:		return "transfer_src";
+		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:		return "transfer_dst";
+		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:			return "present_src";
+		default:										return "other";
+	}
+}
+
+// The compiled graph: every pass (culled ones too) with its uses, and the batches in execution order
+void
+export_frame_graph_as_json( Frame_Graph *graph, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"passes\": [\n", indentation );
+	for ( uint32_t p = 0; p < graph->count_of_passes; ++p ) {
+		Frame_Graph_Pass *pass;
+		pass = &graph->passes[p];
+
+		fprintf( output, "%s    { \"name\": \"%s\", \"live\": %s, \"uses\": [", indentation, pass->name, pass->live ? "true" : "false" );
+		for ( uint32_t i = 0; i < pass->count_of_uses; ++i ) {
+			fprintf( output, "%s{ \"resource\": \"%s\", \"usage\": \"%s\" }", i ? ", " : " ",
+					 graph->resources[pass->uses[i].resource].name, frame_graph_usages[pass->uses[i].usage].name );
+		}
+		fprintf( output, " ] }%s\n", p + 1 < graph->count_of_passes ? "," : "" );
+	}
+	fprintf( output, "%s  ],\n", indentation );
+
+	fprintf( output, "%s  \"batches\": [\n", indentation );
+	for ( uint32_t b = 0; b < graph->count_of_batches; ++b ) {
+		Frame_Graph_Batch *batch;
+		batch = &graph->batches[b];
+
+		fprintf( output, "%s    {\n", indentation );
+		fprintf( output, "%s      \"src_stages\": \"0x%x\", \"dst_stages\": \"0x%x\",\n", indentation, batch->src_stages, batch->dst_stages );
+		fprintf( output, "%s      \"barriers\": [", indentation );
+		for ( uint32_t i = 0; i < batch->count_of_barriers; ++i ) {
+			Frame_Graph_Barrier *barrier;
+			barrier = &graph->barriers[batch->first_barrier + i];
+
+			fprintf( output, "%s{ \"resource\": \"%s\", \"src_access\": \"0x%x\", \"dst_access\": \"0x%x\", \"old_layout\": \"%s\", \"new_layout\": \"%s\" }",
+					 i ? ", " : " ", graph->resources[barrier->resource].name, barrier->src_access, barrier->dst_access,
+					 get_frame_graph_layout_name( barrier->old_layout ), get_frame_graph_layout_name( barrier->new_layout ) );
+		}
+		fprintf( output, " ],\n" );
+		fprintf( output, "%s      \"passes\": [", indentation );
+		for ( uint32_t i = 0; i < batch->count_of_passes; ++i ) {
+			fprintf( output, "%s\"%s\"", i ? ", " : " ", graph->passes[graph->live_passes[batch->first_pass + i]].name );
+		}
+		fprintf( output, " ]\n" );
+		fprintf( output, "%s    }%s\n", indentation, b + 1 < graph->count_of_batches ? "," : "" );
+	}
+	fprintf( output, "%s  ]\n", indentation );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,279 @@
+// Frame pacer. Instead of starting the next frame the moment the last one was handed to present (and then
+// blocking in acquire / on a fence with a queue of finished frames in front of it), draw() asks the pacer when
+// to start and sleeps until then, so the frame's GPU work completes just in time for its deadline.
+//
+// The pacer learns two costs from what actually happened: CPU work (frame start to submit) and GPU work
+// (submit or previous completion, whichever is later, to the frame's fence signaling). Both are smoothed the
+// way TCP smooths round trip times -- a moving average plus a moving mean deviation -- and the start time is
+// the deadline minus the average plus two deviations of each.
+//
+// Deadlines come from the target frame rate (one target interval after the previous deadline) and / or the
+// latency budget (right when the frames already queued on the GPU are predicted to be done, so this one never
+// waits in line). A frame that can't make its deadline re-anchors the schedule at "now + predicted work".
+//
+// Achieved latency (frame start to GPU completion) and present intervals go into rings of
+// FRAME_PACER_HISTORY_SIZE for average / jitter / max reporting. Jitter is the mean absolute deviation.
+//
+// Unity built -- included by vulkan_renderer.c, knows nothing about Vulkan; the renderer feeds it timestamps.
+
+#define FRAME_PACER_HISTORY_SIZE		256
+#define FRAME_PACER_SMOOTHING_SHIFT		3					// new sample weighs 1/8 -- same as TCP's SRTT
+#define FRAME_PACER_DEVIATION_FACTOR	2
+
+typedef struct {
+
+	int64_t			average;
+	int64_t			deviation;
+	bool			has_samples;
+
+} Frame_Pacer_Estimate;
+
+typedef struct {
+
+	double			average;
+	double			jitter;
+	double			maximum;
+
+} Frame_Pacer_Statistic;
+
+typedef struct {
+
+	uint64_t		target_interval_nanoseconds;		// 0 -- no frame rate target
+	uint64_t		latency_budget_nanoseconds;			// 0 -- no latency target
+	bool			enabled;							// false -- only measures, draw() never sleeps
+
+	Frame_Pacer_Estimate	cpu_work;
+	Frame_Pacer_Estimate	gpu_work;
+
+	uint64_t		last_deadline;
+	uint64_t		last_submit;
+	uint64_t		last_completion;
+	uint64_t		last_present;
+
+	uint64_t		latency_history[FRAME_PACER_HISTORY_SIZE];
+	uint64_t		count_of_latency_samples;
+	uint64_t		present_interval_history[FRAME_PACER_HISTORY_SIZE];
+	uint64_t		count_of_present_interval_samples;
+
+	uint64_t		count_of_frames_paced;
+	uint64_t		count_of_deadline_misses;
+	uint64_t		count_of_budget_misses;
+	uint64_t		total_sleep_nanoseconds;
+
+} Frame_Pacer;
+
+// Either target can be 0. Both 0 leaves the pacer measuring only.
+void
+create_frame_pacer( Frame_Pacer *pacer, double target_frames_per_second, double latency_budget_milliseconds )
+{
+	memset( pacer, 0, sizeof (Frame_Pacer) );
+
+	if ( target_frames_per_second > 0.0 ) {
+		pacer->target_interval_nanoseconds = (uint64_t)( 1.0e9 / target_frames_per_second );
+	}
+
+	if ( latency_budget_milliseconds > 0.0 ) {
+		pacer->latency_budget_nanoseconds = (uint64_t)( latency_budget_milliseconds * 1.0e6 );
+	}
+
+	pacer->enabled = ( pacer->target_interval_nanoseconds != 0 || pacer->latency_budget_nanoseconds != 0 );
+
+	return;
+}
+
+void
+update_frame_pacer_estimate( Frame_Pacer_Estimate *estimate, uint64_t sample )
+{
+	if ( !estimate->has_samples ) {
+		estimate->average     = (int64_t)sample;
+		estimate->deviation   = (int64_t)sample / 2;
+		estimate->has_samples = true;
+		return;
+	}
+
+	int64_t error;
+	error = (int64_t)sample - estimate->average;
+
+	estimate->average   += error >> FRAME_PACER_SMOOTHING_SHIFT;
+	estimate->deviation += ( ( error < 0 ? -error : error ) - estimate->deviation ) >> FRAME_PACER_SMOOTHING_SHIFT;
+
+	return;
+}
+
+uint64_t
+get_frame_pacer_prediction( Frame_Pacer_Estimate *estimate )
+{
+	return (uint64_t)( estimate->average + FRAME_PACER_DEVIATION_FACTOR * estimate->deviation );
+}
+
+// Returns when the next frame should start its CPU work and writes the deadline its GPU work should meet by.
+// A start time at or before now means start right away. The schedule only moves on once the frame is actually
+// submitted (record_frame_pacer_submit) -- a frame draw() gives up on, e.g. for a swap chain rebuild, doesn't
+// use up a deadline.
+uint64_t
+plan_frame_pacer_start( Frame_Pacer *pacer, uint64_t now, uint64_t *deadline )
+{
+	uint64_t predicted_work;
+	predicted_work = get_frame_pacer_prediction( &pacer->cpu_work ) + get_frame_pacer_prediction( &pacer->gpu_work );
+
+	uint64_t earliest_deadline;
+	earliest_deadline = now + predicted_work;
+
+	if ( !pacer->enabled ) {
+		*deadline = earliest_deadline;
+		return now;
+	}
+
+	uint64_t planned_deadline = 0;
+
+	if ( pacer->target_interval_nanoseconds ) {
+		planned_deadline = pacer->last_deadline + pacer->target_interval_nanoseconds;
+	}
+
+	// NOTE: the GPU picks this frame up once everything submitted before it is done -- start late enough
+	// that the submit lands right then instead of waiting in the queue
+	if ( pacer->latency_budget_nanoseconds ) {
+		uint64_t gpu_free;
+		gpu_free = pacer->last_completion;
+		if ( pacer->last_submit > pacer->last_completion ) {
+			gpu_free = pacer->last_submit + get_frame_pacer_prediction( &pacer->gpu_work );
+		}
+
+		uint64_t latency_deadline;
+		latency_deadline = gpu_free + get_frame_pacer_prediction( &pacer->gpu_work );
+		if ( latency_deadline > planned_deadline ) {
+			planned_deadline = latency_deadline;
+		}
+	}
+
+	// fell behind (or first frame) -- re-anchor the schedule rather than trying to catch up
+	if ( planned_deadline < earliest_deadline ) {
+		planned_deadline = earliest_deadline;
+	}
+
+	*deadline = planned_deadline;
+
+	return planned_deadline - predicted_work;
+}
+
+void
+record_frame_pacer_start( Frame_Pacer *pacer, uint64_t planned_at, uint64_t started_at )
+{
+	pacer->count_of_frames_paced   += 1;
+	pacer->total_sleep_nanoseconds += started_at - planned_at;
+
+	return;
+}
+
+void
+record_frame_pacer_submit( Frame_Pacer *pacer, uint64_t started_at, uint64_t deadline, uint64_t submitted_at )
+{
+	update_frame_pacer_estimate( &pacer->cpu_work, submitted_at - started_at );
+	pacer->last_submit 	 = submitted_at;
+	pacer->last_deadline = deadline;
+
+	return;
+}
+
+// NOTE: completions must be recorded in submission order. completed_at is when the fence was seen signaled,
+// so it's an upper bound -- the renderer polls while it sleeps to keep that close.
+void
+record_frame_pacer_completion( Frame_Pacer *pacer, uint64_t started_at, uint64_t submitted_at, uint64_t deadline, uint64_t completed_at )
+{
+	uint64_t gpu_started_at;
+	gpu_started_at = submitted_at > pacer->last_completion ? submitted_at : pacer->last_completion;
+	if ( completed_at > gpu_started_at ) {
+		update_frame_pacer_estimate( &pacer->gpu_work, completed_at - gpu_started_at );
+	}
+	pacer->last_completion = completed_at;
+
+	uint64_t latency;
+	latency = completed_at - started_at;
+	pacer->latency_history[pacer->count_of_latency_samples % FRAME_PACER_HISTORY_SIZE] = latency;
+	pacer->count_of_latency_samples += 1;
+
+	if ( pacer->enabled && completed_at > deadline ) {
+		pacer->count_of_deadline_misses += 1;
+	}
+
+	if ( pacer->latency_budget_nanoseconds && latency > pacer->latency_budget_nanoseconds ) {
+		pacer->count_of_budget_misses += 1;
+	}
+
+	return;
+}
+
+void
+record_frame_pacer_present( Frame_Pacer *pacer, uint64_t presented_at )
+{
+	if ( pacer->last_present ) {
+		pacer->present_interval_history[pacer->count_of_present_interval_samples % FRAME_PACER_HISTORY_SIZE] = presented_at - pacer->last_present;
+		pacer->count_of_present_interval_samples += 1;
+	}
+	pacer->last_present = presented_at;
+
+	return;
+}
+
+// Average / jitter / max in milliseconds over the samples still in the ring
+Frame_Pacer_Statistic
+compute_frame_pacer_statistic( uint64_t *history, uint64_t count_of_samples )
+{
+	Frame_Pacer_Statistic statistic = { 0 };
+
+	uint32_t count;
+	count = (uint32_t)( count_of_samples < FRAME_PACER_HISTORY_SIZE ? count_of_samples : FRAME_PACER_HISTORY_SIZE );
+	if ( count == 0 ) {
+		return statistic;
+	}
+
+	double sum = 0.0;
+	for ( uint32_t i = 0; i < count; ++i ) {
+		double sample;
+		sample = (double)history[i] / 1.0e6;
+
+		sum += sample;
+		if ( sample > statistic.maximum ) {
+			statistic.maximum = sample;
+		}
+	}
+	statistic.average = sum / (double)count;
+
+	double sum_of_deviations = 0.0;
+	for ( uint32_t i = 0; i < count; ++i ) {
+		double deviation;
+		deviation = (double)history[i] / 1.0e6 - statistic.average;
+		sum_of_deviations += ( deviation < 0.0 ) ? -deviation : deviation;
+	}
+	statistic.jitter = sum_of_deviations / (double)count;
+
+	return statistic;
+}
+
+void
+export_frame_pacer_as_json( Frame_Pacer *pacer, FILE *output, char *indentation )
+{
+	Frame_Pacer_Statistic latency;
+	latency = compute_frame_pacer_statistic( pacer->latency_history, pacer->count_of_latency_samples );
+
+	Frame_Pacer_Statistic present_interval;
+	present_interval = compute_frame_pacer_statistic( pacer->present_interval_history, pacer->count_of_present_interval_samples );
+
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"enabled\": %s,\n", indentation, pacer->enabled ? "true" : "false" );
+	fprintf( output, "%s  \"target_interval_ms\": %.4f,\n", indentation, (double)pacer->target_interval_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"latency_budget_ms\": %.4f,\n", indentation, (double)pacer->latency_budget_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"frames_paced\": %llu,\n", indentation, (unsigned long long)pacer->count_of_frames_paced );
+	fprintf( output, "%s  \"slept_ms\": %.3f,\n", indentation, (double)pacer->total_sleep_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"deadline_misses\": %llu,\n", indentation, (unsigned long long)pacer->count_of_deadline_misses );
+	fprintf( output, "%s  \"budget_misses\": %llu,\n", indentation, (unsigned long long)pacer->count_of_budget_misses );
+	fprintf( output, "%s  \"predicted_cpu_ms\": %.4f,\n", indentation, (double)get_frame_pacer_prediction( &pacer->cpu_work ) / 1.0e6 );
+	fprintf( output, "%s  \"predicted_gpu_ms\": %.4f,\n", indentation, (double)get_frame_pacer_prediction( &pacer->gpu_work ) / 1.0e6 );
+	fprintf( output, "%s  \"latency_ms\": { \"avg\": %.4f, \"jitter\": %.4f, \"max\": %.4f },\n", indentation,
+			 latency.average, latency.jitter, latency.maximum );
+	fprintf( output, "%s  \"present_interval_ms\": { \"avg\": %.4f, \"jitter\": %.4f, \"max\": %.4f }\n", indentation,
+			 present_interval.average, present_interval.jitter, present_interval.maximum );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,665 @@
+// Batched frustum culling on the CPU. Bounding volumes are kept structure-of-arrays (every center x together, every
+// radius together, ...) so a kernel loads 8 objects' worth of one component with a single load, tests all 8
+// against the six planes, and appends the indices of the survivors to a compact visible list -- no per-object
+// branches, the visible list is the only thing that depends on the result.
+//
+// Kernels, all with the same results (bit for bit -- see the note above the scalar one):
+//
+//   scalar   one object at a time, leaves at the first plane it's outside of
+//   sse      8 objects per step as two 4 wide halves -- x86-64 always has it
+//   avx2     8 objects per step in one register, compiled in with a target attribute and used only when the CPU
+//            says it has it, so the same binary runs on older machines
+//   neon     arm64, 4 wide like sse
+//
+// The compaction is a table lookup: the comparison mask picks a row of lane indices (survivors first), the block's
+// first index is added and all 8 are stored; the write position then moves on by the number of survivors only.
+// The tail that doesn't fill a block goes through the scalar loop, so the stores never run past the list -- the
+// list needs room for every object, as if all were visible.
+//
+// Call initialize_frustum_culling() once before culling; it builds the table and picks the best kernel.
+//
+// Unity built -- included by vulkan_renderer.c and cull_benchmark.c, after vector_math.c.
+
+// NOTE: cpu_has_avx2() and the target attribute come from vector_math.c
+#if defined( MATH_SSE )
+#define CULL_AVX2_FUNCTION MATH_AVX2_FUNCTION
+#endif
+
+#define COUNT_OF_FRUSTUM_PLANES		6
+
+// Planes with inward normals, one array per component -- inside a plane when dot( normal, p ) + distance >= 0.
+// Order: left, right, bottom, top, near, far.
+typedef struct {
+
+	float	normal_x[COUNT_OF_FRUSTUM_PLANES];
+	float	normal_y[COUNT_OF_FRUSTUM_PLANES];
+	float	normal_z[COUNT_OF_FRUSTUM_PLANES];
+	float	distance[COUNT_OF_FRUSTUM_PLANES];
+
+} Frustum;
+
+typedef struct {
+
+	float		*center_x;
+	float		*center_y;
+	float		*center_z;
+	float		*radius;
+	uint32_t	count;
+
+} Cull_Spheres;
+
+typedef struct {
+
+	float		*min_x;
+	float		*min_y;
+	float		*min_z;
+	float		*max_x;
+	float		*max_y;
+	float		*max_z;
+	uint32_t	count;
+
+} Cull_Boxes;
+
+typedef enum {
+
+	CULL_KERNEL_SCALAR,
+	CULL_KERNEL_SSE,
+	CULL_KERNEL_AVX2,
+	CULL_KERNEL_NEON,
+	COUNT_OF_CULL_KERNELS
+
+} Cull_Kernel;
+
+char *cull_kernel_names[COUNT_OF_CULL_KERNELS] = { "scalar", "sse", "avx2", "neon" };
+
+// For every 8 bit survivor mask: the set lanes' indices packed to the front, and how many there are.
+// The first 16 rows double as the 4 wide table.
+typedef struct {
+
+	uint32_t	lanes[256][8];
+	uint8_t		counts[256];
+
+} Cull_Compaction_Table;
+
+Cull_Compaction_Table	cull_compaction_table;
+Cull_Kernel				best_cull_kernel;
+
+//
+// Frustums
+//
+
+void
+normalize_frustum( Frustum *frustum )
+{
+	for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+		float length;
+		length = sqrtf( frustum->normal_x[p] * frustum->normal_x[p] +
+						frustum->normal_y[p] * frustum->normal_y[p] +
+						frustum->normal_z[p] * frustum->normal_z[p] );
+
+		frustum->normal_x[p] /= length;
+		frustum->normal_y[p] /= length;
+		frustum->normal_z[p] /= length;
+		frustum->distance[p] /= length;
+	}
+
+	return;
+}
+
+// Gribb / Hartmann: the planes are sums and differences of the clip matrix's rows. Vulkan clip space, so the near
+// plane is z >= 0 rather than z >= -w, and mat4_perspective's flipped y swaps which row sum is the top.
+// A view-projection gives world space planes, a projection alone view space ones.
+void
+make_frustum_from_matrix( Frustum *frustum, Mat4 *clip )
+{
+	float *m;
+	m = clip->m;
+
+	float sign[COUNT_OF_FRUSTUM_PLANES] 	 = { 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f };
+	uint32_t row_of[COUNT_OF_FRUSTUM_PLANES] = { 0, 0, 1, 1, 2, 2 };
+
+	for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+		uint32_t row;
+		row = row_of[p];
+
+		// near is row 2 on its own, everything else is row 3 +/- the row
+		float w_weight;
+		w_weight = ( p == 4 ) ? 0.0f : 1.0f;
+
+		frustum->normal_x[p] = w_weight * m[3]  + sign[p] * m[0 + row];
+		frustum->normal_y[p] = w_weight * m[7]  + sign[p] * m[4 + row];
+		frustum->normal_z[p] = w_weight * m[11] + sign[p] * m[8 + row];
+		frustum->distance[p] = w_weight * m[15] + sign[p] * m[12 + row];
+	}
+
+	normalize_frustum( frustum );
+
+	return;
+}
+
+// Straight from the camera, no matrices: yaw 0 / pitch 0 looks down -Z with +Y up; angles in radians.
+void
+make_camera_frustum( Frustum *frustum, Vec3 position, float yaw, float pitch,
+					 float vertical_field_of_view, float aspect_ratio, float near_distance, float far_distance )
+{
+	Vec3 forward;
+	forward = vec3( cosf( pitch ) * sinf( yaw ), sinf( pitch ), -cosf( pitch ) * cosf( yaw ) );
+
+	// NOTE: right stays level whatever the pitch, so the camera never rolls
+	Vec3 right;
+	right = vec3( cosf( yaw ), 0.0f, sinf( yaw ) );
+
+	Vec3 up;
+	up = vec3_cross( right, forward );
+
+	float vertical_slope;
+	float horizontal_slope;
+	vertical_slope   = tanf( vertical_field_of_view * 0.5f );
+	horizontal_slope = vertical_slope * aspect_ratio;
+
+	// sides go through the camera, their inward normal leans towards forward by the slope of that side
+	Vec3 normals[COUNT_OF_FRUSTUM_PLANES];
+	normals[0] = vec3_normalize( vec3_add( right, vec3_scale( forward, horizontal_slope ) ) );		// left
+	normals[1] = vec3_normalize( vec3_subtract( vec3_scale( forward, horizontal_slope ), right ) );	// right
+	normals[2] = vec3_normalize( vec3_add( up, vec3_scale( forward, vertical_slope ) ) );			// bottom
+	normals[3] = vec3_normalize( vec3_subtract( vec3_scale( forward, vertical_slope ), up ) );		// top
+	normals[4] = forward;																			// near
+	normals[5] = vec3_scale( forward, -1.0f );														// far
+
+	for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+		frustum->normal_x[p] = normals[p].x;
+		frustum->normal_y[p] = normals[p].y;
+		frustum->normal_z[p] = normals[p].z;
+		frustum->distance[p] = -vec3_dot( normals[p], position );
+	}
+
+	frustum->distance[4] -= near_distance;
+	frustum->distance[5] += far_distance;
+
+	return;
+}
+
+//
+// Bounding volumes
+//
+
+void
+create_cull_spheres( Cull_Spheres *spheres, uint32_t count )
+{
+	float *data;
+	data = (float *)malloc( (uint64_t)( count ? count : 1 ) * 4 * sizeof (float) );
+	if ( !data ) {
+		fprintf( stdout, "Unable to allocate %u cull spheres\n", count );
+		exit( EXIT_FAILURE );
+	}
+
+	spheres->center_x = data;
+	spheres->center_y = data + (uint64_t)count;
+	spheres->center_z = data + (uint64_t)count * 2;
+	spheres->radius   = data + (uint64_t)count * 3;
+	spheres->count 	  = count;
+
+	return;
+}
+
+void
+destroy_cull_spheres( Cull_Spheres *spheres )
+{
+	free( spheres->center_x );
+	memset( spheres, 0, sizeof (Cull_Spheres) );
+
+	return;
+}
+
+void
+create_cull_boxes( Cull_Boxes *boxes, uint32_t count )
+{
+	float *data;
+	data = (float *)malloc( (uint64_t)( count ? count : 1 ) * 6 * sizeof (float) );
+	if ( !data ) {
+		fprintf( stdout, "Unable to allocate %u cull boxes\n", count );
+		exit( EXIT_FAILURE );
+	}
+
+	boxes->min_x = data;
+	boxes->min_y = data + (uint64_t)count;
+	boxes->min_z = data + (uint64_t)count * 2;
+	boxes->max_x = data + (uint64_t)count * 3;
+	boxes->max_y = data + (uint64_t)count * 4;
+	boxes->max_z = data + (uint64_t)count * 5;
+	boxes->count = count;
+
+	return;
+}
+
+void
+destroy_cull_boxes( Cull_Boxes *boxes )
+{
+	free( boxes->min_x );
+	memset( boxes, 0, sizeof (Cull_Boxes) );
+
+	return;
+}
+
+// A box's distance to a plane is decided by its corner furthest along the normal -- per plane that's max or min on
+// each axis by the sign of the normal, the same for every box, so it's picked once per call.
+void
+select_box_corners( Frustum *frustum, Cull_Boxes *boxes, float *corners[COUNT_OF_FRUSTUM_PLANES][3] )
+{
+	for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+		corners[p][0] = ( frustum->normal_x[p] >= 0.0f ) ? boxes->max_x : boxes->min_x;
+		corners[p][1] = ( frustum->normal_y[p] >= 0.0f ) ? boxes->max_y : boxes->min_y;
+		corners[p][2] = ( frustum->normal_z[p] >= 0.0f ) ? boxes->max_z : boxes->min_z;
+	}
+
+	return;
+}
+
+// Every kernel below adds in the same order -- ( ( x * nx + d ) + y * ny ) + z * nz -- and none of it may be
+// contracted into fused multiply-adds (GCC does by default wherever the target has them, arm64 included), so an
+// object exactly on a plane lands on the same side whichever kernel tests it.
+#if defined( __clang__ )
+#pragma STDC FP_CONTRACT OFF
+#elif defined( __GNUC__ )
+#pragma GCC push_options
+#pragma GCC optimize ( "fp-contract=off" )
+#elif defined( _MSC_VER )
+#pragma fp_contract ( off )
+#endif
+
+//
+// Scalar
+//
+
+uint32_t
+cull_spheres_scalar_range( Frustum *frustum, Cull_Spheres *spheres, uint32_t first, uint32_t *visible, uint32_t count_of_visible )
+{
+	for ( uint32_t i = first; i < spheres->count; ++i ) {
+		bool inside = true;
+		for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES && inside; ++p ) {
+			float distance;
+			distance = spheres->center_x[i] * frustum->normal_x[p] + frustum->distance[p];
+			distance = distance + spheres->center_y[i] * frustum->normal_y[p];
+			distance = distance + spheres->center_z[i] * frustum->normal_z[p];
+
+			inside = ( distance >= -spheres->radius[i] );
+		}
+
+		if ( inside ) {
+			visible[count_of_visible++] = i;
+		}
+	}
+
+	return count_of_visible;
+}
+
+uint32_t
+cull_boxes_scalar_range( Frustum *frustum, Cull_Boxes *boxes, uint32_t first, uint32_t *visible, uint32_t count_of_visible )
+{
+	float *corners[COUNT_OF_FRUSTUM_PLANES][3];
+	select_box_corners( frustum, boxes, corners );
+
+	for ( uint32_t i = first; i < boxes->count; ++i ) {
+		bool inside = true;
+		for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES && inside; ++p ) {
+			float distance;
+			distance = corners[p][0][i] * frustum->normal_x[p] + frustum->distance[p];
+			distance = distance + corners[p][1][i] * frustum->normal_y[p];
+			distance = distance + corners[p][2][i] * frustum->normal_z[p];
+
+			inside = ( distance >= 0.0f );
+		}
+
+		if ( inside ) {
+			visible[count_of_visible++] = i;
+		}
+	}
+
+	return count_of_visible;
+}
+
+//
+// SSE
+//
+
+#if defined( MATH_SSE )
+
+uint32_t
+compact_visible_4( uint32_t *visible, uint32_t count_of_visible, uint32_t first, int mask )
+{
+	__m128i indices;
+	indices = _mm_add_epi32( _mm_loadu_si128( (__m128i *)cull_compaction_table.lanes[mask] ), _mm_set1_epi32( (int)first ) );
+	_mm_storeu_si128( (__m128i *)( visible + count_of_visible ), indices );
+
+	return count_of_visible + cull_compaction_table.counts[mask];
+}
+
+uint32_t
+cull_spheres_sse( Frustum *frustum, Cull_Spheres *spheres, uint32_t *visible )
+{
+	uint32_t count_of_visible = 0;
+	uint32_t count_of_blocks;
+	count_of_blocks = spheres->count / 8;
+
+	for ( uint32_t block = 0; block < count_of_blocks; ++block ) {
+		for ( uint32_t half = 0; half < 2; ++half ) {
+			uint32_t first;
+			first = block * 8 + half * 4;
+
+			__m128 x = _mm_loadu_ps( spheres->center_x + first );
+			__m128 y = _mm_loadu_ps( spheres->center_y + first );
+			__m128 z = _mm_loadu_ps( spheres->center_z + first );
+			__m128 negative_radius = _mm_sub_ps( _mm_setzero_ps(), _mm_loadu_ps( spheres->radius + first ) );
+
+			__m128 inside;
+			inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+			for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+				__m128 distance;
+				distance = _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( frustum->normal_x[p] ) ), _mm_set1_ps( frustum->distance[p] ) );
+				distance = _mm_add_ps( distance, _mm_mul_ps( y, _mm_set1_ps( frustum->normal_y[p] ) ) );
+				distance = _mm_add_ps( distance, _mm_mul_ps( z, _mm_set1_ps( frustum->normal_z[p] ) ) );
+				inside 	 = _mm_and_ps( inside, _mm_cmpge_ps( distance, negative_radius ) );
+			}
+
+			count_of_visible = compact_visible_4( visible, count_of_visible, first, _mm_movemask_ps( inside ) );
+		}
+	}
+
+	return cull_spheres_scalar_range( frustum, spheres, count_of_blocks * 8, visible, count_of_visible );
+}
+
+uint32_t
+cull_boxes_sse( Frustum *frustum, Cull_Boxes *boxes, uint32_t *visible )
+{
+	float *corners[COUNT_OF_FRUSTUM_PLANES][3];
+	select_box_corners( frustum, boxes, corners );
+
+	uint32_t count_of_visible = 0;
+	uint32_t count_of_blocks;
+	count_of_blocks = boxes->count / 8;
+
+	for ( uint32_t block = 0; block < count_of_blocks; ++block ) {
+		for ( uint32_t half = 0; half < 2; ++half ) {
+			uint32_t first;
+			first = block * 8 + half * 4;
+
+			__m128 inside;
+			inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+			for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+				__m128 distance;
+				distance = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( corners[p][0] + first ), _mm_set1_ps( frustum->normal_x[p] ) ), _mm_set1_ps( frustum->distance[p] ) );
+				distance = _mm_add_ps( distance, _mm_mul_ps( _mm_loadu_ps( corners[p][1] + first ), _mm_set1_ps( frustum->normal_y[p] ) ) );
+				distance = _mm_add_ps( distance, _mm_mul_ps( _mm_loadu_ps( corners[p][2] + first ), _mm_set1_ps( frustum->normal_z[p] ) ) );
+				inside 	 = _mm_and_ps( inside, _mm_cmpge_ps( distance, _mm_setzero_ps() ) );
+			}
+
+			count_of_visible = compact_visible_4( visible, count_of_visible, first, _mm_movemask_ps( inside ) );
+		}
+	}
+
+	return cull_boxes_scalar_range( frustum, boxes, count_of_blocks * 8, visible, count_of_visible );
+}
+
+//
+// AVX2
+//
+
+CULL_AVX2_FUNCTION uint32_t
+compact_visible_8( uint32_t *visible, uint32_t count_of_visible, uint32_t first, int mask )
+{
+	__m256i indices;
+	indices = _mm256_add_epi32( _mm256_loadu_si256( (__m256i *)cull_compaction_table.lanes[mask] ), _mm256_set1_epi32( (int)first ) );
+	_mm256_storeu_si256( (__m256i *)( visible + count_of_visible ), indices );
+
+	return count_of_visible + cull_compaction_table.counts[mask];
+}
+
+CULL_AVX2_FUNCTION uint32_t
+cull_spheres_avx2( Frustum *frustum, Cull_Spheres *spheres, uint32_t *visible )
+{
+	uint32_t count_of_visible = 0;
+	uint32_t count_of_blocks;
+	count_of_blocks = spheres->count / 8;
+
+	for ( uint32_t block = 0; block < count_of_blocks; ++block ) {
+		uint32_t first;
+		first = block * 8;
+
+		__m256 x = _mm256_loadu_ps( spheres->center_x + first );
+		__m256 y = _mm256_loadu_ps( spheres->center_y + first );
+		__m256 z = _mm256_loadu_ps( spheres->center_z + first );
+		__m256 negative_radius = _mm256_sub_ps( _mm256_setzero_ps(), _mm256_loadu_ps( spheres->radius + first ) );
+
+		__m256 inside;
+		inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+		for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+			__m256 distance;
+			distance = _mm256_add_ps( _mm256_mul_ps( x, _mm256_set1_ps( frustum->normal_x[p] ) ), _mm256_set1_ps( frustum->distance[p] ) );
+			distance = _mm256_add_ps( distance, _mm256_mul_ps( y, _mm256_set1_ps( frustum->normal_y[p] ) ) );
+			distance = _mm256_add_ps( distance, _mm256_mul_ps( z, _mm256_set1_ps( frustum->normal_z[p] ) ) );
+			inside 	 = _mm256_and_ps( inside, _mm256_cmp_ps( distance, negative_radius, _CMP_GE_OQ ) );
+		}
+
+		count_of_visible = compact_visible_8( visible, count_of_visible, first, _mm256_movemask_ps( inside ) );
+	}
+
+	return cull_spheres_scalar_range( frustum, spheres, count_of_blocks * 8, visible, count_of_visible );
+}
+
+CULL_AVX2_FUNCTION uint32_t
+cull_boxes_avx2( Frustum *frustum, Cull_Boxes *boxes, uint32_t *visible )
+{
+	float *corners[COUNT_OF_FRUSTUM_PLANES][3];
+	select_box_corners( frustum, boxes, corners );
+
+	uint32_t count_of_visible = 0;
+	uint32_t count_of_blocks;
+	count_of_blocks = boxes->count / 8;
+
+	for ( uint32_t block = 0; block < count_of_blocks; ++block ) {
+		uint32_t first;
+		first = block * 8;
+
+		__m256 inside;
+		inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+		for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+			__m256 distance;
+			distance = _mm256_add_ps( _mm256_mul_ps( _mm256_loadu_ps( corners[p][0] + first ), _mm256_set1_ps( frustum->normal_x[p] ) ), _mm256_set1_ps( frustum->distance[p] ) );
+			distance = _mm256_add_ps( distance, _mm256_mul_ps( _mm256_loadu_ps( corners[p][1] + first ), _mm256_set1_ps( frustum->normal_y[p] ) ) );
+			distance = _mm256_add_ps( distance, _mm256_mul_ps( _mm256_loadu_ps( corners[p][2] + first ), _mm256_set1_ps( frustum->normal_z[p] ) ) );
+			inside 	 = _mm256_and_ps( inside, _mm256_cmp_ps( distance, _mm256_setzero_ps(), _CMP_GE_OQ ) );
+		}
+
+		count_of_visible = compact_visible_8( visible, count_of_visible, first, _mm256_movemask_ps( inside ) );
+	}
+
+	return cull_boxes_scalar_range( frustum, boxes, count_of_blocks * 8, visible, count_of_visible );
+}
+
+#endif
+
+//
+// NEON
+//
+
+#if defined( MATH_NEON )
+
+uint32_t
+compact_visible_4( uint32_t *visible, uint32_t count_of_visible, uint32_t first, uint32x4_t inside )
+{
+	uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+
+	uint32_t mask;
+	mask = vaddvq_u32( vandq_u32( inside, vld1q_u32( lane_bits ) ) );
+
+	vst1q_u32( visible + count_of_visible, vaddq_u32( vld1q_u32( cull_compaction_table.lanes[mask] ), vdupq_n_u32( first ) ) );
+
+	return count_of_visible + cull_compaction_table.counts[mask];
+}
+
+uint32_t
+cull_spheres_neon( Frustum *frustum, Cull_Spheres *spheres, uint32_t *visible )
+{
+	uint32_t count_of_visible = 0;
+	uint32_t count_of_blocks;
+	count_of_blocks = spheres->count / 8;
+
+	for ( uint32_t block = 0; block < count_of_blocks; ++block ) {
+		for ( uint32_t half = 0; half < 2; ++half ) {
+			uint32_t first;
+			first = block * 8 + half * 4;
+
+			float32x4_t x = vld1q_f32( spheres->center_x + first );
+			float32x4_t y = vld1q_f32( spheres->center_y + first );
+			float32x4_t z = vld1q_f32( spheres->center_z + first );
+			float32x4_t negative_radius = vnegq_f32( vld1q_f32( spheres->radius + first ) );
+
+			uint32x4_t inside;
+			inside = vdupq_n_u32( 0xffffffff );
+			for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+				float32x4_t distance;
+				distance = vmlaq_n_f32( vdupq_n_f32( frustum->distance[p] ), x, frustum->normal_x[p] );
+				distance = vmlaq_n_f32( distance, y, frustum->normal_y[p] );
+				distance = vmlaq_n_f32( distance, z, frustum->normal_z[p] );
+				inside 	 = vandq_u32( inside, vcgeq_f32( distance, negative_radius ) );
+			}
+
+			count_of_visible = compact_visible_4( visible, count_of_visible, first, inside );
+		}
+	}
+
+	return cull_spheres_scalar_range( frustum, spheres, count_of_blocks * 8, visible, count_of_visible );
+}
+
+uint32_t
+cull_boxes_neon( Frustum *frustum, Cull_Boxes *boxes, uint32_t *visible )
+{
+	float *corners[COUNT_OF_FRUSTUM_PLANES][3];
+	select_box_corners( frustum, boxes, corners );
+
+	uint32_t count_of_visible = 0;
+	uint32_t count_of_blocks;
+	count_of_blocks = boxes->count / 8;
+
+	for ( uint32_t block = 0; block < count_of_blocks; ++block ) {
+		for ( uint32_t half = 0; half < 2; ++half ) {
+			uint32_t first;
+			first = block * 8 + half * 4;
+
+			uint32x4_t inside;
+			inside = vdupq_n_u32( 0xffffffff );
+			for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+				float32x4_t distance;
+				distance = vmlaq_n_f32( vdupq_n_f32( frustum->distance[p] ), vld1q_f32( corners[p][0] + first ), frustum->normal_x[p] );
+				distance = vmlaq_n_f32( distance, vld1q_f32( corners[p][1] + first ), frustum->normal_y[p] );
+				distance = vmlaq_n_f32( distance, vld1q_f32( corners[p][2] + first ), frustum->normal_z[p] );
+				inside 	 = vandq_u32( inside, vcgeq_f32( distance, vdupq_n_f32( 0.0f ) ) );
+			}
+
+			count_of_visible = compact_visible_4( visible, count_of_visible, first, inside );
+		}
+	}
+
+	return cull_boxes_scalar_range( frustum, boxes, count_of_blocks * 8, visible, count_of_visible );
+}
+
+#endif
+
+#if defined( __clang__ )
+#pragma STDC FP_CONTRACT DEFAULT
+#elif defined( __GNUC__ )
+#pragma GCC pop_options
+#elif defined( _MSC_VER )
+#pragma fp_contract ( on )
+#endif
+
+//
+// Dispatch
+//
+
+bool
+is_cull_kernel_available( Cull_Kernel kernel )
+{
+	switch ( kernel ) {
+		case CULL_KERNEL_SCALAR:
+			return true;
+#if defined( MATH_SSE )
+		case CULL_KERNEL_SSE:
+			return true;
+		case CULL_KERNEL_AVX2:
+			return cpu_has_avx2();
+#endif
+#if defined( MATH_NEON )
+		case CULL_KERNEL_NEON:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+// Fills the compaction table and returns the widest kernel this CPU runs
+Cull_Kernel
+initialize_frustum_culling( void )
+{
+	for ( uint32_t mask = 0; mask < 256; ++mask ) {
+		uint32_t count = 0;
+		for ( uint32_t lane = 0; lane < 8; ++lane ) {
+			if ( mask & ( 1u << lane ) ) {
+				cull_compaction_table.lanes[mask][count++] = lane;
+			}
+		}
+
+		cull_compaction_table.counts[mask] = (uint8_t)count;
+	}
+
+	best_cull_kernel = CULL_KERNEL_SCALAR;
+	for ( uint32_t kernel = CULL_KERNEL_SSE; kernel < COUNT_OF_CULL_KERNELS; ++kernel ) {
+		if ( is_cull_kernel_available( (Cull_Kernel)kernel ) ) {
+			best_cull_kernel = (Cull_Kernel)kernel;
+		}
+	}
+
+	return best_cull_kernel;
+}
+
+// Writes the indices of the spheres that touch the frustum to visible (room for spheres->count), in order;
+// returns how many
+uint32_t
+cull_spheres( Frustum *frustum, Cull_Spheres *spheres, uint32_t *visible, Cull_Kernel kernel )
+{
+	switch ( kernel ) {
+#if defined( MATH_SSE )
+		case CULL_KERNEL_SSE:
+			return cull_spheres_sse( frustum, spheres, visible );
+		case CULL_KERNEL_AVX2:
+			return cull_spheres_avx2( frustum, spheres, visible );
+#endif
+#if defined( MATH_NEON )
+		case CULL_KERNEL_NEON:
+			return cull_spheres_neon( frustum, spheres, visible );
+#endif
+		default:
+			return cull_spheres_scalar_range( frustum, spheres, 0, visible, 0 );
+	}
+}
+
+// Same for boxes -- conservative like every plane test: a box near a frustum corner may be kept although outside
+uint32_t
+cull_boxes( Frustum *frustum, Cull_Boxes *boxes, uint32_t *visible, Cull_Kernel kernel )
+{
+	switch ( kernel ) {
+#if defined( MATH_SSE )
+		case CULL_KERNEL_SSE:
+			return cull_boxes_sse( frustum, boxes, visible );
+		case CULL_KERNEL_AVX2:
+			return cull_boxes_avx2( frustum, boxes, visible );
+#endif
+#if defined( MATH_NEON )
+		case CULL_KERNEL_NEON:
+			return cull_boxes_neon( frustum, boxes, visible );
+#endif
+		default:
+			return cull_boxes_scalar_range( frustum, boxes, 0, visible, 0 );
+	}
+}
@@ -0,0 +1,365 @@
+// Work-stealing job system. One worker per core: worker 0 is the thread that created the system (the render
+// thread), the rest are platform threads. Every worker owns a Chase-Lev deque -- it pushes and pops its own
+// jobs at the bottom without any locked instruction in the common case, and idle workers steal from the top
+// of somebody else's. Workers that find nothing anywhere go to sleep on a semaphore that submit_job() only
+// touches when someone is actually asleep.
+//
+// Jobs are fire-and-forget with a Job_Counter to wait on; wait_for_job_counter() runs other jobs while it
+// waits, so worker 0 helps out instead of blocking. A job can submit more jobs (to its own worker_index).
+//
+// NOTE: the Job structs come out of a per-worker ring of JOBS_PER_WORKER, so a worker can't have more than
+// that many jobs outstanding -- plenty for per-frame fan-out, where everything is waited on before the next frame.
+//
+// Unity built -- included by vulkan_renderer.c, needs the platform layer's threads, semaphores and atomics.
+
+#define MAX_JOB_WORKERS			16
+#define JOB_DEQUE_CAPACITY		4096			// power of two
+#define JOBS_PER_WORKER			4096
+#define JOB_SPINS_BEFORE_SLEEP	64
+
+typedef void Job_Function( void *data, uint32_t worker_index );
+
+typedef struct {
+
+	volatile int32_t	count_of_pending_jobs;
+
+} Job_Counter;
+
+typedef struct {
+
+	Job_Function	*function;
+	void			*data;
+	Job_Counter		*counter;
+
+} Job;
+
+// NOTE: top and bottom on their own cache lines -- thieves hammer top, the owner hammers bottom
+typedef struct {
+
+	volatile int64_t	top;
+	uint8_t				top_padding[64 - sizeof (int64_t)];
+	volatile int64_t	bottom;
+	uint8_t				bottom_padding[64 - sizeof (int64_t)];
+	void * volatile		jobs[JOB_DEQUE_CAPACITY];
+
+} Job_Deque;
+
+typedef struct Job_System Job_System;
+
+typedef struct {
+
+	Job_Deque			deque;
+	Job_System			*system;
+	uint32_t			worker_index;
+	uint32_t			random_state;				// picks the first victim to steal from
+	uint32_t			next_job;
+	Job					jobs[JOBS_PER_WORKER];
+
+	uint64_t			count_of_jobs_run;
+	uint64_t			count_of_jobs_stolen;
+
+} Job_Worker;
+
+struct Job_System {
+
+	uint32_t			count_of_workers;
+	Job_Worker			*workers;
+	Platform_Thread		threads[MAX_JOB_WORKERS];
+
+	Platform_Semaphore	work_available;
+	volatile int32_t	count_of_sleeping_workers;
+	volatile int32_t	shutting_down;
+
+};
+
+
+// Owner only. false when the deque is full -- the caller runs the job right away instead.
+bool
+push_job( Job_Deque *deque, Job *job )
+{
+	int64_t bottom;
+	int64_t top;
+	bottom = deque->bottom;
+	top    = platform_atomic_load_64( &deque->top );
+
+	if ( bottom - top >= JOB_DEQUE_CAPACITY ) {
+		return false;
+	}
+
+	platform_atomic_store_pointer( &deque->jobs[bottom & ( JOB_DEQUE_CAPACITY - 1 )], job );
+	platform_atomic_store_64( &deque->bottom, bottom + 1 );
+
+	return true;
+}
+
+// Owner only -- newest job first, which keeps what the owner just touched in its cache
+Job *
+pop_job( Job_Deque *deque )
+{
+	int64_t bottom;
+	bottom = deque->bottom - 1;
+	platform_atomic_store_64( &deque->bottom, bottom );
+
+	// NOTE: the store to bottom has to be visible before top is read, or a thief and the owner can both take the last job
+	platform_memory_barrier();
+
+	int64_t top;
+	top = platform_atomic_load_64( &deque->top );
+
+	if ( top > bottom ) {
+		platform_atomic_store_64( &deque->bottom, bottom + 1 );
+		return NULL;
+	}
+
+	Job *job;
+	job = (Job *)platform_atomic_load_pointer( &deque->jobs[bottom & ( JOB_DEQUE_CAPACITY - 1 )] );
+
+	// last job -- race the thieves for it
+	if ( top == bottom ) {
+		if ( !platform_atomic_compare_exchange_64( &deque->top, top, top + 1 ) ) {
+			job = NULL;
+		}
+
+		platform_atomic_store_64( &deque->bottom, bottom + 1 );
+	}
+
+	return job;
+}
+
+// Any thread -- oldest job first. NULL when empty or when another thief got there first.
+Job *
+steal_job( Job_Deque *deque )
+{
+	int64_t top;
+	top = platform_atomic_load_64( &deque->top );
+
+	platform_memory_barrier();
+
+	int64_t bottom;
+	bottom = platform_atomic_load_64( &deque->bottom );
+
+	if ( top >= bottom ) {
+		return NULL;
+	}
+
+	Job *job;
+	job = (Job *)platform_atomic_load_pointer( &deque->jobs[top & ( JOB_DEQUE_CAPACITY - 1 )] );
+
+	if ( !platform_atomic_compare_exchange_64( &deque->top, top, top + 1 ) ) {
+		return NULL;
+	}
+
+	return job;
+}
+
+void
+run_job( Job_Worker *worker, Job *job )
+{
+	job->function( job->data, worker->worker_index );
+
+	worker->count_of_jobs_run += 1;
+	if ( job->counter ) {
+		platform_atomic_add_32( &job->counter->count_of_pending_jobs, -1 );
+	}
+
+	return;
+}
+
+// Own deque first, then every other worker starting at a random one. false if there was nothing to do.
+bool
+run_one_job( Job_System *system, uint32_t worker_index )
+{
+	Job_Worker *worker;
+	worker = &system->workers[worker_index];
+
+	Job *job;
+	job = pop_job( &worker->deque );
+
+	if ( !job && system->count_of_workers > 1 ) {
+		// xorshift32
+		worker->random_state ^= worker->random_state << 13;
+		worker->random_state ^= worker->random_state >> 17;
+		worker->random_state ^= worker->random_state << 5;
+
+		uint32_t first_victim;
+		first_victim = worker->random_state % system->count_of_workers;
+
+		for ( uint32_t i = 0; i < system->count_of_workers && !job; ++i ) {
+			uint32_t victim_index;
+			victim_index = ( first_victim + i ) % system->count_of_workers;
+
+			if ( victim_index == worker_index ) {
+				continue;
+			}
+
+			job = steal_job( &system->workers[victim_index].deque );
+			if ( job ) {
+				worker->count_of_jobs_stolen += 1;
+			}
+		}
+	}
+
+	if ( !job ) {
+		return false;
+	}
+
+	run_job( worker, job );
+
+	return true;
+}
+
+// worker_index is the index of the calling worker -- 0 outside of jobs, the job's own worker_index inside one
+void
+submit_job( Job_System *system, uint32_t worker_index, Job_Function *function, void *data, Job_Counter *counter )
+{
+	Job_Worker *worker;
+	worker = &system->workers[worker_index];
+
+	Job *job;
+	job = &worker->jobs[worker->next_job];
+	worker->next_job = ( worker->next_job + 1 ) % JOBS_PER_WORKER;
+
+	job->function = function;
+	job->data 	  = data;
+	job->counter  = counter;
+
+	if ( counter ) {
+		platform_atomic_add_32( &counter->count_of_pending_jobs, 1 );
+	}
+
+	if ( !push_job( &worker->deque, job ) ) {
+		run_job( worker, job );
+		return;
+	}
+
+	// NOTE: pairs with the increment in job_worker_thread -- either the sleeper sees the job or we see the sleeper
+	platform_memory_barrier();
+	if ( platform_atomic_load_32( &system->count_of_sleeping_workers ) > 0 ) {
+		platform_signal_semaphore( &system->work_available, 1 );
+	}
+
+	return;
+}
+
+// Runs jobs (anyone's) until every job counted by counter has finished
+void
+wait_for_job_counter( Job_System *system, uint32_t worker_index, Job_Counter *counter )
+{
+	while ( platform_atomic_load_32( &counter->count_of_pending_jobs ) > 0 ) {
+		if ( !run_one_job( system, worker_index ) ) {
+			platform_yield_thread();
+		}
+	}
+
+	return;
+}
+
+void
+job_worker_thread( void *worker_as_void )
+{
+	Job_Worker *worker;
+	worker = (Job_Worker *)worker_as_void;
+
+	Job_System *system;
+	system = worker->system;
+
+	uint32_t count_of_idle_spins = 0;
+	while ( !platform_atomic_load_32( &system->shutting_down ) ) {
+		if ( run_one_job( system, worker->worker_index ) ) {
+			count_of_idle_spins = 0;
+			continue;
+		}
+
+		if ( ++count_of_idle_spins < JOB_SPINS_BEFORE_SLEEP ) {
+			platform_yield_thread();
+			continue;
+		}
+
+		// announce the sleep, then look one last time -- a job pushed before the announcement is found here,
+		// one pushed after it comes with a semaphore signal
+		platform_atomic_add_32( &system->count_of_sleeping_workers, 1 );
+		if ( !platform_atomic_load_32( &system->shutting_down ) && !run_one_job( system, worker->worker_index ) ) {
+			platform_wait_semaphore( &system->work_available );
+		}
+		platform_atomic_add_32( &system->count_of_sleeping_workers, -1 );
+
+		count_of_idle_spins = 0;
+	}
+
+	return;
+}
+
+// count_of_workers includes the calling thread; 0 picks one per processor
+void
+create_job_system( Job_System *system, uint32_t count_of_workers )
+{
+	memset( system, 0, sizeof (Job_System) );
+
+	if ( count_of_workers == 0 ) {
+		count_of_workers = platform_get_count_of_processors();
+	}
+
+	if ( count_of_workers > MAX_JOB_WORKERS ) {
+		count_of_workers = MAX_JOB_WORKERS;
+	}
+
+	system->count_of_workers = count_of_workers;
+	system->workers 		 = (Job_Worker *)calloc( count_of_workers, sizeof (Job_Worker) );
+	if ( !system->workers ) {
+		fprintf( stdout, "Unable to allocate space for the job workers\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	platform_create_semaphore( &system->work_available, 0 );
+
+	for ( uint32_t i = 0; i < count_of_workers; ++i ) {
+		system->workers[i].system 		= system;
+		system->workers[i].worker_index = i;
+		system->workers[i].random_state = 0x9e3779b9u * ( i + 1 );
+	}
+
+	for ( uint32_t i = 1; i < count_of_workers; ++i ) {
+		if ( !platform_create_thread( &system->threads[i], job_worker_thread, &system->workers[i] ) ) {
+			fprintf( stdout, "Unable to start job worker thread %u\n", i );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	return;
+}
+
+// NOTE: all submitted jobs must have been waited on
+void
+destroy_job_system( Job_System *system )
+{
+	platform_atomic_store_32( &system->shutting_down, 1 );
+	platform_signal_semaphore( &system->work_available, system->count_of_workers );
+
+	for ( uint32_t i = 1; i < system->count_of_workers; ++i ) {
+		platform_join_thread( system->threads[i] );
+	}
+
+	platform_destroy_semaphore( &system->work_available );
+	free( system->workers );
+
+	return;
+}
+
+// NOTE: counters are plain per-worker fields -- only read them once the workers have gone quiet
+void
+export_job_system_as_json( Job_System *system, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"workers\": %u,\n", indentation, system->count_of_workers );
+	fprintf( output, "%s  \"per_worker\": [\n", indentation );
+	for ( uint32_t i = 0; i < system->count_of_workers; ++i ) {
+		fprintf( output, "%s    { \"jobs_run\": %llu, \"jobs_stolen\": %llu }%s\n", indentation,
+				 (unsigned long long)system->workers[i].count_of_jobs_run,
+				 (unsigned long long)system->workers[i].count_of_jobs_stolen,
+				 i + 1 < system->count_of_workers ? "," : "" );
+	}
+	fprintf( output, "%s  ]\n", indentation );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,501 @@
+// Linux platform layer -- the Vulkan loader plus the few OS services the renderer leans on.
+// Unity built: included first by the Linux entry points (benchmark.c). There is no window system
+// code here, Linux builds present through VK_EXT_headless_surface.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <dlfcn.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+// Load from the platform -- linux
+PFN_vkGetInstanceProcAddr						vkGetInstanceProcAddr;
+
+typedef void * Platform_Library;
+
+Platform_Library
+load_vulkan_library( void ) 
+{
+	void *vulkan_library_handle;
+	vulkan_library_handle = dlopen( "libvulkan.so.1", RTLD_NOW | RTLD_LOCAL );
+	if ( !vulkan_library_handle ) {
+		// unversioned name only exists with the dev package installed
+		vulkan_library_handle = dlopen( "libvulkan.so", RTLD_NOW | RTLD_LOCAL );
+	}
+
+	if ( !vulkan_library_handle ) {
+		fprintf( stdout, "Unable to load the vulkan library: %s\n", dlerror() );
+		exit( EXIT_FAILURE );
+	}
+	
+	return vulkan_library_handle;
+}
+
+void
+load_vulkan_entry_point( Platform_Library vulkan_library_handle )
+{
+	// Load from platform level (linux - dlsym)
+	vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr) dlsym( vulkan_library_handle, "vkGetInstanceProcAddr" );
+	if ( !vkGetInstanceProcAddr ) {
+		fprintf( stdout, "Unable to find vkGetInstanceProcAddr in the vulkan library\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+void
+unload_vulkan_library( Platform_Library vulkan_library_handle )
+{
+	dlclose( vulkan_library_handle );
+
+	return;
+}
+
+uint64_t
+platform_get_timestamp_in_nanoseconds( void )
+{
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+typedef struct {
+
+	void		*data;
+	uint64_t	size;
+
+} Platform_File_Map;
+
+// Read only view of a whole file. false if it doesn't exist / is empty -- callers treat that as "no file".
+bool
+platform_map_file_for_reading( char *path, Platform_File_Map *file_map )
+{
+	file_map->data = NULL;
+	file_map->size = 0;
+
+	int file_descriptor;
+	file_descriptor = open( path, O_RDONLY | O_CLOEXEC );
+	if ( file_descriptor < 0 ) {
+		return false;
+	}
+
+	struct stat file_status;
+	if ( fstat( file_descriptor, &file_status ) != 0 || file_status.st_size == 0 ) {
+		close( file_descriptor );
+		return false;
+	}
+
+	void *data;
+	data = mmap( NULL, (size_t)file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0 );
+	close( file_descriptor );							// the mapping keeps the file alive
+	if ( data == MAP_FAILED ) {
+		return false;
+	}
+
+	file_map->data = data;
+	file_map->size = (uint64_t)file_status.st_size;
+
+	return true;
+}
+
+void
+platform_unmap_file( Platform_File_Map *file_map )
+{
+	if ( file_map->data ) {
+		munmap( file_map->data, (size_t)file_map->size );
+	}
+
+	file_map->data = NULL;
+	file_map->size = 0;
+
+	return;
+}
+
+// Writes to path.tmp and renames it over path, so a crash mid-write leaves the old file intact
+bool
+platform_write_file_atomically( char *path, void *data, uint64_t size )
+{
+	char temporary_path[4096];
+	if ( snprintf( temporary_path, sizeof (temporary_path), "%s.tmp", path ) >= (int)sizeof (temporary_path) ) {
+		return false;
+	}
+
+	int file_descriptor;
+	file_descriptor = open( temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+	if ( file_descriptor < 0 ) {
+		return false;
+	}
+
+	uint8_t *bytes;
+	bytes = (uint8_t *)data;
+
+	uint64_t bytes_written = 0;
+	while ( bytes_written < size ) {
+		ssize_t written;
+		written = write( file_descriptor, bytes + bytes_written, (size_t)( size - bytes_written ) );
+		if ( written <= 0 ) {
+			close( file_descriptor );
+			unlink( temporary_path );
+			return false;
+		}
+
+		bytes_written += (uint64_t)written;
+	}
+
+	// NOTE: without the fsync the rename can hit the disk before the data does
+	if ( fsync( file_descriptor ) != 0 || close( file_descriptor ) != 0 ) {
+		unlink( temporary_path );
+		return false;
+	}
+
+	if ( rename( temporary_path, path ) != 0 ) {
+		unlink( temporary_path );
+		return false;
+	}
+
+	return true;
+}
+
+// Directory watch -- tells the caller which files in one directory were written / moved in. Only non recursive,
+// the shader cache is the only user. One name per call; the rest of an inotify read stays buffered for the next.
+typedef struct {
+
+	int			file_descriptor;
+	int			watch_descriptor;
+	bool		broken;									// poll / read failed for real, the caller stops
+	uint32_t	buffer_size;
+	uint32_t	buffer_offset;
+	uint8_t		buffer[4096] __attribute__ (( aligned ( __alignof__ (struct inotify_event) ) ));
+
+} Platform_Directory_Watch;
+
+bool
+platform_watch_directory( char *path, Platform_Directory_Watch *watch )
+{
+	memset( watch, 0, sizeof (Platform_Directory_Watch) );
+
+	watch->file_descriptor = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if ( watch->file_descriptor < 0 ) {
+		return false;
+	}
+
+	// NOTE: IN_CLOSE_WRITE for tools that write in place, IN_MOVED_TO for tools that write a temp file + rename
+	watch->watch_descriptor = inotify_add_watch( watch->file_descriptor, path, IN_CLOSE_WRITE | IN_MOVED_TO );
+	if ( watch->watch_descriptor < 0 ) {
+		close( watch->file_descriptor );
+		watch->file_descriptor = -1;
+		return false;
+	}
+
+	return true;
+}
+
+// false on timeout. name gets the file name relative to the watched directory.
+bool
+platform_wait_for_directory_change( Platform_Directory_Watch *watch, uint32_t timeout_milliseconds, char *name, uint32_t name_capacity )
+{
+	for ( ;; ) {
+		while ( watch->buffer_offset < watch->buffer_size ) {
+			struct inotify_event *event;
+			event = (struct inotify_event *)( watch->buffer + watch->buffer_offset );
+			watch->buffer_offset += (uint32_t)( sizeof (struct inotify_event) + event->len );
+
+			if ( event->len == 0 || ( event->mask & IN_ISDIR ) ) {
+				continue;
+			}
+
+			if ( snprintf( name, name_capacity, "%s", event->name ) >= (int)name_capacity ) {
+				continue;
+			}
+
+			return true;
+		}
+
+		struct pollfd poll_descriptor = { 0 };
+		poll_descriptor.fd     = watch->file_descriptor;
+		poll_descriptor.events = POLLIN;
+
+		int ready;
+		ready = poll( &poll_descriptor, 1, (int)timeout_milliseconds );
+		if ( ready <= 0 ) {
+			if ( ready < 0 && errno != EINTR ) {
+				fprintf( stderr, "poll on the directory watch failed: %s\n", strerror( errno ) );
+				watch->broken = true;
+			}
+
+			return false;
+		}
+
+		ssize_t bytes_read;
+		bytes_read = read( watch->file_descriptor, watch->buffer, sizeof (watch->buffer) );
+		if ( bytes_read <= 0 ) {
+			if ( bytes_read < 0 && errno != EAGAIN && errno != EINTR ) {
+				fprintf( stderr, "read on the directory watch failed: %s\n", strerror( errno ) );
+				watch->broken = true;
+			}
+
+			return false;
+		}
+
+		watch->buffer_size   = (uint32_t)bytes_read;
+		watch->buffer_offset = 0;
+	}
+}
+
+void
+platform_unwatch_directory( Platform_Directory_Watch *watch )
+{
+	if ( watch->file_descriptor >= 0 ) {
+		close( watch->file_descriptor );				// drops the watch with it
+	}
+
+	watch->file_descriptor = -1;
+
+	return;
+}
+
+// Threads -- only what the job system needs. The trampoline carries the function + parameter into the new
+// thread and frees itself there.
+typedef pthread_t Platform_Thread;
+typedef void Platform_Thread_Function( void *parameter );
+
+typedef struct {
+
+	Platform_Thread_Function	*function;
+	void						*parameter;
+
+} Platform_Thread_Start;
+
+void *
+platform_thread_trampoline( void *start_as_void )
+{
+	Platform_Thread_Start start;
+	start = *(Platform_Thread_Start *)start_as_void;
+	free( start_as_void );
+
+	start.function( start.parameter );
+
+	return NULL;
+}
+
+bool
+platform_create_thread( Platform_Thread *thread, Platform_Thread_Function *function, void *parameter )
+{
+	Platform_Thread_Start *start;
+	start = (Platform_Thread_Start *)malloc( sizeof (Platform_Thread_Start) );
+	if ( !start ) {
+		return false;
+	}
+
+	start->function  = function;
+	start->parameter = parameter;
+
+	if ( pthread_create( thread, NULL, platform_thread_trampoline, start ) != 0 ) {
+		free( start );
+		return false;
+	}
+
+	return true;
+}
+
+void
+platform_join_thread( Platform_Thread thread )
+{
+	pthread_join( thread, NULL );
+
+	return;
+}
+
+void
+platform_yield_thread( void )
+{
+	sched_yield();
+
+	return;
+}
+
+// Sleeps until platform_get_timestamp_in_nanoseconds() reaches timestamp -- returns right away if it already has.
+// NOTE: absolute deadline on the same clock, so a signal restarting the sleep doesn't push the wake up back
+void
+platform_sleep_until( uint64_t timestamp_in_nanoseconds )
+{
+	struct timespec wake_time;
+	wake_time.tv_sec  = (time_t)( timestamp_in_nanoseconds / 1000000000ull );
+	wake_time.tv_nsec = (long)( timestamp_in_nanoseconds % 1000000000ull );
+
+	while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, NULL ) == EINTR ) {
+	}
+
+	return;
+}
+
+uint32_t
+platform_get_count_of_processors( void )
+{
+	long count_of_processors;
+	count_of_processors = sysconf( _SC_NPROCESSORS_ONLN );
+
+	return ( count_of_processors < 1 ) ? 1 : (uint32_t)count_of_processors;
+}
+
+typedef sem_t Platform_Semaphore;
+
+void
+platform_create_semaphore( Platform_Semaphore *semaphore, uint32_t initial_count )
+{
+	if ( sem_init( semaphore, 0, initial_count ) != 0 ) {
+		fprintf( stdout, "Unable to create a semaphore\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+void
+platform_destroy_semaphore( Platform_Semaphore *semaphore )
+{
+	sem_destroy( semaphore );
+
+	return;
+}
+
+void
+platform_signal_semaphore( Platform_Semaphore *semaphore, uint32_t count )
+{
+	for ( uint32_t i = 0; i < count; ++i ) {
+		sem_post( semaphore );
+	}
+
+	return;
+}
+
+void
+platform_wait_semaphore( Platform_Semaphore *semaphore )
+{
+	// NOTE: EINTR just means a signal landed -- keep waiting
+	while ( sem_wait( semaphore ) != 0 ) {
+	}
+
+	return;
+}
+
+typedef pthread_mutex_t Platform_Mutex;
+
+void
+platform_create_mutex( Platform_Mutex *mutex )
+{
+	if ( pthread_mutex_init( mutex, NULL ) != 0 ) {
+		fprintf( stdout, "Unable to create a mutex\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+void
+platform_destroy_mutex( Platform_Mutex *mutex )
+{
+	pthread_mutex_destroy( mutex );
+
+	return;
+}
+
+void
+platform_lock_mutex( Platform_Mutex *mutex )
+{
+	pthread_mutex_lock( mutex );
+
+	return;
+}
+
+void
+platform_unlock_mutex( Platform_Mutex *mutex )
+{
+	pthread_mutex_unlock( mutex );
+
+	return;
+}
+
+// Atomics. Loads are acquire, stores are release, read-modify-writes and the barrier are sequentially consistent.
+int32_t
+platform_atomic_load_32( volatile int32_t *value )
+{
+	return __atomic_load_n( value, __ATOMIC_ACQUIRE );
+}
+
+void
+platform_atomic_store_32( volatile int32_t *value, int32_t new_value )
+{
+	__atomic_store_n( value, new_value, __ATOMIC_RELEASE );
+
+	return;
+}
+
+// returns the new value
+int32_t
+platform_atomic_add_32( volatile int32_t *value, int32_t addend )
+{
+	return __atomic_add_fetch( value, addend, __ATOMIC_SEQ_CST );
+}
+
+int64_t
+platform_atomic_load_64( volatile int64_t *value )
+{
+	return __atomic_load_n( value, __ATOMIC_ACQUIRE );
+}
+
+void
+platform_atomic_store_64( volatile int64_t *value, int64_t new_value )
+{
+	__atomic_store_n( value, new_value, __ATOMIC_RELEASE );
+
+	return;
+}
+
+bool
+platform_atomic_compare_exchange_64( volatile int64_t *value, int64_t expected, int64_t desired )
+{
+	return __atomic_compare_exchange_n( value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+}
+
+void *
+platform_atomic_load_pointer( void * volatile *pointer )
+{
+	return __atomic_load_n( pointer, __ATOMIC_ACQUIRE );
+}
+
+void
+platform_atomic_store_pointer( void * volatile *pointer, void *new_pointer )
+{
+	__atomic_store_n( pointer, new_pointer, __ATOMIC_RELEASE );
+
+	return;
+}
+
+void
+platform_memory_barrier( void )
+{
+	__atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+	return;
+}
@@ -0,0 +1,1099 @@
+// Offline mesh conditioner. Reads a Wavefront OBJ and writes a .mesh file (see mesh_format.c) the renderer can
+// copy straight into its vertex / index buffers:
+//
+//  1. vertices deduplicated by position / uv / normal, polygons fanned into triangles, missing normals smoothed
+//  2. triangles reordered for the post-transform vertex cache (Forsyth's linear-speed optimizer, LRU model)
+//  3. triangles regrouped for overdraw: the cache friendly order is cut into clusters where the cache restarts
+//     anyway (and where a cluster's miss rate is already close to its whole run's), and outward facing clusters
+//     go first so they occlude the rest -- Sander, Nehab and Barczak, "Fast triangle reordering"
+//  4. vertices renumbered in first use order, so the vertex fetches walk memory forwards
+//  5. attributes quantized: 16 bit positions and uvs against the mesh's bounds, octahedral 16 bit normals
+//
+//     cc -O2 -o mesh_conditioner mesh_conditioner.c -ldl -lpthread -lm        (Linux)
+//     cl mesh_conditioner.c                                                   (Windows)
+//
+//     ./mesh_conditioner model.obj model.mesh
+//
+// Options:  --cache-size N             (FIFO cache size used to measure and cluster, default 16)
+//           --overdraw-threshold T     (how much worse than the cache order a cluster's miss rate may get, default 1.05)
+//           --no-overdraw              (keep the pure cache order)
+// Prints vertex cache statistics before and after, the quantization error and the sizes.
+
+#if defined( _WIN32 )
+#include "win32_platform.c"
+#else
+#include "linux_platform.c"
+#endif
+
+#include <math.h>
+
+#include "mesh_format.c"
+
+#define FORSYTH_CACHE_SIZE				32
+#define FORSYTH_CACHE_DECAY_POWER		1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE		0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE		2.0f
+#define FORSYTH_VALENCE_BOOST_POWER		0.5f
+
+typedef struct {
+
+	uint32_t	cache_size;
+	float		overdraw_threshold;
+	bool		overdraw;
+	char		*input_path;
+	char		*output_path;
+
+} Conditioner_Options;
+
+typedef struct {
+
+	float		position[3];
+	float		normal[3];
+	float		uv[2];
+
+} Conditioner_Vertex;
+
+typedef struct {
+
+	Conditioner_Vertex	*vertices;
+	uint32_t			count_of_vertices;
+	uint32_t			*indices;
+	uint32_t			count_of_indices;
+
+} Conditioner_Mesh;
+
+// OBJ corners before deduplication -- indices into the position / uv / normal lists, -1 when absent
+typedef struct {
+
+	int32_t		position;
+	int32_t		uv;
+	int32_t		normal;
+
+} Obj_Corner;
+
+typedef struct {
+
+	float		*positions;
+	uint32_t	count_of_positions;
+	uint32_t	capacity_of_positions;
+	float		*uvs;
+	uint32_t	count_of_uvs;
+	uint32_t	capacity_of_uvs;
+	float		*normals;
+	uint32_t	count_of_normals;
+	uint32_t	capacity_of_normals;
+	Obj_Corner	*corners;								// three per triangle
+	uint32_t	count_of_corners;
+	uint32_t	capacity_of_corners;
+
+} Obj_Data;
+
+void *
+grow_array( void *array, uint32_t *capacity, uint32_t needed, size_t element_size )
+{
+	if ( needed <= *capacity ) {
+		return array;
+	}
+
+	uint32_t new_capacity;
+	new_capacity = ( *capacity < 1024 ) ? 1024 : *capacity;
+	while ( new_capacity < needed ) {
+		new_capacity *= 2;
+	}
+
+	array = realloc( array, new_capacity * element_size );
+	if ( !array ) {
+		fprintf( stdout, "Out of memory\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	*capacity = new_capacity;
+
+	return array;
+}
+
+// "7", "7/3", "7//5", "7/3/5" -- 1 based, negative counts back from the end of the list so far
+int32_t
+parse_obj_index( char **cursor, uint32_t count_so_far )
+{
+	char *end;
+	long value;
+	value = strtol( *cursor, &end, 10 );
+	if ( end == *cursor ) {
+		return -1;
+	}
+
+	*cursor = end;
+
+	if ( value < 0 ) {
+		value += (long)count_so_far;
+	}
+	else {
+		value -= 1;
+	}
+
+	if ( value < 0 || value >= (long)count_so_far ) {
+		fprintf( stdout, "OBJ index out of range\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return (int32_t)value;
+}
+
+bool
+parse_obj_corner( char **cursor, Obj_Data *obj, Obj_Corner *corner )
+{
+	while ( **cursor == ' ' || **cursor == '\t' ) {
+		*cursor += 1;
+	}
+
+	if ( **cursor == '\0' ) {
+		return false;
+	}
+
+	corner->position = parse_obj_index( cursor, obj->count_of_positions );
+	corner->uv 		 = -1;
+	corner->normal 	 = -1;
+	if ( corner->position < 0 ) {
+		fprintf( stdout, "OBJ face without a position\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( **cursor == '/' ) {
+		*cursor += 1;
+		if ( **cursor != '/' ) {
+			corner->uv = parse_obj_index( cursor, obj->count_of_uvs );
+		}
+
+		if ( **cursor == '/' ) {
+			*cursor += 1;
+			corner->normal = parse_obj_index( cursor, obj->count_of_normals );
+		}
+	}
+
+	// skip anything we didn't understand up to the next corner
+	while ( **cursor != '\0' && **cursor != ' ' && **cursor != '\t' ) {
+		*cursor += 1;
+	}
+
+	return true;
+}
+
+void
+parse_obj_floats( char *cursor, float *values, uint32_t count )
+{
+	for ( uint32_t i = 0; i < count; ++i ) {
+		values[i] = strtof( cursor, &cursor );
+	}
+
+	return;
+}
+
+// Only what a mesh needs: v, vt, vn and f (polygons fanned). Groups, materials and the rest are skipped.
+void
+parse_obj( char *text, uint64_t size, Obj_Data *obj )
+{
+	memset( obj, 0, sizeof (Obj_Data) );
+
+	char line[4096];
+	uint64_t offset = 0;
+	while ( offset < size ) {
+		uint64_t line_length = 0;
+		while ( offset + line_length < size && text[offset + line_length] != '\n' ) {
+			line_length += 1;
+		}
+
+		uint64_t copied;
+		copied = ( line_length < sizeof (line) - 1 ) ? line_length : sizeof (line) - 1;
+		memcpy( line, text + offset, (size_t)copied );
+		line[copied] = '\0';
+		if ( copied > 0 && line[copied - 1] == '\r' ) {
+			line[copied - 1] = '\0';
+		}
+
+		offset += line_length + 1;
+
+		if ( line[0] == 'v' && line[1] == ' ' ) {
+			obj->positions = grow_array( obj->positions, &obj->capacity_of_positions, ( obj->count_of_positions + 1 ) * 3, sizeof (float) );
+			parse_obj_floats( line + 2, obj->positions + obj->count_of_positions * 3, 3 );
+			obj->count_of_positions += 1;
+		}
+		else if ( line[0] == 'v' && line[1] == 't' && line[2] == ' ' ) {
+			obj->uvs = grow_array( obj->uvs, &obj->capacity_of_uvs, ( obj->count_of_uvs + 1 ) * 2, sizeof (float) );
+			parse_obj_floats( line + 3, obj->uvs + obj->count_of_uvs * 2, 2 );
+			obj->count_of_uvs += 1;
+		}
+		else if ( line[0] == 'v' && line[1] == 'n' && line[2] == ' ' ) {
+			obj->normals = grow_array( obj->normals, &obj->capacity_of_normals, ( obj->count_of_normals + 1 ) * 3, sizeof (float) );
+			parse_obj_floats( line + 3, obj->normals + obj->count_of_normals * 3, 3 );
+			obj->count_of_normals += 1;
+		}
+		else if ( line[0] == 'f' && line[1] == ' ' ) {
+			char *cursor;
+			cursor = line + 2;
+
+			Obj_Corner first = { 0 };
+			Obj_Corner previous = { 0 };
+			Obj_Corner corner;
+			uint32_t count_of_face_corners = 0;
+			while ( parse_obj_corner( &cursor, obj, &corner ) ) {
+				if ( count_of_face_corners == 0 ) {
+					first = corner;
+				}
+				else if ( count_of_face_corners >= 2 ) {
+					obj->corners = grow_array( obj->corners, &obj->capacity_of_corners, obj->count_of_corners + 3, sizeof (Obj_Corner) );
+					obj->corners[obj->count_of_corners + 0] = first;
+					obj->corners[obj->count_of_corners + 1] = previous;
+					obj->corners[obj->count_of_corners + 2] = corner;
+					obj->count_of_corners += 3;
+				}
+
+				previous = corner;
+				count_of_face_corners += 1;
+			}
+		}
+	}
+
+	return;
+}
+
+uint32_t
+hash_obj_corner( Obj_Corner *corner )
+{
+	uint32_t hash;
+	hash = (uint32_t)corner->position * 0x9e3779b1u;
+	hash ^= (uint32_t)corner->uv * 0x85ebca77u;
+	hash ^= (uint32_t)corner->normal * 0xc2b2ae3du;
+	hash ^= hash >> 15;
+
+	return hash;
+}
+
+// One vertex per distinct corner. Corners without a normal get the area weighted average of the faces around
+// their position.
+void
+build_conditioner_mesh( Obj_Data *obj, Conditioner_Mesh *mesh )
+{
+	uint32_t count_of_corners;
+	count_of_corners = obj->count_of_corners;
+
+	mesh->vertices 	= (Conditioner_Vertex *)malloc( count_of_corners * sizeof (Conditioner_Vertex) );
+	mesh->indices 	= (uint32_t *)malloc( count_of_corners * sizeof (uint32_t) );
+	mesh->count_of_vertices = 0;
+	mesh->count_of_indices  = count_of_corners;
+
+	float *smooth_normals = NULL;
+	for ( uint32_t c = 0; c < count_of_corners; ++c ) {
+		if ( obj->corners[c].normal < 0 ) {
+			smooth_normals = (float *)calloc( obj->count_of_positions * 3, sizeof (float) );
+			break;
+		}
+	}
+
+	if ( smooth_normals ) {
+		for ( uint32_t c = 0; c < count_of_corners; c += 3 ) {
+			float *a;
+			float *b;
+			float *d;
+			a = obj->positions + obj->corners[c + 0].position * 3;
+			b = obj->positions + obj->corners[c + 1].position * 3;
+			d = obj->positions + obj->corners[c + 2].position * 3;
+
+			// cross product of the edges -- its length is twice the area, so bigger faces count for more
+			float face_normal[3];
+			face_normal[0] = ( b[1] - a[1] ) * ( d[2] - a[2] ) - ( b[2] - a[2] ) * ( d[1] - a[1] );
+			face_normal[1] = ( b[2] - a[2] ) * ( d[0] - a[0] ) - ( b[0] - a[0] ) * ( d[2] - a[2] );
+			face_normal[2] = ( b[0] - a[0] ) * ( d[1] - a[1] ) - ( b[1] - a[1] ) * ( d[0] - a[0] );
+
+			for ( uint32_t k = 0; k < 3; ++k ) {
+				float *normal;
+				normal = smooth_normals + obj->corners[c + k].position * 3;
+				normal[0] += face_normal[0];
+				normal[1] += face_normal[1];
+				normal[2] += face_normal[2];
+			}
+		}
+	}
+
+	uint32_t table_size = 1;
+	while ( table_size < count_of_corners * 2 ) {
+		table_size *= 2;
+	}
+
+	uint32_t *table;
+	table = (uint32_t *)malloc( table_size * sizeof (uint32_t) );
+	memset( table, 0xff, table_size * sizeof (uint32_t) );
+
+	uint32_t *vertex_corners;
+	vertex_corners = (uint32_t *)malloc( count_of_corners * sizeof (uint32_t) );
+
+	for ( uint32_t c = 0; c < count_of_corners; ++c ) {
+		Obj_Corner *corner;
+		corner = &obj->corners[c];
+
+		uint32_t slot;
+		slot = hash_obj_corner( corner ) & ( table_size - 1 );
+		while ( table[slot] != UINT32_MAX ) {
+			Obj_Corner *existing;
+			existing = &obj->corners[vertex_corners[table[slot]]];
+			if ( existing->position == corner->position && existing->uv == corner->uv && existing->normal == corner->normal ) {
+				break;
+			}
+
+			slot = ( slot + 1 ) & ( table_size - 1 );
+		}
+
+		if ( table[slot] != UINT32_MAX ) {
+			mesh->indices[c] = table[slot];
+			continue;
+		}
+
+		uint32_t vertex_index;
+		vertex_index = mesh->count_of_vertices;
+		mesh->count_of_vertices += 1;
+		table[slot] 				 = vertex_index;
+		vertex_corners[vertex_index] = c;
+		mesh->indices[c] 			 = vertex_index;
+
+		Conditioner_Vertex *vertex;
+		vertex = &mesh->vertices[vertex_index];
+		memcpy( vertex->position, obj->positions + corner->position * 3, 3 * sizeof (float) );
+
+		if ( corner->uv >= 0 ) {
+			memcpy( vertex->uv, obj->uvs + corner->uv * 2, 2 * sizeof (float) );
+		}
+		else {
+			vertex->uv[0] = 0.0f;
+			vertex->uv[1] = 0.0f;
+		}
+
+		float *normal;
+		normal = ( corner->normal >= 0 ) ? obj->normals + corner->normal * 3 : smooth_normals + corner->position * 3;
+
+		float length;
+		length = sqrtf( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+		if ( length > 0.0f ) {
+			vertex->normal[0] = normal[0] / length;
+			vertex->normal[1] = normal[1] / length;
+			vertex->normal[2] = normal[2] / length;
+		}
+		else {
+			vertex->normal[0] = 0.0f;
+			vertex->normal[1] = 0.0f;
+			vertex->normal[2] = 1.0f;
+		}
+	}
+
+	free( vertex_corners );
+	free( table );
+	free( smooth_normals );
+
+	return;
+}
+
+// FIFO cache simulation: a vertex is a hit while fewer than cache_size misses happened since it was loaded.
+// Returns the misses for one triangle.
+uint32_t
+simulate_fifo_cache( uint32_t *triangle, uint32_t cache_size, uint32_t *load_times, uint32_t *time )
+{
+	uint32_t misses = 0;
+	for ( uint32_t k = 0; k < 3; ++k ) {
+		uint32_t vertex;
+		vertex = triangle[k];
+		if ( *time - load_times[vertex] >= cache_size ) {
+			load_times[vertex] = *time;
+			*time += 1;
+			misses += 1;
+		}
+	}
+
+	return misses;
+}
+
+// Average cache miss ratio (misses per triangle, 0.5 is the best a regular grid gets) and average transformed
+// vertex ratio (misses per vertex, 1.0 is ideal)
+void
+analyze_vertex_cache( uint32_t *indices, uint32_t count_of_indices, uint32_t count_of_vertices, uint32_t cache_size,
+					  float *acmr, float *atvr )
+{
+	uint32_t *load_times;
+	load_times = (uint32_t *)malloc( count_of_vertices * sizeof (uint32_t) );
+
+	// NOTE: start every vertex "cache_size misses ago" so the first use of each is a miss
+	uint32_t time;
+	time = cache_size + 1;
+	for ( uint32_t v = 0; v < count_of_vertices; ++v ) {
+		load_times[v] = 0;
+	}
+
+	uint32_t misses = 0;
+	for ( uint32_t i = 0; i < count_of_indices; i += 3 ) {
+		misses += simulate_fifo_cache( indices + i, cache_size, load_times, &time );
+	}
+
+	*acmr = ( count_of_indices > 0 ) ? (float)misses / (float)( count_of_indices / 3 ) : 0.0f;
+	*atvr = ( count_of_vertices > 0 ) ? (float)misses / (float)count_of_vertices : 0.0f;
+
+	free( load_times );
+
+	return;
+}
+
+float
+score_forsyth_vertex( int32_t cache_position, uint32_t remaining_triangles )
+{
+	if ( remaining_triangles == 0 ) {
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if ( cache_position >= 0 ) {
+		// the last triangle's vertices get a flat score so the next triangle doesn't just reuse the same edge
+		if ( cache_position < 3 ) {
+			score = FORSYTH_LAST_TRIANGLE_SCORE;
+		}
+		else {
+			float scaled;
+			scaled = 1.0f - (float)( cache_position - 3 ) / (float)( FORSYTH_CACHE_SIZE - 3 );
+			score  = powf( scaled, FORSYTH_CACHE_DECAY_POWER );
+		}
+	}
+
+	// vertices with few triangles left get a boost so they're finished off instead of left stranded
+	score += FORSYTH_VALENCE_BOOST_SCALE * powf( (float)remaining_triangles, -FORSYTH_VALENCE_BOOST_POWER );
+
+	return score;
+}
+
+// Tom Forsyth, "Linear-Speed Vertex Cache Optimisation". Greedy: always emit the triangle whose vertices score
+// best against a simulated LRU cache, only the triangles around the cache get rescored after each step.
+void
+optimize_vertex_cache( uint32_t *indices, uint32_t count_of_indices, uint32_t count_of_vertices )
+{
+	uint32_t count_of_triangles;
+	count_of_triangles = count_of_indices / 3;
+	if ( count_of_triangles == 0 ) {
+		return;
+	}
+
+	// triangles around each vertex, compacted as they're emitted so [first, first + remaining) are the live ones
+	uint32_t *triangle_offsets;
+	uint32_t *remaining;
+	uint32_t *adjacency;
+	int32_t *cache_positions;
+	float *vertex_scores;
+	float *triangle_scores;
+	bool *emitted;
+	triangle_offsets = (uint32_t *)calloc( count_of_vertices + 1, sizeof (uint32_t) );
+	remaining 		 = (uint32_t *)calloc( count_of_vertices, sizeof (uint32_t) );
+	adjacency 		 = (uint32_t *)malloc( count_of_indices * sizeof (uint32_t) );
+	cache_positions  = (int32_t *)malloc( count_of_vertices * sizeof (int32_t) );
+	vertex_scores 	 = (float *)malloc( count_of_vertices * sizeof (float) );
+	triangle_scores  = (float *)malloc( count_of_triangles * sizeof (float) );
+	emitted 		 = (bool *)calloc( count_of_triangles, sizeof (bool) );
+
+	for ( uint32_t i = 0; i < count_of_indices; ++i ) {
+		remaining[indices[i]] += 1;
+	}
+
+	for ( uint32_t v = 0; v < count_of_vertices; ++v ) {
+		triangle_offsets[v + 1] = triangle_offsets[v] + remaining[v];
+		remaining[v] 			= 0;
+		cache_positions[v] 		= -1;
+	}
+
+	for ( uint32_t t = 0; t < count_of_triangles; ++t ) {
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			uint32_t vertex;
+			vertex = indices[t * 3 + k];
+			adjacency[triangle_offsets[vertex] + remaining[vertex]] = t;
+			remaining[vertex] += 1;
+		}
+	}
+
+	for ( uint32_t v = 0; v < count_of_vertices; ++v ) {
+		vertex_scores[v] = score_forsyth_vertex( -1, remaining[v] );
+	}
+
+	int32_t best_triangle = 0;
+	float best_score = -1.0f;
+	for ( uint32_t t = 0; t < count_of_triangles; ++t ) {
+		triangle_scores[t] = vertex_scores[indices[t * 3 + 0]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+		if ( triangle_scores[t] > best_score ) {
+			best_score 	  = triangle_scores[t];
+			best_triangle = (int32_t)t;
+		}
+	}
+
+	uint32_t *output;
+	output = (uint32_t *)malloc( count_of_indices * sizeof (uint32_t) );
+
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t new_cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t cache_count = 0;
+	uint32_t scan_cursor = 0;
+
+	for ( uint32_t emitted_count = 0; emitted_count < count_of_triangles; ++emitted_count ) {
+		if ( best_triangle < 0 ) {
+			// nothing around the cache scored -- carry on with the first triangle not emitted yet
+			while ( emitted[scan_cursor] ) {
+				scan_cursor += 1;
+			}
+			best_triangle = (int32_t)scan_cursor;
+		}
+
+		uint32_t *triangle;
+		triangle = indices + best_triangle * 3;
+		emitted[best_triangle] = true;
+		memcpy( output + emitted_count * 3, triangle, 3 * sizeof (uint32_t) );
+
+		// take the triangle out of its vertices' live lists
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			uint32_t vertex;
+			vertex = triangle[k];
+
+			uint32_t *triangles;
+			triangles = adjacency + triangle_offsets[vertex];
+			for ( uint32_t j = 0; j < remaining[vertex]; ++j ) {
+				if ( triangles[j] == (uint32_t)best_triangle ) {
+					triangles[j] = triangles[remaining[vertex] - 1];
+					break;
+				}
+			}
+			remaining[vertex] -= 1;
+		}
+
+		// LRU: the triangle's vertices move to the front, the rest shift back, whatever falls past the end leaves
+		uint32_t new_cache_count = 0;
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			new_cache[new_cache_count++] = triangle[k];
+		}
+		for ( uint32_t j = 0; j < cache_count; ++j ) {
+			uint32_t vertex;
+			vertex = cache[j];
+			if ( vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2] ) {
+				new_cache[new_cache_count++] = vertex;
+			}
+		}
+
+		for ( uint32_t j = 0; j < new_cache_count; ++j ) {
+			uint32_t vertex;
+			vertex = new_cache[j];
+			cache_positions[vertex] = ( j < FORSYTH_CACHE_SIZE ) ? (int32_t)j : -1;
+			vertex_scores[vertex] 	= score_forsyth_vertex( cache_positions[vertex], remaining[vertex] );
+		}
+
+		// rescore the live triangles around everything that moved, the best of them goes next
+		best_triangle = -1;
+		best_score 	  = -1.0f;
+		for ( uint32_t j = 0; j < new_cache_count; ++j ) {
+			uint32_t vertex;
+			vertex = new_cache[j];
+
+			uint32_t *triangles;
+			triangles = adjacency + triangle_offsets[vertex];
+			for ( uint32_t r = 0; r < remaining[vertex]; ++r ) {
+				uint32_t t;
+				t = triangles[r];
+				triangle_scores[t] = vertex_scores[indices[t * 3 + 0]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+				if ( triangle_scores[t] > best_score ) {
+					best_score 	  = triangle_scores[t];
+					best_triangle = (int32_t)t;
+				}
+			}
+		}
+
+		cache_count = ( new_cache_count < FORSYTH_CACHE_SIZE ) ? new_cache_count : FORSYTH_CACHE_SIZE;
+		memcpy( cache, new_cache, cache_count * sizeof (uint32_t) );
+	}
+
+	memcpy( indices, output, count_of_indices * sizeof (uint32_t) );
+
+	free( output );
+	free( emitted );
+	free( triangle_scores );
+	free( vertex_scores );
+	free( cache_positions );
+	free( adjacency );
+	free( remaining );
+	free( triangle_offsets );
+
+	return;
+}
+
+typedef struct {
+
+	uint32_t	first_triangle;
+	uint32_t	count_of_triangles;
+	float		sort_key;
+
+} Overdraw_Cluster;
+
+int
+compare_overdraw_clusters( const void *a, const void *b )
+{
+	Overdraw_Cluster *first;
+	Overdraw_Cluster *second;
+	first  = (Overdraw_Cluster *)a;
+	second = (Overdraw_Cluster *)b;
+
+	// descending, ties in the original order so the sort is stable
+	if ( first->sort_key != second->sort_key ) {
+		return ( first->sort_key > second->sort_key ) ? -1 : 1;
+	}
+
+	return ( first->first_triangle < second->first_triangle ) ? -1 : 1;
+}
+
+// Expects cache optimized indices. Returns the number of clusters.
+uint32_t
+optimize_overdraw( uint32_t *indices, uint32_t count_of_indices, Conditioner_Vertex *vertices, uint32_t count_of_vertices,
+				   uint32_t cache_size, float threshold )
+{
+	uint32_t count_of_triangles;
+	count_of_triangles = count_of_indices / 3;
+	if ( count_of_triangles == 0 ) {
+		return 0;
+	}
+
+	uint32_t *load_times;
+	load_times = (uint32_t *)calloc( count_of_vertices, sizeof (uint32_t) );
+
+	uint32_t *triangle_misses;
+	triangle_misses = (uint32_t *)malloc( count_of_triangles * sizeof (uint32_t) );
+
+	// hard boundaries: a triangle that misses on all three vertices starts a new patch anyway, cutting there costs nothing
+	uint32_t *hard_boundaries;
+	uint32_t count_of_hard_boundaries = 0;
+	hard_boundaries = (uint32_t *)malloc( ( count_of_triangles + 1 ) * sizeof (uint32_t) );
+
+	uint32_t time;
+	time = cache_size + 1;
+	for ( uint32_t t = 0; t < count_of_triangles; ++t ) {
+		triangle_misses[t] = simulate_fifo_cache( indices + t * 3, cache_size, load_times, &time );
+		if ( t == 0 || triangle_misses[t] == 3 ) {
+			hard_boundaries[count_of_hard_boundaries++] = t;
+		}
+	}
+	hard_boundaries[count_of_hard_boundaries] = count_of_triangles;
+
+	// soft boundaries: within a patch, cut as soon as the cluster so far misses no more than threshold times the
+	// patch's own rate -- with the cache cold at the start of every cluster, since after sorting anything may precede it
+	Overdraw_Cluster *clusters;
+	uint32_t count_of_clusters = 0;
+	clusters = (Overdraw_Cluster *)malloc( count_of_triangles * sizeof (Overdraw_Cluster) );
+
+	for ( uint32_t h = 0; h < count_of_hard_boundaries; ++h ) {
+		uint32_t start;
+		uint32_t end;
+		start = hard_boundaries[h];
+		end   = hard_boundaries[h + 1];
+
+		uint32_t patch_misses = 0;
+		time += cache_size + 1;
+		for ( uint32_t t = start; t < end; ++t ) {
+			patch_misses += simulate_fifo_cache( indices + t * 3, cache_size, load_times, &time );
+		}
+
+		float patch_threshold;
+		patch_threshold = threshold * (float)patch_misses / (float)( end - start );
+
+		uint32_t cluster_start = start;
+		uint32_t cluster_misses = 0;
+		time += cache_size + 1;
+		for ( uint32_t t = start; t < end; ++t ) {
+			cluster_misses += simulate_fifo_cache( indices + t * 3, cache_size, load_times, &time );
+
+			if ( (float)cluster_misses / (float)( t + 1 - cluster_start ) <= patch_threshold && t + 1 < end ) {
+				clusters[count_of_clusters].first_triangle 	   = cluster_start;
+				clusters[count_of_clusters].count_of_triangles = t + 1 - cluster_start;
+				count_of_clusters += 1;
+
+				cluster_start  = t + 1;
+				cluster_misses = 0;
+				time += cache_size + 1;
+			}
+		}
+
+		clusters[count_of_clusters].first_triangle 	   = cluster_start;
+		clusters[count_of_clusters].count_of_triangles = end - cluster_start;
+		count_of_clusters += 1;
+	}
+
+	// area weighted centroids -- the mesh's, then each cluster's with its average normal
+	float mesh_centroid[3] = { 0.0f, 0.0f, 0.0f };
+	float mesh_area = 0.0f;
+	for ( uint32_t t = 0; t < count_of_triangles; ++t ) {
+		float *a;
+		float *b;
+		float *c;
+		a = vertices[indices[t * 3 + 0]].position;
+		b = vertices[indices[t * 3 + 1]].position;
+		c = vertices[indices[t * 3 + 2]].position;
+
+		float normal[3];
+		normal[0] = ( b[1] - a[1] ) * ( c[2] - a[2] ) - ( b[2] - a[2] ) * ( c[1] - a[1] );
+		normal[1] = ( b[2] - a[2] ) * ( c[0] - a[0] ) - ( b[0] - a[0] ) * ( c[2] - a[2] );
+		normal[2] = ( b[0] - a[0] ) * ( c[1] - a[1] ) - ( b[1] - a[1] ) * ( c[0] - a[0] );
+
+		float area;
+		area = sqrtf( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			mesh_centroid[k] += area * ( a[k] + b[k] + c[k] ) / 3.0f;
+		}
+		mesh_area += area;
+	}
+
+	if ( mesh_area > 0.0f ) {
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			mesh_centroid[k] /= mesh_area;
+		}
+	}
+
+	for ( uint32_t i = 0; i < count_of_clusters; ++i ) {
+		Overdraw_Cluster *cluster;
+		cluster = &clusters[i];
+
+		float centroid[3] = { 0.0f, 0.0f, 0.0f };
+		float cluster_normal[3] = { 0.0f, 0.0f, 0.0f };
+		float cluster_area = 0.0f;
+		for ( uint32_t t = cluster->first_triangle; t < cluster->first_triangle + cluster->count_of_triangles; ++t ) {
+			float *a;
+			float *b;
+			float *c;
+			a = vertices[indices[t * 3 + 0]].position;
+			b = vertices[indices[t * 3 + 1]].position;
+			c = vertices[indices[t * 3 + 2]].position;
+
+			float normal[3];
+			normal[0] = ( b[1] - a[1] ) * ( c[2] - a[2] ) - ( b[2] - a[2] ) * ( c[1] - a[1] );
+			normal[1] = ( b[2] - a[2] ) * ( c[0] - a[0] ) - ( b[0] - a[0] ) * ( c[2] - a[2] );
+			normal[2] = ( b[0] - a[0] ) * ( c[1] - a[1] ) - ( b[1] - a[1] ) * ( c[0] - a[0] );
+
+			float area;
+			area = sqrtf( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+			for ( uint32_t k = 0; k < 3; ++k ) {
+				centroid[k] 	  += area * ( a[k] + b[k] + c[k] ) / 3.0f;
+				cluster_normal[k] += normal[k];
+			}
+			cluster_area += area;
+		}
+
+		float normal_length;
+		normal_length = sqrtf( cluster_normal[0] * cluster_normal[0] + cluster_normal[1] * cluster_normal[1] + cluster_normal[2] * cluster_normal[2] );
+
+		// how far the cluster sits out along the way it faces -- the outermost, outward facing ones draw first
+		cluster->sort_key = 0.0f;
+		if ( cluster_area > 0.0f && normal_length > 0.0f ) {
+			for ( uint32_t k = 0; k < 3; ++k ) {
+				cluster->sort_key += ( centroid[k] / cluster_area - mesh_centroid[k] ) * cluster_normal[k] / normal_length;
+			}
+		}
+	}
+
+	qsort( clusters, count_of_clusters, sizeof (Overdraw_Cluster), compare_overdraw_clusters );
+
+	uint32_t *output;
+	output = (uint32_t *)malloc( count_of_indices * sizeof (uint32_t) );
+
+	uint32_t output_count = 0;
+	for ( uint32_t i = 0; i < count_of_clusters; ++i ) {
+		memcpy( output + output_count, indices + clusters[i].first_triangle * 3, clusters[i].count_of_triangles * 3 * sizeof (uint32_t) );
+		output_count += clusters[i].count_of_triangles * 3;
+	}
+
+	memcpy( indices, output, count_of_indices * sizeof (uint32_t) );
+
+	free( output );
+	free( clusters );
+	free( hard_boundaries );
+	free( triangle_misses );
+	free( load_times );
+
+	return count_of_clusters;
+}
+
+// Renumbers vertices in the order the indices first touch them and drops unreferenced ones
+void
+optimize_vertex_fetch( Conditioner_Mesh *mesh )
+{
+	uint32_t *remap;
+	remap = (uint32_t *)malloc( mesh->count_of_vertices * sizeof (uint32_t) );
+	memset( remap, 0xff, mesh->count_of_vertices * sizeof (uint32_t) );
+
+	Conditioner_Vertex *vertices;
+	vertices = (Conditioner_Vertex *)malloc( mesh->count_of_vertices * sizeof (Conditioner_Vertex) );
+
+	uint32_t count_of_vertices = 0;
+	for ( uint32_t i = 0; i < mesh->count_of_indices; ++i ) {
+		uint32_t vertex;
+		vertex = mesh->indices[i];
+		if ( remap[vertex] == UINT32_MAX ) {
+			remap[vertex] = count_of_vertices;
+			vertices[count_of_vertices] = mesh->vertices[vertex];
+			count_of_vertices += 1;
+		}
+
+		mesh->indices[i] = remap[vertex];
+	}
+
+	free( mesh->vertices );
+	mesh->vertices 			= vertices;
+	mesh->count_of_vertices = count_of_vertices;
+
+	free( remap );
+
+	return;
+}
+
+uint16_t
+quantize_unorm_16( float value, float offset, float scale )
+{
+	float normalized;
+	normalized = ( value - offset ) / scale;
+	if ( normalized < 0.0f ) {
+		normalized = 0.0f;
+	}
+	if ( normalized > 1.0f ) {
+		normalized = 1.0f;
+	}
+
+	return (uint16_t)lrintf( normalized * 65535.0f );
+}
+
+// Quantizes into a complete file image. Reports the largest position error (in mesh units) and normal error (degrees).
+uint8_t *
+write_mesh_file_image( Conditioner_Mesh *mesh, uint64_t *file_size, float *max_position_error, float *max_normal_error_degrees )
+{
+	Mesh_File_Header header = { 0 };
+	header.magic 			 = MESH_FILE_MAGIC;
+	header.version 			 = MESH_FILE_VERSION;
+	header.count_of_vertices = mesh->count_of_vertices;
+	header.count_of_indices  = mesh->count_of_indices;
+	header.index_size 		 = ( mesh->count_of_vertices <= 65536 ) ? 2 : 4;
+	header.vertex_stride 	 = sizeof (Mesh_Vertex);
+
+	float position_min[3] = { INFINITY, INFINITY, INFINITY };
+	float position_max[3] = { -INFINITY, -INFINITY, -INFINITY };
+	float uv_min[2] = { INFINITY, INFINITY };
+	float uv_max[2] = { -INFINITY, -INFINITY };
+	for ( uint32_t v = 0; v < mesh->count_of_vertices; ++v ) {
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			position_min[k] = fminf( position_min[k], mesh->vertices[v].position[k] );
+			position_max[k] = fmaxf( position_max[k], mesh->vertices[v].position[k] );
+		}
+		for ( uint32_t k = 0; k < 2; ++k ) {
+			uv_min[k] = fminf( uv_min[k], mesh->vertices[v].uv[k] );
+			uv_max[k] = fmaxf( uv_max[k], mesh->vertices[v].uv[k] );
+		}
+	}
+
+	// NOTE: a flat axis still needs a non zero scale, everything on it quantizes to 0
+	for ( uint32_t k = 0; k < 3; ++k ) {
+		header.position_offset[k] = position_min[k];
+		header.position_scale[k]  = ( position_max[k] > position_min[k] ) ? position_max[k] - position_min[k] : 1.0f;
+		header.center_and_radius[k] = ( position_min[k] + position_max[k] ) * 0.5f;
+	}
+	for ( uint32_t k = 0; k < 2; ++k ) {
+		header.uv_offset[k] = uv_min[k];
+		header.uv_scale[k]  = ( uv_max[k] > uv_min[k] ) ? uv_max[k] - uv_min[k] : 1.0f;
+	}
+
+	float radius_squared = 0.0f;
+	for ( uint32_t v = 0; v < mesh->count_of_vertices; ++v ) {
+		float distance_squared = 0.0f;
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			float delta;
+			delta = mesh->vertices[v].position[k] - header.center_and_radius[k];
+			distance_squared += delta * delta;
+		}
+		radius_squared = fmaxf( radius_squared, distance_squared );
+	}
+	header.center_and_radius[3] = sqrtf( radius_squared );
+
+	uint64_t vertex_data_size;
+	uint64_t index_data_size;
+	vertex_data_size = (uint64_t)mesh->count_of_vertices * sizeof (Mesh_Vertex);
+	index_data_size  = (uint64_t)mesh->count_of_indices * header.index_size;
+
+	header.vertex_data_offset = ( sizeof (Mesh_File_Header) + MESH_FILE_ALIGNMENT - 1 ) & ~(uint64_t)( MESH_FILE_ALIGNMENT - 1 );
+	header.index_data_offset  = ( header.vertex_data_offset + vertex_data_size + MESH_FILE_ALIGNMENT - 1 ) & ~(uint64_t)( MESH_FILE_ALIGNMENT - 1 );
+	*file_size = header.index_data_offset + index_data_size;
+
+	uint8_t *image;
+	image = (uint8_t *)calloc( 1, (size_t)*file_size );
+	memcpy( image, &header, sizeof (Mesh_File_Header) );
+
+	*max_position_error 	  = 0.0f;
+	*max_normal_error_degrees = 0.0f;
+
+	Mesh_Vertex *vertices;
+	vertices = (Mesh_Vertex *)( image + header.vertex_data_offset );
+	for ( uint32_t v = 0; v < mesh->count_of_vertices; ++v ) {
+		Conditioner_Vertex *source;
+		source = &mesh->vertices[v];
+
+		for ( uint32_t k = 0; k < 3; ++k ) {
+			vertices[v].position[k] = quantize_unorm_16( source->position[k], header.position_offset[k], header.position_scale[k] );
+
+			float dequantized;
+			dequantized = (float)vertices[v].position[k] / 65535.0f * header.position_scale[k] + header.position_offset[k];
+			*max_position_error = fmaxf( *max_position_error, fabsf( dequantized - source->position[k] ) );
+		}
+
+		for ( uint32_t k = 0; k < 2; ++k ) {
+			vertices[v].uv[k] = quantize_unorm_16( source->uv[k], header.uv_offset[k], header.uv_scale[k] );
+		}
+
+		encode_mesh_normal( source->normal, vertices[v].normal );
+
+		float decoded[3];
+		decode_mesh_normal( vertices[v].normal, decoded );
+
+		float cosine;
+		cosine = decoded[0] * source->normal[0] + decoded[1] * source->normal[1] + decoded[2] * source->normal[2];
+		cosine = fminf( fmaxf( cosine, -1.0f ), 1.0f );
+		*max_normal_error_degrees = fmaxf( *max_normal_error_degrees, acosf( cosine ) * 57.2957795f );
+	}
+
+	void *indices;
+	indices = image + header.index_data_offset;
+	for ( uint32_t i = 0; i < mesh->count_of_indices; ++i ) {
+		if ( header.index_size == 2 ) {
+			( (uint16_t *)indices )[i] = (uint16_t)mesh->indices[i];
+		}
+		else {
+			( (uint32_t *)indices )[i] = mesh->indices[i];
+		}
+	}
+
+	return image;
+}
+
+Conditioner_Options
+parse_conditioner_options( int argument_count, char **arguments )
+{
+	Conditioner_Options options = { 0 };
+	options.cache_size 		   = 16;
+	options.overdraw_threshold = 1.05f;
+	options.overdraw 		   = true;
+
+	for ( int i = 1; i < argument_count; ++i ) {
+		bool has_value = ( i + 1 < argument_count );
+
+		if ( strcmp( arguments[i], "--cache-size" ) == 0 && has_value ) {
+			options.cache_size = (uint32_t)strtoul( arguments[++i], NULL, 10 );
+		}
+		else if ( strcmp( arguments[i], "--overdraw-threshold" ) == 0 && has_value ) {
+			options.overdraw_threshold = strtof( arguments[++i], NULL );
+		}
+		else if ( strcmp( arguments[i], "--no-overdraw" ) == 0 ) {
+			options.overdraw = false;
+		}
+		else if ( arguments[i][0] != '-' && !options.input_path ) {
+			options.input_path = arguments[i];
+		}
+		else if ( arguments[i][0] != '-' && !options.output_path ) {
+			options.output_path = arguments[i];
+		}
+		else {
+			fprintf( stderr, "Unknown or incomplete option: %s\n", arguments[i] );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	if ( !options.input_path || !options.output_path || options.cache_size < 3 ) {
+		fprintf( stderr, "Usage: mesh_conditioner input.obj output.mesh [--cache-size N] [--overdraw-threshold T] [--no-overdraw]\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return options;
+}
+
+int
+main( int argument_count, char **arguments )
+{
+	Conditioner_Options options;
+	options = parse_conditioner_options( argument_count, arguments );
+
+	uint64_t start;
+	start = platform_get_timestamp_in_nanoseconds();
+
+	Platform_File_Map input;
+	if ( !platform_map_file_for_reading( options.input_path, &input ) ) {
+		fprintf( stdout, "Unable to read %s\n", options.input_path );
+		exit( EXIT_FAILURE );
+	}
+
+	Obj_Data obj;
+	parse_obj( (char *)input.data, input.size, &obj );
+	platform_unmap_file( &input );
+
+	if ( obj.count_of_corners == 0 ) {
+		fprintf( stdout, "%s has no triangles\n", options.input_path );
+		exit( EXIT_FAILURE );
+	}
+
+	Conditioner_Mesh mesh;
+	build_conditioner_mesh( &obj, &mesh );
+
+	free( obj.positions );
+	free( obj.uvs );
+	free( obj.normals );
+	free( obj.corners );
+
+	float acmr_before;
+	float atvr_before;
+	analyze_vertex_cache( mesh.indices, mesh.count_of_indices, mesh.count_of_vertices, options.cache_size, &acmr_before, &atvr_before );
+
+	optimize_vertex_cache( mesh.indices, mesh.count_of_indices, mesh.count_of_vertices );
+
+	float acmr_cache;
+	float atvr_cache;
+	analyze_vertex_cache( mesh.indices, mesh.count_of_indices, mesh.count_of_vertices, options.cache_size, &acmr_cache, &atvr_cache );
+
+	uint32_t count_of_clusters = 0;
+	if ( options.overdraw ) {
+		count_of_clusters = optimize_overdraw( mesh.indices, mesh.count_of_indices, mesh.vertices, mesh.count_of_vertices,
+											   options.cache_size, options.overdraw_threshold );
+	}
+
+	optimize_vertex_fetch( &mesh );
+
+	float acmr_after;
+	float atvr_after;
+	analyze_vertex_cache( mesh.indices, mesh.count_of_indices, mesh.count_of_vertices, options.cache_size, &acmr_after, &atvr_after );
+
+	uint64_t file_size;
+	float max_position_error;
+	float max_normal_error_degrees;
+	uint8_t *image;
+	image = write_mesh_file_image( &mesh, &file_size, &max_position_error, &max_normal_error_degrees );
+
+	if ( !platform_write_file_atomically( options.output_path, image, file_size ) ) {
+		fprintf( stdout, "Unable to write %s\n", options.output_path );
+		exit( EXIT_FAILURE );
+	}
+
+	uint64_t end;
+	end = platform_get_timestamp_in_nanoseconds();
+
+	fprintf( stdout, "%s -> %s\n", options.input_path, options.output_path );
+	fprintf( stdout, "  vertices         %u, triangles %u\n", mesh.count_of_vertices, mesh.count_of_indices / 3 );
+	fprintf( stdout, "  ACMR (fifo %u)    %.3f -> %.3f (cache order) -> %.3f (final)\n", options.cache_size, acmr_before, acmr_cache, acmr_after );
+	fprintf( stdout, "  ATVR             %.3f -> %.3f -> %.3f\n", atvr_before, atvr_cache, atvr_after );
+	if ( options.overdraw ) {
+		fprintf( stdout, "  overdraw         %u clusters, threshold %.2f\n", count_of_clusters, options.overdraw_threshold );
+	}
+	fprintf( stdout, "  vertex size      %u -> %u bytes\n", (uint32_t)( 8 * sizeof (float) ), (uint32_t)sizeof (Mesh_Vertex) );
+	fprintf( stdout, "  index size       %u bytes\n", ( mesh.count_of_vertices <= 65536 ) ? 2 : 4 );
+	fprintf( stdout, "  max error        position %g, normal %.4f degrees\n", max_position_error, max_normal_error_degrees );
+	fprintf( stdout, "  file size        %llu bytes\n", (unsigned long long)file_size );
+	fprintf( stdout, "  time             %.1f ms\n", (double)( end - start ) / 1000000.0 );
+
+	free( image );
+	free( mesh.vertices );
+	free( mesh.indices );
+
+	return 0;
+}
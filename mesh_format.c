@@ -0,0 +1,161 @@
+// Conditioned mesh files (.mesh) -- what mesh_conditioner.c writes and the renderer uploads as is. One header,
+// then the vertices, then the indices, each 16 byte aligned so both can be copied straight into buffers:
+//
+//   Mesh_File_Header
+//   Mesh_Vertex    [count_of_vertices]    -- 16 bytes each, down from 32 as floats
+//   uint16 / uint32 [count_of_indices]    -- index_size, 16 bit whenever the vertices fit
+//
+// Vertex attributes, for the pipeline's vertex input state:
+//
+//   position  offset 0   VK_FORMAT_R16G16B16A16_UNORM  xyz * position_scale + position_offset (w unused)
+//   normal    offset 8   VK_FORMAT_R16G16_SNORM        octahedral -- decode_mesh_normal() shows the math
+//   uv        offset 12  VK_FORMAT_R16G16_UNORM        uv * uv_scale + uv_offset
+//
+// Indices are ordered for the post-transform cache and then for overdraw, vertices in first use order.
+//
+// Unity built -- included by mesh_conditioner.c, and by whatever loads meshes.
+
+#define MESH_FILE_MAGIC			0x4853454d			// "MESH"
+#define MESH_FILE_VERSION		1
+#define MESH_FILE_ALIGNMENT		16
+
+typedef struct {
+
+	uint16_t	position[4];
+	int16_t		normal[2];
+	uint16_t	uv[2];
+
+} Mesh_Vertex;
+
+typedef struct {
+
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	count_of_vertices;
+	uint32_t	count_of_indices;
+	uint32_t	index_size;							// 2 or 4
+	uint32_t	vertex_stride;						// sizeof (Mesh_Vertex)
+	uint64_t	vertex_data_offset;					// from the start of the file
+	uint64_t	index_data_offset;
+
+	float		position_offset[3];					// per mesh dequantization
+	float		position_scale[3];
+	float		uv_offset[2];
+	float		uv_scale[2];
+	float		center_and_radius[4];				// bounding sphere, in the same space as the dequantized positions
+
+} Mesh_File_Header;
+
+// Checks a whole file in memory; NULL with the reason when it isn't a mesh this build understands
+Mesh_File_Header *
+validate_mesh_file( void *data, uint64_t size, char **reason )
+{
+	Mesh_File_Header *header;
+	header = (Mesh_File_Header *)data;
+
+	if ( size < sizeof (Mesh_File_Header) || header->magic != MESH_FILE_MAGIC ) {
+		*reason = "not a mesh file";
+		return NULL;
+	}
+
+	if ( header->version != MESH_FILE_VERSION || header->vertex_stride != sizeof (Mesh_Vertex) ) {
+		*reason = "mesh file version mismatch";
+		return NULL;
+	}
+
+	if ( header->index_size != 2 && header->index_size != 4 ) {
+		*reason = "bad index size";
+		return NULL;
+	}
+
+	uint64_t vertex_data_size;
+	uint64_t index_data_size;
+	vertex_data_size = (uint64_t)header->count_of_vertices * header->vertex_stride;
+	index_data_size  = (uint64_t)header->count_of_indices * header->index_size;
+
+	if ( header->vertex_data_offset > size || vertex_data_size > size - header->vertex_data_offset ||
+		 header->index_data_offset > size || index_data_size > size - header->index_data_offset ) {
+		*reason = "mesh file truncated";
+		return NULL;
+	}
+
+	*reason = NULL;
+
+	return header;
+}
+
+Mesh_Vertex *
+get_mesh_vertices( Mesh_File_Header *header )
+{
+	return (Mesh_Vertex *)( (uint8_t *)header + header->vertex_data_offset );
+}
+
+void *
+get_mesh_indices( Mesh_File_Header *header )
+{
+	return (uint8_t *)header + header->index_data_offset;
+}
+
+float
+sign_not_zero( float value )
+{
+	return ( value >= 0.0f ) ? 1.0f : -1.0f;
+}
+
+// Octahedral normal encoding: project onto the octahedron |x| + |y| + |z| = 1, fold the lower half over the
+// upper one, store x / y. Much more even precision than storing xyz at the same bit count.
+void
+encode_mesh_normal( float *normal, int16_t *encoded )
+{
+	float length;
+	length = fabsf( normal[0] ) + fabsf( normal[1] ) + fabsf( normal[2] );
+	if ( length == 0.0f ) {
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x;
+	float y;
+	x = normal[0] / length;
+	y = normal[1] / length;
+	if ( normal[2] < 0.0f ) {
+		float folded_x;
+		folded_x = ( 1.0f - fabsf( y ) ) * sign_not_zero( x );
+		y 		 = ( 1.0f - fabsf( x ) ) * sign_not_zero( y );
+		x 		 = folded_x;
+	}
+
+	encoded[0] = (int16_t)lrintf( x * 32767.0f );
+	encoded[1] = (int16_t)lrintf( y * 32767.0f );
+
+	return;
+}
+
+// What the vertex shader does after the SNORM fetch
+void
+decode_mesh_normal( int16_t *encoded, float *normal )
+{
+	float x;
+	float y;
+	x = (float)encoded[0] / 32767.0f;
+	y = (float)encoded[1] / 32767.0f;
+
+	float z;
+	z = 1.0f - fabsf( x ) - fabsf( y );
+	if ( z < 0.0f ) {
+		float folded_x;
+		folded_x = ( 1.0f - fabsf( y ) ) * sign_not_zero( x );
+		y 		 = ( 1.0f - fabsf( x ) ) * sign_not_zero( y );
+		x 		 = folded_x;
+	}
+
+	float length;
+	length = sqrtf( x * x + y * y + z * z );
+
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+
+	return;
+}
@@ -0,0 +1,101 @@
+// Bounded single-producer / single-consumer queue of fixed size elements. No locks and no read-modify-write
+// instructions: the producer only ever writes tail, the consumer only ever writes head, and each side keeps a
+// cached copy of the other's index so it only touches the shared cache line when the queue looks full / empty.
+//
+// push and pop copy elements in and out and never block -- push returns false when full, pop when empty.
+// What to do about a full queue is the producer's call.
+//
+// Unity built -- included by vulkan_renderer.c, needs the platform layer's atomics.
+
+typedef struct {
+
+	volatile int64_t	tail;						// next slot the producer writes
+	int64_t				cached_head;				// producer's last look at head
+	uint8_t				producer_padding[64 - 2 * sizeof (int64_t)];
+
+	volatile int64_t	head;						// next slot the consumer reads
+	int64_t				cached_tail;				// consumer's last look at tail
+	uint8_t				consumer_padding[64 - 2 * sizeof (int64_t)];
+
+	uint8_t				*elements;
+	uint32_t			element_size;
+	uint32_t			capacity;					// power of two
+	uint64_t			count_of_full_pushes;		// producer side -- pushes that found no room
+
+} Spsc_Queue;
+
+void
+create_spsc_queue( Spsc_Queue *queue, uint32_t element_size, uint32_t capacity )
+{
+	if ( capacity == 0 || ( capacity & ( capacity - 1 ) ) != 0 ) {
+		fprintf( stdout, "SPSC queue capacity must be a power of two\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	memset( queue, 0, sizeof (Spsc_Queue) );
+
+	queue->elements = (uint8_t *)malloc( (size_t)element_size * capacity );
+	if ( !queue->elements ) {
+		fprintf( stdout, "Unable to allocate space for an SPSC queue\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	queue->element_size = element_size;
+	queue->capacity     = capacity;
+
+	return;
+}
+
+void
+destroy_spsc_queue( Spsc_Queue *queue )
+{
+	free( queue->elements );
+	queue->elements = NULL;
+
+	return;
+}
+
+// producer only
+bool
+spsc_queue_push( Spsc_Queue *queue, void *element )
+{
+	int64_t tail;
+	tail = queue->tail;
+
+	if ( tail - queue->cached_head == (int64_t)queue->capacity ) {
+		queue->cached_head = platform_atomic_load_64( &queue->head );
+		if ( tail - queue->cached_head == (int64_t)queue->capacity ) {
+			queue->count_of_full_pushes += 1;
+			return false;
+		}
+	}
+
+	memcpy( queue->elements + (size_t)( tail & ( queue->capacity - 1 ) ) * queue->element_size, element, queue->element_size );
+
+	// release -- the element is written before the consumer can see the new tail
+	platform_atomic_store_64( &queue->tail, tail + 1 );
+
+	return true;
+}
+
+// consumer only
+bool
+spsc_queue_pop( Spsc_Queue *queue, void *element )
+{
+	int64_t head;
+	head = queue->head;
+
+	if ( head == queue->cached_tail ) {
+		queue->cached_tail = platform_atomic_load_64( &queue->tail );
+		if ( head == queue->cached_tail ) {
+			return false;
+		}
+	}
+
+	memcpy( element, queue->elements + (size_t)( head & ( queue->capacity - 1 ) ) * queue->element_size, queue->element_size );
+
+	// release -- the element is copied out before the producer can reuse the slot
+	platform_atomic_store_64( &queue->head, head + 1 );
+
+	return true;
+}
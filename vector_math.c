@@ -0,0 +1,651 @@
+// Vector / matrix / quaternion math. Plain structs passed by value, right handed, matrices column major (m[column
+// * 4 + row], the same as GLSL) so they go into push constants and buffers as is. Projections target Vulkan clip
+// space: y down, depth 0 to 1.
+//
+// The matrix products are where the time goes (a scene does one per object per frame), so those have SSE and
+// NEON versions; everything else is scalar -- a 3 component vector in a 4 wide register mostly buys shuffles.
+// The instruction set is picked at compile time: SSE2 is part of x86-64 and NEON of arm64, so a plain -O2 build
+// gets them (32 bit ARM stays scalar). PLAYGROUND_MATH_SCALAR forces the scalar code; mat4_multiply_scalar is
+// always there for comparisons.
+// AVX2 is compiled in with a target attribute and only used when cpu_has_avx2() says so: the batched matrix
+// product does two result columns per register here, and frustum_culling.c has its 8 wide kernels.
+// NOTE: GCC 12+ vectorizes the scalar product at -O2 by itself, and a batch too big for the cache is bound by
+// memory -- the hand written SSE / NEON only beats it by a little, the AVX2 batch is the one that pays off.
+//
+// Unity built -- included by vulkan_renderer.c and cull_benchmark.c, needs <math.h>.
+
+#if defined( PLAYGROUND_MATH_SCALAR )
+#define MATH_SCALAR 1
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define MATH_SSE 1
+#include <immintrin.h>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define MATH_AVX2_FUNCTION
+#else
+#define MATH_AVX2_FUNCTION __attribute__(( target( "avx2" ) ))
+#endif
+#elif ( defined( __ARM_NEON ) && defined( __aarch64__ ) ) || defined( _M_ARM64 )
+#define MATH_NEON 1
+#include <arm_neon.h>
+#else
+#define MATH_SCALAR 1
+#endif
+
+#define MATH_PI		3.14159265358979f
+
+typedef struct {
+
+	float	x;
+	float	y;
+	float	z;
+
+} Vec3;
+
+typedef struct {
+
+	float	x;
+	float	y;
+	float	z;
+	float	w;
+
+} Vec4;
+
+// x y z vector part, w scalar part -- unit length whenever it's a rotation
+typedef struct {
+
+	float	x;
+	float	y;
+	float	z;
+	float	w;
+
+} Quat;
+
+typedef struct {
+
+	float	m[16];
+
+} Mat4;
+
+//
+// Vectors
+//
+
+Vec3
+vec3( float x, float y, float z )
+{
+	Vec3 result;
+	result.x = x;
+	result.y = y;
+	result.z = z;
+
+	return result;
+}
+
+Vec3
+vec3_add( Vec3 a, Vec3 b )
+{
+	return vec3( a.x + b.x, a.y + b.y, a.z + b.z );
+}
+
+Vec3
+vec3_subtract( Vec3 a, Vec3 b )
+{
+	return vec3( a.x - b.x, a.y - b.y, a.z - b.z );
+}
+
+Vec3
+vec3_scale( Vec3 a, float scale )
+{
+	return vec3( a.x * scale, a.y * scale, a.z * scale );
+}
+
+float
+vec3_dot( Vec3 a, Vec3 b )
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vec3
+vec3_cross( Vec3 a, Vec3 b )
+{
+	return vec3( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x );
+}
+
+float
+vec3_length( Vec3 a )
+{
+	return sqrtf( vec3_dot( a, a ) );
+}
+
+// NOTE: zero stays zero rather than turning into NaNs
+Vec3
+vec3_normalize( Vec3 a )
+{
+	float length;
+	length = vec3_length( a );
+	if ( length == 0.0f ) {
+		return a;
+	}
+
+	return vec3_scale( a, 1.0f / length );
+}
+
+Vec3
+vec3_lerp( Vec3 a, Vec3 b, float t )
+{
+	return vec3( a.x + ( b.x - a.x ) * t, a.y + ( b.y - a.y ) * t, a.z + ( b.z - a.z ) * t );
+}
+
+Vec4
+vec4( float x, float y, float z, float w )
+{
+	Vec4 result;
+	result.x = x;
+	result.y = y;
+	result.z = z;
+	result.w = w;
+
+	return result;
+}
+
+float
+vec4_dot( Vec4 a, Vec4 b )
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+//
+// Quaternions
+//
+
+Quat
+quat_identity( void )
+{
+	Quat result = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	return result;
+}
+
+// angle in radians, axis doesn't need to be unit length
+Quat
+quat_from_axis_angle( Vec3 axis, float angle )
+{
+	Vec3 unit_axis;
+	unit_axis = vec3_normalize( axis );
+
+	float half_sine;
+	half_sine = sinf( angle * 0.5f );
+
+	Quat result;
+	result.x = unit_axis.x * half_sine;
+	result.y = unit_axis.y * half_sine;
+	result.z = unit_axis.z * half_sine;
+	result.w = cosf( angle * 0.5f );
+
+	return result;
+}
+
+// a after b -- rotating by the result is rotating by b, then by a
+Quat
+quat_multiply( Quat a, Quat b )
+{
+	Quat result;
+	result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+	result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+	result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+	result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+
+	return result;
+}
+
+Quat
+quat_conjugate( Quat a )
+{
+	Quat result;
+	result.x = -a.x;
+	result.y = -a.y;
+	result.z = -a.z;
+	result.w = a.w;
+
+	return result;
+}
+
+Quat
+quat_normalize( Quat a )
+{
+	float length;
+	length = sqrtf( a.x * a.x + a.y * a.y + a.z * a.z + a.w * a.w );
+	if ( length == 0.0f ) {
+		return quat_identity();
+	}
+
+	Quat result;
+	result.x = a.x / length;
+	result.y = a.y / length;
+	result.z = a.z / length;
+	result.w = a.w / length;
+
+	return result;
+}
+
+// v + 2w (q x v) + 2 q x (q x v) -- cheaper than q v q*
+Vec3
+quat_rotate( Quat q, Vec3 v )
+{
+	Vec3 axis;
+	axis = vec3( q.x, q.y, q.z );
+
+	Vec3 t;
+	t = vec3_scale( vec3_cross( axis, v ), 2.0f );
+
+	return vec3_add( vec3_add( v, vec3_scale( t, q.w ) ), vec3_cross( axis, t ) );
+}
+
+// Takes the short way round; falls back to a normalized lerp when the two are nearly the same
+Quat
+quat_slerp( Quat a, Quat b, float t )
+{
+	float cosine;
+	cosine = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	if ( cosine < 0.0f ) {
+		b.x = -b.x;
+		b.y = -b.y;
+		b.z = -b.z;
+		b.w = -b.w;
+		cosine = -cosine;
+	}
+
+	float weight_a;
+	float weight_b;
+	if ( cosine > 0.9995f ) {
+		weight_a = 1.0f - t;
+		weight_b = t;
+	}
+	else {
+		float angle;
+		float sine;
+		angle = acosf( cosine );
+		sine  = sinf( angle );
+
+		weight_a = sinf( ( 1.0f - t ) * angle ) / sine;
+		weight_b = sinf( t * angle ) / sine;
+	}
+
+	Quat result;
+	result.x = a.x * weight_a + b.x * weight_b;
+	result.y = a.y * weight_a + b.y * weight_b;
+	result.z = a.z * weight_a + b.z * weight_b;
+	result.w = a.w * weight_a + b.w * weight_b;
+
+	return quat_normalize( result );
+}
+
+//
+// Matrices
+//
+
+Mat4
+mat4_identity( void )
+{
+	Mat4 result = { { 0 } };
+	result.m[0]  = 1.0f;
+	result.m[5]  = 1.0f;
+	result.m[10] = 1.0f;
+	result.m[15] = 1.0f;
+
+	return result;
+}
+
+Mat4
+mat4_transpose( Mat4 a )
+{
+	Mat4 result;
+	for ( uint32_t column = 0; column < 4; ++column ) {
+		for ( uint32_t row = 0; row < 4; ++row ) {
+			result.m[column * 4 + row] = a.m[row * 4 + column];
+		}
+	}
+
+	return result;
+}
+
+// a * b -- applies b first
+Mat4
+mat4_multiply_scalar( Mat4 *a, Mat4 *b )
+{
+	Mat4 result;
+	for ( uint32_t column = 0; column < 4; ++column ) {
+		for ( uint32_t row = 0; row < 4; ++row ) {
+			result.m[column * 4 + row] = a->m[0 * 4 + row] * b->m[column * 4 + 0] +
+										 a->m[1 * 4 + row] * b->m[column * 4 + 1] +
+										 a->m[2 * 4 + row] * b->m[column * 4 + 2] +
+										 a->m[3 * 4 + row] * b->m[column * 4 + 3];
+		}
+	}
+
+	return result;
+}
+
+// result = a * b, stored through the pointer -- the shared kernel for mat4_multiply and the batch. a's columns stay in
+// registers, each column of b is one load and its four elements are broadcast with in-register shuffles, then
+// the result column is a's columns weighted by them. Writing through the pointer keeps the batch from copying a
+// returned Mat4 around per object. result must not alias a or b.
+void
+mat4_multiply_to( Mat4 *a, Mat4 *b, Mat4 *result )
+{
+#if defined( MATH_SSE )
+	__m128 a0 = _mm_loadu_ps( a->m + 0 );
+	__m128 a1 = _mm_loadu_ps( a->m + 4 );
+	__m128 a2 = _mm_loadu_ps( a->m + 8 );
+	__m128 a3 = _mm_loadu_ps( a->m + 12 );
+
+	for ( uint32_t column = 0; column < 4; ++column ) {
+		__m128 b_column;
+		b_column = _mm_loadu_ps( b->m + column * 4 );
+
+		__m128 sum;
+		sum = _mm_mul_ps( a0, _mm_shuffle_ps( b_column, b_column, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+		sum = _mm_add_ps( sum, _mm_mul_ps( a1, _mm_shuffle_ps( b_column, b_column, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+		sum = _mm_add_ps( sum, _mm_mul_ps( a2, _mm_shuffle_ps( b_column, b_column, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+		sum = _mm_add_ps( sum, _mm_mul_ps( a3, _mm_shuffle_ps( b_column, b_column, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+		_mm_storeu_ps( result->m + column * 4, sum );
+	}
+#elif defined( MATH_NEON )
+	float32x4_t a0 = vld1q_f32( a->m + 0 );
+	float32x4_t a1 = vld1q_f32( a->m + 4 );
+	float32x4_t a2 = vld1q_f32( a->m + 8 );
+	float32x4_t a3 = vld1q_f32( a->m + 12 );
+
+	for ( uint32_t column = 0; column < 4; ++column ) {
+		float32x4_t b_column;
+		b_column = vld1q_f32( b->m + column * 4 );
+
+		float32x4_t sum;
+		sum = vmulq_laneq_f32( a0, b_column, 0 );
+		sum = vmlaq_laneq_f32( sum, a1, b_column, 1 );
+		sum = vmlaq_laneq_f32( sum, a2, b_column, 2 );
+		sum = vmlaq_laneq_f32( sum, a3, b_column, 3 );
+		vst1q_f32( result->m + column * 4, sum );
+	}
+#else
+	*result = mat4_multiply_scalar( a, b );
+#endif
+
+	return;
+}
+
+Mat4
+mat4_multiply( Mat4 *a, Mat4 *b )
+{
+	Mat4 result;
+	mat4_multiply_to( a, b, &result );
+
+	return result;
+}
+
+Vec4
+mat4_transform( Mat4 *a, Vec4 v )
+{
+	Vec4 result;
+#if defined( MATH_SSE )
+	__m128 sum;
+	sum = _mm_mul_ps( _mm_loadu_ps( a->m + 0 ), _mm_set1_ps( v.x ) );
+	sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( a->m + 4 ), _mm_set1_ps( v.y ) ) );
+	sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( a->m + 8 ), _mm_set1_ps( v.z ) ) );
+	sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( a->m + 12 ), _mm_set1_ps( v.w ) ) );
+	_mm_storeu_ps( &result.x, sum );
+#elif defined( MATH_NEON )
+	float32x4_t sum;
+	sum = vmulq_n_f32( vld1q_f32( a->m + 0 ), v.x );
+	sum = vmlaq_n_f32( sum, vld1q_f32( a->m + 4 ), v.y );
+	sum = vmlaq_n_f32( sum, vld1q_f32( a->m + 8 ), v.z );
+	sum = vmlaq_n_f32( sum, vld1q_f32( a->m + 12 ), v.w );
+	vst1q_f32( &result.x, sum );
+#else
+	result.x = a->m[0] * v.x + a->m[4] * v.y + a->m[8]  * v.z + a->m[12] * v.w;
+	result.y = a->m[1] * v.x + a->m[5] * v.y + a->m[9]  * v.z + a->m[13] * v.w;
+	result.z = a->m[2] * v.x + a->m[6] * v.y + a->m[10] * v.z + a->m[14] * v.w;
+	result.w = a->m[3] * v.x + a->m[7] * v.y + a->m[11] * v.z + a->m[15] * v.w;
+#endif
+
+	return result;
+}
+
+// NOTE: no divide by w -- for affine matrices
+Vec3
+mat4_transform_point( Mat4 *a, Vec3 p )
+{
+	Vec4 result;
+	result = mat4_transform( a, vec4( p.x, p.y, p.z, 1.0f ) );
+
+	return vec3( result.x, result.y, result.z );
+}
+
+// parents[i] * locals[i] for a whole array -- the per-object world matrix update
+void
+mat4_multiply_batch( Mat4 *parents, Mat4 *locals, Mat4 *results, uint32_t count )
+{
+	for ( uint32_t i = 0; i < count; ++i ) {
+		mat4_multiply_to( &parents[i], &locals[i], &results[i] );
+	}
+
+	return;
+}
+
+void
+mat4_multiply_batch_scalar( Mat4 *parents, Mat4 *locals, Mat4 *results, uint32_t count )
+{
+	for ( uint32_t i = 0; i < count; ++i ) {
+		results[i] = mat4_multiply_scalar( &parents[i], &locals[i] );
+	}
+
+	return;
+}
+
+#if defined( MATH_SSE )
+bool
+cpu_has_avx2( void )
+{
+#if defined( _MSC_VER )
+	int registers[4];
+	__cpuid( registers, 0 );
+	if ( registers[0] < 7 ) {
+		return false;
+	}
+
+	// AVX needs the OS to save the ymm registers too (OSXSAVE, then XCR0 bits 1 and 2)
+	__cpuid( registers, 1 );
+	if ( !( registers[2] & ( 1 << 27 ) ) || !( registers[2] & ( 1 << 28 ) ) || ( _xgetbv( 0 ) & 6 ) != 6 ) {
+		return false;
+	}
+
+	__cpuidex( registers, 7, 0 );
+
+	return ( registers[1] & ( 1 << 5 ) ) != 0;
+#else
+	__builtin_cpu_init();
+
+	return __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+}
+
+// Same products as mat4_multiply_batch, two result columns per register: a's columns are broadcast into both
+// halves, one load brings in two columns of b and an in-lane permute spreads each element over its half. Same
+// operations in the same order as the SSE version, so the results match it bit for bit. Only call it when
+// cpu_has_avx2().
+MATH_AVX2_FUNCTION void
+mat4_multiply_batch_avx2( Mat4 *parents, Mat4 *locals, Mat4 *results, uint32_t count )
+{
+	for ( uint32_t i = 0; i < count; ++i ) {
+		float *a;
+		float *b;
+		float *result;
+		a 	   = parents[i].m;
+		b 	   = locals[i].m;
+		result = results[i].m;
+
+		__m256 a0 = _mm256_broadcast_ps( (__m128 *)( a + 0 ) );
+		__m256 a1 = _mm256_broadcast_ps( (__m128 *)( a + 4 ) );
+		__m256 a2 = _mm256_broadcast_ps( (__m128 *)( a + 8 ) );
+		__m256 a3 = _mm256_broadcast_ps( (__m128 *)( a + 12 ) );
+
+		for ( uint32_t column = 0; column < 4; column += 2 ) {
+			__m256 b_columns;
+			b_columns = _mm256_loadu_ps( b + column * 4 );
+
+			__m256 sum;
+			sum = _mm256_mul_ps( a0, _mm256_permute_ps( b_columns, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+			sum = _mm256_add_ps( sum, _mm256_mul_ps( a1, _mm256_permute_ps( b_columns, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+			sum = _mm256_add_ps( sum, _mm256_mul_ps( a2, _mm256_permute_ps( b_columns, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+			sum = _mm256_add_ps( sum, _mm256_mul_ps( a3, _mm256_permute_ps( b_columns, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+			_mm256_storeu_ps( result + column * 4, sum );
+		}
+	}
+
+	return;
+}
+#endif
+
+Mat4
+mat4_translation( Vec3 translation )
+{
+	Mat4 result;
+	result = mat4_identity();
+	result.m[12] = translation.x;
+	result.m[13] = translation.y;
+	result.m[14] = translation.z;
+
+	return result;
+}
+
+Mat4
+mat4_from_quat( Quat q )
+{
+	float xx = q.x * q.x;
+	float yy = q.y * q.y;
+	float zz = q.z * q.z;
+	float xy = q.x * q.y;
+	float xz = q.x * q.z;
+	float yz = q.y * q.z;
+	float wx = q.w * q.x;
+	float wy = q.w * q.y;
+	float wz = q.w * q.z;
+
+	Mat4 result;
+	result = mat4_identity();
+	result.m[0]  = 1.0f - 2.0f * ( yy + zz );
+	result.m[1]  = 2.0f * ( xy + wz );
+	result.m[2]  = 2.0f * ( xz - wy );
+	result.m[4]  = 2.0f * ( xy - wz );
+	result.m[5]  = 1.0f - 2.0f * ( xx + zz );
+	result.m[6]  = 2.0f * ( yz + wx );
+	result.m[8]  = 2.0f * ( xz + wy );
+	result.m[9]  = 2.0f * ( yz - wx );
+	result.m[10] = 1.0f - 2.0f * ( xx + yy );
+
+	return result;
+}
+
+// translation * rotation * scale, built directly
+Mat4
+mat4_compose( Vec3 translation, Quat rotation, Vec3 scale )
+{
+	Mat4 result;
+	result = mat4_from_quat( rotation );
+
+	for ( uint32_t row = 0; row < 3; ++row ) {
+		result.m[0 * 4 + row] *= scale.x;
+		result.m[1 * 4 + row] *= scale.y;
+		result.m[2 * 4 + row] *= scale.z;
+	}
+
+	result.m[12] = translation.x;
+	result.m[13] = translation.y;
+	result.m[14] = translation.z;
+
+	return result;
+}
+
+// Camera at eye looking at target -- view space looks down -Z with +Y up
+Mat4
+mat4_look_at( Vec3 eye, Vec3 target, Vec3 up )
+{
+	Vec3 forward;
+	Vec3 right;
+	Vec3 true_up;
+	forward = vec3_normalize( vec3_subtract( target, eye ) );
+	right 	= vec3_normalize( vec3_cross( forward, up ) );
+	true_up = vec3_cross( right, forward );
+
+	Mat4 result;
+	result = mat4_identity();
+	result.m[0]  =  right.x;
+	result.m[4]  =  right.y;
+	result.m[8]  =  right.z;
+	result.m[1]  =  true_up.x;
+	result.m[5]  =  true_up.y;
+	result.m[9]  =  true_up.z;
+	result.m[2]  = -forward.x;
+	result.m[6]  = -forward.y;
+	result.m[10] = -forward.z;
+	result.m[12] = -vec3_dot( right, eye );
+	result.m[13] = -vec3_dot( true_up, eye );
+	result.m[14] =  vec3_dot( forward, eye );
+
+	return result;
+}
+
+// Vulkan clip space: y flipped so +Y is up on screen, depth 0 at near to 1 at far
+Mat4
+mat4_perspective( float vertical_field_of_view, float aspect_ratio, float near_distance, float far_distance )
+{
+	float focal_length;
+	focal_length = 1.0f / tanf( vertical_field_of_view * 0.5f );
+
+	Mat4 result = { { 0 } };
+	result.m[0]  =  focal_length / aspect_ratio;
+	result.m[5]  = -focal_length;
+	result.m[10] =  far_distance / ( near_distance - far_distance );
+	result.m[11] = -1.0f;
+	result.m[14] =  near_distance * far_distance / ( near_distance - far_distance );
+
+	return result;
+}
+
+// For rotation / scale / translation matrices (bottom row 0 0 0 1) -- inverts the 3x3 by cofactors
+Mat4
+mat4_inverse_affine( Mat4 *a )
+{
+	float *m;
+	m = a->m;
+
+	float cofactor_00 = m[5] * m[10] - m[9] * m[6];
+	float cofactor_01 = m[9] * m[2]  - m[1] * m[10];
+	float cofactor_02 = m[1] * m[6]  - m[5] * m[2];
+
+	float determinant;
+	determinant = m[0] * cofactor_00 + m[4] * cofactor_01 + m[8] * cofactor_02;
+
+	float inverse_determinant;
+	inverse_determinant = ( determinant != 0.0f ) ? 1.0f / determinant : 0.0f;
+
+	Mat4 result;
+	result = mat4_identity();
+	result.m[0]  = cofactor_00 * inverse_determinant;
+	result.m[1]  = cofactor_01 * inverse_determinant;
+	result.m[2]  = cofactor_02 * inverse_determinant;
+	result.m[4]  = ( m[8] * m[6]  - m[4] * m[10] ) * inverse_determinant;
+	result.m[5]  = ( m[0] * m[10] - m[8] * m[2] )  * inverse_determinant;
+	result.m[6]  = ( m[4] * m[2]  - m[0] * m[6] )  * inverse_determinant;
+	result.m[8]  = ( m[4] * m[9]  - m[8] * m[5] )  * inverse_determinant;
+	result.m[9]  = ( m[8] * m[1]  - m[0] * m[9] )  * inverse_determinant;
+	result.m[10] = ( m[0] * m[5]  - m[4] * m[1] )  * inverse_determinant;
+
+	// translation: -( inverse 3x3 * t )
+	for ( uint32_t row = 0; row < 3; ++row ) {
+		result.m[12 + row] = -( result.m[0 + row] * m[12] + result.m[4 + row] * m[13] + result.m[8 + row] * m[14] );
+	}
+
+	return result;
+}
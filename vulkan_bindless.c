@@ -0,0 +1,488 @@
+// Bindless resources. Opt in (PLAYGROUND_BINDLESS / --bindless) and only on a Vulkan 1.2 device with the
+// descriptor indexing features below. One descriptor set holds three large arrays:
+//
+//   binding 0 -- sampled images     layout( set = 0, binding = 0 ) uniform texture2D images[];
+//   binding 1 -- storage buffers    layout( set = 0, binding = 1 ) buffer Buffers { ... } buffers[];
+//   binding 2 -- samplers           layout( set = 0, binding = 2 ) uniform sampler samplers[];
+//
+// all update-after-bind and partially bound, so entries can be written while frames reading other entries are
+// in flight, and entries nobody wrote are fine as long as nobody reads them. A resource is registered once and
+// gets back its index in its array -- the integer shaders index with, passed through push constants or a
+// buffer. The set is bound once per command buffer (bind_bindless_descriptor_set) instead of per draw.
+//
+// Indices come from a free list per array. A released index isn't handed out again until the last frame that
+// could have read it has completed. Writes are queued and go to the driver in one batch per frame, before submit.
+//
+// Unity built -- included by vulkan_renderer.c after the descriptor allocator, whose batched writer it uses.
+
+#define BINDLESS_SAMPLED_IMAGE_CAPACITY		16384			// upper bounds -- clamped to the device's update-after-bind limits
+#define BINDLESS_STORAGE_BUFFER_CAPACITY	16384
+#define BINDLESS_SAMPLER_CAPACITY			256
+#define BINDLESS_PUSH_CONSTANT_SIZE			128				// maxPushConstantsSize is at least this everywhere
+
+#define BINDLESS_INVALID_HANDLE				UINT32_MAX
+
+typedef uint32_t Bindless_Handle;
+
+typedef enum {
+
+	BINDLESS_SAMPLED_IMAGES,
+	BINDLESS_STORAGE_BUFFERS,
+	BINDLESS_SAMPLERS,
+	COUNT_OF_BINDLESS_ARRAYS
+
+} Bindless_Array;
+
+char *bindless_array_names[] = {
+	"sampled_images",
+	"storage_buffers",
+	"samplers",
+};
+
+VkDescriptorType bindless_array_descriptor_types[] = {
+	VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+	VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+	VK_DESCRIPTOR_TYPE_SAMPLER,
+};
+
+typedef struct {
+
+	uint32_t		index;
+	uint64_t		last_frame_number;				// reusable once this frame has completed
+
+} Bindless_Retired_Handle;
+
+typedef struct {
+
+	uint32_t				capacity;
+	uint32_t				high_water;				// indices below this were handed out at least once
+	bool					*in_use;				// per index -- handed out and not released yet
+	uint32_t				*free_indices;
+	uint32_t				count_of_free_indices;
+	Bindless_Retired_Handle	*retired_handles;
+	uint32_t				count_of_retired_handles;
+
+	uint32_t				count_in_use;
+	uint32_t				peak_in_use;
+
+} Bindless_Index_Allocator;
+
+typedef struct {
+
+	bool							supported;
+	char							*unsupported_reason;
+	uint32_t						capacities[COUNT_OF_BINDLESS_ARRAYS];
+
+} Vulkan_Bindless_Support;
+
+typedef struct {
+
+	Vulkan_Bindless_Support		support;					// filled by the device probe
+	bool						enabled;
+
+	Vulkan_Device_Dispatch		*dispatch;
+	VkDescriptorPool			pool;
+	VkDescriptorSetLayout		layout;						// both owned by the object cache
+	VkPipelineLayout			pipeline_layout;			// set 0 -- the arrays, plus BINDLESS_PUSH_CONSTANT_SIZE of push constants
+	VkDescriptorSet				set;
+
+	Platform_Mutex				mutex;						// registration / release from any thread
+	Bindless_Index_Allocator	arrays[COUNT_OF_BINDLESS_ARRAYS];
+	Vulkan_Descriptor_Writer	pending_writes;
+
+} Vulkan_Bindless;
+
+uint32_t
+clamp_bindless_capacity( uint32_t capacity, uint32_t set_limit, uint32_t stage_limit )
+{
+	if ( capacity > set_limit ) {
+		capacity = set_limit;
+	}
+
+	if ( capacity > stage_limit ) {
+		capacity = stage_limit;
+	}
+
+	return capacity;
+}
+
+// Before the device is created. Leaves support->supported false, with the reason, when anything is missing.
+void
+probe_vulkan_bindless_support( Vulkan_Bindless_Support *support, VkPhysicalDevice physical_device, uint32_t instance_api_version, uint32_t device_api_version,
+							   VkPhysicalDeviceVulkan12Features *enabled_features )
+{
+	memset( support, 0, sizeof (Vulkan_Bindless_Support) );
+
+	if ( instance_api_version < VK_API_VERSION_1_2 || device_api_version < VK_API_VERSION_1_2 || !vkGetPhysicalDeviceFeatures2 ) {
+		support->unsupported_reason = "needs Vulkan 1.2";
+		return;
+	}
+
+	VkPhysicalDeviceVulkan12Features features = { 0 };
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features2 = { 0 };
+	features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features2.pNext = &features;
+
+	vkGetPhysicalDeviceFeatures2( physical_device, &features2 );
+
+	if ( !features.descriptorIndexing ||
+		 !features.runtimeDescriptorArray ||
+		 !features.descriptorBindingPartiallyBound ||
+		 !features.descriptorBindingUpdateUnusedWhilePending ||
+		 !features.descriptorBindingSampledImageUpdateAfterBind ||
+		 !features.descriptorBindingStorageBufferUpdateAfterBind ||
+		 !features.shaderSampledImageArrayNonUniformIndexing ||
+		 !features.shaderStorageBufferArrayNonUniformIndexing ) {
+		support->unsupported_reason = "missing descriptor indexing features";
+		return;
+	}
+
+	VkPhysicalDeviceVulkan12Properties properties = { 0 };
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties2 = { 0 };
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties2.pNext = &properties;
+
+	vkGetPhysicalDeviceProperties2( physical_device, &properties2 );
+
+	support->capacities[BINDLESS_SAMPLED_IMAGES]  = clamp_bindless_capacity( BINDLESS_SAMPLED_IMAGE_CAPACITY,
+																			 properties.maxDescriptorSetUpdateAfterBindSampledImages,
+																			 properties.maxPerStageDescriptorUpdateAfterBindSampledImages );
+	support->capacities[BINDLESS_STORAGE_BUFFERS] = clamp_bindless_capacity( BINDLESS_STORAGE_BUFFER_CAPACITY,
+																			 properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+																			 properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers );
+	support->capacities[BINDLESS_SAMPLERS]        = clamp_bindless_capacity( BINDLESS_SAMPLER_CAPACITY,
+																			 properties.maxDescriptorSetUpdateAfterBindSamplers,
+																			 properties.maxPerStageDescriptorUpdateAfterBindSamplers );
+
+	// all three are visible to every stage -- their sum has to fit the per stage total too
+	while ( support->capacities[BINDLESS_SAMPLED_IMAGES] + support->capacities[BINDLESS_STORAGE_BUFFERS] + support->capacities[BINDLESS_SAMPLERS]
+			> properties.maxPerStageUpdateAfterBindResources ) {
+		support->capacities[BINDLESS_SAMPLED_IMAGES]  /= 2;
+		support->capacities[BINDLESS_STORAGE_BUFFERS] /= 2;
+	}
+
+	if ( support->capacities[BINDLESS_SAMPLED_IMAGES] == 0 || support->capacities[BINDLESS_STORAGE_BUFFERS] == 0 || support->capacities[BINDLESS_SAMPLERS] == 0 ) {
+		support->unsupported_reason = "update-after-bind limits too small";
+		return;
+	}
+
+	// NOTE: only what the arrays need, on top of whatever other probes asked for -- the rest of the struct stays as is
+	enabled_features->descriptorIndexing 							= VK_TRUE;
+	enabled_features->runtimeDescriptorArray 						= VK_TRUE;
+	enabled_features->descriptorBindingPartiallyBound 				= VK_TRUE;
+	enabled_features->descriptorBindingUpdateUnusedWhilePending 	= VK_TRUE;
+	enabled_features->descriptorBindingSampledImageUpdateAfterBind 	= VK_TRUE;
+	enabled_features->descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	enabled_features->shaderSampledImageArrayNonUniformIndexing 	= VK_TRUE;
+	enabled_features->shaderStorageBufferArrayNonUniformIndexing 	= VK_TRUE;
+
+	support->supported = true;
+
+	return;
+}
+
+void
+create_bindless_index_allocator( Bindless_Index_Allocator *allocator, uint32_t capacity )
+{
+	memset( allocator, 0, sizeof (Bindless_Index_Allocator) );
+	allocator->capacity = capacity;
+
+	allocator->in_use 		   = (bool *)calloc( capacity, sizeof (bool) );
+	allocator->free_indices    = (uint32_t *)malloc( capacity * sizeof (uint32_t) );
+	allocator->retired_handles = (Bindless_Retired_Handle *)malloc( capacity * sizeof (Bindless_Retired_Handle) );
+	if ( !allocator->in_use || !allocator->free_indices || !allocator->retired_handles ) {
+		fprintf( stdout, "Unable to allocate space for bindless handles\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+// Freed indices first, so the arrays stay as dense as the live resources allow
+uint32_t
+allocate_bindless_index( Bindless_Index_Allocator *allocator, char *what )
+{
+	uint32_t index;
+
+	if ( allocator->count_of_free_indices ) {
+		index = allocator->free_indices[--allocator->count_of_free_indices];
+	}
+	else if ( allocator->high_water < allocator->capacity ) {
+		index = allocator->high_water++;
+	}
+	else {
+		fprintf( stdout, "Out of bindless %s (%u)\n", what, allocator->capacity );
+		exit( EXIT_FAILURE );
+	}
+
+	allocator->in_use[index]  = true;
+	allocator->count_in_use += 1;
+	if ( allocator->count_in_use > allocator->peak_in_use ) {
+		allocator->peak_in_use = allocator->count_in_use;
+	}
+
+	return index;
+}
+
+// Both sides of the descriptor writes come from the object cache -- nothing in here but the pool needs destroying
+void
+create_vulkan_bindless( Vulkan_Bindless *bindless, Vulkan_Device_Dispatch *dispatch, Vulkan_Object_Cache *object_cache,
+						Vulkan_Descriptor_Allocator *descriptor_allocator )
+{
+	bindless->dispatch = dispatch;
+	platform_create_mutex( &bindless->mutex );
+	begin_descriptor_writes( &bindless->pending_writes, descriptor_allocator );
+
+	VkDescriptorSetLayoutBinding bindings[COUNT_OF_BINDLESS_ARRAYS] = { 0 };
+	VkDescriptorBindingFlags binding_flags[COUNT_OF_BINDLESS_ARRAYS];
+	VkDescriptorPoolSize pool_sizes[COUNT_OF_BINDLESS_ARRAYS];
+
+	for ( uint32_t array = 0; array < COUNT_OF_BINDLESS_ARRAYS; ++array ) {
+		bindings[array].binding         = array;
+		bindings[array].descriptorType  = bindless_array_descriptor_types[array];
+		bindings[array].descriptorCount = bindless->support.capacities[array];
+		bindings[array].stageFlags      = VK_SHADER_STAGE_ALL;
+
+		binding_flags[array] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+							   VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+							   VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+		pool_sizes[array].type            = bindless_array_descriptor_types[array];
+		pool_sizes[array].descriptorCount = bindless->support.capacities[array];
+
+		create_bindless_index_allocator( &bindless->arrays[array], bindless->support.capacities[array] );
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_create_info = { 0 };
+	binding_flags_create_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	binding_flags_create_info.bindingCount  = COUNT_OF_BINDLESS_ARRAYS;
+	binding_flags_create_info.pBindingFlags = binding_flags;
+
+	VkDescriptorSetLayoutCreateInfo layout_create_info = { 0 };
+	layout_create_info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layout_create_info.pNext        = &binding_flags_create_info;
+	layout_create_info.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layout_create_info.bindingCount = COUNT_OF_BINDLESS_ARRAYS;
+	layout_create_info.pBindings    = bindings;
+
+	bindless->layout = get_vulkan_descriptor_set_layout( object_cache, &layout_create_info );
+
+	VkPushConstantRange push_constant_range = { 0 };
+	push_constant_range.stageFlags = VK_SHADER_STAGE_ALL;
+	push_constant_range.size       = BINDLESS_PUSH_CONSTANT_SIZE;
+
+	VkPipelineLayoutCreateInfo pipeline_layout_create_info = { 0 };
+	pipeline_layout_create_info.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipeline_layout_create_info.setLayoutCount         = 1;
+	pipeline_layout_create_info.pSetLayouts            = &bindless->layout;
+	pipeline_layout_create_info.pushConstantRangeCount = 1;
+	pipeline_layout_create_info.pPushConstantRanges    = &push_constant_range;
+
+	bindless->pipeline_layout = get_vulkan_pipeline_layout( object_cache, &pipeline_layout_create_info );
+
+	VkDescriptorPoolCreateInfo pool_create_info = { 0 };
+	pool_create_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	pool_create_info.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	pool_create_info.maxSets       = 1;
+	pool_create_info.poolSizeCount = COUNT_OF_BINDLESS_ARRAYS;
+	pool_create_info.pPoolSizes    = pool_sizes;
+
+	VkResult result;
+	result = dispatch->vkCreateDescriptorPool( dispatch->logical_device, &pool_create_info, NULL, &bindless->pool );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create the bindless descriptor pool\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkDescriptorSetAllocateInfo allocate_info = { 0 };
+	allocate_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocate_info.descriptorPool     = bindless->pool;
+	allocate_info.descriptorSetCount = 1;
+	allocate_info.pSetLayouts        = &bindless->layout;
+
+	result = dispatch->vkAllocateDescriptorSets( dispatch->logical_device, &allocate_info, &bindless->set );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to allocate the bindless descriptor set\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	bindless->enabled = true;
+
+	return;
+}
+
+Bindless_Handle
+register_bindless_sampled_image( Vulkan_Bindless *bindless, VkImageView image_view, VkImageLayout image_layout )
+{
+	platform_lock_mutex( &bindless->mutex );
+
+	uint32_t index;
+	index = allocate_bindless_index( &bindless->arrays[BINDLESS_SAMPLED_IMAGES], "sampled images" );
+	write_descriptor_image( &bindless->pending_writes, bindless->set, BINDLESS_SAMPLED_IMAGES, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+							VK_NULL_HANDLE, image_view, image_layout );
+
+	platform_unlock_mutex( &bindless->mutex );
+
+	return index;
+}
+
+Bindless_Handle
+register_bindless_storage_buffer( Vulkan_Bindless *bindless, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range )
+{
+	platform_lock_mutex( &bindless->mutex );
+
+	uint32_t index;
+	index = allocate_bindless_index( &bindless->arrays[BINDLESS_STORAGE_BUFFERS], "storage buffers" );
+	write_descriptor_buffer( &bindless->pending_writes, bindless->set, BINDLESS_STORAGE_BUFFERS, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+							 buffer, offset, range );
+
+	platform_unlock_mutex( &bindless->mutex );
+
+	return index;
+}
+
+Bindless_Handle
+register_bindless_sampler( Vulkan_Bindless *bindless, VkSampler sampler )
+{
+	platform_lock_mutex( &bindless->mutex );
+
+	uint32_t index;
+	index = allocate_bindless_index( &bindless->arrays[BINDLESS_SAMPLERS], "samplers" );
+	write_descriptor_image( &bindless->pending_writes, bindless->set, BINDLESS_SAMPLERS, index, VK_DESCRIPTOR_TYPE_SAMPLER,
+							sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED );
+
+	platform_unlock_mutex( &bindless->mutex );
+
+	return index;
+}
+
+// last_frame_number -- the last frame that may still read the entry; while recording that's the frame being recorded
+void
+release_bindless_handle( Vulkan_Bindless *bindless, Bindless_Array array, Bindless_Handle handle, uint64_t last_frame_number )
+{
+	platform_lock_mutex( &bindless->mutex );
+
+	Bindless_Index_Allocator *allocator;
+	allocator = &bindless->arrays[array];
+
+	// NOTE: a second release would queue the index twice -- handed out twice later, and the retired list can overflow
+	if ( handle >= allocator->capacity || !allocator->in_use[handle] ) {
+		fprintf( stdout, "Released bindless %s handle %u that isn't in use\n", bindless_array_names[array], handle );
+		exit( EXIT_FAILURE );
+	}
+	allocator->in_use[handle] = false;
+
+	Bindless_Retired_Handle *retired_handle;
+	retired_handle = &allocator->retired_handles[allocator->count_of_retired_handles++];
+	retired_handle->index             = handle;
+	retired_handle->last_frame_number = last_frame_number;
+
+	allocator->count_in_use -= 1;
+
+	platform_unlock_mutex( &bindless->mutex );
+
+	return;
+}
+
+// NOTE: cheap to call every frame -- only compares frame numbers unless something is ready to go
+void
+recycle_bindless_handles( Vulkan_Bindless *bindless, uint64_t last_completed_frame_number )
+{
+	platform_lock_mutex( &bindless->mutex );
+
+	for ( uint32_t array = 0; array < COUNT_OF_BINDLESS_ARRAYS; ++array ) {
+		Bindless_Index_Allocator *allocator;
+		allocator = &bindless->arrays[array];
+
+		uint32_t count_of_remaining = 0;
+		for ( uint32_t i = 0; i < allocator->count_of_retired_handles; ++i ) {
+			Bindless_Retired_Handle *retired_handle;
+			retired_handle = &allocator->retired_handles[i];
+
+			if ( retired_handle->last_frame_number <= last_completed_frame_number ) {
+				allocator->free_indices[allocator->count_of_free_indices++] = retired_handle->index;
+			}
+			else {
+				allocator->retired_handles[count_of_remaining++] = *retired_handle;
+			}
+		}
+
+		allocator->count_of_retired_handles = count_of_remaining;
+	}
+
+	platform_unlock_mutex( &bindless->mutex );
+
+	return;
+}
+
+// Once per frame, after recording and before submit -- update-after-bind lets the writes land that late
+void
+flush_bindless_writes( Vulkan_Bindless *bindless )
+{
+	platform_lock_mutex( &bindless->mutex );
+	flush_descriptor_writes( &bindless->pending_writes );
+	platform_unlock_mutex( &bindless->mutex );
+
+	return;
+}
+
+void
+bind_bindless_descriptor_set( Vulkan_Bindless *bindless, VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point )
+{
+	bindless->dispatch->vkCmdBindDescriptorSets( command_buffer, bind_point, bindless->pipeline_layout, 0, 1, &bindless->set, 0, NULL );
+
+	return;
+}
+
+// NOTE: the device must be idle. The layouts belong to the object cache.
+void
+destroy_vulkan_bindless( Vulkan_Bindless *bindless )
+{
+	if ( !bindless->enabled ) {
+		return;
+	}
+
+	bindless->dispatch->vkDestroyDescriptorPool( bindless->dispatch->logical_device, bindless->pool, NULL );
+
+	for ( uint32_t array = 0; array < COUNT_OF_BINDLESS_ARRAYS; ++array ) {
+		free( bindless->arrays[array].in_use );
+		free( bindless->arrays[array].free_indices );
+		free( bindless->arrays[array].retired_handles );
+	}
+
+	platform_destroy_mutex( &bindless->mutex );
+
+	return;
+}
+
+void
+export_vulkan_bindless_as_json( Vulkan_Bindless *bindless, bool requested, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"requested\": %s,\n", indentation, requested ? "true" : "false" );
+
+	if ( !bindless->enabled ) {
+		fprintf( output, "%s  \"enabled\": false,\n", indentation );
+		fprintf( output, "%s  \"reason\": \"%s\"\n", indentation,
+				 !requested ? "not requested" : bindless->support.unsupported_reason ? bindless->support.unsupported_reason : "unknown" );
+		fprintf( output, "%s}", indentation );
+		return;
+	}
+
+	fprintf( output, "%s  \"enabled\": true,\n", indentation );
+	for ( uint32_t array = 0; array < COUNT_OF_BINDLESS_ARRAYS; ++array ) {
+		Bindless_Index_Allocator *allocator;
+		allocator = &bindless->arrays[array];
+
+		fprintf( output, "%s  \"%s\": { \"capacity\": %u, \"in_use\": %u, \"peak\": %u, \"retired\": %u }%s\n", indentation,
+				 bindless_array_names[array], allocator->capacity, allocator->count_in_use, allocator->peak_in_use,
+				 allocator->count_of_retired_handles, ( array + 1 < COUNT_OF_BINDLESS_ARRAYS ) ? "," : "" );
+	}
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
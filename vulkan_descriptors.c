@@ -0,0 +1,425 @@
+// Descriptor set allocation. Sets are never freed one by one -- they come out of lists of VkDescriptorPool:
+//
+//  - per frame lists, one per job worker in every frame slot (same as the command pools), so recording jobs
+//    allocate without locks. Reset wholesale with vkResetDescriptorPool once the slot's fence has signaled.
+//  - one long-lived list for static sets, behind a lock, never reset -- its sets live until shutdown.
+//
+// A list allocates from its current pool until the driver says it's out, then moves on to the next pool,
+// creating one when there are none left. New pools are sized by what the list has seen: the set count
+// doubles each time (up to DESCRIPTOR_POOL_MAX_SETS) and each descriptor type gets the share it has had of
+// the list's allocations so far. A frame list that had to spill into a second pool is consolidated on its
+// next reset -- its pools are dropped and replaced by one sized for the whole frame, so a steady state frame
+// allocates from a single pool.
+//
+// Writes are batched in a Vulkan_Descriptor_Writer and go to the driver in one vkUpdateDescriptorSets.
+//
+// Unity built -- included by vulkan_renderer.c after the object cache, which owns the set layouts.
+
+#define COUNT_OF_DESCRIPTOR_TYPES			11					// the core 1.0 types, SAMPLER through INPUT_ATTACHMENT
+#define DESCRIPTOR_POOL_INITIAL_SETS		64
+#define DESCRIPTOR_POOL_MAX_SETS			4096
+#define MAX_DESCRIPTOR_WRITES				64					// per writer batch -- a full batch flushes itself
+
+// A set layout plus how many descriptors of each type one set of it takes -- the pools need the counts,
+// and VkDescriptorSetLayout can't be asked for them
+typedef struct {
+
+	VkDescriptorSetLayout	layout;
+	uint32_t				descriptor_counts[COUNT_OF_DESCRIPTOR_TYPES];
+
+} Vulkan_Descriptor_Layout;
+
+typedef struct {
+
+	VkDescriptorPool	*pools;
+	uint32_t			count_of_pools;
+	uint32_t			pools_capacity;
+	uint32_t			current_pool;							// allocations go here until it runs out
+	uint32_t			next_pool_set_count;
+
+	uint32_t			count_of_sets_this_frame;				// since the last reset
+	uint64_t			count_of_sets_allocated;				// ever -- with the counts below, the shape of new pools
+	uint64_t			count_of_descriptors_allocated[COUNT_OF_DESCRIPTOR_TYPES];
+
+} Vulkan_Descriptor_Pool_List;
+
+typedef struct {
+
+	Vulkan_Device_Dispatch		*dispatch;
+
+	Platform_Mutex				static_mutex;
+	Vulkan_Descriptor_Pool_List	static_pools;
+
+	uint32_t			count_of_pools_created;
+	uint32_t			count_of_pool_resets;
+	uint32_t			count_of_consolidations;
+	uint64_t			count_of_frames;
+	uint64_t			count_of_frame_sets;
+	uint32_t			peak_frame_sets;
+	uint32_t			last_frame_sets;
+
+	volatile int32_t	count_of_update_calls;					// any thread
+	volatile int32_t	count_of_descriptor_writes;
+
+} Vulkan_Descriptor_Allocator;
+
+typedef struct {
+
+	Vulkan_Descriptor_Allocator	*allocator;
+	VkWriteDescriptorSet		writes[MAX_DESCRIPTOR_WRITES];
+	VkDescriptorImageInfo		image_infos[MAX_DESCRIPTOR_WRITES];		// write i points at image_infos[i] or buffer_infos[i]
+	VkDescriptorBufferInfo		buffer_infos[MAX_DESCRIPTOR_WRITES];
+	uint32_t					count_of_writes;
+
+} Vulkan_Descriptor_Writer;
+
+void
+create_vulkan_descriptor_allocator( Vulkan_Descriptor_Allocator *allocator, Vulkan_Device_Dispatch *dispatch )
+{
+	memset( allocator, 0, sizeof (Vulkan_Descriptor_Allocator) );
+	allocator->dispatch = dispatch;
+	platform_create_mutex( &allocator->static_mutex );
+
+	return;
+}
+
+// Goes through the object cache, so equal create infos share one layout
+Vulkan_Descriptor_Layout
+get_vulkan_descriptor_layout( Vulkan_Object_Cache *object_cache, const VkDescriptorSetLayoutCreateInfo *create_info )
+{
+	Vulkan_Descriptor_Layout descriptor_layout = { 0 };
+	descriptor_layout.layout = get_vulkan_descriptor_set_layout( object_cache, create_info );
+
+	for ( uint32_t i = 0; i < create_info->bindingCount; ++i ) {
+		const VkDescriptorSetLayoutBinding *binding;
+		binding = &create_info->pBindings[i];
+
+		if ( (uint32_t)binding->descriptorType >= COUNT_OF_DESCRIPTOR_TYPES ) {
+			fprintf( stdout, "Descriptor allocator doesn't know descriptor type %d\n", (int)binding->descriptorType );
+			exit( EXIT_FAILURE );
+		}
+
+		descriptor_layout.descriptor_counts[binding->descriptorType] += binding->descriptorCount;
+	}
+
+	return descriptor_layout;
+}
+
+void
+create_descriptor_pool_for_list( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Pool_List *list, Vulkan_Descriptor_Layout *layout )
+{
+	if ( list->next_pool_set_count == 0 ) {
+		list->next_pool_set_count = DESCRIPTOR_POOL_INITIAL_SETS;
+	}
+
+	uint32_t set_count;
+	set_count = list->next_pool_set_count;
+
+	// NOTE: the set that didn't fit counts too, so the new pool can always hold it
+	uint64_t observed_sets;
+	observed_sets = list->count_of_sets_allocated + 1;
+
+	VkDescriptorPoolSize pool_sizes[COUNT_OF_DESCRIPTOR_TYPES];
+	uint32_t count_of_pool_sizes = 0;
+
+	for ( uint32_t type = 0; type < COUNT_OF_DESCRIPTOR_TYPES; ++type ) {
+		uint64_t observed_descriptors;
+		observed_descriptors = list->count_of_descriptors_allocated[type] + layout->descriptor_counts[type];
+		if ( observed_descriptors == 0 ) {
+			continue;
+		}
+
+		uint64_t descriptor_count;
+		descriptor_count = ( observed_descriptors * set_count + observed_sets - 1 ) / observed_sets;
+		if ( descriptor_count < layout->descriptor_counts[type] ) {
+			descriptor_count = layout->descriptor_counts[type];
+		}
+
+		pool_sizes[count_of_pool_sizes].type            = (VkDescriptorType)type;
+		pool_sizes[count_of_pool_sizes].descriptorCount = (uint32_t)descriptor_count;
+		count_of_pool_sizes += 1;
+	}
+
+	// layouts without bindings still need a pool to come from
+	if ( count_of_pool_sizes == 0 ) {
+		pool_sizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		pool_sizes[0].descriptorCount = 1;
+		count_of_pool_sizes = 1;
+	}
+
+	VkDescriptorPoolCreateInfo pool_create_info = { 0 };
+	pool_create_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	pool_create_info.maxSets       = set_count;
+	pool_create_info.poolSizeCount = count_of_pool_sizes;
+	pool_create_info.pPoolSizes    = pool_sizes;
+
+	if ( list->count_of_pools == list->pools_capacity ) {
+		list->pools_capacity = list->pools_capacity ? list->pools_capacity * 2 : 4;
+		list->pools = (VkDescriptorPool *)realloc( list->pools, list->pools_capacity * sizeof (VkDescriptorPool) );
+		if ( !list->pools ) {
+			fprintf( stdout, "Unable to allocate space for descriptor pools\n" );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	VkResult result;
+	result = allocator->dispatch->vkCreateDescriptorPool( allocator->dispatch->logical_device, &pool_create_info, NULL, &list->pools[list->count_of_pools] );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a descriptor pool\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	list->current_pool    = list->count_of_pools;
+	list->count_of_pools += 1;
+
+	if ( list->next_pool_set_count < DESCRIPTOR_POOL_MAX_SETS ) {
+		list->next_pool_set_count *= 2;
+	}
+
+	allocator->count_of_pools_created += 1;
+
+	return;
+}
+
+VkDescriptorSet
+allocate_descriptor_set_from_list( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Pool_List *list, Vulkan_Descriptor_Layout *layout )
+{
+	VkDescriptorSetAllocateInfo allocate_info = { 0 };
+	allocate_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocate_info.descriptorSetCount = 1;
+	allocate_info.pSetLayouts        = &layout->layout;
+
+	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+
+	for ( ;; ) {
+		if ( list->current_pool == list->count_of_pools ) {
+			create_descriptor_pool_for_list( allocator, list, layout );
+		}
+
+		allocate_info.descriptorPool = list->pools[list->current_pool];
+
+		VkResult result;
+		result = allocator->dispatch->vkAllocateDescriptorSets( allocator->dispatch->logical_device, &allocate_info, &descriptor_set );
+		if ( result == VK_SUCCESS ) {
+			break;
+		}
+
+		if ( result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL ) {
+			fprintf( stdout, "Unable to allocate a descriptor set\n" );
+			exit( EXIT_FAILURE );
+		}
+
+		list->current_pool += 1;
+	}
+
+	list->count_of_sets_this_frame += 1;
+	list->count_of_sets_allocated  += 1;
+	for ( uint32_t type = 0; type < COUNT_OF_DESCRIPTOR_TYPES; ++type ) {
+		list->count_of_descriptors_allocated[type] += layout->descriptor_counts[type];
+	}
+
+	return descriptor_set;
+}
+
+// NOTE: only the worker that owns list may call this, and only while recording the slot's frame
+VkDescriptorSet
+allocate_frame_descriptor_set( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Pool_List *list, Vulkan_Descriptor_Layout *layout )
+{
+	return allocate_descriptor_set_from_list( allocator, list, layout );
+}
+
+// Any thread. The set lives until shutdown.
+VkDescriptorSet
+allocate_static_descriptor_set( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Layout *layout )
+{
+	platform_lock_mutex( &allocator->static_mutex );
+
+	VkDescriptorSet descriptor_set;
+	descriptor_set = allocate_descriptor_set_from_list( allocator, &allocator->static_pools, layout );
+
+	platform_unlock_mutex( &allocator->static_mutex );
+
+	return descriptor_set;
+}
+
+void
+destroy_vulkan_descriptor_pool_list( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Pool_List *list )
+{
+	for ( uint32_t i = 0; i < list->count_of_pools; ++i ) {
+		allocator->dispatch->vkDestroyDescriptorPool( allocator->dispatch->logical_device, list->pools[i], NULL );
+	}
+
+	free( list->pools );
+	list->pools          = NULL;
+	list->count_of_pools = 0;
+	list->pools_capacity = 0;
+	list->current_pool   = 0;
+
+	return;
+}
+
+// Once the slot's fence has signaled. Every set from the list is gone after this.
+void
+reset_vulkan_descriptor_pool_list( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Pool_List *list )
+{
+	// spilled last frame -- start over with one pool that fits the whole frame, created by the next allocation
+	if ( list->count_of_pools > 1 && list->current_pool > 0 ) {
+		uint32_t set_count;
+		set_count = DESCRIPTOR_POOL_INITIAL_SETS;
+		while ( set_count < list->count_of_sets_this_frame + list->count_of_sets_this_frame / 2 && set_count < DESCRIPTOR_POOL_MAX_SETS ) {
+			set_count *= 2;
+		}
+
+		destroy_vulkan_descriptor_pool_list( allocator, list );
+		list->next_pool_set_count = set_count;
+
+		allocator->count_of_consolidations += 1;
+	}
+	else {
+		for ( uint32_t i = 0; i < list->count_of_pools; ++i ) {
+			allocator->dispatch->vkResetDescriptorPool( allocator->dispatch->logical_device, list->pools[i], 0 );
+			allocator->count_of_pool_resets += 1;
+		}
+	}
+
+	list->current_pool             = 0;
+	list->count_of_sets_this_frame = 0;
+
+	return;
+}
+
+// After the frame's recording is done -- returns how many sets it allocated across its lists
+uint32_t
+end_frame_descriptor_allocations( Vulkan_Descriptor_Allocator *allocator, Vulkan_Descriptor_Pool_List *lists, uint32_t count_of_lists )
+{
+	uint32_t count_of_sets = 0;
+	for ( uint32_t i = 0; i < count_of_lists; ++i ) {
+		count_of_sets += lists[i].count_of_sets_this_frame;
+	}
+
+	allocator->count_of_frames     += 1;
+	allocator->count_of_frame_sets += count_of_sets;
+	allocator->last_frame_sets      = count_of_sets;
+	if ( count_of_sets > allocator->peak_frame_sets ) {
+		allocator->peak_frame_sets = count_of_sets;
+	}
+
+	return count_of_sets;
+}
+
+void
+destroy_vulkan_descriptor_allocator( Vulkan_Descriptor_Allocator *allocator )
+{
+	destroy_vulkan_descriptor_pool_list( allocator, &allocator->static_pools );
+	platform_destroy_mutex( &allocator->static_mutex );
+
+	return;
+}
+
+void
+begin_descriptor_writes( Vulkan_Descriptor_Writer *writer, Vulkan_Descriptor_Allocator *allocator )
+{
+	writer->allocator       = allocator;
+	writer->count_of_writes = 0;
+
+	return;
+}
+
+// Any thread, as long as no one else is writing the same sets
+void
+flush_descriptor_writes( Vulkan_Descriptor_Writer *writer )
+{
+	if ( writer->count_of_writes == 0 ) {
+		return;
+	}
+
+	Vulkan_Device_Dispatch *dispatch;
+	dispatch = writer->allocator->dispatch;
+
+	dispatch->vkUpdateDescriptorSets( dispatch->logical_device, writer->count_of_writes, writer->writes, 0, NULL );
+
+	platform_atomic_add_32( &writer->allocator->count_of_update_calls, 1 );
+	platform_atomic_add_32( &writer->allocator->count_of_descriptor_writes, (int32_t)writer->count_of_writes );
+
+	writer->count_of_writes = 0;
+
+	return;
+}
+
+VkWriteDescriptorSet *
+add_descriptor_write( Vulkan_Descriptor_Writer *writer, VkDescriptorSet set, uint32_t binding, uint32_t array_element, VkDescriptorType type )
+{
+	if ( writer->count_of_writes == MAX_DESCRIPTOR_WRITES ) {
+		flush_descriptor_writes( writer );
+	}
+
+	VkWriteDescriptorSet *write;
+	write = &writer->writes[writer->count_of_writes];
+	memset( write, 0, sizeof (VkWriteDescriptorSet) );
+
+	write->sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write->dstSet          = set;
+	write->dstBinding      = binding;
+	write->dstArrayElement = array_element;
+	write->descriptorCount = 1;
+	write->descriptorType  = type;
+
+	writer->count_of_writes += 1;
+
+	return write;
+}
+
+void
+write_descriptor_buffer( Vulkan_Descriptor_Writer *writer, VkDescriptorSet set, uint32_t binding, uint32_t array_element, VkDescriptorType type,
+						 VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range )
+{
+	VkWriteDescriptorSet *write;
+	write = add_descriptor_write( writer, set, binding, array_element, type );
+
+	VkDescriptorBufferInfo *buffer_info;
+	buffer_info = &writer->buffer_infos[write - writer->writes];
+	buffer_info->buffer = buffer;
+	buffer_info->offset = offset;
+	buffer_info->range  = range;
+
+	write->pBufferInfo = buffer_info;
+
+	return;
+}
+
+void
+write_descriptor_image( Vulkan_Descriptor_Writer *writer, VkDescriptorSet set, uint32_t binding, uint32_t array_element, VkDescriptorType type,
+						VkSampler sampler, VkImageView image_view, VkImageLayout image_layout )
+{
+	VkWriteDescriptorSet *write;
+	write = add_descriptor_write( writer, set, binding, array_element, type );
+
+	VkDescriptorImageInfo *image_info;
+	image_info = &writer->image_infos[write - writer->writes];
+	image_info->sampler     = sampler;
+	image_info->imageView   = image_view;
+	image_info->imageLayout = image_layout;
+
+	write->pImageInfo = image_info;
+
+	return;
+}
+
+void
+export_vulkan_descriptor_allocator_as_json( Vulkan_Descriptor_Allocator *allocator, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"pools_created\": %u,\n", indentation, allocator->count_of_pools_created );
+	fprintf( output, "%s  \"pool_resets\": %u,\n", indentation, allocator->count_of_pool_resets );
+	fprintf( output, "%s  \"consolidations\": %u,\n", indentation, allocator->count_of_consolidations );
+	fprintf( output, "%s  \"static_pools\": %u,\n", indentation, allocator->static_pools.count_of_pools );
+	fprintf( output, "%s  \"static_sets\": %llu,\n", indentation, (unsigned long long)allocator->static_pools.count_of_sets_allocated );
+	fprintf( output, "%s  \"frame_sets\": { \"avg\": %.2f, \"max\": %u, \"last\": %u },\n", indentation,
+			 allocator->count_of_frames ? (double)allocator->count_of_frame_sets / (double)allocator->count_of_frames : 0.0,
+			 allocator->peak_frame_sets, allocator->last_frame_sets );
+	fprintf( output, "%s  \"update_calls\": %d,\n", indentation, platform_atomic_load_32( &allocator->count_of_update_calls ) );
+	fprintf( output, "%s  \"descriptor_writes\": %d\n", indentation, platform_atomic_load_32( &allocator->count_of_descriptor_writes ) );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,561 @@
+// Physical device selection. Every device the instance enumerates is scored instead of taking the first
+// discrete GPU, so integrated GPUs and CPU implementations (lavapipe on the build hosts) work too and multi-GPU
+// boxes land on the same, best device every time:
+//
+//  - hard requirements -- required device extensions, required features, a graphics family and a family that
+//    can present to the surface. Failing any of them rejects the device, the reason ends up in the report
+//  - score -- device type first (discrete > integrated > virtual > CPU), then device local memory, dedicated
+//    transfer / async compute families, a few limits, wanted features and optional extensions
+//  - micro-benchmark (opt-in, PLAYGROUND_DEVICE_BENCHMARK=1) -- devices scoring within DEVICE_BENCHMARK_TIE_RANGE
+//    of the best one each get a throwaway VkDevice and run a short buffer clear / copy loop; fastest wins
+//
+// PLAYGROUND_DEVICE (or Vulkan_Context::device_override) picks a device by enumeration index or by a piece of
+// its name, e.g. PLAYGROUND_DEVICE=llvmpipe. A device it names that fails the requirements is reported and the
+// scored pick is used instead.
+//
+// Unity built -- included by vulkan_renderer.c after the memory allocator, which the micro-benchmark borrows.
+
+#define DEVICE_BENCHMARK_TIE_RANGE		0.10f						// of the best score
+#define DEVICE_BENCHMARK_BUFFER_SIZE	( 16ull * 1024 * 1024 )
+#define DEVICE_BENCHMARK_ITERATIONS		8
+
+// NOTE: all VK_FALSE for now -- flip a member on when the renderer starts depending on it
+VkPhysicalDeviceFeatures required_device_features = { 0 };
+
+typedef struct {
+
+	VkPhysicalDevice					physical_device;
+	uint32_t							enumeration_index;
+	VkPhysicalDeviceProperties			properties;
+	VkPhysicalDeviceFeatures			features;
+	uint64_t							device_local_bytes;			// largest device local heap
+	uint32_t							graphics_family_index;
+
+	char								*rejection;					// NULL -- meets every requirement
+	float								score;
+	float								type_score;
+	float								memory_score;
+	float								queue_score;
+	float								limit_score;
+	float								feature_score;
+
+	bool								benchmarked;
+	double								benchmark_gigabytes_per_second;
+
+} Vulkan_Device_Candidate;
+
+typedef struct {
+
+	uint32_t					count_of_candidates;				// 0 -- the startup cache picked the device
+	Vulkan_Device_Candidate		*candidates;						// one per enumerated device
+	int							selected_candidate;					// -1 -- nothing selected here
+	char						*override;							// what PLAYGROUND_DEVICE / device_override said
+	char						*override_source;					// where it came from, for the messages
+	bool						override_used;
+	bool						benchmark_enabled;
+	uint64_t					benchmark_nanoseconds;
+
+} Vulkan_Device_Selection;
+
+
+float
+score_vulkan_device_type( VkPhysicalDeviceType device_type )
+{
+	switch ( device_type ) {
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: 	 return 1000.0f;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 500.0f;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: 	 return 250.0f;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU: 			 return 100.0f;
+		default: 									 return 50.0f;
+	}
+}
+
+// NOTE: VkPhysicalDeviceFeatures is nothing but VkBool32s, so it can be walked as an array
+char *
+check_required_device_features( VkPhysicalDeviceFeatures *features )
+{
+	VkBool32 *required;
+	VkBool32 *available;
+	required  = (VkBool32 *)&required_device_features;
+	available = (VkBool32 *)features;
+
+	uint32_t count_of_features;
+	count_of_features = sizeof (VkPhysicalDeviceFeatures) / sizeof (VkBool32);
+
+	for ( uint32_t i = 0; i < count_of_features; ++i ) {
+		if ( required[i] && !available[i] ) {
+			return "missing a required feature";
+		}
+	}
+
+	return NULL;
+}
+
+// Extension enumeration for one candidate -- NULL and the count of optional extensions it has, or why it's out
+char *
+check_candidate_device_extensions( VkPhysicalDevice physical_device, uint32_t *count_of_optional_extensions )
+{
+	*count_of_optional_extensions = 0;
+
+	uint32_t count_of_available_device_extensions = 0;
+	vkEnumerateDeviceExtensionProperties( physical_device, NULL, &count_of_available_device_extensions, NULL );
+	if ( count_of_available_device_extensions == 0 ) {
+		return "no device extensions";
+	}
+
+	VkExtensionProperties *available_device_extensions;
+	available_device_extensions = (VkExtensionProperties *)malloc( count_of_available_device_extensions * sizeof (VkExtensionProperties) );
+	if ( !available_device_extensions ) {
+		fprintf( stdout, "Unable to allocate space for the available device extensions\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	vkEnumerateDeviceExtensionProperties( physical_device, NULL, &count_of_available_device_extensions, available_device_extensions );
+
+	char *rejection = NULL;
+	for ( uint32_t i = 0; i < count_of_required_device_extensions && !rejection; ++i ) {
+		bool extension_found = false;
+		for ( uint32_t j = 0; j < count_of_available_device_extensions; ++j ) {
+			if ( strcmp( required_device_extensions[i], available_device_extensions[j].extensionName ) == 0 ) {
+				extension_found = true;
+				break;
+			}
+		}
+
+		if ( !extension_found ) {
+			rejection = "missing a required extension";
+		}
+	}
+
+	for ( uint32_t i = 0; i < count_of_optional_device_extensions; ++i ) {
+		for ( uint32_t j = 0; j < count_of_available_device_extensions; ++j ) {
+			if ( strcmp( optional_device_extensions[i], available_device_extensions[j].extensionName ) == 0 ) {
+				*count_of_optional_extensions += 1;
+				break;
+			}
+		}
+	}
+
+	free( available_device_extensions );
+
+	return rejection;
+}
+
+void
+score_vulkan_device_candidate( Vulkan_Device_Candidate *candidate, VkSurfaceKHR surface )
+{
+	VkPhysicalDevice physical_device;
+	physical_device = candidate->physical_device;
+
+	vkGetPhysicalDeviceProperties( physical_device, &candidate->properties );
+	vkGetPhysicalDeviceFeatures( physical_device, &candidate->features );
+
+	VkPhysicalDeviceMemoryProperties memory_properties;
+	vkGetPhysicalDeviceMemoryProperties( physical_device, &memory_properties );
+	for ( uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i ) {
+		if ( ( memory_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ) &&
+			 memory_properties.memoryHeaps[i].size > candidate->device_local_bytes ) {
+			candidate->device_local_bytes = memory_properties.memoryHeaps[i].size;
+		}
+	}
+
+	uint32_t count_of_queue_families = 0;
+	VkQueueFamilyProperties queue_family_properties[MAX_QUEUE_FAMILIES];
+	vkGetPhysicalDeviceQueueFamilyProperties( physical_device, &count_of_queue_families, NULL );
+	if ( count_of_queue_families > MAX_QUEUE_FAMILIES ) {
+		count_of_queue_families = MAX_QUEUE_FAMILIES;
+	}
+	vkGetPhysicalDeviceQueueFamilyProperties( physical_device, &count_of_queue_families, queue_family_properties );
+
+	bool has_graphics 				= false;
+	bool has_present 				= false;
+	bool has_graphics_with_present 	= false;
+	bool has_async_compute 			= false;
+	bool has_dedicated_transfer 	= false;
+	for ( uint32_t i = 0; i < count_of_queue_families; ++i ) {
+		VkQueueFlags queue_flags;
+		queue_flags = queue_family_properties[i].queueFlags;
+
+		if ( queue_family_properties[i].queueCount < 1 ) {
+			continue;
+		}
+
+		VkBool32 has_presentation_support = VK_FALSE;
+		vkGetPhysicalDeviceSurfaceSupportKHR( physical_device, i, surface, &has_presentation_support );
+
+		if ( ( queue_flags & VK_QUEUE_GRAPHICS_BIT ) && !has_graphics ) {
+			has_graphics 					 = true;
+			candidate->graphics_family_index = i;
+		}
+
+		if ( has_presentation_support == VK_TRUE ) {
+			has_present = true;
+			if ( queue_flags & VK_QUEUE_GRAPHICS_BIT ) {
+				has_graphics_with_present 		 = true;
+				candidate->graphics_family_index = i;
+			}
+		}
+
+		if ( ( queue_flags & VK_QUEUE_COMPUTE_BIT ) && !( queue_flags & VK_QUEUE_GRAPHICS_BIT ) ) {
+			has_async_compute = true;
+		}
+
+		if ( ( queue_flags & VK_QUEUE_TRANSFER_BIT ) && !( queue_flags & ( VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT ) ) ) {
+			has_dedicated_transfer = true;
+		}
+	}
+
+	uint32_t count_of_optional_extensions;
+	candidate->rejection = check_candidate_device_extensions( physical_device, &count_of_optional_extensions );
+
+	if ( !candidate->rejection ) {
+		candidate->rejection = check_required_device_features( &candidate->features );
+	}
+
+	if ( !candidate->rejection && !has_graphics ) {
+		candidate->rejection = "no graphics queue family";
+	}
+
+	if ( !candidate->rejection && !has_present ) {
+		candidate->rejection = "can't present to the surface";
+	}
+
+	if ( candidate->rejection ) {
+		return;
+	}
+
+	VkPhysicalDeviceLimits *limits;
+	limits = &candidate->properties.limits;
+
+	candidate->type_score = score_vulkan_device_type( candidate->properties.deviceType );
+
+	// NOTE: a point per 64 MB, capped at 16 GB -- type still dominates, memory splits two devices of a kind
+	uint64_t device_local_megabytes;
+	device_local_megabytes 	= candidate->device_local_bytes / ( 1024 * 1024 );
+	candidate->memory_score = (float)( device_local_megabytes < 16384 ? device_local_megabytes : 16384 ) / 64.0f;
+
+	candidate->queue_score = ( has_graphics_with_present ? 25.0f : 0.0f )
+						   + ( has_async_compute ? 50.0f : 0.0f )
+						   + ( has_dedicated_transfer ? 50.0f : 0.0f );
+
+	candidate->limit_score = (float)limits->maxImageDimension2D / 1024.0f
+						   + (float)limits->maxComputeWorkGroupInvocations / 128.0f
+						   + ( limits->timestampComputeAndGraphics ? 10.0f : 0.0f );
+
+	// wanted, not required -- what the GPU driven path and texture streaming would like to have
+	candidate->feature_score = ( candidate->features.multiDrawIndirect ? 10.0f : 0.0f )
+							 + ( candidate->features.drawIndirectFirstInstance ? 10.0f : 0.0f )
+							 + ( candidate->features.samplerAnisotropy ? 10.0f : 0.0f )
+							 + ( candidate->features.textureCompressionBC ? 10.0f : 0.0f )
+							 + 10.0f * (float)count_of_optional_extensions;
+
+	candidate->score = candidate->type_score + candidate->memory_score + candidate->queue_score
+					 + candidate->limit_score + candidate->feature_score;
+
+	return;
+}
+
+// Throwaway device, one graphics queue: fill a buffer, copy it to another, DEVICE_BENCHMARK_ITERATIONS times.
+// The first submit warms up, the second is timed on the CPU across submit + fence -- coarse, but it's
+// comparing devices that are otherwise a coin toss, not measuring them. Returns GB/s moved.
+double
+run_device_micro_benchmark( Vulkan_Device_Candidate *candidate )
+{
+	float queue_priority = 1.0f;
+
+	VkDeviceQueueCreateInfo queue_create_info = { 0 };
+	queue_create_info.sType 			= VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queue_create_info.queueFamilyIndex 	= candidate->graphics_family_index;
+	queue_create_info.queueCount 		= 1;
+	queue_create_info.pQueuePriorities 	= &queue_priority;
+
+	VkDeviceCreateInfo device_create_info = { 0 };
+	device_create_info.sType 				= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	device_create_info.queueCreateInfoCount = 1;
+	device_create_info.pQueueCreateInfos 	= &queue_create_info;
+
+	VkDevice logical_device;
+	if ( vkCreateDevice( candidate->physical_device, &device_create_info, NULL, &logical_device ) != VK_SUCCESS ) {
+		return 0.0;
+	}
+
+	Vulkan_Device_Dispatch dispatch = { 0 };
+	load_vulkan_device_dispatch( &dispatch, logical_device, VULKAN_DISPATCH_STARTUP, NULL, 0 );
+
+	VkQueue queue;
+	dispatch.vkGetDeviceQueue( logical_device, candidate->graphics_family_index, 0, &queue );
+
+	Vulkan_Memory_Allocator memory;
+	create_vulkan_memory_allocator( &memory, &dispatch, candidate->physical_device );
+
+	Vulkan_Allocation source_allocation;
+	Vulkan_Allocation destination_allocation;
+	VkBuffer source;
+	VkBuffer destination;
+	source 		= create_vulkan_buffer( &memory, DEVICE_BENCHMARK_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+										VULKAN_MEMORY_USAGE_GPU_ONLY, &source_allocation );
+	destination = create_vulkan_buffer( &memory, DEVICE_BENCHMARK_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+										VULKAN_MEMORY_USAGE_GPU_ONLY, &destination_allocation );
+
+	VkCommandPoolCreateInfo command_pool_create_info = { 0 };
+	command_pool_create_info.sType 			  = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_create_info.queueFamilyIndex = candidate->graphics_family_index;
+
+	VkCommandPool command_pool;
+	dispatch.vkCreateCommandPool( logical_device, &command_pool_create_info, NULL, &command_pool );
+
+	VkCommandBufferAllocateInfo command_buffer_allocate_info = { 0 };
+	command_buffer_allocate_info.sType 				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	command_buffer_allocate_info.commandPool 		= command_pool;
+	command_buffer_allocate_info.level 				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	command_buffer_allocate_info.commandBufferCount = 1;
+
+	VkCommandBuffer command_buffer;
+	dispatch.vkAllocateCommandBuffers( logical_device, &command_buffer_allocate_info, &command_buffer );
+
+	VkCommandBufferBeginInfo command_buffer_begin_info = { 0 };
+	command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+	// fill -> copy reads what the fill wrote, next fill overwrites what the copy read
+	VkMemoryBarrier transfer_barrier = { 0 };
+	transfer_barrier.sType 		   = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	transfer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	transfer_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	VkBufferCopy copy_region = { 0 };
+	copy_region.size = DEVICE_BENCHMARK_BUFFER_SIZE;
+
+	dispatch.vkBeginCommandBuffer( command_buffer, &command_buffer_begin_info );
+	for ( uint32_t i = 0; i < DEVICE_BENCHMARK_ITERATIONS; ++i ) {
+		dispatch.vkCmdFillBuffer( command_buffer, source, 0, VK_WHOLE_SIZE, 0x01010101u * i );
+		dispatch.vkCmdPipelineBarrier( command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+									   0, 1, &transfer_barrier, 0, NULL, 0, NULL );
+		dispatch.vkCmdCopyBuffer( command_buffer, source, destination, 1, &copy_region );
+		dispatch.vkCmdPipelineBarrier( command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+									   0, 1, &transfer_barrier, 0, NULL, 0, NULL );
+	}
+	dispatch.vkEndCommandBuffer( command_buffer );
+
+	VkFenceCreateInfo fence_create_info = { 0 };
+	fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkFence fence;
+	dispatch.vkCreateFence( logical_device, &fence_create_info, NULL, &fence );
+
+	VkSubmitInfo submit_info = { 0 };
+	submit_info.sType 				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.commandBufferCount 	= 1;
+	submit_info.pCommandBuffers 	= &command_buffer;
+
+	uint64_t measured_nanoseconds = 0;
+	for ( uint32_t run = 0; run < 2; ++run ) {
+		uint64_t run_start;
+		run_start = platform_get_timestamp_in_nanoseconds();
+
+		dispatch.vkResetFences( logical_device, 1, &fence );
+		dispatch.vkQueueSubmit( queue, 1, &submit_info, fence );
+		dispatch.vkWaitForFences( logical_device, 1, &fence, VK_TRUE, UINT64_MAX );
+
+		measured_nanoseconds = platform_get_timestamp_in_nanoseconds() - run_start;
+	}
+
+	dispatch.vkDestroyFence( logical_device, fence, NULL );
+	dispatch.vkDestroyCommandPool( logical_device, command_pool, NULL );
+	destroy_vulkan_buffer( &memory, source, &source_allocation );
+	destroy_vulkan_buffer( &memory, destination, &destination_allocation );
+	destroy_vulkan_memory_allocator( &memory );
+	dispatch.vkDestroyDevice( logical_device, NULL );
+
+	if ( measured_nanoseconds == 0 ) {
+		return 0.0;
+	}
+
+	// fill writes once, copy reads and writes
+	double bytes_moved;
+	bytes_moved = (double)DEVICE_BENCHMARK_ITERATIONS * (double)DEVICE_BENCHMARK_BUFFER_SIZE * 3.0;
+
+	return bytes_moved / (double)measured_nanoseconds;
+}
+
+// Enumeration index ("1") or a case sensitive piece of the device name ("Radeon"). -1 when nothing matches.
+int
+find_vulkan_device_override( Vulkan_Device_Selection *selection, char *override )
+{
+	char *end;
+	unsigned long index;
+	index = strtoul( override, &end, 10 );
+	if ( end != override && *end == '\0' ) {
+		for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+			if ( selection->candidates[i].enumeration_index == index ) {
+				return (int)i;
+			}
+		}
+
+		return -1;
+	}
+
+	for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+		if ( strstr( selection->candidates[i].properties.deviceName, override ) ) {
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+// Exits when no device meets the requirements
+VkPhysicalDevice
+select_vulkan_physical_device( Vulkan_Device_Selection *selection, VkPhysicalDevice *physical_devices, uint32_t physical_device_count,
+							   VkSurfaceKHR surface, char *override, char *override_source, bool benchmark_enabled )
+{
+	free( selection->candidates );
+	memset( selection, 0, sizeof (Vulkan_Device_Selection) );
+	selection->selected_candidate = -1;
+	selection->override 		  = override;
+	selection->override_source 	  = override_source;
+	selection->benchmark_enabled  = benchmark_enabled;
+
+	// NOTE: sized from the enumeration -- every device the instance reports is scored and shows up in the report
+	selection->count_of_candidates = physical_device_count;
+	selection->candidates          = (Vulkan_Device_Candidate *)calloc( physical_device_count, sizeof (Vulkan_Device_Candidate) );
+	if ( !selection->candidates ) {
+		fprintf( stdout, "Unable to allocate space for the device candidates\n" );
+		exit( EXIT_FAILURE );
+	}
+	for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+		Vulkan_Device_Candidate *candidate;
+		candidate = &selection->candidates[i];
+		candidate->physical_device 	 = physical_devices[i];
+		candidate->enumeration_index = i;
+
+		score_vulkan_device_candidate( candidate, surface );
+	}
+
+	if ( override ) {
+		int override_index;
+		override_index = find_vulkan_device_override( selection, override );
+
+		if ( override_index == -1 ) {
+			fprintf( stderr, "No device matches %s %s -- picking one instead\n", override_source, override );
+		}
+		else if ( selection->candidates[override_index].rejection ) {
+			fprintf( stderr, "%s from %s can't be used (%s) -- picking another device\n",
+					 selection->candidates[override_index].properties.deviceName, override_source, selection->candidates[override_index].rejection );
+		}
+		else {
+			selection->selected_candidate = override_index;
+			selection->override_used 	  = true;
+			return selection->candidates[override_index].physical_device;
+		}
+	}
+
+	int best_index = -1;
+	for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+		if ( selection->candidates[i].rejection ) {
+			continue;
+		}
+
+		// NOTE: strictly greater -- equal scores keep enumeration order, so the pick is stable run to run
+		if ( best_index == -1 || selection->candidates[i].score > selection->candidates[best_index].score ) {
+			best_index = (int)i;
+		}
+	}
+
+	if ( best_index == -1 ) {
+		fprintf( stdout, "No Vulkan device meets the requirements:\n" );
+		for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+			fprintf( stdout, "  %s -- %s\n", selection->candidates[i].properties.deviceName, selection->candidates[i].rejection );
+		}
+		exit( EXIT_FAILURE );
+	}
+
+	if ( benchmark_enabled ) {
+		uint64_t benchmark_start;
+		benchmark_start = platform_get_timestamp_in_nanoseconds();
+
+		float tie_score;
+		tie_score = selection->candidates[best_index].score * ( 1.0f - DEVICE_BENCHMARK_TIE_RANGE );
+
+		uint32_t count_of_tied_candidates = 0;
+		for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+			if ( !selection->candidates[i].rejection && selection->candidates[i].score >= tie_score ) {
+				count_of_tied_candidates += 1;
+			}
+		}
+
+		// nothing to break with a single contender
+		if ( count_of_tied_candidates > 1 ) {
+			int fastest_index = -1;
+			for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+				Vulkan_Device_Candidate *candidate;
+				candidate = &selection->candidates[i];
+
+				if ( candidate->rejection || candidate->score < tie_score ) {
+					continue;
+				}
+
+				candidate->benchmark_gigabytes_per_second = run_device_micro_benchmark( candidate );
+				candidate->benchmarked 					  = true;
+
+				if ( fastest_index == -1 ||
+					 candidate->benchmark_gigabytes_per_second > selection->candidates[fastest_index].benchmark_gigabytes_per_second ) {
+					fastest_index = (int)i;
+				}
+			}
+
+			if ( selection->candidates[fastest_index].benchmark_gigabytes_per_second > 0.0 ) {
+				best_index = fastest_index;
+			}
+		}
+
+		selection->benchmark_nanoseconds = platform_get_timestamp_in_nanoseconds() - benchmark_start;
+	}
+
+	selection->selected_candidate = best_index;
+
+	return selection->candidates[best_index].physical_device;
+}
+
+void
+export_vulkan_device_selection_as_json( Vulkan_Device_Selection *selection, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"scored\": %s,\n", indentation, selection->count_of_candidates > 0 ? "true" : "false" );
+	fprintf( output, "%s  \"override_used\": %s,\n", indentation, selection->override_used ? "true" : "false" );
+	fprintf( output, "%s  \"benchmark_ms\": %.3f,\n", indentation, (double)selection->benchmark_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"candidates\": [\n", indentation );
+	for ( uint32_t i = 0; i < selection->count_of_candidates; ++i ) {
+		Vulkan_Device_Candidate *candidate;
+		candidate = &selection->candidates[i];
+
+		fprintf( output, "%s    { \"name\": \"%s\", \"selected\": %s, ", indentation, candidate->properties.deviceName,
+				 (int)i == selection->selected_candidate ? "true" : "false" );
+		if ( candidate->rejection ) {
+			fprintf( output, "\"rejected\": \"%s\" }", candidate->rejection );
+		}
+		else {
+			fprintf( output, "\"score\": %.1f, \"type\": %.1f, \"memory\": %.1f, \"queues\": %.1f, \"limits\": %.1f, \"features\": %.1f",
+					 candidate->score, candidate->type_score, candidate->memory_score, candidate->queue_score,
+					 candidate->limit_score, candidate->feature_score );
+			if ( candidate->benchmarked ) {
+				fprintf( output, ", \"benchmark_gb_per_second\": %.3f", candidate->benchmark_gigabytes_per_second );
+			}
+			fprintf( output, " }" );
+		}
+		fprintf( output, "%s\n", i + 1 < selection->count_of_candidates ? "," : "" );
+	}
+	fprintf( output, "%s  ]\n", indentation );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
+
+void
+destroy_vulkan_device_selection( Vulkan_Device_Selection *selection )
+{
+	free( selection->candidates );
+	selection->candidates          = NULL;
+	selection->count_of_candidates = 0;
+
+	return;
+}
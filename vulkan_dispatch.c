@@ -0,0 +1,226 @@
+// Per-device dispatch table. Every device level command is fetched with vkGetDeviceProcAddr for one
+// specific VkDevice and called through vulkan_context->dispatch, so hot path calls (vkCmd*, vkQueueSubmit)
+// go straight into the driver instead of through the loader's trampolines, and two devices in the same
+// process each get their own table.
+//
+// The command lists below are the whole table -- add a command to a list and the struct member and the
+// loading code follow. Lists are split by when they're needed:
+//
+//  - VULKAN_DEVICE_STARTUP_FUNCTIONS   -- everything the renderer calls, enough for a throwaway device
+//  - VULKAN_DEVICE_DEFERRED_FUNCTIONS  -- the rest of core 1.0, loaded with the renderer's device (VULKAN_DISPATCH_ALL)
+//    so the whole table is valid there; throwaway devices like the selection micro-benchmark skip it
+//  - VULKAN_DEVICE_CORE_1_2_FUNCTIONS  -- core 1.2 commands we use, loaded on request when the device is 1.2
+//  - one list per device extension     -- loaded only if that extension was enabled on the device
+//
+// Unity built -- included by vulkan_renderer.c after the instance level function pointers.
+
+#define VULKAN_DEVICE_STARTUP_FUNCTIONS( X ) \
+	X( vkDestroyDevice ) \
+	X( vkGetDeviceQueue ) \
+	X( vkDeviceWaitIdle ) \
+	X( vkQueueSubmit ) \
+	X( vkCreateSemaphore ) \
+	X( vkDestroySemaphore ) \
+	X( vkCreateFence ) \
+	X( vkDestroyFence ) \
+	X( vkWaitForFences ) \
+	X( vkResetFences ) \
+	X( vkGetFenceStatus ) \
+	X( vkCreateCommandPool ) \
+	X( vkDestroyCommandPool ) \
+	X( vkAllocateCommandBuffers ) \
+	X( vkFreeCommandBuffers ) \
+	X( vkBeginCommandBuffer ) \
+	X( vkEndCommandBuffer ) \
+	X( vkCmdPipelineBarrier ) \
+	X( vkCmdClearColorImage ) \
+	X( vkCreateQueryPool ) \
+	X( vkDestroyQueryPool ) \
+	X( vkGetQueryPoolResults ) \
+	X( vkCmdResetQueryPool ) \
+	X( vkCmdWriteTimestamp ) \
+	X( vkAllocateMemory ) \
+	X( vkFreeMemory ) \
+	X( vkMapMemory ) \
+	X( vkBindBufferMemory ) \
+	X( vkBindImageMemory ) \
+	X( vkGetBufferMemoryRequirements ) \
+	X( vkGetImageMemoryRequirements ) \
+	X( vkCreateBuffer ) \
+	X( vkDestroyBuffer ) \
+	X( vkCreateImage ) \
+	X( vkDestroyImage ) \
+	X( vkQueueWaitIdle ) \
+	X( vkResetCommandPool ) \
+	X( vkCmdCopyBuffer ) \
+	X( vkCmdCopyBufferToImage ) \
+	X( vkCreatePipelineCache ) \
+	X( vkDestroyPipelineCache ) \
+	X( vkGetPipelineCacheData ) \
+	X( vkCmdExecuteCommands ) \
+	X( vkCmdFillBuffer ) \
+	X( vkCreateRenderPass ) \
+	X( vkDestroyRenderPass ) \
+	X( vkCreateFramebuffer ) \
+	X( vkDestroyFramebuffer ) \
+	X( vkCreateSampler ) \
+	X( vkDestroySampler ) \
+	X( vkCreateDescriptorSetLayout ) \
+	X( vkDestroyDescriptorSetLayout ) \
+	X( vkCreatePipelineLayout ) \
+	X( vkDestroyPipelineLayout ) \
+	X( vkCreateDescriptorPool ) \
+	X( vkDestroyDescriptorPool ) \
+	X( vkResetDescriptorPool ) \
+	X( vkAllocateDescriptorSets ) \
+	X( vkUpdateDescriptorSets ) \
+	X( vkCmdBindDescriptorSets ) \
+	X( vkCreateShaderModule ) \
+	X( vkDestroyShaderModule ) \
+	X( vkCreateComputePipelines ) \
+	X( vkDestroyPipeline ) \
+	X( vkCmdBindPipeline ) \
+	X( vkCmdPushConstants ) \
+	X( vkCmdDispatch )
+
+#define VULKAN_DEVICE_DEFERRED_FUNCTIONS( X ) \
+	X( vkQueueBindSparse ) \
+	X( vkUnmapMemory ) \
+	X( vkFlushMappedMemoryRanges ) \
+	X( vkInvalidateMappedMemoryRanges ) \
+	X( vkGetDeviceMemoryCommitment ) \
+	X( vkGetImageSparseMemoryRequirements ) \
+	X( vkCreateEvent ) \
+	X( vkDestroyEvent ) \
+	X( vkGetEventStatus ) \
+	X( vkSetEvent ) \
+	X( vkResetEvent ) \
+	X( vkCreateBufferView ) \
+	X( vkDestroyBufferView ) \
+	X( vkGetImageSubresourceLayout ) \
+	X( vkCreateImageView ) \
+	X( vkDestroyImageView ) \
+	X( vkMergePipelineCaches ) \
+	X( vkCreateGraphicsPipelines ) \
+	X( vkFreeDescriptorSets ) \
+	X( vkGetRenderAreaGranularity ) \
+	X( vkResetCommandBuffer ) \
+	X( vkCmdSetViewport ) \
+	X( vkCmdSetScissor ) \
+	X( vkCmdSetLineWidth ) \
+	X( vkCmdSetDepthBias ) \
+	X( vkCmdSetBlendConstants ) \
+	X( vkCmdSetDepthBounds ) \
+	X( vkCmdSetStencilCompareMask ) \
+	X( vkCmdSetStencilWriteMask ) \
+	X( vkCmdSetStencilReference ) \
+	X( vkCmdBindIndexBuffer ) \
+	X( vkCmdBindVertexBuffers ) \
+	X( vkCmdDraw ) \
+	X( vkCmdDrawIndexed ) \
+	X( vkCmdDrawIndirect ) \
+	X( vkCmdDrawIndexedIndirect ) \
+	X( vkCmdDispatchIndirect ) \
+	X( vkCmdCopyImage ) \
+	X( vkCmdBlitImage ) \
+	X( vkCmdCopyImageToBuffer ) \
+	X( vkCmdUpdateBuffer ) \
+	X( vkCmdClearDepthStencilImage ) \
+	X( vkCmdClearAttachments ) \
+	X( vkCmdResolveImage ) \
+	X( vkCmdSetEvent ) \
+	X( vkCmdResetEvent ) \
+	X( vkCmdWaitEvents ) \
+	X( vkCmdBeginQuery ) \
+	X( vkCmdEndQuery ) \
+	X( vkCmdCopyQueryPoolResults ) \
+	X( vkCmdBeginRenderPass ) \
+	X( vkCmdNextSubpass ) \
+	X( vkCmdEndRenderPass )
+
+// Core 1.2 -- only asked for when both the instance and the device are 1.2 (select_vulkan_instance_api_version)
+#define VULKAN_DEVICE_CORE_1_2_FUNCTIONS( X ) \
+	X( vkCmdDrawIndexedIndirectCount )
+
+// VK_KHR_swapchain
+#define VULKAN_DEVICE_KHR_SWAPCHAIN_FUNCTIONS( X ) \
+	X( vkCreateSwapchainKHR ) \
+	X( vkDestroySwapchainKHR ) \
+	X( vkGetSwapchainImagesKHR ) \
+	X( vkAcquireNextImageKHR ) \
+	X( vkQueuePresentKHR )
+
+typedef enum {
+
+	VULKAN_DISPATCH_STARTUP  = 0x1,
+	VULKAN_DISPATCH_DEFERRED = 0x2,
+	VULKAN_DISPATCH_CORE_1_2 = 0x4,
+	VULKAN_DISPATCH_ALL      = VULKAN_DISPATCH_STARTUP | VULKAN_DISPATCH_DEFERRED
+
+} Vulkan_Dispatch_Group;
+
+typedef struct {
+
+	VkDevice	logical_device;
+	uint32_t	loaded_groups;			// Vulkan_Dispatch_Group bits
+
+#define DECLARE_VULKAN_DEVICE_FUNCTION( name ) PFN_##name name;
+	VULKAN_DEVICE_STARTUP_FUNCTIONS( DECLARE_VULKAN_DEVICE_FUNCTION )
+	VULKAN_DEVICE_DEFERRED_FUNCTIONS( DECLARE_VULKAN_DEVICE_FUNCTION )
+	VULKAN_DEVICE_CORE_1_2_FUNCTIONS( DECLARE_VULKAN_DEVICE_FUNCTION )
+	VULKAN_DEVICE_KHR_SWAPCHAIN_FUNCTIONS( DECLARE_VULKAN_DEVICE_FUNCTION )
+#undef DECLARE_VULKAN_DEVICE_FUNCTION
+
+} Vulkan_Device_Dispatch;
+
+// NOTE: a NULL here means the driver doesn't have a command we're about to call -- no point limping on
+#define LOAD_VULKAN_DEVICE_FUNCTION( name ) \
+	dispatch->name = (PFN_##name) vkGetDeviceProcAddr( dispatch->logical_device, #name ); \
+	if ( !dispatch->name ) { \
+		fprintf( stdout, "Unable to load device function %s\n", #name ); \
+		exit( EXIT_FAILURE ); \
+	}
+
+bool
+device_extension_is_enabled( char *extension_name, char **enabled_extensions, uint32_t count_of_enabled_extensions )
+{
+	for ( uint32_t i = 0; i < count_of_enabled_extensions; ++i ) {
+		if ( strcmp( extension_name, enabled_extensions[i] ) == 0 ) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Extension commands always load with the startup group -- they're only there because we asked for the extension
+void
+load_vulkan_device_dispatch( Vulkan_Device_Dispatch *dispatch, VkDevice logical_device, uint32_t groups,
+							 char **enabled_extensions, uint32_t count_of_enabled_extensions )
+{
+	dispatch->logical_device = logical_device;
+
+	if ( ( groups & VULKAN_DISPATCH_STARTUP ) && !( dispatch->loaded_groups & VULKAN_DISPATCH_STARTUP ) ) {
+		VULKAN_DEVICE_STARTUP_FUNCTIONS( LOAD_VULKAN_DEVICE_FUNCTION )
+
+		if ( device_extension_is_enabled( VK_KHR_SWAPCHAIN_EXTENSION_NAME, enabled_extensions, count_of_enabled_extensions ) ) {
+			VULKAN_DEVICE_KHR_SWAPCHAIN_FUNCTIONS( LOAD_VULKAN_DEVICE_FUNCTION )
+		}
+
+		dispatch->loaded_groups |= VULKAN_DISPATCH_STARTUP;
+	}
+
+	if ( ( groups & VULKAN_DISPATCH_DEFERRED ) && !( dispatch->loaded_groups & VULKAN_DISPATCH_DEFERRED ) ) {
+		VULKAN_DEVICE_DEFERRED_FUNCTIONS( LOAD_VULKAN_DEVICE_FUNCTION )
+
+		dispatch->loaded_groups |= VULKAN_DISPATCH_DEFERRED;
+	}
+
+	if ( ( groups & VULKAN_DISPATCH_CORE_1_2 ) && !( dispatch->loaded_groups & VULKAN_DISPATCH_CORE_1_2 ) ) {
+		VULKAN_DEVICE_CORE_1_2_FUNCTIONS( LOAD_VULKAN_DEVICE_FUNCTION )
+
+		dispatch->loaded_groups |= VULKAN_DISPATCH_CORE_1_2;
+	}
+
+	return;
+}
@@ -0,0 +1,705 @@
+// GPU driven scene. Objects (bounding sphere, transform, mesh, material bucket) live in storage buffers, and
+// every frame a compute pass (shaders/cull.comp) frustum culls them, picks a LOD by distance and appends one
+// VkDrawIndexedIndirectCommand per surviving object to its bucket's range of the draw buffer, bumping the
+// bucket's count. Drawing is then one vkCmdDrawIndexedIndirectCount per bucket (record_gpu_scene_draws) -- the
+// CPU's cost per frame doesn't depend on how many objects there are.
+//
+//   reset_draw_counts     -- vkCmdFillBuffer the counts to 0          counts: transfer_write
+//   cull                  -- one invocation per object                counts: compute_shader_read_write
+//                                                                     draws:  compute_shader_write
+//   read_back_draw_counts -- counts into host visible memory          counts: transfer_read
+//
+// The frame graph puts the barriers in between; a pass that draws the scene declares indirect_read on both
+// (use_gpu_scene_draws) and gets the compute -> indirect barrier the same way. Draws and counts are per frame
+// slot, since the next frame's cull may run while this frame's draws are still reading. So is the read back,
+// looked at once the slot's fence has signaled (resolve_gpu_scene_counts) to report how many objects survived.
+//
+// firstInstance of every draw is the object's index, so the vertex shader gets its transform from
+// objects[gl_InstanceIndex]. Each bucket's range is sized for every object in the bucket, so appends can't
+// overflow. Needs Vulkan 1.2 (drawIndirectCount) plus multiDrawIndirect and drawIndirectFirstInstance.
+//
+// The cull pipeline is rebuilt at the frame boundary when the shader cache swaps in a new cull.comp.spv.
+//
+// Unity built -- included by vulkan_renderer.c after the frame graph.
+
+#define GPU_SCENE_MAX_LODS				4				// MAX_LODS in shaders/cull.comp
+#define GPU_SCENE_MAX_BUCKETS			64
+#define GPU_SCENE_CULL_GROUP_SIZE		64				// local_size_x in shaders/cull.comp
+#define GPU_SCENE_CULL_SHADER			"cull.comp.spv"
+#define GPU_SCENE_UPLOAD_CHUNK_SIZE		( UPLOAD_STAGING_RING_SIZE / 4 )
+
+// std430 -- these have to match the structs in shaders/cull.comp
+typedef struct {
+
+	float		center_and_radius[4];			// world space bounding sphere
+	float		transform[12];					// 3x4 row major, for the vertex shader -- culling only needs the sphere
+	uint32_t	mesh;
+	uint32_t	bucket;
+	uint32_t	padding[2];
+
+} Gpu_Scene_Object;
+
+typedef struct {
+
+	uint32_t	index_count;
+	uint32_t	first_index;
+	int32_t		vertex_offset;
+	float		max_distance;					// used up to this far from the camera
+
+} Gpu_Scene_Lod;
+
+typedef struct {
+
+	Gpu_Scene_Lod	lods[GPU_SCENE_MAX_LODS];	// most detailed first, objects past the last one aren't drawn
+	uint32_t		count_of_lods;
+	uint32_t		padding[3];
+
+} Gpu_Scene_Mesh;
+
+typedef struct {
+
+	uint32_t	first_draw;
+	uint32_t	max_draws;						// objects in the bucket
+
+} Gpu_Scene_Bucket;
+
+// push constants -- 128 bytes, the least maxPushConstantsSize is allowed to be
+typedef struct {
+
+	float		frustum_planes[6][4];			// inward normal + distance -- inside when dot( n, p ) + w >= 0
+	float		camera_position[3];
+	float		lod_scale;						// distances are multiplied by this before picking a LOD
+	uint32_t	count_of_objects;
+	uint32_t	padding[3];
+
+} Gpu_Scene_Cull_Constants;
+
+typedef struct {
+
+	VkBuffer			draws;
+	Vulkan_Allocation	draws_allocation;
+	VkBuffer			counts;
+	Vulkan_Allocation	counts_allocation;
+	VkBuffer			read_back;
+	Vulkan_Allocation	read_back_allocation;	// GPU_TO_CPU, stays mapped
+	VkDescriptorSet		cull_set;
+	bool				read_back_pending;		// recorded, not looked at yet
+
+} Gpu_Scene_Frame;
+
+typedef struct {
+
+	bool		supported;
+	char		*unsupported_reason;
+
+} Vulkan_Gpu_Scene_Support;
+
+typedef struct {
+
+	Vulkan_Gpu_Scene_Support	support;		// filled by the device probe
+	bool						enabled;
+
+	Vulkan_Device_Dispatch		*dispatch;
+	Vulkan_Memory_Allocator		*memory;
+	Vulkan_Pipeline_Cache		*pipeline_cache;
+
+	Vulkan_Shader				*cull_shader;
+	uint32_t					cull_shader_generation;		// what cull_pipeline was built from
+	Vulkan_Descriptor_Layout	cull_set_layout;			// both owned by the object cache
+	VkPipelineLayout			cull_pipeline_layout;
+	VkPipeline					cull_pipeline;
+	VkPipeline					retired_pipeline;			// replaced by a reload, destroyed once its last frame is done
+	uint64_t					retired_pipeline_frame_number;
+	uint32_t					count_of_pipeline_builds;
+
+	VkBuffer					objects;
+	Vulkan_Allocation			objects_allocation;
+	VkBuffer					meshes;
+	Vulkan_Allocation			meshes_allocation;
+	VkBuffer					bucket_ranges;
+	Vulkan_Allocation			bucket_ranges_allocation;
+	uint32_t					count_of_objects;
+	uint32_t					count_of_meshes;
+	Gpu_Scene_Bucket			buckets[GPU_SCENE_MAX_BUCKETS];
+	uint32_t					count_of_buckets;
+
+	Gpu_Scene_Frame				frames[FRAME_RING_CAPACITY];
+	uint32_t					count_of_frames;
+
+	Gpu_Scene_Cull_Constants	cull_constants;				// set on the render thread before the passes record
+	uint32_t					draws_resource;				// frame graph
+	uint32_t					counts_resource;
+
+	uint64_t					count_of_frames_read_back;
+	uint64_t					total_visible;
+	uint32_t					min_visible;
+	uint32_t					max_visible;
+	uint32_t					last_visible[GPU_SCENE_MAX_BUCKETS];
+
+} Vulkan_Gpu_Scene;
+
+// Before the device is created. Turns on what the indirect count path needs, leaves support->supported false
+// with the reason otherwise.
+void
+probe_vulkan_gpu_scene_support( Vulkan_Gpu_Scene_Support *support, VkPhysicalDevice physical_device, bool device_is_1_2,
+								VkPhysicalDeviceFeatures *enabled_features, VkPhysicalDeviceVulkan12Features *enabled_vulkan_12_features )
+{
+	memset( support, 0, sizeof (Vulkan_Gpu_Scene_Support) );
+
+	if ( !device_is_1_2 ) {
+		support->unsupported_reason = "needs Vulkan 1.2";
+		return;
+	}
+
+	VkPhysicalDeviceVulkan12Features features = { 0 };
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features2 = { 0 };
+	features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features2.pNext = &features;
+
+	vkGetPhysicalDeviceFeatures2( physical_device, &features2 );
+
+	if ( !features.drawIndirectCount ) {
+		support->unsupported_reason = "missing drawIndirectCount";
+		return;
+	}
+
+	// NOTE: one draw per bucket covers many objects, and each object's draw carries its index in firstInstance
+	if ( !features2.features.multiDrawIndirect || !features2.features.drawIndirectFirstInstance ) {
+		support->unsupported_reason = "missing multiDrawIndirect / drawIndirectFirstInstance";
+		return;
+	}
+
+	enabled_features->multiDrawIndirect 		   = VK_TRUE;
+	enabled_features->drawIndirectFirstInstance    = VK_TRUE;
+	enabled_vulkan_12_features->drawIndirectCount = VK_TRUE;
+
+	support->supported = true;
+
+	return;
+}
+
+void
+build_gpu_scene_cull_pipeline( Vulkan_Gpu_Scene *scene )
+{
+	Vulkan_Device_Dispatch *dispatch;
+	dispatch = scene->dispatch;
+
+	VkComputePipelineCreateInfo pipeline_create_info = { 0 };
+	pipeline_create_info.sType 		  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipeline_create_info.stage.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipeline_create_info.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipeline_create_info.stage.module = scene->cull_shader->module;
+	pipeline_create_info.stage.pName  = "main";
+	pipeline_create_info.layout 	  = scene->cull_pipeline_layout;
+
+	Vulkan_Pipeline_Creation_Feedback feedback;
+	pipeline_create_info.pNext = begin_pipeline_creation_feedback( scene->pipeline_cache, &feedback, NULL );
+
+	VkPipeline pipeline;
+	VkResult result;
+	result = dispatch->vkCreateComputePipelines( dispatch->logical_device, scene->pipeline_cache->cache, 1, &pipeline_create_info, NULL, &pipeline );
+	end_pipeline_creation_feedback( scene->pipeline_cache, &feedback );
+
+	scene->cull_shader_generation = scene->cull_shader->generation;
+
+	if ( result != VK_SUCCESS ) {
+		// NOTE: a reload that doesn't build keeps the last pipeline that did
+		if ( scene->cull_pipeline != VK_NULL_HANDLE ) {
+			fprintf( stderr, "Unable to rebuild the cull pipeline -- keeping the old one\n" );
+			return;
+		}
+
+		fprintf( stdout, "Unable to create the cull pipeline\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	scene->retired_pipeline = scene->cull_pipeline;
+	scene->cull_pipeline 	= pipeline;
+	scene->count_of_pipeline_builds += 1;
+
+	return;
+}
+
+void
+create_vulkan_gpu_scene( Vulkan_Gpu_Scene *scene, Vulkan_Device_Dispatch *dispatch, Vulkan_Memory_Allocator *memory,
+						 Vulkan_Object_Cache *object_cache, Vulkan_Pipeline_Cache *pipeline_cache, Vulkan_Shader_Cache *shader_cache )
+{
+	scene->enabled 		  = true;
+	scene->dispatch 	  = dispatch;
+	scene->memory 		  = memory;
+	scene->pipeline_cache = pipeline_cache;
+
+	VkDescriptorSetLayoutBinding bindings[5] = { 0 };
+	for ( uint32_t i = 0; i < 5; ++i ) {
+		bindings[i].binding 		= i;
+		bindings[i].descriptorType 	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags 		= VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo set_layout_create_info = { 0 };
+	set_layout_create_info.sType 		= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	set_layout_create_info.bindingCount = 5;
+	set_layout_create_info.pBindings 	= bindings;
+
+	scene->cull_set_layout = get_vulkan_descriptor_layout( object_cache, &set_layout_create_info );
+
+	VkPushConstantRange push_constant_range = { 0 };
+	push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	push_constant_range.size 	   = sizeof (Gpu_Scene_Cull_Constants);
+
+	VkPipelineLayoutCreateInfo pipeline_layout_create_info = { 0 };
+	pipeline_layout_create_info.sType 				   = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipeline_layout_create_info.setLayoutCount 		   = 1;
+	pipeline_layout_create_info.pSetLayouts 		   = &scene->cull_set_layout.layout;
+	pipeline_layout_create_info.pushConstantRangeCount = 1;
+	pipeline_layout_create_info.pPushConstantRanges    = &push_constant_range;
+
+	scene->cull_pipeline_layout = get_vulkan_pipeline_layout( object_cache, &pipeline_layout_create_info );
+
+	scene->cull_shader = get_vulkan_shader( shader_cache, GPU_SCENE_CULL_SHADER );
+	build_gpu_scene_cull_pipeline( scene );
+
+	return;
+}
+
+// Copies in chunks so a big scene doesn't have to fit the staging ring in one piece
+void
+upload_gpu_scene_buffer( Vulkan_Uploader *uploader, VkBuffer buffer, void *data, VkDeviceSize size )
+{
+	uint8_t *bytes;
+	bytes = (uint8_t *)data;
+
+	for ( VkDeviceSize offset = 0; offset < size; offset += GPU_SCENE_UPLOAD_CHUNK_SIZE ) {
+		VkDeviceSize chunk_size;
+		chunk_size = ( size - offset < GPU_SCENE_UPLOAD_CHUNK_SIZE ) ? size - offset : GPU_SCENE_UPLOAD_CHUNK_SIZE;
+
+		upload_to_buffer( uploader, buffer, offset, bytes + offset, chunk_size );
+	}
+
+	return;
+}
+
+// Once, before the first frame that records the scene. Buckets get contiguous draw ranges in bucket order, each
+// as long as the bucket has objects. The first graphics submit after this waits on the upload.
+void
+upload_gpu_scene( Vulkan_Gpu_Scene *scene, Vulkan_Uploader *uploader, Vulkan_Descriptor_Allocator *descriptors, uint32_t count_of_frames,
+				  Gpu_Scene_Object *objects, uint32_t count_of_objects, Gpu_Scene_Mesh *meshes, uint32_t count_of_meshes, uint32_t count_of_buckets )
+{
+	if ( count_of_objects == 0 || count_of_meshes == 0 || count_of_buckets == 0 || count_of_buckets > GPU_SCENE_MAX_BUCKETS ) {
+		fprintf( stdout, "GPU scene needs objects, meshes and 1 to %u buckets\n", GPU_SCENE_MAX_BUCKETS );
+		exit( EXIT_FAILURE );
+	}
+
+	scene->count_of_objects = count_of_objects;
+	scene->count_of_meshes  = count_of_meshes;
+	scene->count_of_buckets = count_of_buckets;
+	scene->count_of_frames  = count_of_frames;
+	scene->min_visible 		= UINT32_MAX;
+
+	memset( scene->buckets, 0, sizeof (scene->buckets) );
+	for ( uint32_t i = 0; i < count_of_objects; ++i ) {
+		if ( objects[i].bucket >= count_of_buckets || objects[i].mesh >= count_of_meshes ) {
+			fprintf( stdout, "GPU scene object %u points at a bucket / mesh that doesn't exist\n", i );
+			exit( EXIT_FAILURE );
+		}
+
+		scene->buckets[objects[i].bucket].max_draws += 1;
+	}
+
+	uint32_t first_draw = 0;
+	for ( uint32_t b = 0; b < count_of_buckets; ++b ) {
+		scene->buckets[b].first_draw = first_draw;
+		first_draw += scene->buckets[b].max_draws;
+	}
+
+	VkDeviceSize objects_size;
+	VkDeviceSize meshes_size;
+	VkDeviceSize buckets_size;
+	VkDeviceSize draws_size;
+	VkDeviceSize counts_size;
+	objects_size = (VkDeviceSize)count_of_objects * sizeof (Gpu_Scene_Object);
+	meshes_size  = (VkDeviceSize)count_of_meshes * sizeof (Gpu_Scene_Mesh);
+	buckets_size = (VkDeviceSize)count_of_buckets * sizeof (Gpu_Scene_Bucket);
+	draws_size 	 = (VkDeviceSize)count_of_objects * sizeof (VkDrawIndexedIndirectCommand);
+	counts_size  = (VkDeviceSize)count_of_buckets * sizeof (uint32_t);
+
+	scene->objects 		 = create_vulkan_buffer( scene->memory, objects_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											     VULKAN_MEMORY_USAGE_GPU_ONLY, &scene->objects_allocation );
+	scene->meshes 		 = create_vulkan_buffer( scene->memory, meshes_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											     VULKAN_MEMORY_USAGE_GPU_ONLY, &scene->meshes_allocation );
+	scene->bucket_ranges = create_vulkan_buffer( scene->memory, buckets_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+											     VULKAN_MEMORY_USAGE_GPU_ONLY, &scene->bucket_ranges_allocation );
+
+	upload_gpu_scene_buffer( uploader, scene->objects, objects, objects_size );
+	upload_gpu_scene_buffer( uploader, scene->meshes, meshes, meshes_size );
+	upload_gpu_scene_buffer( uploader, scene->bucket_ranges, scene->buckets, buckets_size );
+
+	Vulkan_Descriptor_Writer writer;
+	begin_descriptor_writes( &writer, descriptors );
+
+	for ( uint32_t f = 0; f < count_of_frames; ++f ) {
+		Gpu_Scene_Frame *frame;
+		frame = &scene->frames[f];
+
+		frame->draws 	 = create_vulkan_buffer( scene->memory, draws_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+												 VULKAN_MEMORY_USAGE_GPU_ONLY, &frame->draws_allocation );
+		frame->counts 	 = create_vulkan_buffer( scene->memory, counts_size,
+												 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+												 VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+												 VULKAN_MEMORY_USAGE_GPU_ONLY, &frame->counts_allocation );
+		frame->read_back = create_vulkan_buffer( scene->memory, counts_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+												 VULKAN_MEMORY_USAGE_GPU_TO_CPU, &frame->read_back_allocation );
+
+		frame->cull_set = allocate_static_descriptor_set( descriptors, &scene->cull_set_layout );
+		write_descriptor_buffer( &writer, frame->cull_set, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, scene->objects, 0, objects_size );
+		write_descriptor_buffer( &writer, frame->cull_set, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, scene->meshes, 0, meshes_size );
+		write_descriptor_buffer( &writer, frame->cull_set, 2, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, scene->bucket_ranges, 0, buckets_size );
+		write_descriptor_buffer( &writer, frame->cull_set, 3, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame->draws, 0, draws_size );
+		write_descriptor_buffer( &writer, frame->cull_set, 4, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frame->counts, 0, counts_size );
+	}
+
+	flush_descriptor_writes( &writer );
+
+	scene->cull_constants.count_of_objects = count_of_objects;
+	scene->cull_constants.lod_scale 	   = 1.0f;
+
+	return;
+}
+
+// Render thread, before the frame records. yaw 0 / pitch 0 looks down -Z with +Y up; angles in radians.
+// NOTE: the same frustum the CPU culling kernels use, repacked plane by plane for the shader
+void
+set_gpu_scene_camera( Vulkan_Gpu_Scene *scene, float *position, float yaw, float pitch,
+					  float vertical_field_of_view, float aspect_ratio, float near_distance, float far_distance )
+{
+	Frustum frustum;
+	make_camera_frustum( &frustum, vec3( position[0], position[1], position[2] ), yaw, pitch,
+						 vertical_field_of_view, aspect_ratio, near_distance, far_distance );
+
+	Gpu_Scene_Cull_Constants *constants;
+	constants = &scene->cull_constants;
+
+	for ( uint32_t p = 0; p < COUNT_OF_FRUSTUM_PLANES; ++p ) {
+		constants->frustum_planes[p][0] = frustum.normal_x[p];
+		constants->frustum_planes[p][1] = frustum.normal_y[p];
+		constants->frustum_planes[p][2] = frustum.normal_z[p];
+		constants->frustum_planes[p][3] = frustum.distance[p];
+	}
+
+	constants->camera_position[0] = position[0];
+	constants->camera_position[1] = position[1];
+	constants->camera_position[2] = position[2];
+
+	return;
+}
+
+void
+record_gpu_scene_reset_counts( Vulkan_Frame_Target *target, VkCommandBuffer command_buffer, void *data )
+{
+	Vulkan_Gpu_Scene *scene;
+	scene = (Vulkan_Gpu_Scene *)data;
+
+	target->dispatch->vkCmdFillBuffer( command_buffer, scene->frames[target->frame_slot].counts, 0, VK_WHOLE_SIZE, 0 );
+
+	return;
+}
+
+void
+record_gpu_scene_cull( Vulkan_Frame_Target *target, VkCommandBuffer command_buffer, void *data )
+{
+	Vulkan_Gpu_Scene *scene;
+	scene = (Vulkan_Gpu_Scene *)data;
+
+	Vulkan_Device_Dispatch *dispatch;
+	dispatch = target->dispatch;
+
+	dispatch->vkCmdBindPipeline( command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, scene->cull_pipeline );
+	dispatch->vkCmdBindDescriptorSets( command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, scene->cull_pipeline_layout,
+									   0, 1, &scene->frames[target->frame_slot].cull_set, 0, NULL );
+	dispatch->vkCmdPushConstants( command_buffer, scene->cull_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT,
+								  0, sizeof (Gpu_Scene_Cull_Constants), &scene->cull_constants );
+	dispatch->vkCmdDispatch( command_buffer, ( scene->count_of_objects + GPU_SCENE_CULL_GROUP_SIZE - 1 ) / GPU_SCENE_CULL_GROUP_SIZE, 1, 1 );
+
+	return;
+}
+
+void
+record_gpu_scene_read_back( Vulkan_Frame_Target *target, VkCommandBuffer command_buffer, void *data )
+{
+	Vulkan_Gpu_Scene *scene;
+	scene = (Vulkan_Gpu_Scene *)data;
+
+	Gpu_Scene_Frame *frame;
+	frame = &scene->frames[target->frame_slot];
+
+	VkBufferCopy buffer_copy = { 0 };
+	buffer_copy.size = (VkDeviceSize)scene->count_of_buckets * sizeof (uint32_t);
+
+	target->dispatch->vkCmdCopyBuffer( command_buffer, frame->counts, frame->read_back, 1, &buffer_copy );
+
+	// NOTE: the fence alone doesn't make device writes visible to the host
+	VkMemoryBarrier memory_barrier = { 0 };
+	memory_barrier.sType 		 = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memory_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+	target->dispatch->vkCmdPipelineBarrier( command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+											1, &memory_barrier, 0, NULL, 0, NULL );
+
+	frame->read_back_pending = true;
+
+	return;
+}
+
+// The passes that produce the draws -- they go before whatever passes draw the scene
+void
+add_gpu_scene_passes( Vulkan_Gpu_Scene *scene, Frame_Graph *graph )
+{
+	scene->draws_resource  = add_frame_graph_buffer( graph, "gpu_scene_draws", false );
+	scene->counts_resource = add_frame_graph_buffer( graph, "gpu_scene_draw_counts", false );
+
+	uint32_t reset_pass;
+	reset_pass = add_frame_graph_pass( graph, "reset_draw_counts", record_gpu_scene_reset_counts, scene );
+	use_frame_graph_resource( graph, reset_pass, scene->counts_resource, FRAME_GRAPH_USAGE_TRANSFER_WRITE );
+
+	uint32_t cull_pass;
+	cull_pass = add_frame_graph_pass( graph, "cull", record_gpu_scene_cull, scene );
+	use_frame_graph_resource( graph, cull_pass, scene->counts_resource, FRAME_GRAPH_USAGE_COMPUTE_SHADER_READ_WRITE );
+	use_frame_graph_resource( graph, cull_pass, scene->draws_resource, FRAME_GRAPH_USAGE_COMPUTE_SHADER_WRITE );
+
+	uint32_t read_back_pass;
+	read_back_pass = add_frame_graph_pass( graph, "read_back_draw_counts", record_gpu_scene_read_back, scene );
+	use_frame_graph_resource( graph, read_back_pass, scene->counts_resource, FRAME_GRAPH_USAGE_TRANSFER_READ );
+	set_frame_graph_pass_side_effects( graph, read_back_pass );
+
+	return;
+}
+
+// For the pass that calls record_gpu_scene_draws()
+void
+use_gpu_scene_draws( Vulkan_Gpu_Scene *scene, Frame_Graph *graph, uint32_t pass_index )
+{
+	use_frame_graph_resource( graph, pass_index, scene->draws_resource, FRAME_GRAPH_USAGE_INDIRECT_READ );
+	use_frame_graph_resource( graph, pass_index, scene->counts_resource, FRAME_GRAPH_USAGE_INDIRECT_READ );
+
+	return;
+}
+
+void
+bind_gpu_scene_frame( Vulkan_Gpu_Scene *scene, Frame_Graph *graph, uint32_t frame_slot )
+{
+	bind_frame_graph_buffer( graph, scene->draws_resource, scene->frames[frame_slot].draws );
+	bind_frame_graph_buffer( graph, scene->counts_resource, scene->frames[frame_slot].counts );
+
+	return;
+}
+
+// Inside the render pass, with the vertex / index buffers and the objects binding already bound. One draw per
+// bucket, bucket b with bucket_pipelines[b] -- buckets are materials, the pipeline is all that changes.
+void
+record_gpu_scene_draws( Vulkan_Gpu_Scene *scene, VkCommandBuffer command_buffer, uint32_t frame_slot, VkPipeline *bucket_pipelines )
+{
+	Gpu_Scene_Frame *frame;
+	frame = &scene->frames[frame_slot];
+
+	for ( uint32_t b = 0; b < scene->count_of_buckets; ++b ) {
+		if ( scene->buckets[b].max_draws == 0 ) {
+			continue;
+		}
+
+		scene->dispatch->vkCmdBindPipeline( command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bucket_pipelines[b] );
+		scene->dispatch->vkCmdDrawIndexedIndirectCount( command_buffer,
+														frame->draws, (VkDeviceSize)scene->buckets[b].first_draw * sizeof (VkDrawIndexedIndirectCommand),
+														frame->counts, (VkDeviceSize)b * sizeof (uint32_t),
+														scene->buckets[b].max_draws, sizeof (VkDrawIndexedIndirectCommand) );
+	}
+
+	return;
+}
+
+// Frame boundary, render thread. A cull.comp.spv the shader cache swapped in gets a new pipeline; the old one
+// waits until the frames that used it are done. One rebuild in flight at a time -- the next waits for that.
+void
+update_gpu_scene_pipeline( Vulkan_Gpu_Scene *scene, uint64_t last_submitted_frame_number, uint64_t last_completed_frame_number )
+{
+	if ( scene->retired_pipeline != VK_NULL_HANDLE ) {
+		if ( scene->retired_pipeline_frame_number > last_completed_frame_number ) {
+			return;
+		}
+
+		scene->dispatch->vkDestroyPipeline( scene->dispatch->logical_device, scene->retired_pipeline, NULL );
+		scene->retired_pipeline = VK_NULL_HANDLE;
+	}
+
+	if ( scene->cull_shader->generation == scene->cull_shader_generation ) {
+		return;
+	}
+
+	build_gpu_scene_cull_pipeline( scene );
+	scene->retired_pipeline_frame_number = last_submitted_frame_number;
+
+	return;
+}
+
+// Once the slot's fence has signaled -- never stalls
+void
+resolve_gpu_scene_counts( Vulkan_Gpu_Scene *scene, uint32_t frame_slot )
+{
+	Gpu_Scene_Frame *frame;
+	frame = &scene->frames[frame_slot];
+	if ( !frame->read_back_pending ) {
+		return;
+	}
+
+	frame->read_back_pending = false;
+
+	uint32_t *counts;
+	counts = (uint32_t *)frame->read_back_allocation.mapped;
+
+	uint32_t visible = 0;
+	for ( uint32_t b = 0; b < scene->count_of_buckets; ++b ) {
+		scene->last_visible[b] = counts[b];
+		visible += counts[b];
+	}
+
+	scene->count_of_frames_read_back += 1;
+	scene->total_visible 			 += visible;
+	if ( visible < scene->min_visible ) {
+		scene->min_visible = visible;
+	}
+	if ( visible > scene->max_visible ) {
+		scene->max_visible = visible;
+	}
+
+	return;
+}
+
+// NOTE: caller has waited for the device to go idle
+void
+destroy_vulkan_gpu_scene( Vulkan_Gpu_Scene *scene )
+{
+	if ( !scene->enabled ) {
+		return;
+	}
+
+	Vulkan_Device_Dispatch *dispatch;
+	dispatch = scene->dispatch;
+
+	if ( scene->retired_pipeline != VK_NULL_HANDLE ) {
+		dispatch->vkDestroyPipeline( dispatch->logical_device, scene->retired_pipeline, NULL );
+	}
+	dispatch->vkDestroyPipeline( dispatch->logical_device, scene->cull_pipeline, NULL );
+
+	// descriptor sets go with the static pools
+	for ( uint32_t f = 0; f < scene->count_of_frames; ++f ) {
+		destroy_vulkan_buffer( scene->memory, scene->frames[f].draws, &scene->frames[f].draws_allocation );
+		destroy_vulkan_buffer( scene->memory, scene->frames[f].counts, &scene->frames[f].counts_allocation );
+		destroy_vulkan_buffer( scene->memory, scene->frames[f].read_back, &scene->frames[f].read_back_allocation );
+	}
+
+	if ( scene->count_of_objects > 0 ) {
+		destroy_vulkan_buffer( scene->memory, scene->objects, &scene->objects_allocation );
+		destroy_vulkan_buffer( scene->memory, scene->meshes, &scene->meshes_allocation );
+		destroy_vulkan_buffer( scene->memory, scene->bucket_ranges, &scene->bucket_ranges_allocation );
+	}
+
+	scene->enabled = false;
+
+	return;
+}
+
+// Until there's an asset path: count_of_objects spheres scattered through a cube around the origin, spread
+// over the meshes (three LODs each, index ranges made up -- nothing draws them yet) and buckets round robin.
+// Same seed every run so benchmark runs compare.
+void
+generate_gpu_scene_test_content( Gpu_Scene_Object *objects, uint32_t count_of_objects, Gpu_Scene_Mesh *meshes, uint32_t count_of_meshes,
+								 uint32_t count_of_buckets, float extent )
+{
+	uint32_t random_state = 0x9e3779b9;
+
+	for ( uint32_t m = 0; m < count_of_meshes; ++m ) {
+		Gpu_Scene_Mesh *mesh;
+		mesh = &meshes[m];
+		memset( mesh, 0, sizeof (Gpu_Scene_Mesh) );
+
+		mesh->count_of_lods = 3;
+		for ( uint32_t l = 0; l < mesh->count_of_lods; ++l ) {
+			mesh->lods[l].index_count  = 3 * ( 1024 >> ( 2 * l ) );
+			mesh->lods[l].first_index  = m * 4096 + l * 3072;
+			mesh->lods[l].max_distance = extent * 0.25f * (float)( 1 << l );
+		}
+	}
+
+	for ( uint32_t i = 0; i < count_of_objects; ++i ) {
+		Gpu_Scene_Object *object;
+		object = &objects[i];
+		memset( object, 0, sizeof (Gpu_Scene_Object) );
+
+		float random[4];
+		for ( uint32_t r = 0; r < 4; ++r ) {
+			// xorshift32
+			random_state ^= random_state << 13;
+			random_state ^= random_state >> 17;
+			random_state ^= random_state << 5;
+			random[r] = (float)( random_state >> 8 ) / (float)( 1 << 24 );
+		}
+
+		object->center_and_radius[0] = ( random[0] - 0.5f ) * extent;
+		object->center_and_radius[1] = ( random[1] - 0.5f ) * extent;
+		object->center_and_radius[2] = ( random[2] - 0.5f ) * extent;
+		object->center_and_radius[3] = 0.5f + random[3] * 1.5f;
+
+		object->transform[0]  = 1.0f;
+		object->transform[3]  = object->center_and_radius[0];
+		object->transform[5]  = 1.0f;
+		object->transform[7]  = object->center_and_radius[1];
+		object->transform[10] = 1.0f;
+		object->transform[11] = object->center_and_radius[2];
+
+		object->mesh   = i % count_of_meshes;
+		object->bucket = i % count_of_buckets;
+	}
+
+	return;
+}
+
+void
+export_vulkan_gpu_scene_as_json( Vulkan_Gpu_Scene *scene, bool requested, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"requested\": %s,\n", indentation, requested ? "true" : "false" );
+	fprintf( output, "%s  \"enabled\": %s", indentation, scene->enabled ? "true" : "false" );
+
+	if ( requested && !scene->support.supported ) {
+		fprintf( output, ",\n%s  \"unsupported_reason\": \"%s\"\n", indentation, scene->support.unsupported_reason );
+		fprintf( output, "%s}", indentation );
+		return;
+	}
+
+	if ( !scene->enabled ) {
+		fprintf( output, "\n%s}", indentation );
+		return;
+	}
+
+	fprintf( output, ",\n" );
+	fprintf( output, "%s  \"objects\": %u,\n", indentation, scene->count_of_objects );
+	fprintf( output, "%s  \"meshes\": %u,\n", indentation, scene->count_of_meshes );
+	fprintf( output, "%s  \"buckets\": %u,\n", indentation, scene->count_of_buckets );
+	fprintf( output, "%s  \"pipeline_builds\": %u,\n", indentation, scene->count_of_pipeline_builds );
+	fprintf( output, "%s  \"frames_read_back\": %llu,\n", indentation, (unsigned long long)scene->count_of_frames_read_back );
+	fprintf( output, "%s  \"visible_min\": %u,\n", indentation, scene->count_of_frames_read_back ? scene->min_visible : 0 );
+	fprintf( output, "%s  \"visible_avg\": %.1f,\n", indentation,
+			 scene->count_of_frames_read_back ? (double)scene->total_visible / (double)scene->count_of_frames_read_back : 0.0 );
+	fprintf( output, "%s  \"visible_max\": %u,\n", indentation, scene->max_visible );
+	fprintf( output, "%s  \"last_visible_per_bucket\": [", indentation );
+	for ( uint32_t b = 0; b < scene->count_of_buckets; ++b ) {
+		fprintf( output, "%s%u", b ? ", " : "", scene->last_visible[b] );
+	}
+	fprintf( output, "]\n" );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
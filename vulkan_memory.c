@@ -0,0 +1,1137 @@
+// Device memory sub-allocator. Resources never get their own vkAllocateMemory -- they're carved out of
+// large blocks, one set of blocks per memory type, so we stay far below maxMemoryAllocationCount and the
+// driver only sees a handful of allocations.
+//
+//  - memory types are picked by usage (GPU only / upload / readback / staging) from cached memory properties
+//  - general pools sub-allocate with TLSF: two level segregated free lists with bitmaps, so finding a
+//    free range, splitting and merging neighbours on free are all O(1)
+//  - linear pools are a single block with a bump pointer for transient data, reset all at once
+//  - buffers / linear images and optimal images get separate pools when bufferImageGranularity is
+//    bigger than our minimum alignment, so they can never share a page
+//  - host visible blocks stay mapped for their whole lifetime
+//  - block metadata comes from a node pool, and empty blocks are kept around, so once the working set
+//    is warm allocate / free never call malloc or the driver
+//
+// Requests larger than half a block get a dedicated allocation.
+//
+// Unity built -- included by vulkan_renderer.c after the dispatch table, before Vulkan_Context.
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+// NOTE: every offset and size handed out by a TLSF block is a multiple of this, which is also what makes
+// front padding for bigger alignments always large enough to become a free range of its own
+#define VULKAN_MEMORY_MINIMUM_ALIGNMENT_LOG2	8
+#define VULKAN_MEMORY_MINIMUM_ALIGNMENT			( 1ull << VULKAN_MEMORY_MINIMUM_ALIGNMENT_LOG2 )
+
+#define VULKAN_MEMORY_DEFAULT_BLOCK_SIZE		( 64ull * 1024 * 1024 )
+#define VULKAN_MEMORY_SMALL_HEAP_SIZE			( 1024ull * 1024 * 1024 )
+#define VULKAN_MEMORY_NODES_PER_CHUNK			1024
+
+// Second level splits each power of two range into 32 lists. Below TLSF_SMALL_BLOCK_SIZE the first list
+// is linear -- 32 lists of VULKAN_MEMORY_MINIMUM_ALIGNMENT each.
+#define TLSF_SL_LOG2				5
+#define TLSF_SL_COUNT				( 1 << TLSF_SL_LOG2 )
+#define TLSF_SMALL_BLOCK_LOG2		( VULKAN_MEMORY_MINIMUM_ALIGNMENT_LOG2 + TLSF_SL_LOG2 )
+#define TLSF_SMALL_BLOCK_SIZE		( 1ull << TLSF_SMALL_BLOCK_LOG2 )
+#define TLSF_FL_COUNT				32
+
+typedef enum {
+
+	VULKAN_MEMORY_USAGE_GPU_ONLY,			// render targets, static vertex / index data, textures
+	VULKAN_MEMORY_USAGE_CPU_TO_GPU,			// written by the CPU every frame, read by the GPU (uniforms, dynamic vertices)
+	VULKAN_MEMORY_USAGE_GPU_TO_CPU,			// written by the GPU, read back on the CPU
+	VULKAN_MEMORY_USAGE_STAGING,			// upload source -- stays out of device local memory
+	COUNT_OF_VULKAN_MEMORY_USAGES
+
+} Vulkan_Memory_Usage;
+
+typedef enum {
+
+	VULKAN_RESOURCE_LINEAR,					// buffers and VK_IMAGE_TILING_LINEAR images
+	VULKAN_RESOURCE_OPTIMAL,				// VK_IMAGE_TILING_OPTIMAL images
+	COUNT_OF_VULKAN_RESOURCE_KINDS
+
+} Vulkan_Resource_Kind;
+
+typedef enum {
+
+	VULKAN_MEMORY_STRATEGY_TLSF,
+	VULKAN_MEMORY_STRATEGY_LINEAR,
+
+} Vulkan_Memory_Strategy;
+
+// One range of a TLSF block, free or used. Neighbours in memory are linked (physical) so a free can merge
+// in O(1), free ranges are also on their size class list. Two free ranges are never next to each other.
+typedef struct Vulkan_Memory_Node {
+
+	VkDeviceSize				offset;
+	VkDeviceSize				size;
+	struct Vulkan_Memory_Node	*previous_physical;
+	struct Vulkan_Memory_Node	*next_physical;
+	struct Vulkan_Memory_Node	*previous_free;
+	struct Vulkan_Memory_Node	*next_free;			// also links unused nodes in the node pool
+	bool						is_free;
+
+} Vulkan_Memory_Node;
+
+typedef struct {
+
+	VkDeviceMemory		memory;
+	VkDeviceSize		size;
+	void				*mapped;				// NULL -- not host visible
+
+	uint32_t			count_of_allocations;
+	VkDeviceSize		bytes_used;
+
+	// TLSF
+	Vulkan_Memory_Node	*first_node;
+	uint32_t			fl_bitmap;
+	uint32_t			sl_bitmap[TLSF_FL_COUNT];
+	Vulkan_Memory_Node	*free_lists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+	// LINEAR
+	VkDeviceSize		linear_offset;
+
+} Vulkan_Memory_Block;
+
+typedef struct {
+
+	Vulkan_Memory_Strategy	strategy;
+	uint32_t				memory_type_index;
+	VkDeviceSize			block_size;
+	Vulkan_Memory_Block		**blocks;
+	uint32_t				count_of_blocks;
+	uint32_t				capacity_of_blocks;
+
+} Vulkan_Memory_Pool;
+
+typedef struct {
+
+	VkDeviceMemory		memory;
+	VkDeviceSize		offset;
+	VkDeviceSize		size;
+	void				*mapped;				// NULL -- not host visible
+	uint32_t			memory_type_index;
+
+	Vulkan_Memory_Pool	*pool;					// NULL -- dedicated allocation
+	Vulkan_Memory_Block	*block;
+	Vulkan_Memory_Node	*node;					// NULL -- linear or dedicated
+
+} Vulkan_Allocation;
+
+typedef struct {
+
+	uint32_t		count_of_blocks;
+	uint32_t		count_of_allocations;
+	uint32_t		count_of_dedicated_allocations;
+	uint32_t		count_of_free_ranges;
+	VkDeviceSize	bytes_reserved;				// blocks + dedicated allocations
+	VkDeviceSize	bytes_used;
+	VkDeviceSize	bytes_free;
+	VkDeviceSize	largest_free_range;
+	double			fragmentation;				// 0 -- all free space in one range, towards 1 -- scattered
+
+} Vulkan_Memory_Statistics;
+
+typedef struct {
+
+	Vulkan_Device_Dispatch				*dispatch;
+	VkPhysicalDeviceMemoryProperties	memory_properties;
+	VkDeviceSize						buffer_image_granularity;
+	bool								separate_optimal_resources;
+	uint32_t							max_memory_allocation_count;
+	uint32_t							count_of_device_memory_objects;
+
+	Vulkan_Memory_Pool					pools[VK_MAX_MEMORY_TYPES][COUNT_OF_VULKAN_RESOURCE_KINDS];
+
+	uint32_t							count_of_dedicated_allocations[VK_MAX_MEMORY_TYPES];
+	VkDeviceSize						dedicated_bytes[VK_MAX_MEMORY_TYPES];
+
+	Vulkan_Memory_Node					*free_nodes;
+	Vulkan_Memory_Node					**node_chunks;
+	uint32_t							count_of_node_chunks;
+
+	uint64_t							count_of_allocate_calls;
+	uint64_t							count_of_free_calls;
+
+} Vulkan_Memory_Allocator;
+
+
+uint32_t
+find_lowest_set_bit( uint32_t value )
+{
+#if defined( _MSC_VER )
+	unsigned long index;
+	_BitScanForward( &index, value );
+	return (uint32_t)index;
+#else
+	return (uint32_t)__builtin_ctz( value );
+#endif
+}
+
+uint32_t
+find_highest_set_bit_64( uint64_t value )
+{
+#if defined( _MSC_VER )
+	unsigned long index;
+	_BitScanReverse64( &index, value );
+	return (uint32_t)index;
+#else
+	return 63 - (uint32_t)__builtin_clzll( value );
+#endif
+}
+
+uint32_t
+count_set_bits( uint32_t value )
+{
+#if defined( _MSC_VER )
+	return (uint32_t)__popcnt( value );
+#else
+	return (uint32_t)__builtin_popcount( value );
+#endif
+}
+
+VkDeviceSize
+align_device_size( VkDeviceSize size, VkDeviceSize alignment )
+{
+	return ( size + alignment - 1 ) & ~( alignment - 1 );
+}
+
+Vulkan_Memory_Node *
+get_vulkan_memory_node( Vulkan_Memory_Allocator *allocator )
+{
+	if ( !allocator->free_nodes ) {
+		Vulkan_Memory_Node *chunk;
+		chunk = (Vulkan_Memory_Node *)malloc( VULKAN_MEMORY_NODES_PER_CHUNK * sizeof (Vulkan_Memory_Node) );
+
+		Vulkan_Memory_Node **node_chunks;
+		node_chunks = (Vulkan_Memory_Node **)realloc( allocator->node_chunks, ( allocator->count_of_node_chunks + 1 ) * sizeof (Vulkan_Memory_Node *) );
+		if ( !chunk || !node_chunks ) {
+			fprintf( stdout, "Unable to allocate space for memory allocator nodes\n" );
+			exit( EXIT_FAILURE );
+		}
+
+		allocator->node_chunks = node_chunks;
+		allocator->node_chunks[allocator->count_of_node_chunks++] = chunk;
+
+		for ( uint32_t i = 0; i < VULKAN_MEMORY_NODES_PER_CHUNK; ++i ) {
+			chunk[i].next_free = ( i + 1 < VULKAN_MEMORY_NODES_PER_CHUNK ) ? &chunk[i + 1] : NULL;
+		}
+		allocator->free_nodes = chunk;
+	}
+
+	Vulkan_Memory_Node *node;
+	node = allocator->free_nodes;
+	allocator->free_nodes = node->next_free;
+
+	memset( node, 0, sizeof (Vulkan_Memory_Node) );
+
+	return node;
+}
+
+void
+release_vulkan_memory_node( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Node *node )
+{
+	node->next_free = allocator->free_nodes;
+	allocator->free_nodes = node;
+
+	return;
+}
+
+void
+tlsf_mapping_insert( VkDeviceSize size, uint32_t *fl, uint32_t *sl )
+{
+	if ( size < TLSF_SMALL_BLOCK_SIZE ) {
+		*fl = 0;
+		*sl = (uint32_t)( size >> VULKAN_MEMORY_MINIMUM_ALIGNMENT_LOG2 );
+		return;
+	}
+
+	uint32_t highest_bit;
+	highest_bit = find_highest_set_bit_64( size );
+
+	*fl = highest_bit - TLSF_SMALL_BLOCK_LOG2 + 1;
+	*sl = (uint32_t)( size >> ( highest_bit - TLSF_SL_LOG2 ) ) ^ TLSF_SL_COUNT;
+
+	return;
+}
+
+// NOTE: rounds up to the next list boundary so any range on the list we land on is big enough
+void
+tlsf_mapping_search( VkDeviceSize size, uint32_t *fl, uint32_t *sl )
+{
+	if ( size >= TLSF_SMALL_BLOCK_SIZE ) {
+		size += ( 1ull << ( find_highest_set_bit_64( size ) - TLSF_SL_LOG2 ) ) - 1;
+	}
+
+	tlsf_mapping_insert( size, fl, sl );
+
+	return;
+}
+
+void
+tlsf_insert_free_node( Vulkan_Memory_Block *block, Vulkan_Memory_Node *node )
+{
+	uint32_t fl;
+	uint32_t sl;
+	tlsf_mapping_insert( node->size, &fl, &sl );
+
+	node->is_free 		= true;
+	node->previous_free = NULL;
+	node->next_free 	= block->free_lists[fl][sl];
+	if ( node->next_free ) {
+		node->next_free->previous_free = node;
+	}
+
+	block->free_lists[fl][sl] = node;
+	block->fl_bitmap 	 |= 1u << fl;
+	block->sl_bitmap[fl] |= 1u << sl;
+
+	return;
+}
+
+void
+tlsf_remove_free_node( Vulkan_Memory_Block *block, Vulkan_Memory_Node *node )
+{
+	uint32_t fl;
+	uint32_t sl;
+	tlsf_mapping_insert( node->size, &fl, &sl );
+
+	if ( node->previous_free ) {
+		node->previous_free->next_free = node->next_free;
+	}
+	else {
+		block->free_lists[fl][sl] = node->next_free;
+	}
+
+	if ( node->next_free ) {
+		node->next_free->previous_free = node->previous_free;
+	}
+
+	if ( !block->free_lists[fl][sl] ) {
+		block->sl_bitmap[fl] &= ~( 1u << sl );
+		if ( block->sl_bitmap[fl] == 0 ) {
+			block->fl_bitmap &= ~( 1u << fl );
+		}
+	}
+
+	node->is_free 		= false;
+	node->previous_free = NULL;
+	node->next_free 	= NULL;
+
+	return;
+}
+
+Vulkan_Memory_Node *
+tlsf_find_free_node( Vulkan_Memory_Block *block, VkDeviceSize size )
+{
+	uint32_t fl;
+	uint32_t sl;
+	tlsf_mapping_search( size, &fl, &sl );
+	if ( fl >= TLSF_FL_COUNT ) {
+		return NULL;
+	}
+
+	uint32_t sl_map;
+	sl_map = block->sl_bitmap[fl] & ( ~0u << sl );
+	if ( sl_map == 0 ) {
+		if ( fl + 1 >= TLSF_FL_COUNT ) {
+			return NULL;
+		}
+
+		uint32_t fl_map;
+		fl_map = block->fl_bitmap & ( ~0u << ( fl + 1 ) );
+		if ( fl_map == 0 ) {
+			return NULL;
+		}
+
+		fl 	   = find_lowest_set_bit( fl_map );
+		sl_map = block->sl_bitmap[fl];
+	}
+
+	sl = find_lowest_set_bit( sl_map );
+
+	return block->free_lists[fl][sl];
+}
+
+// Splits [node->offset + size, end) off into a new free range after node
+void
+tlsf_split_node_back( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Block *block, Vulkan_Memory_Node *node, VkDeviceSize size )
+{
+	Vulkan_Memory_Node *remainder;
+	remainder = get_vulkan_memory_node( allocator );
+	remainder->offset 			 = node->offset + size;
+	remainder->size   			 = node->size - size;
+	remainder->previous_physical = node;
+	remainder->next_physical 	 = node->next_physical;
+
+	if ( node->next_physical ) {
+		node->next_physical->previous_physical = remainder;
+	}
+
+	node->next_physical = remainder;
+	node->size 			= size;
+
+	tlsf_insert_free_node( block, remainder );
+
+	return;
+}
+
+// Splits [node->offset, node->offset + padding) off into a new free range before node
+void
+tlsf_split_node_front( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Block *block, Vulkan_Memory_Node *node, VkDeviceSize padding )
+{
+	Vulkan_Memory_Node *front;
+	front = get_vulkan_memory_node( allocator );
+	front->offset 			 = node->offset;
+	front->size   			 = padding;
+	front->previous_physical = node->previous_physical;
+	front->next_physical 	 = node;
+
+	if ( node->previous_physical ) {
+		node->previous_physical->next_physical = front;
+	}
+	else {
+		block->first_node = front;
+	}
+
+	node->previous_physical = front;
+	node->offset 		   += padding;
+	node->size 			   -= padding;
+
+	tlsf_insert_free_node( block, front );
+
+	return;
+}
+
+// NOTE: size is already a multiple of VULKAN_MEMORY_MINIMUM_ALIGNMENT
+Vulkan_Memory_Node *
+allocate_from_tlsf_block( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Block *block, VkDeviceSize size, VkDeviceSize alignment )
+{
+	// worst case padding -- ranges already start on a VULKAN_MEMORY_MINIMUM_ALIGNMENT boundary
+	VkDeviceSize search_size;
+	search_size = size;
+	if ( alignment > VULKAN_MEMORY_MINIMUM_ALIGNMENT ) {
+		search_size += alignment - VULKAN_MEMORY_MINIMUM_ALIGNMENT;
+	}
+
+	Vulkan_Memory_Node *node;
+	node = tlsf_find_free_node( block, search_size );
+	if ( !node ) {
+		return NULL;
+	}
+
+	tlsf_remove_free_node( block, node );
+
+	VkDeviceSize padding;
+	padding = align_device_size( node->offset, alignment ) - node->offset;
+	if ( padding > 0 ) {
+		tlsf_split_node_front( allocator, block, node, padding );
+	}
+
+	if ( node->size > size ) {
+		tlsf_split_node_back( allocator, block, node, size );
+	}
+
+	return node;
+}
+
+void
+free_to_tlsf_block( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Block *block, Vulkan_Memory_Node *node )
+{
+	Vulkan_Memory_Node *previous;
+	previous = node->previous_physical;
+	if ( previous && previous->is_free ) {
+		tlsf_remove_free_node( block, previous );
+
+		previous->size 		   += node->size;
+		previous->next_physical = node->next_physical;
+		if ( node->next_physical ) {
+			node->next_physical->previous_physical = previous;
+		}
+
+		release_vulkan_memory_node( allocator, node );
+		node = previous;
+	}
+
+	Vulkan_Memory_Node *next;
+	next = node->next_physical;
+	if ( next && next->is_free ) {
+		tlsf_remove_free_node( block, next );
+
+		node->size 		   += next->size;
+		node->next_physical = next->next_physical;
+		if ( next->next_physical ) {
+			next->next_physical->previous_physical = node;
+		}
+
+		release_vulkan_memory_node( allocator, next );
+	}
+
+	tlsf_insert_free_node( block, node );
+
+	return;
+}
+
+VkDeviceSize
+allocate_from_linear_block( Vulkan_Memory_Block *block, VkDeviceSize size, VkDeviceSize alignment, bool *success )
+{
+	VkDeviceSize offset;
+	offset = align_device_size( block->linear_offset, alignment );
+
+	*success = ( offset + size <= block->size );
+	if ( *success ) {
+		block->linear_offset = offset + size;
+	}
+
+	return offset;
+}
+
+bool
+memory_type_is_host_visible( Vulkan_Memory_Allocator *allocator, uint32_t memory_type_index )
+{
+	return ( allocator->memory_properties.memoryTypes[memory_type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ) != 0;
+}
+
+// NOTE: one of the few places the allocator talks to the driver -- new blocks and dedicated allocations only
+VkDeviceMemory
+allocate_vulkan_device_memory( Vulkan_Memory_Allocator *allocator, uint32_t memory_type_index, VkDeviceSize size, void **mapped )
+{
+	*mapped = NULL;
+
+	if ( allocator->count_of_device_memory_objects >= allocator->max_memory_allocation_count ) {
+		fprintf( stderr, "Reached maxMemoryAllocationCount (%u)\n", allocator->max_memory_allocation_count );
+		return VK_NULL_HANDLE;
+	}
+
+	VkMemoryAllocateInfo memory_allocate_info = { 0 };
+	memory_allocate_info.sType 			 = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memory_allocate_info.allocationSize  = size;
+	memory_allocate_info.memoryTypeIndex = memory_type_index;
+
+	VkResult result;
+	VkDeviceMemory memory;
+	result = allocator->dispatch->vkAllocateMemory( allocator->dispatch->logical_device, &memory_allocate_info, NULL, &memory );
+	if ( result != VK_SUCCESS ) {
+		return VK_NULL_HANDLE;
+	}
+
+	if ( memory_type_is_host_visible( allocator, memory_type_index ) ) {
+		result = allocator->dispatch->vkMapMemory( allocator->dispatch->logical_device, memory, 0, VK_WHOLE_SIZE, 0, mapped );
+		if ( result != VK_SUCCESS ) {
+			fprintf( stdout, "Unable to map host visible device memory\n" );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	allocator->count_of_device_memory_objects += 1;
+
+	return memory;
+}
+
+void
+free_vulkan_device_memory( Vulkan_Memory_Allocator *allocator, VkDeviceMemory memory )
+{
+	// vkFreeMemory unmaps implicitly
+	allocator->dispatch->vkFreeMemory( allocator->dispatch->logical_device, memory, NULL );
+	allocator->count_of_device_memory_objects -= 1;
+
+	return;
+}
+
+// Falls back to smaller blocks when the heap can't fit a full one, but never below minimum_size
+Vulkan_Memory_Block *
+create_vulkan_memory_block( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Pool *pool, VkDeviceSize minimum_size )
+{
+	VkDeviceSize block_size;
+	block_size = pool->block_size;
+
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	void *mapped 		  = NULL;
+	while ( block_size >= minimum_size ) {
+		memory = allocate_vulkan_device_memory( allocator, pool->memory_type_index, block_size, &mapped );
+		if ( memory != VK_NULL_HANDLE || pool->strategy == VULKAN_MEMORY_STRATEGY_LINEAR ) {
+			break;
+		}
+
+		block_size /= 2;
+	}
+
+	if ( memory == VK_NULL_HANDLE ) {
+		return NULL;
+	}
+
+	Vulkan_Memory_Block *block;
+	block = (Vulkan_Memory_Block *)calloc( 1, sizeof (Vulkan_Memory_Block) );
+	if ( !block ) {
+		fprintf( stdout, "Unable to allocate space for a memory block\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( pool->count_of_blocks == pool->capacity_of_blocks ) {
+		uint32_t capacity_of_blocks;
+		capacity_of_blocks = ( pool->capacity_of_blocks == 0 ) ? 4 : pool->capacity_of_blocks * 2;
+
+		Vulkan_Memory_Block **blocks;
+		blocks = (Vulkan_Memory_Block **)realloc( pool->blocks, capacity_of_blocks * sizeof (Vulkan_Memory_Block *) );
+		if ( !blocks ) {
+			fprintf( stdout, "Unable to allocate space for memory blocks\n" );
+			exit( EXIT_FAILURE );
+		}
+
+		pool->blocks 			 = blocks;
+		pool->capacity_of_blocks = capacity_of_blocks;
+	}
+
+	block->memory = memory;
+	block->size   = block_size;
+	block->mapped = mapped;
+
+	if ( pool->strategy == VULKAN_MEMORY_STRATEGY_TLSF ) {
+		Vulkan_Memory_Node *node;
+		node = get_vulkan_memory_node( allocator );
+		node->offset = 0;
+		node->size 	 = block_size;
+
+		block->first_node = node;
+		tlsf_insert_free_node( block, node );
+	}
+
+	pool->blocks[pool->count_of_blocks++] = block;
+
+	return block;
+}
+
+void
+destroy_vulkan_memory_pool( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Pool *pool )
+{
+	for ( uint32_t i = 0; i < pool->count_of_blocks; ++i ) {
+		free_vulkan_device_memory( allocator, pool->blocks[i]->memory );
+		free( pool->blocks[i] );
+	}
+
+	free( pool->blocks );
+	pool->blocks 			 = NULL;
+	pool->count_of_blocks 	 = 0;
+	pool->capacity_of_blocks = 0;
+
+	return;
+}
+
+VkDeviceSize
+select_vulkan_memory_block_size( Vulkan_Memory_Allocator *allocator, uint32_t memory_type_index )
+{
+	uint32_t heap_index;
+	heap_index = allocator->memory_properties.memoryTypes[memory_type_index].heapIndex;
+
+	VkDeviceSize heap_size;
+	heap_size = allocator->memory_properties.memoryHeaps[heap_index].size;
+
+	// small heaps (e.g. the 256 MB host visible device local one) get eighths so one block can't take it all
+	if ( heap_size <= VULKAN_MEMORY_SMALL_HEAP_SIZE ) {
+		return ( heap_size / 8 ) & ~( VULKAN_MEMORY_MINIMUM_ALIGNMENT - 1 );
+	}
+
+	return VULKAN_MEMORY_DEFAULT_BLOCK_SIZE;
+}
+
+void
+create_vulkan_memory_allocator( Vulkan_Memory_Allocator *allocator, Vulkan_Device_Dispatch *dispatch, VkPhysicalDevice physical_device )
+{
+	memset( allocator, 0, sizeof (Vulkan_Memory_Allocator) );
+	allocator->dispatch = dispatch;
+
+	vkGetPhysicalDeviceMemoryProperties( physical_device, &allocator->memory_properties );
+
+	VkPhysicalDeviceProperties device_properties;
+	vkGetPhysicalDeviceProperties( physical_device, &device_properties );
+
+	allocator->buffer_image_granularity    = device_properties.limits.bufferImageGranularity;
+	allocator->max_memory_allocation_count = device_properties.limits.maxMemoryAllocationCount;
+
+	// NOTE: ranges are VULKAN_MEMORY_MINIMUM_ALIGNMENT aligned, so a granularity up to that is already respected
+	allocator->separate_optimal_resources = ( allocator->buffer_image_granularity > VULKAN_MEMORY_MINIMUM_ALIGNMENT );
+
+	for ( uint32_t type = 0; type < allocator->memory_properties.memoryTypeCount; ++type ) {
+		for ( uint32_t kind = 0; kind < COUNT_OF_VULKAN_RESOURCE_KINDS; ++kind ) {
+			Vulkan_Memory_Pool *pool;
+			pool = &allocator->pools[type][kind];
+			pool->strategy 			= VULKAN_MEMORY_STRATEGY_TLSF;
+			pool->memory_type_index = type;
+			pool->block_size 		= select_vulkan_memory_block_size( allocator, type );
+		}
+	}
+
+	return;
+}
+
+// NOTE: every allocation must have been freed (dedicated ones included), the blocks go regardless
+void
+destroy_vulkan_memory_allocator( Vulkan_Memory_Allocator *allocator )
+{
+	for ( uint32_t type = 0; type < allocator->memory_properties.memoryTypeCount; ++type ) {
+		for ( uint32_t kind = 0; kind < COUNT_OF_VULKAN_RESOURCE_KINDS; ++kind ) {
+			destroy_vulkan_memory_pool( allocator, &allocator->pools[type][kind] );
+		}
+	}
+
+	for ( uint32_t i = 0; i < allocator->count_of_node_chunks; ++i ) {
+		free( allocator->node_chunks[i] );
+	}
+	free( allocator->node_chunks );
+
+	allocator->node_chunks 			= NULL;
+	allocator->count_of_node_chunks = 0;
+	allocator->free_nodes 			= NULL;
+
+	return;
+}
+
+// Picks the type with all the required flags and as many preferred (and as few avoided) ones as possible.
+// Returns UINT32_MAX when nothing in memory_type_bits qualifies.
+uint32_t
+find_vulkan_memory_type( Vulkan_Memory_Allocator *allocator, uint32_t memory_type_bits, Vulkan_Memory_Usage usage )
+{
+	VkMemoryPropertyFlags required  = 0;
+	VkMemoryPropertyFlags preferred = 0;
+	VkMemoryPropertyFlags avoided   = 0;
+
+	switch ( usage ) {
+		case VULKAN_MEMORY_USAGE_GPU_ONLY: {
+			preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+			avoided   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		} break;
+
+		// NOTE: everything host visible is required to be coherent so nobody has to remember to flush
+		case VULKAN_MEMORY_USAGE_CPU_TO_GPU: {
+			required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		} break;
+
+		case VULKAN_MEMORY_USAGE_GPU_TO_CPU: {
+			required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+		} break;
+
+		case VULKAN_MEMORY_USAGE_STAGING: {
+			required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			avoided   = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		} break;
+
+		default: {
+		} break;
+	}
+
+	uint32_t best_type  = UINT32_MAX;
+	int32_t  best_score = INT32_MIN;
+
+	for ( uint32_t type = 0; type < allocator->memory_properties.memoryTypeCount; ++type ) {
+		if ( !( memory_type_bits & ( 1u << type ) ) ) {
+			continue;
+		}
+
+		VkMemoryPropertyFlags flags;
+		flags = allocator->memory_properties.memoryTypes[type].propertyFlags;
+		if ( ( flags & required ) != required ) {
+			continue;
+		}
+
+		int32_t score;
+		score = (int32_t)count_set_bits( flags & preferred ) - (int32_t)count_set_bits( flags & avoided );
+		if ( score > best_score ) {
+			best_score = score;
+			best_type  = type;
+		}
+	}
+
+	return best_type;
+}
+
+Vulkan_Allocation
+allocate_dedicated_vulkan_memory( Vulkan_Memory_Allocator *allocator, uint32_t memory_type_index, VkDeviceSize size )
+{
+	Vulkan_Allocation allocation = { 0 };
+
+	allocation.memory = allocate_vulkan_device_memory( allocator, memory_type_index, size, &allocation.mapped );
+	if ( allocation.memory == VK_NULL_HANDLE ) {
+		return allocation;
+	}
+
+	allocation.size 			 = size;
+	allocation.memory_type_index = memory_type_index;
+
+	allocator->count_of_dedicated_allocations[memory_type_index] += 1;
+	allocator->dedicated_bytes[memory_type_index] 				 += size;
+
+	return allocation;
+}
+
+// Allocates from an existing block if any has room, otherwise adds a block. memory == VK_NULL_HANDLE on failure.
+Vulkan_Allocation
+allocate_vulkan_memory_from_pool( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Pool *pool, VkMemoryRequirements *memory_requirements )
+{
+	Vulkan_Allocation allocation = { 0 };
+
+	VkDeviceSize alignment;
+	alignment = memory_requirements->alignment;
+
+	VkDeviceSize size;
+	size = memory_requirements->size;
+
+	if ( pool->strategy == VULKAN_MEMORY_STRATEGY_TLSF ) {
+		if ( alignment < VULKAN_MEMORY_MINIMUM_ALIGNMENT ) {
+			alignment = VULKAN_MEMORY_MINIMUM_ALIGNMENT;
+		}
+		size = align_device_size( size, VULKAN_MEMORY_MINIMUM_ALIGNMENT );
+	}
+
+	for ( uint32_t i = 0; i <= pool->count_of_blocks; ++i ) {
+		Vulkan_Memory_Block *block;
+		if ( i < pool->count_of_blocks ) {
+			block = pool->blocks[i];
+		}
+		else {
+			// linear pools never grow -- they're reset, not refilled
+			if ( pool->strategy == VULKAN_MEMORY_STRATEGY_LINEAR && pool->count_of_blocks > 0 ) {
+				break;
+			}
+
+			block = create_vulkan_memory_block( allocator, pool, size + alignment );
+			if ( !block ) {
+				break;
+			}
+		}
+
+		if ( pool->strategy == VULKAN_MEMORY_STRATEGY_TLSF ) {
+			Vulkan_Memory_Node *node;
+			node = allocate_from_tlsf_block( allocator, block, size, alignment );
+			if ( !node ) {
+				continue;
+			}
+
+			allocation.offset = node->offset;
+			allocation.node   = node;
+		}
+		else {
+			bool success;
+			allocation.offset = allocate_from_linear_block( block, size, alignment, &success );
+			if ( !success ) {
+				continue;
+			}
+		}
+
+		allocation.memory 			 = block->memory;
+		allocation.size 			 = size;
+		allocation.mapped 			 = block->mapped ? (uint8_t *)block->mapped + allocation.offset : NULL;
+		allocation.memory_type_index = pool->memory_type_index;
+		allocation.pool 			 = pool;
+		allocation.block 			 = block;
+
+		block->count_of_allocations += 1;
+		block->bytes_used 			+= size;
+		allocator->count_of_allocate_calls += 1;
+
+		return allocation;
+	}
+
+	return allocation;
+}
+
+Vulkan_Allocation
+allocate_vulkan_memory( Vulkan_Memory_Allocator *allocator, VkMemoryRequirements *memory_requirements,
+						Vulkan_Memory_Usage usage, Vulkan_Resource_Kind kind )
+{
+	uint32_t memory_type_index;
+	memory_type_index = find_vulkan_memory_type( allocator, memory_requirements->memoryTypeBits, usage );
+	if ( memory_type_index == UINT32_MAX ) {
+		fprintf( stdout, "No memory type fits the resource and the requested usage\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( !allocator->separate_optimal_resources ) {
+		kind = VULKAN_RESOURCE_LINEAR;
+	}
+
+	Vulkan_Memory_Pool *pool;
+	pool = &allocator->pools[memory_type_index][kind];
+
+	Vulkan_Allocation allocation;
+	if ( memory_requirements->size > pool->block_size / 2 ) {
+		allocation = allocate_dedicated_vulkan_memory( allocator, memory_type_index, memory_requirements->size );
+	}
+	else {
+		allocation = allocate_vulkan_memory_from_pool( allocator, pool, memory_requirements );
+	}
+
+	if ( allocation.memory == VK_NULL_HANDLE ) {
+		fprintf( stdout, "Unable to allocate %llu bytes of device memory\n", (unsigned long long)memory_requirements->size );
+		exit( EXIT_FAILURE );
+	}
+
+	return allocation;
+}
+
+// NOTE: empty blocks are kept -- trim_vulkan_memory_pools() hands them back to the driver
+void
+free_vulkan_memory( Vulkan_Memory_Allocator *allocator, Vulkan_Allocation *allocation )
+{
+	if ( allocation->memory == VK_NULL_HANDLE ) {
+		return;
+	}
+
+	if ( !allocation->pool ) {
+		free_vulkan_device_memory( allocator, allocation->memory );
+		allocator->count_of_dedicated_allocations[allocation->memory_type_index] -= 1;
+		allocator->dedicated_bytes[allocation->memory_type_index] 				 -= allocation->size;
+	}
+	else {
+		Vulkan_Memory_Block *block;
+		block = allocation->block;
+
+		if ( allocation->node ) {
+			free_to_tlsf_block( allocator, block, allocation->node );
+		}
+
+		block->count_of_allocations -= 1;
+		block->bytes_used 			-= allocation->size;
+
+		// the bump pointer can only go back once everything in the block is gone
+		if ( allocation->pool->strategy == VULKAN_MEMORY_STRATEGY_LINEAR && block->count_of_allocations == 0 ) {
+			block->linear_offset = 0;
+		}
+
+		allocator->count_of_free_calls += 1;
+	}
+
+	memset( allocation, 0, sizeof (Vulkan_Allocation) );
+
+	return;
+}
+
+// A pool with a single block of block_size bytes and a bump pointer. Allocations fail once it's full.
+void
+create_vulkan_linear_memory_pool( Vulkan_Memory_Allocator *allocator, Vulkan_Memory_Pool *pool, uint32_t memory_type_index, VkDeviceSize block_size )
+{
+	memset( pool, 0, sizeof (Vulkan_Memory_Pool) );
+	pool->strategy 			= VULKAN_MEMORY_STRATEGY_LINEAR;
+	pool->memory_type_index = memory_type_index;
+	pool->block_size 		= block_size;
+
+	if ( !create_vulkan_memory_block( allocator, pool, block_size ) ) {
+		fprintf( stdout, "Unable to allocate a %llu byte linear memory pool\n", (unsigned long long)block_size );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+// NOTE: drops everything at once -- the caller guarantees the GPU is done with all of it
+void
+reset_vulkan_linear_memory_pool( Vulkan_Memory_Pool *pool )
+{
+	for ( uint32_t i = 0; i < pool->count_of_blocks; ++i ) {
+		pool->blocks[i]->linear_offset 		  = 0;
+		pool->blocks[i]->count_of_allocations = 0;
+		pool->blocks[i]->bytes_used 		  = 0;
+	}
+
+	return;
+}
+
+// Gives empty blocks back to the driver -- for after a level unload, not every frame
+void
+trim_vulkan_memory_pools( Vulkan_Memory_Allocator *allocator )
+{
+	for ( uint32_t type = 0; type < allocator->memory_properties.memoryTypeCount; ++type ) {
+		for ( uint32_t kind = 0; kind < COUNT_OF_VULKAN_RESOURCE_KINDS; ++kind ) {
+			Vulkan_Memory_Pool *pool;
+			pool = &allocator->pools[type][kind];
+
+			uint32_t count_of_remaining = 0;
+			for ( uint32_t i = 0; i < pool->count_of_blocks; ++i ) {
+				Vulkan_Memory_Block *block;
+				block = pool->blocks[i];
+
+				if ( block->count_of_allocations == 0 ) {
+					release_vulkan_memory_node( allocator, block->first_node );
+					free_vulkan_device_memory( allocator, block->memory );
+					free( block );
+					continue;
+				}
+
+				pool->blocks[count_of_remaining++] = block;
+			}
+
+			pool->count_of_blocks = count_of_remaining;
+		}
+	}
+
+	return;
+}
+
+void
+accumulate_vulkan_memory_pool_statistics( Vulkan_Memory_Pool *pool, Vulkan_Memory_Statistics *statistics )
+{
+	for ( uint32_t i = 0; i < pool->count_of_blocks; ++i ) {
+		Vulkan_Memory_Block *block;
+		block = pool->blocks[i];
+
+		statistics->count_of_blocks 	 += 1;
+		statistics->count_of_allocations += block->count_of_allocations;
+		statistics->bytes_reserved 		 += block->size;
+		statistics->bytes_used 			 += block->bytes_used;
+
+		if ( pool->strategy == VULKAN_MEMORY_STRATEGY_LINEAR ) {
+			VkDeviceSize tail;
+			tail = block->size - block->linear_offset;
+
+			statistics->bytes_free 			 += tail;
+			statistics->count_of_free_ranges += ( tail > 0 );
+			if ( tail > statistics->largest_free_range ) {
+				statistics->largest_free_range = tail;
+			}
+			continue;
+		}
+
+		for ( Vulkan_Memory_Node *node = block->first_node; node; node = node->next_physical ) {
+			if ( !node->is_free ) {
+				continue;
+			}
+
+			statistics->bytes_free 			 += node->size;
+			statistics->count_of_free_ranges += 1;
+			if ( node->size > statistics->largest_free_range ) {
+				statistics->largest_free_range = node->size;
+			}
+		}
+	}
+
+	return;
+}
+
+// Walks every block -- reporting only, not for the hot path
+Vulkan_Memory_Statistics
+compute_vulkan_memory_statistics( Vulkan_Memory_Allocator *allocator )
+{
+	Vulkan_Memory_Statistics statistics = { 0 };
+
+	for ( uint32_t type = 0; type < allocator->memory_properties.memoryTypeCount; ++type ) {
+		for ( uint32_t kind = 0; kind < COUNT_OF_VULKAN_RESOURCE_KINDS; ++kind ) {
+			accumulate_vulkan_memory_pool_statistics( &allocator->pools[type][kind], &statistics );
+		}
+
+		statistics.count_of_dedicated_allocations += allocator->count_of_dedicated_allocations[type];
+		statistics.count_of_allocations 		  += allocator->count_of_dedicated_allocations[type];
+		statistics.bytes_reserved 				  += allocator->dedicated_bytes[type];
+		statistics.bytes_used 					  += allocator->dedicated_bytes[type];
+	}
+
+	if ( statistics.bytes_free > 0 ) {
+		statistics.fragmentation = 1.0 - (double)statistics.largest_free_range / (double)statistics.bytes_free;
+	}
+
+	return statistics;
+}
+
+void
+export_vulkan_memory_statistics_as_json( Vulkan_Memory_Allocator *allocator, FILE *output, char *indentation )
+{
+	Vulkan_Memory_Statistics statistics;
+	statistics = compute_vulkan_memory_statistics( allocator );
+
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"device_memory_objects\": %u,\n", indentation, allocator->count_of_device_memory_objects );
+	fprintf( output, "%s  \"blocks\": %u,\n", indentation, statistics.count_of_blocks );
+	fprintf( output, "%s  \"allocations\": %u,\n", indentation, statistics.count_of_allocations );
+	fprintf( output, "%s  \"dedicated_allocations\": %u,\n", indentation, statistics.count_of_dedicated_allocations );
+	fprintf( output, "%s  \"bytes_reserved\": %llu,\n", indentation, (unsigned long long)statistics.bytes_reserved );
+	fprintf( output, "%s  \"bytes_used\": %llu,\n", indentation, (unsigned long long)statistics.bytes_used );
+	fprintf( output, "%s  \"bytes_free\": %llu,\n", indentation, (unsigned long long)statistics.bytes_free );
+	fprintf( output, "%s  \"free_ranges\": %u,\n", indentation, statistics.count_of_free_ranges );
+	fprintf( output, "%s  \"largest_free_range\": %llu,\n", indentation, (unsigned long long)statistics.largest_free_range );
+	fprintf( output, "%s  \"fragmentation\": %.4f\n", indentation, statistics.fragmentation );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
+
+VkBuffer
+create_vulkan_buffer( Vulkan_Memory_Allocator *allocator, VkDeviceSize size, VkBufferUsageFlags usage_flags,
+					  Vulkan_Memory_Usage memory_usage, Vulkan_Allocation *allocation )
+{
+	VkBufferCreateInfo buffer_create_info = { 0 };
+	buffer_create_info.sType 	   = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	buffer_create_info.size 	   = size;
+	buffer_create_info.usage 	   = usage_flags;
+	buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkResult result;
+	VkBuffer buffer;
+	result = allocator->dispatch->vkCreateBuffer( allocator->dispatch->logical_device, &buffer_create_info, NULL, &buffer );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a buffer\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkMemoryRequirements memory_requirements;
+	allocator->dispatch->vkGetBufferMemoryRequirements( allocator->dispatch->logical_device, buffer, &memory_requirements );
+
+	*allocation = allocate_vulkan_memory( allocator, &memory_requirements, memory_usage, VULKAN_RESOURCE_LINEAR );
+
+	result = allocator->dispatch->vkBindBufferMemory( allocator->dispatch->logical_device, buffer, allocation->memory, allocation->offset );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to bind buffer memory\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return buffer;
+}
+
+void
+destroy_vulkan_buffer( Vulkan_Memory_Allocator *allocator, VkBuffer buffer, Vulkan_Allocation *allocation )
+{
+	allocator->dispatch->vkDestroyBuffer( allocator->dispatch->logical_device, buffer, NULL );
+	free_vulkan_memory( allocator, allocation );
+
+	return;
+}
+
+VkImage
+create_vulkan_image( Vulkan_Memory_Allocator *allocator, VkImageCreateInfo *image_create_info,
+					 Vulkan_Memory_Usage memory_usage, Vulkan_Allocation *allocation )
+{
+	VkResult result;
+	VkImage image;
+	result = allocator->dispatch->vkCreateImage( allocator->dispatch->logical_device, image_create_info, NULL, &image );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create an image\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkMemoryRequirements memory_requirements;
+	allocator->dispatch->vkGetImageMemoryRequirements( allocator->dispatch->logical_device, image, &memory_requirements );
+
+	Vulkan_Resource_Kind kind;
+	kind = ( image_create_info->tiling == VK_IMAGE_TILING_OPTIMAL ) ? VULKAN_RESOURCE_OPTIMAL : VULKAN_RESOURCE_LINEAR;
+
+	*allocation = allocate_vulkan_memory( allocator, &memory_requirements, memory_usage, kind );
+
+	result = allocator->dispatch->vkBindImageMemory( allocator->dispatch->logical_device, image, allocation->memory, allocation->offset );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to bind image memory\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return image;
+}
+
+void
+destroy_vulkan_image( Vulkan_Memory_Allocator *allocator, VkImage image, Vulkan_Allocation *allocation )
+{
+	allocator->dispatch->vkDestroyImage( allocator->dispatch->logical_device, image, NULL );
+	free_vulkan_memory( allocator, allocation );
+
+	return;
+}
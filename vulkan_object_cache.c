@@ -0,0 +1,727 @@
+// Hashed caches for the small objects pipelines are built from: render passes, framebuffers, samplers,
+// descriptor set layouts and pipeline layouts. get_vulkan_X( cache, &create_info ) hands back the object an
+// identical create info made before, or makes it -- callers never destroy what they get, the cache owns it.
+//
+// The key is the create info serialized field by field (arrays and what they point at included, padding left
+// out) into a byte string. Chained structs are only accepted where the key knows them -- so far the binding flags
+// on a descriptor set layout. It's hashed with FNV-1a and compared in full on lookup, so a hash
+// collision costs a probe, never a wrong object. Each kind is its own open addressing table with its own lock;
+// a miss creates under that lock, so two recording jobs asking for the same thing at once still get one object.
+// Creation is rare enough that holding the lock across the driver call doesn't matter.
+//
+// Framebuffers point at swap chain image views, so invalidate_vulkan_framebuffers() empties their table on a
+// swap chain rebuild (a new view can get an old view's handle -- keeping the entries would hand back a
+// framebuffer for the wrong image). The old framebuffers wait on a retired list until their last frame is done.
+//
+// Unity built -- included by vulkan_renderer.c, needs the platform layer's mutex.
+
+#define VULKAN_OBJECT_TABLE_INITIAL_CAPACITY	64				// power of two, grows at 3/4 full
+#define VULKAN_OBJECT_KEY_CAPACITY				4096
+
+typedef enum {
+
+	VULKAN_OBJECT_RENDER_PASS,
+	VULKAN_OBJECT_FRAMEBUFFER,
+	VULKAN_OBJECT_SAMPLER,
+	VULKAN_OBJECT_DESCRIPTOR_SET_LAYOUT,
+	VULKAN_OBJECT_PIPELINE_LAYOUT,
+	COUNT_OF_VULKAN_OBJECT_KINDS
+
+} Vulkan_Object_Kind;
+
+char *vulkan_object_kind_names[] = {
+	"render_pass",
+	"framebuffer",
+	"sampler",
+	"descriptor_set_layout",
+	"pipeline_layout",
+};
+
+typedef struct {
+
+	uint64_t		hash;
+	uint32_t		key_offset;						// into the table's key bytes
+	uint32_t		key_size;						// 0 -- empty slot
+	uint64_t		handle;							// non-dispatchable handle, 64 bits on every platform
+
+} Vulkan_Object_Entry;
+
+typedef struct {
+
+	Platform_Mutex			mutex;
+	Vulkan_Object_Entry		*entries;
+	uint32_t				capacity;
+	uint32_t				count_of_objects;
+
+	uint8_t					*key_bytes;
+	uint32_t				key_bytes_used;
+	uint32_t				key_bytes_capacity;
+
+	uint64_t				count_of_hits;
+	uint64_t				count_of_misses;
+
+} Vulkan_Object_Table;
+
+typedef struct {
+
+	uint64_t		handle;
+	uint64_t		last_frame_number;				// destroy once this frame has completed
+
+} Vulkan_Retired_Object;
+
+typedef struct {
+
+	uint8_t			bytes[VULKAN_OBJECT_KEY_CAPACITY];
+	uint32_t		size;
+
+} Vulkan_Object_Key;
+
+typedef struct {
+
+	Vulkan_Device_Dispatch	*dispatch;
+	Vulkan_Object_Table		tables[COUNT_OF_VULKAN_OBJECT_KINDS];
+
+	Vulkan_Retired_Object	*retired_framebuffers;
+	uint32_t				count_of_retired_framebuffers;
+	uint32_t				retired_framebuffers_capacity;
+	uint32_t				count_of_framebuffer_invalidations;
+
+} Vulkan_Object_Cache;
+
+void
+create_vulkan_object_table( Vulkan_Object_Table *table, uint32_t capacity )
+{
+	memset( table, 0, sizeof (Vulkan_Object_Table) );
+	platform_create_mutex( &table->mutex );
+
+	table->entries = (Vulkan_Object_Entry *)calloc( capacity, sizeof (Vulkan_Object_Entry) );
+	if ( !table->entries ) {
+		fprintf( stdout, "Unable to allocate space for an object cache table\n" );
+		exit( EXIT_FAILURE );
+	}
+	table->capacity = capacity;
+
+	return;
+}
+
+void
+create_vulkan_object_cache( Vulkan_Object_Cache *cache, Vulkan_Device_Dispatch *dispatch )
+{
+	memset( cache, 0, sizeof (Vulkan_Object_Cache) );
+	cache->dispatch = dispatch;
+
+	for ( uint32_t kind = 0; kind < COUNT_OF_VULKAN_OBJECT_KINDS; ++kind ) {
+		create_vulkan_object_table( &cache->tables[kind], VULKAN_OBJECT_TABLE_INITIAL_CAPACITY );
+	}
+
+	return;
+}
+
+// NOTE: FNV-1a, 64 bit
+uint64_t
+hash_vulkan_object_key( Vulkan_Object_Key *key )
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	for ( uint32_t i = 0; i < key->size; ++i ) {
+		hash ^= key->bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+// Whatever is still chained once the known structs are taken off -- refusing beats caching two different objects as one
+void
+begin_vulkan_object_key( Vulkan_Object_Key *key, const void *next, char *what )
+{
+	if ( next ) {
+		fprintf( stdout, "Object cache doesn't handle a pNext chain on a %s create info\n", what );
+		exit( EXIT_FAILURE );
+	}
+
+	key->size = 0;
+
+	return;
+}
+
+void
+append_vulkan_object_key( Vulkan_Object_Key *key, const void *data, uint32_t size )
+{
+	if ( key->size + size > VULKAN_OBJECT_KEY_CAPACITY ) {
+		fprintf( stdout, "Object cache key is over %u bytes\n", VULKAN_OBJECT_KEY_CAPACITY );
+		exit( EXIT_FAILURE );
+	}
+
+	// NOTE: empty arrays may come in as NULL
+	if ( size ) {
+		memcpy( key->bytes + key->size, data, size );
+		key->size += size;
+	}
+
+	return;
+}
+
+void
+append_vulkan_object_key_value( Vulkan_Object_Key *key, uint32_t value )
+{
+	append_vulkan_object_key( key, &value, sizeof (uint32_t) );
+
+	return;
+}
+
+// handles go in as 64 bits whatever their C type, so the key bytes are the same on 32 bit builds
+void
+append_vulkan_object_key_handles( Vulkan_Object_Key *key, const void *handles, uint32_t count_of_handles, uint32_t handle_size )
+{
+	for ( uint32_t i = 0; i < count_of_handles; ++i ) {
+		uint64_t handle = 0;
+		memcpy( &handle, (uint8_t *)handles + (size_t)i * handle_size, handle_size );
+		append_vulkan_object_key( key, &handle, sizeof (uint64_t) );
+	}
+
+	return;
+}
+
+// Optional arrays get a present / absent marker so a NULL array and an empty one never share a key
+void
+append_vulkan_object_key_attachment_references( Vulkan_Object_Key *key, const VkAttachmentReference *references, uint32_t count_of_references )
+{
+	append_vulkan_object_key_value( key, references != NULL );
+	if ( references ) {
+		for ( uint32_t i = 0; i < count_of_references; ++i ) {
+			append_vulkan_object_key_value( key, references[i].attachment );
+			append_vulkan_object_key_value( key, (uint32_t)references[i].layout );
+		}
+	}
+
+	return;
+}
+
+void
+grow_vulkan_object_table( Vulkan_Object_Table *table )
+{
+	Vulkan_Object_Entry *old_entries;
+	old_entries = table->entries;
+
+	uint32_t old_capacity;
+	old_capacity = table->capacity;
+
+	table->capacity = old_capacity * 2;
+	table->entries  = (Vulkan_Object_Entry *)calloc( table->capacity, sizeof (Vulkan_Object_Entry) );
+	if ( !table->entries ) {
+		fprintf( stdout, "Unable to grow an object cache table\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	for ( uint32_t i = 0; i < old_capacity; ++i ) {
+		if ( old_entries[i].key_size == 0 ) {
+			continue;
+		}
+
+		uint32_t slot;
+		slot = (uint32_t)old_entries[i].hash & ( table->capacity - 1 );
+		while ( table->entries[slot].key_size != 0 ) {
+			slot = ( slot + 1 ) & ( table->capacity - 1 );
+		}
+		table->entries[slot] = old_entries[i];
+	}
+
+	free( old_entries );
+
+	return;
+}
+
+uint32_t
+store_vulkan_object_key( Vulkan_Object_Table *table, Vulkan_Object_Key *key )
+{
+	if ( table->key_bytes_used + key->size > table->key_bytes_capacity ) {
+		uint32_t new_capacity;
+		new_capacity = table->key_bytes_capacity ? table->key_bytes_capacity * 2 : VULKAN_OBJECT_KEY_CAPACITY;
+		while ( table->key_bytes_used + key->size > new_capacity ) {
+			new_capacity *= 2;
+		}
+
+		table->key_bytes = (uint8_t *)realloc( table->key_bytes, new_capacity );
+		if ( !table->key_bytes ) {
+			fprintf( stdout, "Unable to grow object cache key storage\n" );
+			exit( EXIT_FAILURE );
+		}
+		table->key_bytes_capacity = new_capacity;
+	}
+
+	uint32_t key_offset;
+	key_offset = table->key_bytes_used;
+
+	memcpy( table->key_bytes + key_offset, key->bytes, key->size );
+	table->key_bytes_used += key->size;
+
+	return key_offset;
+}
+
+uint64_t
+create_vulkan_cached_object( Vulkan_Object_Cache *cache, Vulkan_Object_Kind kind, const void *create_info )
+{
+	Vulkan_Device_Dispatch *dispatch;
+	dispatch = cache->dispatch;
+
+	uint64_t handle = 0;
+	VkResult result = VK_SUCCESS;
+
+	switch ( kind ) {
+
+		case VULKAN_OBJECT_RENDER_PASS: {
+			VkRenderPass render_pass;
+			result = dispatch->vkCreateRenderPass( dispatch->logical_device, (const VkRenderPassCreateInfo *)create_info, NULL, &render_pass );
+			memcpy( &handle, &render_pass, sizeof (VkRenderPass) );
+		} break;
+
+		case VULKAN_OBJECT_FRAMEBUFFER: {
+			VkFramebuffer framebuffer;
+			result = dispatch->vkCreateFramebuffer( dispatch->logical_device, (const VkFramebufferCreateInfo *)create_info, NULL, &framebuffer );
+			memcpy( &handle, &framebuffer, sizeof (VkFramebuffer) );
+		} break;
+
+		case VULKAN_OBJECT_SAMPLER: {
+			VkSampler sampler;
+			result = dispatch->vkCreateSampler( dispatch->logical_device, (const VkSamplerCreateInfo *)create_info, NULL, &sampler );
+			memcpy( &handle, &sampler, sizeof (VkSampler) );
+		} break;
+
+		case VULKAN_OBJECT_DESCRIPTOR_SET_LAYOUT: {
+			VkDescriptorSetLayout descriptor_set_layout;
+			result = dispatch->vkCreateDescriptorSetLayout( dispatch->logical_device, (const VkDescriptorSetLayoutCreateInfo *)create_info, NULL, &descriptor_set_layout );
+			memcpy( &handle, &descriptor_set_layout, sizeof (VkDescriptorSetLayout) );
+		} break;
+
+		case VULKAN_OBJECT_PIPELINE_LAYOUT: {
+			VkPipelineLayout pipeline_layout;
+			result = dispatch->vkCreatePipelineLayout( dispatch->logical_device, (const VkPipelineLayoutCreateInfo *)create_info, NULL, &pipeline_layout );
+			memcpy( &handle, &pipeline_layout, sizeof (VkPipelineLayout) );
+		} break;
+
+		default: {
+		} break;
+	}
+
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a cached %s\n", vulkan_object_kind_names[kind] );
+		exit( EXIT_FAILURE );
+	}
+
+	return handle;
+}
+
+void
+destroy_vulkan_cached_object( Vulkan_Object_Cache *cache, Vulkan_Object_Kind kind, uint64_t handle )
+{
+	Vulkan_Device_Dispatch *dispatch;
+	dispatch = cache->dispatch;
+
+	switch ( kind ) {
+
+		case VULKAN_OBJECT_RENDER_PASS: {
+			VkRenderPass render_pass;
+			memcpy( &render_pass, &handle, sizeof (VkRenderPass) );
+			dispatch->vkDestroyRenderPass( dispatch->logical_device, render_pass, NULL );
+		} break;
+
+		case VULKAN_OBJECT_FRAMEBUFFER: {
+			VkFramebuffer framebuffer;
+			memcpy( &framebuffer, &handle, sizeof (VkFramebuffer) );
+			dispatch->vkDestroyFramebuffer( dispatch->logical_device, framebuffer, NULL );
+		} break;
+
+		case VULKAN_OBJECT_SAMPLER: {
+			VkSampler sampler;
+			memcpy( &sampler, &handle, sizeof (VkSampler) );
+			dispatch->vkDestroySampler( dispatch->logical_device, sampler, NULL );
+		} break;
+
+		case VULKAN_OBJECT_DESCRIPTOR_SET_LAYOUT: {
+			VkDescriptorSetLayout descriptor_set_layout;
+			memcpy( &descriptor_set_layout, &handle, sizeof (VkDescriptorSetLayout) );
+			dispatch->vkDestroyDescriptorSetLayout( dispatch->logical_device, descriptor_set_layout, NULL );
+		} break;
+
+		case VULKAN_OBJECT_PIPELINE_LAYOUT: {
+			VkPipelineLayout pipeline_layout;
+			memcpy( &pipeline_layout, &handle, sizeof (VkPipelineLayout) );
+			dispatch->vkDestroyPipelineLayout( dispatch->logical_device, pipeline_layout, NULL );
+		} break;
+
+		default: {
+		} break;
+	}
+
+	return;
+}
+
+// Any thread. Returns the cached handle or creates, stores and returns a new one.
+uint64_t
+find_or_create_vulkan_object( Vulkan_Object_Cache *cache, Vulkan_Object_Kind kind, Vulkan_Object_Key *key, const void *create_info )
+{
+	Vulkan_Object_Table *table;
+	table = &cache->tables[kind];
+
+	uint64_t hash;
+	hash = hash_vulkan_object_key( key );
+
+	platform_lock_mutex( &table->mutex );
+
+	uint32_t slot;
+	slot = (uint32_t)hash & ( table->capacity - 1 );
+
+	while ( table->entries[slot].key_size != 0 ) {
+		Vulkan_Object_Entry *entry;
+		entry = &table->entries[slot];
+
+		if ( entry->hash == hash && entry->key_size == key->size &&
+			 memcmp( table->key_bytes + entry->key_offset, key->bytes, key->size ) == 0 ) {
+			uint64_t handle;
+			handle = entry->handle;
+
+			table->count_of_hits += 1;
+			platform_unlock_mutex( &table->mutex );
+
+			return handle;
+		}
+
+		slot = ( slot + 1 ) & ( table->capacity - 1 );
+	}
+
+	uint64_t handle;
+	handle = create_vulkan_cached_object( cache, kind, create_info );
+	table->count_of_misses += 1;
+
+	if ( ( table->count_of_objects + 1 ) * 4 > table->capacity * 3 ) {
+		grow_vulkan_object_table( table );
+
+		slot = (uint32_t)hash & ( table->capacity - 1 );
+		while ( table->entries[slot].key_size != 0 ) {
+			slot = ( slot + 1 ) & ( table->capacity - 1 );
+		}
+	}
+
+	Vulkan_Object_Entry *entry;
+	entry = &table->entries[slot];
+	entry->hash       = hash;
+	entry->key_offset = store_vulkan_object_key( table, key );
+	entry->key_size   = key->size;
+	entry->handle     = handle;
+
+	table->count_of_objects += 1;
+
+	platform_unlock_mutex( &table->mutex );
+
+	return handle;
+}
+
+VkRenderPass
+get_vulkan_render_pass( Vulkan_Object_Cache *cache, const VkRenderPassCreateInfo *create_info )
+{
+	Vulkan_Object_Key key;
+	begin_vulkan_object_key( &key, create_info->pNext, "render pass" );
+
+	append_vulkan_object_key_value( &key, create_info->flags );
+
+	append_vulkan_object_key_value( &key, create_info->attachmentCount );
+	for ( uint32_t i = 0; i < create_info->attachmentCount; ++i ) {
+		const VkAttachmentDescription *attachment;
+		attachment = &create_info->pAttachments[i];
+
+		append_vulkan_object_key_value( &key, attachment->flags );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->format );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->samples );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->loadOp );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->storeOp );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->stencilLoadOp );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->stencilStoreOp );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->initialLayout );
+		append_vulkan_object_key_value( &key, (uint32_t)attachment->finalLayout );
+	}
+
+	append_vulkan_object_key_value( &key, create_info->subpassCount );
+	for ( uint32_t i = 0; i < create_info->subpassCount; ++i ) {
+		const VkSubpassDescription *subpass;
+		subpass = &create_info->pSubpasses[i];
+
+		append_vulkan_object_key_value( &key, subpass->flags );
+		append_vulkan_object_key_value( &key, (uint32_t)subpass->pipelineBindPoint );
+		append_vulkan_object_key_value( &key, subpass->inputAttachmentCount );
+		append_vulkan_object_key_attachment_references( &key, subpass->pInputAttachments, subpass->inputAttachmentCount );
+		append_vulkan_object_key_value( &key, subpass->colorAttachmentCount );
+		append_vulkan_object_key_attachment_references( &key, subpass->pColorAttachments, subpass->colorAttachmentCount );
+		append_vulkan_object_key_attachment_references( &key, subpass->pResolveAttachments, subpass->colorAttachmentCount );
+		append_vulkan_object_key_attachment_references( &key, subpass->pDepthStencilAttachment, 1 );
+		append_vulkan_object_key_value( &key, subpass->preserveAttachmentCount );
+		append_vulkan_object_key( &key, subpass->pPreserveAttachments, subpass->preserveAttachmentCount * sizeof (uint32_t) );
+	}
+
+	append_vulkan_object_key_value( &key, create_info->dependencyCount );
+	for ( uint32_t i = 0; i < create_info->dependencyCount; ++i ) {
+		const VkSubpassDependency *dependency;
+		dependency = &create_info->pDependencies[i];
+
+		append_vulkan_object_key_value( &key, dependency->srcSubpass );
+		append_vulkan_object_key_value( &key, dependency->dstSubpass );
+		append_vulkan_object_key_value( &key, dependency->srcStageMask );
+		append_vulkan_object_key_value( &key, dependency->dstStageMask );
+		append_vulkan_object_key_value( &key, dependency->srcAccessMask );
+		append_vulkan_object_key_value( &key, dependency->dstAccessMask );
+		append_vulkan_object_key_value( &key, dependency->dependencyFlags );
+	}
+
+	uint64_t handle;
+	handle = find_or_create_vulkan_object( cache, VULKAN_OBJECT_RENDER_PASS, &key, create_info );
+
+	VkRenderPass render_pass;
+	memcpy( &render_pass, &handle, sizeof (VkRenderPass) );
+
+	return render_pass;
+}
+
+// NOTE: the render pass handle is part of the key -- it comes from this cache too, so equal passes share one
+VkFramebuffer
+get_vulkan_framebuffer( Vulkan_Object_Cache *cache, const VkFramebufferCreateInfo *create_info )
+{
+	Vulkan_Object_Key key;
+	begin_vulkan_object_key( &key, create_info->pNext, "framebuffer" );
+
+	append_vulkan_object_key_value( &key, create_info->flags );
+	append_vulkan_object_key_handles( &key, &create_info->renderPass, 1, sizeof (VkRenderPass) );
+	append_vulkan_object_key_value( &key, create_info->attachmentCount );
+	append_vulkan_object_key_handles( &key, create_info->pAttachments, create_info->attachmentCount, sizeof (VkImageView) );
+	append_vulkan_object_key_value( &key, create_info->width );
+	append_vulkan_object_key_value( &key, create_info->height );
+	append_vulkan_object_key_value( &key, create_info->layers );
+
+	uint64_t handle;
+	handle = find_or_create_vulkan_object( cache, VULKAN_OBJECT_FRAMEBUFFER, &key, create_info );
+
+	VkFramebuffer framebuffer;
+	memcpy( &framebuffer, &handle, sizeof (VkFramebuffer) );
+
+	return framebuffer;
+}
+
+VkSampler
+get_vulkan_sampler( Vulkan_Object_Cache *cache, const VkSamplerCreateInfo *create_info )
+{
+	Vulkan_Object_Key key;
+	begin_vulkan_object_key( &key, create_info->pNext, "sampler" );
+
+	append_vulkan_object_key_value( &key, create_info->flags );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->magFilter );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->minFilter );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->mipmapMode );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->addressModeU );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->addressModeV );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->addressModeW );
+	append_vulkan_object_key( &key, &create_info->mipLodBias, sizeof (float) );
+	append_vulkan_object_key_value( &key, create_info->anisotropyEnable );
+	append_vulkan_object_key( &key, &create_info->maxAnisotropy, sizeof (float) );
+	append_vulkan_object_key_value( &key, create_info->compareEnable );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->compareOp );
+	append_vulkan_object_key( &key, &create_info->minLod, sizeof (float) );
+	append_vulkan_object_key( &key, &create_info->maxLod, sizeof (float) );
+	append_vulkan_object_key_value( &key, (uint32_t)create_info->borderColor );
+	append_vulkan_object_key_value( &key, create_info->unnormalizedCoordinates );
+
+	uint64_t handle;
+	handle = find_or_create_vulkan_object( cache, VULKAN_OBJECT_SAMPLER, &key, create_info );
+
+	VkSampler sampler;
+	memcpy( &sampler, &handle, sizeof (VkSampler) );
+
+	return sampler;
+}
+
+// NOTE: binding order is part of the key -- sort bindings by number if they're built in varying order
+VkDescriptorSetLayout
+get_vulkan_descriptor_set_layout( Vulkan_Object_Cache *cache, const VkDescriptorSetLayoutCreateInfo *create_info )
+{
+	// NOTE: sType is always the first member -- enough to tell what is chained
+	const VkDescriptorSetLayoutBindingFlagsCreateInfo *binding_flags = NULL;
+	const void *next = create_info->pNext;
+	if ( next && ( (const VkDescriptorSetLayoutBindingFlagsCreateInfo *)next )->sType == VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO ) {
+		binding_flags = (const VkDescriptorSetLayoutBindingFlagsCreateInfo *)next;
+		next = binding_flags->pNext;
+	}
+
+	Vulkan_Object_Key key;
+	begin_vulkan_object_key( &key, next, "descriptor set layout" );
+
+	append_vulkan_object_key_value( &key, create_info->flags );
+	append_vulkan_object_key_value( &key, binding_flags != NULL );
+	if ( binding_flags ) {
+		append_vulkan_object_key_value( &key, binding_flags->bindingCount );
+		append_vulkan_object_key( &key, binding_flags->pBindingFlags, binding_flags->bindingCount * sizeof (VkDescriptorBindingFlags) );
+	}
+
+	append_vulkan_object_key_value( &key, create_info->bindingCount );
+	for ( uint32_t i = 0; i < create_info->bindingCount; ++i ) {
+		const VkDescriptorSetLayoutBinding *binding;
+		binding = &create_info->pBindings[i];
+
+		append_vulkan_object_key_value( &key, binding->binding );
+		append_vulkan_object_key_value( &key, (uint32_t)binding->descriptorType );
+		append_vulkan_object_key_value( &key, binding->descriptorCount );
+		append_vulkan_object_key_value( &key, binding->stageFlags );
+		append_vulkan_object_key_value( &key, binding->pImmutableSamplers != NULL );
+		if ( binding->pImmutableSamplers ) {
+			append_vulkan_object_key_handles( &key, binding->pImmutableSamplers, binding->descriptorCount, sizeof (VkSampler) );
+		}
+	}
+
+	uint64_t handle;
+	handle = find_or_create_vulkan_object( cache, VULKAN_OBJECT_DESCRIPTOR_SET_LAYOUT, &key, create_info );
+
+	VkDescriptorSetLayout descriptor_set_layout;
+	memcpy( &descriptor_set_layout, &handle, sizeof (VkDescriptorSetLayout) );
+
+	return descriptor_set_layout;
+}
+
+VkPipelineLayout
+get_vulkan_pipeline_layout( Vulkan_Object_Cache *cache, const VkPipelineLayoutCreateInfo *create_info )
+{
+	Vulkan_Object_Key key;
+	begin_vulkan_object_key( &key, create_info->pNext, "pipeline layout" );
+
+	append_vulkan_object_key_value( &key, create_info->flags );
+	append_vulkan_object_key_value( &key, create_info->setLayoutCount );
+	append_vulkan_object_key_handles( &key, create_info->pSetLayouts, create_info->setLayoutCount, sizeof (VkDescriptorSetLayout) );
+	append_vulkan_object_key_value( &key, create_info->pushConstantRangeCount );
+	for ( uint32_t i = 0; i < create_info->pushConstantRangeCount; ++i ) {
+		append_vulkan_object_key_value( &key, create_info->pPushConstantRanges[i].stageFlags );
+		append_vulkan_object_key_value( &key, create_info->pPushConstantRanges[i].offset );
+		append_vulkan_object_key_value( &key, create_info->pPushConstantRanges[i].size );
+	}
+
+	uint64_t handle;
+	handle = find_or_create_vulkan_object( cache, VULKAN_OBJECT_PIPELINE_LAYOUT, &key, create_info );
+
+	VkPipelineLayout pipeline_layout;
+	memcpy( &pipeline_layout, &handle, sizeof (VkPipelineLayout) );
+
+	return pipeline_layout;
+}
+
+// Swap chain rebuild. Every cached framebuffer moves to the retired list, tagged with the last frame that
+// could have used it, and the table starts over empty.
+void
+invalidate_vulkan_framebuffers( Vulkan_Object_Cache *cache, uint64_t last_frame_number )
+{
+	Vulkan_Object_Table *table;
+	table = &cache->tables[VULKAN_OBJECT_FRAMEBUFFER];
+
+	platform_lock_mutex( &table->mutex );
+
+	if ( cache->count_of_retired_framebuffers + table->count_of_objects > cache->retired_framebuffers_capacity ) {
+		uint32_t new_capacity;
+		new_capacity = cache->count_of_retired_framebuffers + table->count_of_objects;
+
+		cache->retired_framebuffers = (Vulkan_Retired_Object *)realloc( cache->retired_framebuffers, new_capacity * sizeof (Vulkan_Retired_Object) );
+		if ( !cache->retired_framebuffers ) {
+			fprintf( stdout, "Unable to allocate space for retired framebuffers\n" );
+			exit( EXIT_FAILURE );
+		}
+		cache->retired_framebuffers_capacity = new_capacity;
+	}
+
+	for ( uint32_t i = 0; i < table->capacity; ++i ) {
+		if ( table->entries[i].key_size == 0 ) {
+			continue;
+		}
+
+		Vulkan_Retired_Object *retired_framebuffer;
+		retired_framebuffer = &cache->retired_framebuffers[cache->count_of_retired_framebuffers++];
+		retired_framebuffer->handle            = table->entries[i].handle;
+		retired_framebuffer->last_frame_number = last_frame_number;
+	}
+
+	memset( table->entries, 0, table->capacity * sizeof (Vulkan_Object_Entry) );
+	table->count_of_objects = 0;
+	table->key_bytes_used   = 0;
+
+	cache->count_of_framebuffer_invalidations += 1;
+
+	platform_unlock_mutex( &table->mutex );
+
+	return;
+}
+
+// NOTE: cheap to call every frame -- only compares frame numbers unless something is ready to go
+void
+destroy_retired_vulkan_framebuffers( Vulkan_Object_Cache *cache, uint64_t last_completed_frame_number )
+{
+	uint32_t count_of_remaining = 0;
+
+	for ( uint32_t i = 0; i < cache->count_of_retired_framebuffers; ++i ) {
+		Vulkan_Retired_Object *retired_framebuffer;
+		retired_framebuffer = &cache->retired_framebuffers[i];
+
+		if ( retired_framebuffer->last_frame_number <= last_completed_frame_number ) {
+			destroy_vulkan_cached_object( cache, VULKAN_OBJECT_FRAMEBUFFER, retired_framebuffer->handle );
+		}
+		else {
+			cache->retired_framebuffers[count_of_remaining++] = *retired_framebuffer;
+		}
+	}
+
+	cache->count_of_retired_framebuffers = count_of_remaining;
+
+	return;
+}
+
+// NOTE: the device must be idle. Goes backwards through the kinds -- pipeline layouts before the set layouts
+// they were made from, framebuffers before their render passes.
+void
+destroy_vulkan_object_cache( Vulkan_Object_Cache *cache )
+{
+	destroy_retired_vulkan_framebuffers( cache, UINT64_MAX );
+	free( cache->retired_framebuffers );
+
+	for ( uint32_t kind = COUNT_OF_VULKAN_OBJECT_KINDS; kind-- > 0; ) {
+		Vulkan_Object_Table *table;
+		table = &cache->tables[kind];
+
+		for ( uint32_t i = 0; i < table->capacity; ++i ) {
+			if ( table->entries[i].key_size != 0 ) {
+				destroy_vulkan_cached_object( cache, (Vulkan_Object_Kind)kind, table->entries[i].handle );
+			}
+		}
+
+		free( table->entries );
+		free( table->key_bytes );
+		platform_destroy_mutex( &table->mutex );
+	}
+
+	return;
+}
+
+void
+export_vulkan_object_cache_as_json( Vulkan_Object_Cache *cache, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+
+	for ( uint32_t kind = 0; kind < COUNT_OF_VULKAN_OBJECT_KINDS; ++kind ) {
+		Vulkan_Object_Table *table;
+		table = &cache->tables[kind];
+
+		uint64_t count_of_requests;
+		count_of_requests = table->count_of_hits + table->count_of_misses;
+
+		fprintf( output, "%s  \"%s\": { \"objects\": %u, \"hits\": %llu, \"misses\": %llu, \"hit_rate\": %.4f },\n", indentation,
+				 vulkan_object_kind_names[kind], table->count_of_objects,
+				 (unsigned long long)table->count_of_hits, (unsigned long long)table->count_of_misses,
+				 count_of_requests ? (double)table->count_of_hits / (double)count_of_requests : 0.0 );
+	}
+
+	fprintf( output, "%s  \"framebuffer_invalidations\": %u,\n", indentation, cache->count_of_framebuffer_invalidations );
+	fprintf( output, "%s  \"retired_framebuffers\": %u\n", indentation, cache->count_of_retired_framebuffers );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,316 @@
+// Persistent pipeline cache. At startup the cache file is memory mapped and, if its header matches this
+// device (vendorID / deviceID / pipelineCacheUUID), handed straight to vkCreatePipelineCache -- no read into
+// a heap buffer first. It is written back on shutdown and at checkpoints while running, always through
+// platform_write_file_atomically so a crash mid-save can't leave a torn file behind for the next start.
+//
+// Hits / misses come from VK_EXT_pipeline_creation_feedback when the device has it: chain
+// the VkPipelineCreationFeedbackCreateInfoEXT from begin_pipeline_creation_feedback() into the pipeline create
+// info and pass it to end_pipeline_creation_feedback() afterwards.
+//
+// Unity built -- included by vulkan_renderer.c after the platform layer services it uses.
+
+#define PIPELINE_CACHE_HEADER_SIZE						32			// VkPipelineCacheHeaderVersionOne
+#define PIPELINE_CACHE_CHECKPOINT_INTERVAL_NANOSECONDS	( 30ull * 1000000000ull )
+
+typedef enum {
+
+	PIPELINE_CACHE_COLD_NO_FILE,
+	PIPELINE_CACHE_COLD_TRUNCATED,
+	PIPELINE_CACHE_COLD_BAD_HEADER_VERSION,
+	PIPELINE_CACHE_COLD_OTHER_VENDOR_OR_DEVICE,
+	PIPELINE_CACHE_COLD_OTHER_DRIVER,				// pipelineCacheUUID changes with driver builds
+	PIPELINE_CACHE_WARM,
+
+} Pipeline_Cache_Load_Result;
+
+char *pipeline_cache_load_result_names[] = {
+	"no_file",
+	"truncated",
+	"bad_header_version",
+	"other_vendor_or_device",
+	"other_driver",
+	"warm",
+};
+
+typedef struct {
+
+	VkPipelineCreationFeedbackEXT			pipeline_feedback;
+	VkPipelineCreationFeedbackCreateInfoEXT	create_info;
+
+} Vulkan_Pipeline_Creation_Feedback;
+
+typedef struct {
+
+	Vulkan_Device_Dispatch		*dispatch;
+	VkPipelineCache				cache;
+	char						*path;							// NULL -- in memory only, never saved
+	bool						creation_feedback_enabled;
+
+	Pipeline_Cache_Load_Result	load_result;
+	uint64_t					bytes_loaded;
+	uint64_t					load_nanoseconds;
+
+	uint32_t					count_of_pipelines_created;
+	uint32_t					count_of_pipelines_at_last_save;
+	uint32_t					count_of_hits;
+	uint32_t					count_of_misses;
+	uint64_t					pipeline_creation_nanoseconds;	// driver reported, only with creation feedback
+
+	uint64_t					last_checkpoint_timestamp;
+	uint32_t					count_of_saves;
+	uint64_t					bytes_saved;
+	uint64_t					save_nanoseconds;				// last save
+
+} Vulkan_Pipeline_Cache;
+
+
+uint32_t
+read_pipeline_cache_header_field( uint8_t *header, uint32_t offset )
+{
+	// NOTE: the header is written in the device's byte order, which is this CPU's for everything we run on
+	uint32_t value;
+	memcpy( &value, header + offset, sizeof (uint32_t) );
+
+	return value;
+}
+
+Pipeline_Cache_Load_Result
+validate_pipeline_cache_header( void *data, uint64_t size, VkPhysicalDeviceProperties *device_properties )
+{
+	if ( size < PIPELINE_CACHE_HEADER_SIZE ) {
+		return PIPELINE_CACHE_COLD_TRUNCATED;
+	}
+
+	uint8_t *header;
+	header = (uint8_t *)data;
+
+	uint32_t header_size;
+	uint32_t header_version;
+	header_size    = read_pipeline_cache_header_field( header, 0 );
+	header_version = read_pipeline_cache_header_field( header, 4 );
+
+	if ( header_size < PIPELINE_CACHE_HEADER_SIZE || header_size > size ) {
+		return PIPELINE_CACHE_COLD_TRUNCATED;
+	}
+
+	if ( header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ) {
+		return PIPELINE_CACHE_COLD_BAD_HEADER_VERSION;
+	}
+
+	if ( read_pipeline_cache_header_field( header, 8 ) != device_properties->vendorID ||
+		 read_pipeline_cache_header_field( header, 12 ) != device_properties->deviceID ) {
+		return PIPELINE_CACHE_COLD_OTHER_VENDOR_OR_DEVICE;
+	}
+
+	if ( memcmp( header + 16, device_properties->pipelineCacheUUID, VK_UUID_SIZE ) != 0 ) {
+		return PIPELINE_CACHE_COLD_OTHER_DRIVER;
+	}
+
+	return PIPELINE_CACHE_WARM;
+}
+
+// A file that doesn't match is ignored, not deleted -- the next save replaces it
+void
+create_vulkan_pipeline_cache( Vulkan_Pipeline_Cache *pipeline_cache, Vulkan_Device_Dispatch *dispatch,
+							  VkPhysicalDeviceProperties *device_properties, char *path, bool creation_feedback_enabled )
+{
+	memset( pipeline_cache, 0, sizeof (Vulkan_Pipeline_Cache) );
+	pipeline_cache->dispatch 				  = dispatch;
+	pipeline_cache->path 					  = path;
+	pipeline_cache->creation_feedback_enabled = creation_feedback_enabled;
+	pipeline_cache->load_result 			  = PIPELINE_CACHE_COLD_NO_FILE;
+
+	uint64_t load_start;
+	load_start = platform_get_timestamp_in_nanoseconds();
+
+	Platform_File_Map file_map = { 0 };
+	if ( path && platform_map_file_for_reading( path, &file_map ) ) {
+		pipeline_cache->load_result = validate_pipeline_cache_header( file_map.data, file_map.size, device_properties );
+	}
+
+	VkPipelineCacheCreateInfo pipeline_cache_create_info = { 0 };
+	pipeline_cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	if ( pipeline_cache->load_result == PIPELINE_CACHE_WARM ) {
+		pipeline_cache_create_info.initialDataSize = (size_t)file_map.size;
+		pipeline_cache_create_info.pInitialData    = file_map.data;
+	}
+
+	VkResult result;
+	result = dispatch->vkCreatePipelineCache( dispatch->logical_device, &pipeline_cache_create_info, NULL, &pipeline_cache->cache );
+	if ( result != VK_SUCCESS && pipeline_cache->load_result == PIPELINE_CACHE_WARM ) {
+		// NOTE: the header was fine but the driver still didn't like the blob -- start empty instead
+		pipeline_cache->load_result = PIPELINE_CACHE_COLD_OTHER_DRIVER;
+		pipeline_cache_create_info.initialDataSize = 0;
+		pipeline_cache_create_info.pInitialData    = NULL;
+		result = dispatch->vkCreatePipelineCache( dispatch->logical_device, &pipeline_cache_create_info, NULL, &pipeline_cache->cache );
+	}
+
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a pipeline cache\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( pipeline_cache->load_result == PIPELINE_CACHE_WARM ) {
+		pipeline_cache->bytes_loaded = file_map.size;
+	}
+
+	// the driver has its own copy now
+	platform_unmap_file( &file_map );
+
+	pipeline_cache->load_nanoseconds 		  = platform_get_timestamp_in_nanoseconds() - load_start;
+	pipeline_cache->last_checkpoint_timestamp = platform_get_timestamp_in_nanoseconds();
+
+	return;
+}
+
+bool
+save_vulkan_pipeline_cache( Vulkan_Pipeline_Cache *pipeline_cache )
+{
+	if ( !pipeline_cache->path ) {
+		return false;
+	}
+
+	uint64_t save_start;
+	save_start = platform_get_timestamp_in_nanoseconds();
+
+	VkDevice logical_device;
+	logical_device = pipeline_cache->dispatch->logical_device;
+
+	size_t data_size = 0;
+	VkResult result;
+	result = pipeline_cache->dispatch->vkGetPipelineCacheData( logical_device, pipeline_cache->cache, &data_size, NULL );
+	if ( result != VK_SUCCESS || data_size == 0 ) {
+		return false;
+	}
+
+	void *data;
+	data = malloc( data_size );
+	if ( !data ) {
+		fprintf( stdout, "Unable to allocate space for the pipeline cache data\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	// NOTE: VK_INCOMPLETE only if the cache grew in between, which needs another thread creating pipelines --
+	// the truncated blob is still a valid cache, just a smaller one
+	result = pipeline_cache->dispatch->vkGetPipelineCacheData( logical_device, pipeline_cache->cache, &data_size, data );
+	if ( result != VK_SUCCESS && result != VK_INCOMPLETE ) {
+		free( data );
+		return false;
+	}
+
+	bool saved;
+	saved = platform_write_file_atomically( pipeline_cache->path, data, data_size );
+	free( data );
+
+	if ( !saved ) {
+		fprintf( stderr, "Unable to write the pipeline cache to %s\n", pipeline_cache->path );
+		return false;
+	}
+
+	pipeline_cache->count_of_saves 				  += 1;
+	pipeline_cache->bytes_saved 				   = data_size;
+	pipeline_cache->count_of_pipelines_at_last_save = pipeline_cache->count_of_pipelines_created;
+	pipeline_cache->save_nanoseconds 			   = platform_get_timestamp_in_nanoseconds() - save_start;
+
+	return true;
+}
+
+// Cheap enough to call every frame -- only saves when the interval has passed and pipelines were created since
+void
+checkpoint_vulkan_pipeline_cache( Vulkan_Pipeline_Cache *pipeline_cache )
+{
+	if ( pipeline_cache->count_of_pipelines_created == pipeline_cache->count_of_pipelines_at_last_save ) {
+		return;
+	}
+
+	uint64_t now;
+	now = platform_get_timestamp_in_nanoseconds();
+	if ( now - pipeline_cache->last_checkpoint_timestamp < PIPELINE_CACHE_CHECKPOINT_INTERVAL_NANOSECONDS ) {
+		return;
+	}
+
+	pipeline_cache->last_checkpoint_timestamp = now;
+	save_vulkan_pipeline_cache( pipeline_cache );
+
+	return;
+}
+
+// NOTE: saves first -- the device must still be alive
+void
+destroy_vulkan_pipeline_cache( Vulkan_Pipeline_Cache *pipeline_cache )
+{
+	// NOTE: a cold start always writes once, even with no pipelines, so the next start finds a matching header
+	bool never_saved_cold_cache;
+	never_saved_cold_cache = ( pipeline_cache->load_result != PIPELINE_CACHE_WARM && pipeline_cache->count_of_saves == 0 );
+
+	if ( pipeline_cache->count_of_pipelines_created != pipeline_cache->count_of_pipelines_at_last_save || never_saved_cold_cache ) {
+		save_vulkan_pipeline_cache( pipeline_cache );
+	}
+
+	pipeline_cache->dispatch->vkDestroyPipelineCache( pipeline_cache->dispatch->logical_device, pipeline_cache->cache, NULL );
+
+	return;
+}
+
+// Returns what to chain into VkGraphicsPipelineCreateInfo / VkComputePipelineCreateInfo::pNext, or NULL
+// when the device has no creation feedback
+void *
+begin_pipeline_creation_feedback( Vulkan_Pipeline_Cache *pipeline_cache, Vulkan_Pipeline_Creation_Feedback *feedback, void *next )
+{
+	if ( !pipeline_cache->creation_feedback_enabled ) {
+		return next;
+	}
+
+	memset( feedback, 0, sizeof (Vulkan_Pipeline_Creation_Feedback) );
+	feedback->create_info.sType 					= VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+	feedback->create_info.pNext 					= next;
+	feedback->create_info.pPipelineCreationFeedback = &feedback->pipeline_feedback;
+
+	return &feedback->create_info;
+}
+
+void
+end_pipeline_creation_feedback( Vulkan_Pipeline_Cache *pipeline_cache, Vulkan_Pipeline_Creation_Feedback *feedback )
+{
+	pipeline_cache->count_of_pipelines_created += 1;
+
+	if ( !pipeline_cache->creation_feedback_enabled ) {
+		return;
+	}
+
+	// NOTE: drivers are allowed to leave the feedback unfilled -- those pipelines count as neither
+	if ( !( feedback->pipeline_feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT ) ) {
+		return;
+	}
+
+	if ( feedback->pipeline_feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT ) {
+		pipeline_cache->count_of_hits += 1;
+	}
+	else {
+		pipeline_cache->count_of_misses += 1;
+	}
+
+	pipeline_cache->pipeline_creation_nanoseconds += feedback->pipeline_feedback.duration;
+
+	return;
+}
+
+void
+export_vulkan_pipeline_cache_as_json( Vulkan_Pipeline_Cache *pipeline_cache, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"load\": \"%s\",\n", indentation, pipeline_cache_load_result_names[pipeline_cache->load_result] );
+	fprintf( output, "%s  \"bytes_loaded\": %llu,\n", indentation, (unsigned long long)pipeline_cache->bytes_loaded );
+	fprintf( output, "%s  \"load_ms\": %.3f,\n", indentation, (double)pipeline_cache->load_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"creation_feedback\": %s,\n", indentation, pipeline_cache->creation_feedback_enabled ? "true" : "false" );
+	fprintf( output, "%s  \"pipelines_created\": %u,\n", indentation, pipeline_cache->count_of_pipelines_created );
+	fprintf( output, "%s  \"hits\": %u,\n", indentation, pipeline_cache->count_of_hits );
+	fprintf( output, "%s  \"misses\": %u,\n", indentation, pipeline_cache->count_of_misses );
+	fprintf( output, "%s  \"pipeline_creation_ms\": %.3f,\n", indentation, (double)pipeline_cache->pipeline_creation_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"saves\": %u,\n", indentation, pipeline_cache->count_of_saves );
+	fprintf( output, "%s  \"bytes_saved\": %llu,\n", indentation, (unsigned long long)pipeline_cache->bytes_saved );
+	fprintf( output, "%s  \"save_ms\": %.3f\n", indentation, (double)pipeline_cache->save_nanoseconds / 1.0e6 );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,443 @@
+// Per-frame profiler. CPU phase timers wrap the blocking calls in draw() (frame fence, acquire, submit,
+// present) and every frame's primary command buffer writes GPU timestamps around its barriers and clear.
+//
+// GPU results are never waited on: a frame's timestamps are read back once draw() has waited on its frame
+// slot's fence anyway (reusing the slot, or noticing the frame completed), so the data is a few frames old
+// but the read can't stall. Completed frames land in a fixed size ring (PROFILER_HISTORY_SIZE) that can be
+// summarized (rolling min / avg / max) or exported as CSV / JSON.
+//
+// Unity built -- included by vulkan_renderer.c after the dispatch table, before Vulkan_Context.
+
+#define PROFILER_HISTORY_SIZE 		256
+
+// NOTE: each frame slot owns one range of queries for its lifetime -- a slot's range is only reset by its next
+// frame, after the slot's fence said the previous one is done. So one range per slot of the largest frame ring
+// (FRAME_RING_CAPACITY in vulkan_renderer.c, which checks the two agree); swap chain rebuilds don't matter.
+#define PROFILER_QUERY_RANGES		8
+
+typedef enum {
+
+	GPU_TIMESTAMP_BEGIN,
+	GPU_TIMESTAMP_BARRIER_TO_CLEAR,
+	GPU_TIMESTAMP_CLEAR,
+	GPU_TIMESTAMP_END,
+	COUNT_OF_GPU_TIMESTAMPS
+
+} Gpu_Timestamp;
+
+typedef enum {
+
+	PROFILE_METRIC_CPU_WAIT_FOR_FRAME,
+	PROFILE_METRIC_CPU_ACQUIRE,
+	PROFILE_METRIC_CPU_RECORD,
+	PROFILE_METRIC_CPU_SUBMIT,
+	PROFILE_METRIC_CPU_PRESENT,
+	PROFILE_METRIC_CPU_FRAME,
+	PROFILE_METRIC_GPU_BARRIERS,
+	PROFILE_METRIC_GPU_CLEAR,
+	PROFILE_METRIC_GPU_FRAME,
+	COUNT_OF_PROFILE_METRICS
+
+} Profile_Metric;
+
+char *profile_metric_names[COUNT_OF_PROFILE_METRICS] = {
+	"cpu_wait_for_frame",
+	"cpu_acquire",
+	"cpu_record",
+	"cpu_submit",
+	"cpu_present",
+	"cpu_frame",
+	"gpu_barriers",
+	"gpu_clear",
+	"gpu_frame",
+};
+
+char *
+get_present_mode_name( VkPresentModeKHR present_mode )
+{
+	switch ( present_mode ) {
+		case VK_PRESENT_MODE_IMMEDIATE_KHR:		return "immediate";
+		case VK_PRESENT_MODE_MAILBOX_KHR:		return "mailbox";
+		case VK_PRESENT_MODE_FIFO_KHR:			return "fifo";
+		case VK_PRESENT_MODE_FIFO_RELAXED_KHR:	return "fifo_relaxed";
+		default:								return "unknown";
+	}
+}
+
+typedef struct {
+
+	uint64_t		frame_number;
+	uint64_t		nanoseconds[COUNT_OF_PROFILE_METRICS];
+	bool			gpu_valid;			// false -- GPU timing unsupported or results weren't available
+	VkPresentModeKHR	present_mode;	// swap chain the frame was presented to -- the policy can change it at runtime
+	uint32_t		descriptor_sets;	// allocated from the frame's descriptor pools
+
+} Frame_Profile;
+
+typedef struct {
+
+	double			minimum;
+	double			average;
+	double			maximum;
+
+} Profile_Statistic;
+
+typedef struct {
+
+	Frame_Profile	history[PROFILER_HISTORY_SIZE];
+	uint64_t		count_of_frames_profiled;			// history index -- count_of_frames_profiled % PROFILER_HISTORY_SIZE
+
+	Frame_Profile	current;							// frame being timed by draw() right now
+	uint64_t		phase_start[COUNT_OF_PROFILE_METRICS];
+
+	Vulkan_Device_Dispatch	*dispatch;
+
+	bool			gpu_timing_enabled;
+	VkQueryPool		query_pool;
+	uint32_t		next_query_range;
+	double			nanoseconds_per_tick;
+	uint64_t		timestamp_mask;						// timestampValidBits worth of ones
+
+} Frame_Profiler;
+
+
+void
+create_frame_profiler( Frame_Profiler *profiler, Vulkan_Device_Dispatch *dispatch, VkPhysicalDevice physical_device, uint32_t queue_family_index )
+{
+	memset( profiler, 0, sizeof (Frame_Profiler) );
+	profiler->dispatch = dispatch;
+
+	VkPhysicalDeviceProperties device_properties;
+	vkGetPhysicalDeviceProperties( physical_device, &device_properties );
+
+	uint32_t count_of_queue_families;
+	vkGetPhysicalDeviceQueueFamilyProperties( physical_device, &count_of_queue_families, NULL );
+
+	VkQueueFamilyProperties *queue_family_properties;
+	queue_family_properties = (VkQueueFamilyProperties *)malloc( count_of_queue_families * sizeof (VkQueueFamilyProperties) );
+	if ( !queue_family_properties ) {
+		fprintf( stdout, "Unable to allocate space for queue family properties\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	vkGetPhysicalDeviceQueueFamilyProperties( physical_device, &count_of_queue_families, queue_family_properties );
+
+	uint32_t timestamp_valid_bits;
+	timestamp_valid_bits = queue_family_properties[queue_family_index].timestampValidBits;
+	free( queue_family_properties );
+
+	// CPU timers still work without GPU timestamps
+	if ( timestamp_valid_bits == 0 ) {
+		fprintf( stdout, "Queue family doesn't support timestamps -- GPU profiling disabled\n" );
+		return;
+	}
+
+	profiler->nanoseconds_per_tick = (double)device_properties.limits.timestampPeriod;
+	profiler->timestamp_mask       = ( timestamp_valid_bits >= 64 ) ? ~0ull : ( ( 1ull << timestamp_valid_bits ) - 1 );
+
+	VkQueryPoolCreateInfo query_pool_create_info = { 0 };
+	query_pool_create_info.sType 	  = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	query_pool_create_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	query_pool_create_info.queryCount = PROFILER_QUERY_RANGES * COUNT_OF_GPU_TIMESTAMPS;
+
+	VkResult result;
+	result = dispatch->vkCreateQueryPool( dispatch->logical_device, &query_pool_create_info, NULL, &profiler->query_pool );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create the timestamp query pool\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	profiler->gpu_timing_enabled = true;
+
+	return;
+}
+
+void
+destroy_frame_profiler( Frame_Profiler *profiler )
+{
+	if ( profiler->query_pool != VK_NULL_HANDLE ) {
+		profiler->dispatch->vkDestroyQueryPool( profiler->dispatch->logical_device, profiler->query_pool, NULL );
+	}
+
+	return;
+}
+
+uint32_t
+allocate_profiler_query_range( Frame_Profiler *profiler )
+{
+	uint32_t query_range;
+	query_range = profiler->next_query_range;
+	profiler->next_query_range = ( profiler->next_query_range + 1 ) % PROFILER_QUERY_RANGES;
+
+	return query_range;
+}
+
+// NOTE: recorded at the top of the frame slot's primary command buffer each frame -- the slot's range is only
+// reused once its fence has signaled and the previous timestamps were read back, so no host side reset is needed
+void
+record_profiler_reset( Frame_Profiler *profiler, VkCommandBuffer command_buffer, uint32_t query_range )
+{
+	if ( !profiler->gpu_timing_enabled ) {
+		return;
+	}
+
+	profiler->dispatch->vkCmdResetQueryPool( command_buffer, profiler->query_pool, query_range * COUNT_OF_GPU_TIMESTAMPS, COUNT_OF_GPU_TIMESTAMPS );
+
+	return;
+}
+
+void
+record_profiler_timestamp( Frame_Profiler *profiler, VkCommandBuffer command_buffer, uint32_t query_range,
+						   Gpu_Timestamp timestamp, VkPipelineStageFlagBits pipeline_stage )
+{
+	if ( !profiler->gpu_timing_enabled ) {
+		return;
+	}
+
+	profiler->dispatch->vkCmdWriteTimestamp( command_buffer, pipeline_stage, profiler->query_pool, query_range * COUNT_OF_GPU_TIMESTAMPS + timestamp );
+
+	return;
+}
+
+void
+begin_profiler_frame( Frame_Profiler *profiler, uint64_t frame_number )
+{
+	memset( &profiler->current, 0, sizeof (Frame_Profile) );
+	profiler->current.frame_number = frame_number;
+	profiler->phase_start[PROFILE_METRIC_CPU_FRAME] = platform_get_timestamp_in_nanoseconds();
+
+	return;
+}
+
+void
+begin_profiler_cpu_phase( Frame_Profiler *profiler, Profile_Metric metric )
+{
+	profiler->phase_start[metric] = platform_get_timestamp_in_nanoseconds();
+
+	return;
+}
+
+// NOTE: accumulates, so a phase can be entered more than once per frame
+void
+end_profiler_cpu_phase( Frame_Profiler *profiler, Profile_Metric metric )
+{
+	profiler->current.nanoseconds[metric] += platform_get_timestamp_in_nanoseconds() - profiler->phase_start[metric];
+
+	return;
+}
+
+void
+push_frame_profile( Frame_Profiler *profiler, Frame_Profile *frame_profile )
+{
+	profiler->history[profiler->count_of_frames_profiled % PROFILER_HISTORY_SIZE] = *frame_profile;
+	profiler->count_of_frames_profiled += 1;
+
+	return;
+}
+
+// Returns the CPU half of the frame. With GPU timing on the caller parks it with the frame slot
+// until resolve_frame_profile(), otherwise it is already complete and goes straight into the history.
+Frame_Profile
+end_profiler_frame( Frame_Profiler *profiler )
+{
+	end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_FRAME );
+
+	if ( !profiler->gpu_timing_enabled ) {
+		push_frame_profile( profiler, &profiler->current );
+	}
+
+	return profiler->current;
+}
+
+// NOTE: only call once the submission that wrote query_range is known to have completed -- never waits
+void
+resolve_frame_profile( Frame_Profiler *profiler, uint32_t query_range, Frame_Profile *pending_profile )
+{
+	uint64_t timestamps[COUNT_OF_GPU_TIMESTAMPS];
+
+	VkResult result;
+	result = profiler->dispatch->vkGetQueryPoolResults( profiler->dispatch->logical_device, profiler->query_pool,
+														query_range * COUNT_OF_GPU_TIMESTAMPS, COUNT_OF_GPU_TIMESTAMPS,
+														sizeof timestamps, timestamps, sizeof (uint64_t),
+														VK_QUERY_RESULT_64_BIT );
+
+	if ( result == VK_SUCCESS ) {
+		for ( uint32_t i = 0; i < COUNT_OF_GPU_TIMESTAMPS; ++i ) {
+			timestamps[i] &= profiler->timestamp_mask;
+		}
+
+		// masked subtraction handles counters that wrapped between the two writes
+		uint64_t barrier_ticks;
+		uint64_t clear_ticks;
+		uint64_t frame_ticks;
+		barrier_ticks  = ( timestamps[GPU_TIMESTAMP_BARRIER_TO_CLEAR] - timestamps[GPU_TIMESTAMP_BEGIN] ) & profiler->timestamp_mask;
+		barrier_ticks += ( timestamps[GPU_TIMESTAMP_END] - timestamps[GPU_TIMESTAMP_CLEAR] ) & profiler->timestamp_mask;
+		clear_ticks    = ( timestamps[GPU_TIMESTAMP_CLEAR] - timestamps[GPU_TIMESTAMP_BARRIER_TO_CLEAR] ) & profiler->timestamp_mask;
+		frame_ticks    = ( timestamps[GPU_TIMESTAMP_END] - timestamps[GPU_TIMESTAMP_BEGIN] ) & profiler->timestamp_mask;
+
+		pending_profile->nanoseconds[PROFILE_METRIC_GPU_BARRIERS] = (uint64_t)( (double)barrier_ticks * profiler->nanoseconds_per_tick );
+		pending_profile->nanoseconds[PROFILE_METRIC_GPU_CLEAR]    = (uint64_t)( (double)clear_ticks * profiler->nanoseconds_per_tick );
+		pending_profile->nanoseconds[PROFILE_METRIC_GPU_FRAME]    = (uint64_t)( (double)frame_ticks * profiler->nanoseconds_per_tick );
+		pending_profile->gpu_valid = true;
+	}
+
+	push_frame_profile( profiler, pending_profile );
+
+	return;
+}
+
+uint32_t
+get_count_of_frame_profiles( Frame_Profiler *profiler )
+{
+	if ( profiler->count_of_frames_profiled < PROFILER_HISTORY_SIZE ) {
+		return (uint32_t)profiler->count_of_frames_profiled;
+	}
+
+	return PROFILER_HISTORY_SIZE;
+}
+
+// NOTE: i = 0 is the oldest frame still in the ring
+Frame_Profile *
+get_frame_profile( Frame_Profiler *profiler, uint32_t i )
+{
+	uint64_t oldest;
+	oldest = profiler->count_of_frames_profiled - get_count_of_frame_profiles( profiler );
+
+	return &profiler->history[( oldest + i ) % PROFILER_HISTORY_SIZE];
+}
+
+// Rolling min / avg / max over whatever is in the ring, in milliseconds. GPU metrics skip frames without valid results.
+void
+compute_frame_profile_statistics( Frame_Profiler *profiler, Profile_Statistic statistics[COUNT_OF_PROFILE_METRICS] )
+{
+	uint32_t count_of_frame_profiles;
+	count_of_frame_profiles = get_count_of_frame_profiles( profiler );
+
+	for ( uint32_t metric = 0; metric < COUNT_OF_PROFILE_METRICS; ++metric ) {
+		bool gpu_metric = ( metric >= PROFILE_METRIC_GPU_BARRIERS );
+
+		uint64_t minimum = UINT64_MAX;
+		uint64_t maximum = 0;
+		uint64_t sum     = 0;
+		uint32_t count   = 0;
+
+		for ( uint32_t i = 0; i < count_of_frame_profiles; ++i ) {
+			Frame_Profile *frame_profile;
+			frame_profile = get_frame_profile( profiler, i );
+
+			if ( gpu_metric && !frame_profile->gpu_valid ) {
+				continue;
+			}
+
+			uint64_t nanoseconds;
+			nanoseconds = frame_profile->nanoseconds[metric];
+
+			if ( nanoseconds < minimum ) {
+				minimum = nanoseconds;
+			}
+
+			if ( nanoseconds > maximum ) {
+				maximum = nanoseconds;
+			}
+
+			sum   += nanoseconds;
+			count += 1;
+		}
+
+		if ( count == 0 ) {
+			statistics[metric].minimum = 0.0;
+			statistics[metric].average = 0.0;
+			statistics[metric].maximum = 0.0;
+			continue;
+		}
+
+		statistics[metric].minimum = (double)minimum / 1.0e6;
+		statistics[metric].average = (double)sum / (double)count / 1.0e6;
+		statistics[metric].maximum = (double)maximum / 1.0e6;
+	}
+
+	return;
+}
+
+// One row per frame in the ring, oldest first, times in milliseconds. GPU columns are empty when not valid.
+void
+export_frame_profiles_as_csv( Frame_Profiler *profiler, FILE *output )
+{
+	fprintf( output, "frame,present_mode,descriptor_sets" );
+	for ( uint32_t metric = 0; metric < COUNT_OF_PROFILE_METRICS; ++metric ) {
+		fprintf( output, ",%s_ms", profile_metric_names[metric] );
+	}
+	fprintf( output, "\n" );
+
+	uint32_t count_of_frame_profiles;
+	count_of_frame_profiles = get_count_of_frame_profiles( profiler );
+
+	for ( uint32_t i = 0; i < count_of_frame_profiles; ++i ) {
+		Frame_Profile *frame_profile;
+		frame_profile = get_frame_profile( profiler, i );
+
+		fprintf( output, "%llu,%s,%u", (unsigned long long)frame_profile->frame_number, get_present_mode_name( frame_profile->present_mode ),
+				 frame_profile->descriptor_sets );
+		for ( uint32_t metric = 0; metric < COUNT_OF_PROFILE_METRICS; ++metric ) {
+			if ( metric >= PROFILE_METRIC_GPU_BARRIERS && !frame_profile->gpu_valid ) {
+				fprintf( output, "," );
+				continue;
+			}
+
+			fprintf( output, ",%.4f", (double)frame_profile->nanoseconds[metric] / 1.0e6 );
+		}
+		fprintf( output, "\n" );
+	}
+
+	return;
+}
+
+// Rolling statistics, plus every frame in the ring if include_frames. indentation -- prefix for each line so the object can be nested
+void
+export_frame_profiles_as_json( Frame_Profiler *profiler, FILE *output, char *indentation, bool include_frames )
+{
+	Profile_Statistic statistics[COUNT_OF_PROFILE_METRICS];
+	compute_frame_profile_statistics( profiler, statistics );
+
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"gpu_timing\": %s,\n", indentation, profiler->gpu_timing_enabled ? "true" : "false" );
+	fprintf( output, "%s  \"statistics_ms\": {\n", indentation );
+	for ( uint32_t metric = 0; metric < COUNT_OF_PROFILE_METRICS; ++metric ) {
+		fprintf( output, "%s    \"%s\": { \"min\": %.4f, \"avg\": %.4f, \"max\": %.4f }%s\n", indentation,
+				 profile_metric_names[metric],
+				 statistics[metric].minimum, statistics[metric].average, statistics[metric].maximum,
+				 ( metric + 1 < COUNT_OF_PROFILE_METRICS ) ? "," : "" );
+	}
+	fprintf( output, "%s  }%s\n", indentation, include_frames ? "," : "" );
+
+	if ( !include_frames ) {
+		fprintf( output, "%s}", indentation );
+		return;
+	}
+
+	uint32_t count_of_frame_profiles;
+	count_of_frame_profiles = get_count_of_frame_profiles( profiler );
+
+	fprintf( output, "%s  \"frames\": [\n", indentation );
+	for ( uint32_t i = 0; i < count_of_frame_profiles; ++i ) {
+		Frame_Profile *frame_profile;
+		frame_profile = get_frame_profile( profiler, i );
+
+		fprintf( output, "%s    { \"frame\": %llu, \"present_mode\": \"%s\", \"descriptor_sets\": %u", indentation,
+				 (unsigned long long)frame_profile->frame_number, get_present_mode_name( frame_profile->present_mode ),
+				 frame_profile->descriptor_sets );
+		for ( uint32_t metric = 0; metric < COUNT_OF_PROFILE_METRICS; ++metric ) {
+			if ( metric >= PROFILE_METRIC_GPU_BARRIERS && !frame_profile->gpu_valid ) {
+				fprintf( output, ", \"%s\": null", profile_metric_names[metric] );
+				continue;
+			}
+
+			fprintf( output, ", \"%s\": %.4f", profile_metric_names[metric], (double)frame_profile->nanoseconds[metric] / 1.0e6 );
+		}
+		fprintf( output, " }%s\n", ( i + 1 < count_of_frame_profiles ) ? "," : "" );
+	}
+	fprintf( output, "%s  ]\n", indentation );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,481 @@
+// Queue topology. Every queue family of the device is looked at once and each role -- graphics, present,
+// async compute, transfer -- gets a family and as many queues from it as it asked for (and the family has).
+// Roles that end up in the same family get their own queue indices while the family has spare queues, and
+// share queue 0 of the family after that. Present shares the graphics queue whenever the graphics family
+// can present, which is the common case and saves a semaphore hop.
+//
+// Cross-queue synchronization lives here too:
+//
+//  - Vulkan_Queue_Submit collects waits / command buffers / signals so a submit can pick up work from
+//    other queues (upload batches, async compute) without the caller juggling parallel arrays
+//  - the *_queue_ownership_* helpers record the release / acquire barrier pair for a resource moving
+//    between two families, or a single plain barrier when both sides are the same family
+//
+// NOTE: two roles sharing a VkQueue also share its external synchronization -- submits to it must not come
+// from two threads at once.
+//
+// Unity built -- included by vulkan_renderer.c after the memory allocator.
+
+#define MAX_QUEUE_FAMILIES				16
+#define MAX_QUEUES_PER_ROLE				4
+
+#define MAX_SUBMIT_WAIT_SEMAPHORES		8
+#define MAX_SUBMIT_COMMAND_BUFFERS		8
+#define MAX_SUBMIT_SIGNAL_SEMAPHORES	4
+
+typedef enum {
+
+	VULKAN_QUEUE_GRAPHICS,
+	VULKAN_QUEUE_PRESENT,
+	VULKAN_QUEUE_COMPUTE,
+	VULKAN_QUEUE_TRANSFER,
+
+	VULKAN_QUEUE_ROLE_COUNT
+
+} Vulkan_Queue_Role;
+
+char *vulkan_queue_role_names[VULKAN_QUEUE_ROLE_COUNT] = {
+	"graphics",
+	"present",
+	"compute",
+	"transfer",
+};
+
+// NOTE: how many queues each role would like and what priority they run at -- the graphics queue is
+// the frame, everything else fills in around it
+uint32_t vulkan_queue_role_requested_counts[VULKAN_QUEUE_ROLE_COUNT] = { 1, 1, 2, 1 };
+float 	 vulkan_queue_role_priorities[VULKAN_QUEUE_ROLE_COUNT] 		 = { 1.0f, 1.0f, 0.5f, 0.25f };
+
+typedef struct {
+
+	uint32_t	family_index;
+	float		priority;
+	bool		is_dedicated;									// family isn't the graphics family
+	uint32_t	count_of_queues;
+	uint32_t	queue_indices[MAX_QUEUES_PER_ROLE];				// within the family
+	VkQueue		queues[MAX_QUEUES_PER_ROLE];
+
+} Vulkan_Queue_Role_Assignment;
+
+typedef struct {
+
+	uint32_t					count_of_queue_families;
+	VkQueueFamilyProperties		queue_family_properties[MAX_QUEUE_FAMILIES];
+
+	Vulkan_Queue_Role_Assignment	roles[VULKAN_QUEUE_ROLE_COUNT];
+
+	// handed straight to VkDeviceCreateInfo -- one entry per family in use
+	uint32_t					count_of_queue_create_infos;
+	VkDeviceQueueCreateInfo		queue_create_infos[VULKAN_QUEUE_ROLE_COUNT];
+	float						queue_priorities[VULKAN_QUEUE_ROLE_COUNT][VULKAN_QUEUE_ROLE_COUNT * MAX_QUEUES_PER_ROLE];
+
+} Vulkan_Queue_Topology;
+
+typedef struct {
+
+	uint32_t				count_of_wait_semaphores;
+	VkSemaphore				wait_semaphores[MAX_SUBMIT_WAIT_SEMAPHORES];
+	VkPipelineStageFlags	wait_stages[MAX_SUBMIT_WAIT_SEMAPHORES];
+
+	uint32_t				count_of_command_buffers;
+	VkCommandBuffer			command_buffers[MAX_SUBMIT_COMMAND_BUFFERS];
+
+	uint32_t				count_of_signal_semaphores;
+	VkSemaphore				signal_semaphores[MAX_SUBMIT_SIGNAL_SEMAPHORES];
+
+} Vulkan_Queue_Submit;
+
+
+int
+find_queue_family_with_flags( Vulkan_Queue_Topology *topology, VkQueueFlags required_flags, VkQueueFlags excluded_flags )
+{
+	for ( uint32_t i = 0; i < topology->count_of_queue_families; ++i ) {
+		VkQueueFlags queue_flags;
+		queue_flags = topology->queue_family_properties[i].queueFlags;
+
+		if ( topology->queue_family_properties[i].queueCount < 1 ) {
+			continue;
+		}
+
+		if ( ( queue_flags & required_flags ) == required_flags && ( queue_flags & excluded_flags ) == 0 ) {
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+void
+assign_vulkan_queue_role( Vulkan_Queue_Topology *topology, Vulkan_Queue_Role role, uint32_t family_index,
+						  uint32_t *count_of_queues_used_per_family )
+{
+	Vulkan_Queue_Role_Assignment *assignment;
+	assignment = &topology->roles[role];
+
+	assignment->family_index = family_index;
+	assignment->priority 	 = vulkan_queue_role_priorities[role];
+
+	uint32_t count_of_queues_in_family;
+	count_of_queues_in_family = topology->queue_family_properties[family_index].queueCount;
+
+	uint32_t count_of_requested_queues;
+	count_of_requested_queues = vulkan_queue_role_requested_counts[role];
+
+	for ( uint32_t i = 0; i < count_of_requested_queues; ++i ) {
+		if ( count_of_queues_used_per_family[family_index] >= count_of_queues_in_family ) {
+			break;
+		}
+
+		assignment->queue_indices[assignment->count_of_queues++] = count_of_queues_used_per_family[family_index]++;
+	}
+
+	// family is out of queues -- share the first one
+	if ( assignment->count_of_queues == 0 ) {
+		assignment->queue_indices[0] = 0;
+		assignment->count_of_queues  = 1;
+	}
+
+	return;
+}
+
+// Everything after the family probe: compute / transfer families, queue indices and the create infos.
+// NOTE: count_of_queue_families and queue_family_properties must already be filled in, the rest zeroed --
+// the startup cache replays this with the families it remembered instead of probing the surface again
+void
+assign_vulkan_queue_topology( Vulkan_Queue_Topology *topology, uint32_t graphics_family_index, uint32_t present_family_index )
+{
+	// async compute -- a compute family without graphics, otherwise compute rides on the graphics family
+	int compute_family_index;
+	compute_family_index = find_queue_family_with_flags( topology, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT );
+	if ( compute_family_index == -1 ) {
+		compute_family_index = (int)graphics_family_index;
+	}
+
+	// DMA engines -- transfer only, then anything without graphics, then the graphics family.
+	// NOTE: graphics and compute families implicitly support transfers, only the rest have to say so
+	int transfer_family_index;
+	transfer_family_index = find_queue_family_with_flags( topology, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT );
+	if ( transfer_family_index == -1 ) {
+		transfer_family_index = compute_family_index;
+	}
+
+	uint32_t count_of_queues_used_per_family[MAX_QUEUE_FAMILIES] = { 0 };
+
+	assign_vulkan_queue_role( topology, VULKAN_QUEUE_GRAPHICS, graphics_family_index, count_of_queues_used_per_family );
+
+	if ( present_family_index == graphics_family_index ) {
+		topology->roles[VULKAN_QUEUE_PRESENT] = topology->roles[VULKAN_QUEUE_GRAPHICS];
+		topology->roles[VULKAN_QUEUE_PRESENT].count_of_queues = 1;
+	}
+	else {
+		assign_vulkan_queue_role( topology, VULKAN_QUEUE_PRESENT, present_family_index, count_of_queues_used_per_family );
+	}
+
+	assign_vulkan_queue_role( topology, VULKAN_QUEUE_COMPUTE, compute_family_index, count_of_queues_used_per_family );
+	assign_vulkan_queue_role( topology, VULKAN_QUEUE_TRANSFER, transfer_family_index, count_of_queues_used_per_family );
+
+	for ( uint32_t role = 0; role < VULKAN_QUEUE_ROLE_COUNT; ++role ) {
+		topology->roles[role].is_dedicated = ( topology->roles[role].family_index != graphics_family_index );
+	}
+
+	// one create info per family in use, each queue index at the priority of the role that claimed it first
+	for ( uint32_t family_index = 0; family_index < topology->count_of_queue_families; ++family_index ) {
+		if ( count_of_queues_used_per_family[family_index] == 0 ) {
+			continue;
+		}
+
+		uint32_t create_info_index;
+		create_info_index = topology->count_of_queue_create_infos++;
+
+		float *queue_priorities;
+		queue_priorities = topology->queue_priorities[create_info_index];
+
+		for ( uint32_t role = 0; role < VULKAN_QUEUE_ROLE_COUNT; ++role ) {
+			Vulkan_Queue_Role_Assignment *assignment;
+			assignment = &topology->roles[role];
+
+			if ( assignment->family_index != family_index ) {
+				continue;
+			}
+
+			for ( uint32_t i = 0; i < assignment->count_of_queues; ++i ) {
+				uint32_t queue_index;
+				queue_index = assignment->queue_indices[i];
+
+				if ( queue_priorities[queue_index] == 0.0f ) {
+					queue_priorities[queue_index] = assignment->priority;
+				}
+			}
+		}
+
+		VkDeviceQueueCreateInfo *queue_create_info;
+		queue_create_info = &topology->queue_create_infos[create_info_index];
+		queue_create_info->sType 			= VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queue_create_info->queueFamilyIndex = family_index;
+		queue_create_info->queueCount 		= count_of_queues_used_per_family[family_index];
+		queue_create_info->pQueuePriorities = queue_priorities;
+	}
+
+	return;
+}
+
+// NOTE: the create infos point into the topology's own priority arrays -- select into the struct that
+// outlives vkCreateDevice, don't copy it
+void
+select_vulkan_queue_topology( Vulkan_Queue_Topology *topology, VkPhysicalDevice physical_device, VkSurfaceKHR surface )
+{
+	memset( topology, 0, sizeof (Vulkan_Queue_Topology) );
+
+	vkGetPhysicalDeviceQueueFamilyProperties( physical_device, &topology->count_of_queue_families, NULL );
+	if ( topology->count_of_queue_families == 0 ) {
+		fprintf( stdout, "Zero queue families found for the device\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( topology->count_of_queue_families > MAX_QUEUE_FAMILIES ) {
+		topology->count_of_queue_families = MAX_QUEUE_FAMILIES;
+	}
+
+	vkGetPhysicalDeviceQueueFamilyProperties( physical_device, &topology->count_of_queue_families, topology->queue_family_properties );
+
+	// NOTE: graphics + present in one family beats any split, so look for that first
+	int graphics_family_index = -1;
+	int present_family_index  = -1;
+	for ( uint32_t i = 0; i < topology->count_of_queue_families; ++i ) {
+		if ( topology->queue_family_properties[i].queueCount < 1 ) {
+			continue;
+		}
+
+		VkBool32 has_presentation_support;
+		vkGetPhysicalDeviceSurfaceSupportKHR( physical_device, i, surface, &has_presentation_support );
+
+		bool has_graphics_support;
+		has_graphics_support = ( topology->queue_family_properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT ) != 0;
+
+		if ( has_graphics_support && has_presentation_support == VK_TRUE ) {
+			graphics_family_index = (int)i;
+			present_family_index  = (int)i;
+			break;
+		}
+
+		if ( has_graphics_support && graphics_family_index == -1 ) {
+			graphics_family_index = (int)i;
+		}
+
+		if ( has_presentation_support == VK_TRUE && present_family_index == -1 ) {
+			present_family_index = (int)i;
+		}
+	}
+
+	if ( graphics_family_index == -1 || present_family_index == -1 ) {
+		fprintf( stdout, "Unable to find queue families that support graphics and presentation to selected surface\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	assign_vulkan_queue_topology( topology, (uint32_t)graphics_family_index, (uint32_t)present_family_index );
+
+	return;
+}
+
+void
+get_vulkan_queues( Vulkan_Queue_Topology *topology, Vulkan_Device_Dispatch *dispatch )
+{
+	for ( uint32_t role = 0; role < VULKAN_QUEUE_ROLE_COUNT; ++role ) {
+		Vulkan_Queue_Role_Assignment *assignment;
+		assignment = &topology->roles[role];
+
+		for ( uint32_t i = 0; i < assignment->count_of_queues; ++i ) {
+			dispatch->vkGetDeviceQueue( dispatch->logical_device, assignment->family_index, assignment->queue_indices[i], &assignment->queues[i] );
+		}
+	}
+
+	return;
+}
+
+void
+export_vulkan_queue_topology_as_json( Vulkan_Queue_Topology *topology, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	for ( uint32_t role = 0; role < VULKAN_QUEUE_ROLE_COUNT; ++role ) {
+		Vulkan_Queue_Role_Assignment *assignment;
+		assignment = &topology->roles[role];
+
+		fprintf( output, "%s  \"%s\": { \"family\": %u, \"queues\": %u, \"priority\": %.2f, \"dedicated\": %s }%s\n",
+				 indentation, vulkan_queue_role_names[role], assignment->family_index, assignment->count_of_queues,
+				 assignment->priority, assignment->is_dedicated ? "true" : "false",
+				 role + 1 < VULKAN_QUEUE_ROLE_COUNT ? "," : "" );
+	}
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
+
+// Distinct families in use, for VK_SHARING_MODE_CONCURRENT resources touched by several roles.
+// Returns the count, 1 means exclusive sharing is fine.
+uint32_t
+get_vulkan_queue_families_for_roles( Vulkan_Queue_Topology *topology, Vulkan_Queue_Role *roles, uint32_t count_of_roles,
+									 uint32_t *family_indices )
+{
+	uint32_t count_of_family_indices = 0;
+
+	for ( uint32_t i = 0; i < count_of_roles; ++i ) {
+		uint32_t family_index;
+		family_index = topology->roles[roles[i]].family_index;
+
+		bool already_listed = false;
+		for ( uint32_t j = 0; j < count_of_family_indices; ++j ) {
+			if ( family_indices[j] == family_index ) {
+				already_listed = true;
+			}
+		}
+
+		if ( !already_listed ) {
+			family_indices[count_of_family_indices++] = family_index;
+		}
+	}
+
+	return count_of_family_indices;
+}
+
+void
+add_submit_wait( Vulkan_Queue_Submit *submit, VkSemaphore semaphore, VkPipelineStageFlags wait_stage )
+{
+	if ( submit->count_of_wait_semaphores == MAX_SUBMIT_WAIT_SEMAPHORES ) {
+		fprintf( stdout, "Too many wait semaphores for one submit\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	submit->wait_semaphores[submit->count_of_wait_semaphores] = semaphore;
+	submit->wait_stages[submit->count_of_wait_semaphores] 	  = wait_stage;
+	submit->count_of_wait_semaphores += 1;
+
+	return;
+}
+
+void
+add_submit_command_buffer( Vulkan_Queue_Submit *submit, VkCommandBuffer command_buffer )
+{
+	if ( submit->count_of_command_buffers == MAX_SUBMIT_COMMAND_BUFFERS ) {
+		fprintf( stdout, "Too many command buffers for one submit\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	submit->command_buffers[submit->count_of_command_buffers++] = command_buffer;
+
+	return;
+}
+
+void
+add_submit_signal( Vulkan_Queue_Submit *submit, VkSemaphore semaphore )
+{
+	if ( submit->count_of_signal_semaphores == MAX_SUBMIT_SIGNAL_SEMAPHORES ) {
+		fprintf( stdout, "Too many signal semaphores for one submit\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	submit->signal_semaphores[submit->count_of_signal_semaphores++] = semaphore;
+
+	return;
+}
+
+VkResult
+submit_to_queue( Vulkan_Device_Dispatch *dispatch, VkQueue queue, Vulkan_Queue_Submit *submit, VkFence fence )
+{
+	VkSubmitInfo submit_info = { 0 };
+	submit_info.sType 				 = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.waitSemaphoreCount 	 = submit->count_of_wait_semaphores;
+	submit_info.pWaitSemaphores 	 = submit->wait_semaphores;
+	submit_info.pWaitDstStageMask 	 = submit->wait_stages;
+	submit_info.commandBufferCount 	 = submit->count_of_command_buffers;
+	submit_info.pCommandBuffers 	 = submit->command_buffers;
+	submit_info.signalSemaphoreCount = submit->count_of_signal_semaphores;
+	submit_info.pSignalSemaphores 	 = submit->signal_semaphores;
+
+	return dispatch->vkQueueSubmit( queue, 1, &submit_info, fence );
+}
+
+// Moves a buffer range from one queue family to another. The release half goes into a command buffer on the
+// source queue, the acquire half into one on the destination queue, and the caller orders the two with a
+// semaphore. Same family -- the semaphore already makes the writes visible, nothing to record.
+// Returns whether anything went into acquire_command_buffer.
+bool
+record_buffer_queue_ownership_transfer( Vulkan_Device_Dispatch *dispatch,
+										VkCommandBuffer release_command_buffer, uint32_t source_family_index,
+										VkPipelineStageFlags source_stage, VkAccessFlags source_access,
+										VkCommandBuffer acquire_command_buffer, uint32_t destination_family_index,
+										VkPipelineStageFlags destination_stage, VkAccessFlags destination_access,
+										VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size )
+{
+	if ( source_family_index == destination_family_index ) {
+		return false;
+	}
+
+	VkBufferMemoryBarrier ownership_barrier = { 0 };
+	ownership_barrier.sType 			  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	ownership_barrier.srcQueueFamilyIndex = source_family_index;
+	ownership_barrier.dstQueueFamilyIndex = destination_family_index;
+	ownership_barrier.buffer 			  = buffer;
+	ownership_barrier.offset 			  = offset;
+	ownership_barrier.size 				  = size;
+
+	// release -- dst access is ignored on the releasing queue
+	ownership_barrier.srcAccessMask = source_access;
+	ownership_barrier.dstAccessMask = 0;
+	dispatch->vkCmdPipelineBarrier( release_command_buffer, source_stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+									0, 0, NULL, 1, &ownership_barrier, 0, NULL );
+
+	// acquire -- src access is ignored on the acquiring queue
+	ownership_barrier.srcAccessMask = 0;
+	ownership_barrier.dstAccessMask = destination_access;
+	dispatch->vkCmdPipelineBarrier( acquire_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, destination_stage,
+									0, 0, NULL, 1, &ownership_barrier, 0, NULL );
+
+	return true;
+}
+
+// Same for an image, with an optional layout change folded in. Both halves must describe the identical
+// transition. Same family -- a single barrier on the source queue does the layout change.
+bool
+record_image_queue_ownership_transfer( Vulkan_Device_Dispatch *dispatch,
+									   VkCommandBuffer release_command_buffer, uint32_t source_family_index,
+									   VkPipelineStageFlags source_stage, VkAccessFlags source_access,
+									   VkCommandBuffer acquire_command_buffer, uint32_t destination_family_index,
+									   VkPipelineStageFlags destination_stage, VkAccessFlags destination_access,
+									   VkImage image, VkImageSubresourceRange subresource_range,
+									   VkImageLayout old_layout, VkImageLayout new_layout )
+{
+	VkImageMemoryBarrier ownership_barrier = { 0 };
+	ownership_barrier.sType 			  = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	ownership_barrier.oldLayout 		  = old_layout;
+	ownership_barrier.newLayout 		  = new_layout;
+	ownership_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	ownership_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	ownership_barrier.image 			  = image;
+	ownership_barrier.subresourceRange 	  = subresource_range;
+
+	if ( source_family_index == destination_family_index ) {
+		if ( old_layout != new_layout ) {
+			ownership_barrier.srcAccessMask = source_access;
+			ownership_barrier.dstAccessMask = 0;
+			dispatch->vkCmdPipelineBarrier( release_command_buffer, source_stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+											0, 0, NULL, 0, NULL, 1, &ownership_barrier );
+		}
+
+		return false;
+	}
+
+	ownership_barrier.srcQueueFamilyIndex = source_family_index;
+	ownership_barrier.dstQueueFamilyIndex = destination_family_index;
+
+	ownership_barrier.srcAccessMask = source_access;
+	ownership_barrier.dstAccessMask = 0;
+	dispatch->vkCmdPipelineBarrier( release_command_buffer, source_stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+									0, 0, NULL, 0, NULL, 1, &ownership_barrier );
+
+	ownership_barrier.srcAccessMask = 0;
+	ownership_barrier.dstAccessMask = destination_access;
+	dispatch->vkCmdPipelineBarrier( acquire_command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, destination_stage,
+									0, 0, NULL, 0, NULL, 1, &ownership_barrier );
+
+	return true;
+}
@@ -0,0 +1,2396 @@
+// Platform independent half of the playground. Unity built -- the including file first pulls in a
+// platform layer (win32_platform.c / linux_platform.c) which brings in the Vulkan headers and provides
+// vkGetInstanceProcAddr plus the platform_* services, and it defines PLATFORM_SURFACE_EXTENSION_NAME
+// for the kind of surface it is going to create.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+// Load at global level (no instance)
+PFN_vkCreateInstance							vkCreateInstance;
+PFN_vkEnumerateInstanceExtensionProperties		vkEnumerateInstanceExtensionProperties;
+PFN_vkEnumerateInstanceLayerProperties			vkEnumerateInstanceLayerProperties;
+PFN_vkEnumerateInstanceVersion					vkEnumerateInstanceVersion;			// NULL -- 1.0 loader
+
+// Load at instance level
+PFN_vkEnumeratePhysicalDevices  				vkEnumeratePhysicalDevices;
+PFN_vkEnumerateDeviceExtensionProperties		vkEnumerateDeviceExtensionProperties;
+PFN_vkGetPhysicalDeviceProperties				vkGetPhysicalDeviceProperties;
+PFN_vkGetPhysicalDeviceFeatures					vkGetPhysicalDeviceFeatures;
+PFN_vkGetPhysicalDeviceMemoryProperties			vkGetPhysicalDeviceMemoryProperties;
+PFN_vkGetPhysicalDeviceQueueFamilyProperties    vkGetPhysicalDeviceQueueFamilyProperties;
+PFN_vkCreateDevice								vkCreateDevice;
+PFN_vkGetDeviceProcAddr							vkGetDeviceProcAddr;
+PFN_vkDestroyInstance							vkDestroyInstance;
+
+// Load at instance level -- core 1.1, only used on a 1.2 instance
+PFN_vkGetPhysicalDeviceFeatures2				vkGetPhysicalDeviceFeatures2;
+PFN_vkGetPhysicalDeviceProperties2				vkGetPhysicalDeviceProperties2;
+
+// Load at instance level -- extensions
+PFN_vkDestroySurfaceKHR							vkDestroySurfaceKHR;
+PFN_vkGetPhysicalDeviceSurfaceSupportKHR		vkGetPhysicalDeviceSurfaceSupportKHR;
+PFN_vkGetPhysicalDeviceSurfaceFormatsKHR		vkGetPhysicalDeviceSurfaceFormatsKHR;
+PFN_vkGetPhysicalDeviceSurfacePresentModesKHR	vkGetPhysicalDeviceSurfacePresentModesKHR;
+PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR   vkGetPhysicalDeviceSurfaceCapabilitiesKHR;
+PFN_vkCreateDebugUtilsMessengerEXT				vkCreateDebugUtilsMessengerEXT;
+PFN_vkDestroyDebugUtilsMessengerEXT				vkDestroyDebugUtilsMessengerEXT;
+PFN_vkCreateHeadlessSurfaceEXT					vkCreateHeadlessSurfaceEXT;
+
+// NOTE: device level commands live in Vulkan_Context::dispatch, one table per VkDevice
+#include "vulkan_dispatch.c"
+
+// Globals
+char *required_instance_extensions[] = {
+	VK_KHR_SURFACE_EXTENSION_NAME,
+	PLATFORM_SURFACE_EXTENSION_NAME,
+};
+
+uint32_t count_of_required_instance_extensions = (sizeof required_instance_extensions) / (sizeof required_instance_extensions[0]);
+
+char *required_device_extensions[] = {
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+};
+
+uint32_t count_of_required_device_extensions = (sizeof required_device_extensions) / (sizeof required_device_extensions[0]);
+
+// enabled when the device has them, everything keeps working without
+char *optional_device_extensions[] = {
+	VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,
+};
+
+uint32_t count_of_optional_device_extensions = (sizeof optional_device_extensions) / (sizeof optional_device_extensions[0]);
+
+// required + whatever optional extensions the device turned out to support
+#define MAX_ENABLED_DEVICE_EXTENSIONS 16
+
+char *validation_layers[] = {
+	"VK_LAYER_KHRONOS_validation",
+};
+
+uint32_t count_of_validation_layers = (sizeof validation_layers) / (sizeof validation_layers[0]);
+
+#include "job_system.c"
+#include "spsc_queue.c"
+#include "vulkan_profiler.c"
+#include "frame_pacer.c"
+#include "vulkan_memory.c"
+#include "vulkan_queues.c"
+#include "vulkan_startup_cache.c"
+#include "vulkan_device_selection.c"
+#include "vulkan_upload.c"
+#include "vulkan_pipeline_cache.c"
+#include "vulkan_object_cache.c"
+#include "vulkan_descriptors.c"
+#include "vulkan_bindless.c"
+#include "vulkan_shader_cache.c"
+#include "mesh_format.c"
+#include "asset_streaming.c"
+
+// NOTE: upper bound on the frame ring -- the number actually used is picked at startup (max_frames_in_flight)
+#define FRAME_RING_CAPACITY 		8
+#define DEFAULT_FRAMES_IN_FLIGHT 	2
+
+#if FRAME_RING_CAPACITY > PROFILER_QUERY_RANGES
+#error "every frame slot needs its own profiler query range"
+#endif
+
+// NOTE: one worker may end up recording every task of a frame, so each worker pool can hold that many
+#define MAX_RECORDING_TASKS			32
+
+// Command pool of one worker for one frame slot. Secondaries stay allocated across frames -- vkResetCommandPool
+// recycles their memory wholesale once the slot's fence has signaled, no per-buffer resets.
+typedef struct {
+
+	VkCommandPool		command_pool;
+	uint32_t			count_of_command_buffers;			// allocated so far
+	uint32_t			count_of_command_buffers_used;		// this frame
+	VkCommandBuffer		command_buffers[MAX_RECORDING_TASKS];
+
+} Vulkan_Worker_Command_Pool;
+
+// One slot of the frame ring. The CPU only reuses a slot once the GPU has signaled its fence,
+// so up to max_frames_in_flight frames can be queued before draw() blocks.
+typedef struct {
+
+	VkSemaphore			image_available;
+	VkFence				submit_complete;
+	uint64_t			frame_number;			// 0 -- slot has never been submitted
+
+	Vulkan_Worker_Command_Pool	worker_command_pools[MAX_JOB_WORKERS];
+	Vulkan_Descriptor_Pool_List	descriptor_pools[MAX_JOB_WORKERS];		// per worker too -- reset with the command pools
+	VkCommandBuffer		command_buffer;			// primary, from worker 0's pool -- stitches the secondaries together
+	uint32_t			query_range;			// timestamps written by command_buffer
+	Frame_Profile		pending_profile;		// CPU half of the last frame, waiting on its GPU timestamps
+	bool				has_pending_profile;
+
+	uint64_t			paced_start;			// when the pacer let the frame's CPU work begin
+	uint64_t			paced_deadline;			// when its GPU work should be done by
+	uint64_t			submitted_at;
+	bool				completion_pending;		// the pacer hasn't seen this frame's fence signal yet
+
+} Vulkan_Frame;
+
+typedef struct {
+
+	VkImage				image;
+	VkFence				in_flight;				// fence of the last frame that rendered to this image
+	VkSemaphore			rendering_complete;		// signaled by the submit, waited on by the present of this image
+
+} Vulkan_Swap_Chain_Image;
+
+// What a recording task gets to see. The target image is in whatever layout the pass declared it with
+// (frame graph usage) while the pass's commands run.
+typedef struct {
+
+	Vulkan_Device_Dispatch	*dispatch;
+	VkImage				image;
+	VkExtent2D			extent;
+	VkClearColorValue	clear_color;
+	uint64_t			frame_number;
+	uint32_t			frame_slot;				// index into the frame ring, for per-slot resources
+
+} Vulkan_Frame_Target;
+
+// One secondary command buffer per live frame graph pass per frame, recorded on whichever worker picks it up
+// and executed by the frame's primary in pass order -- the GPU sees the same order no matter who recorded what
+typedef void Record_Commands_Function( Vulkan_Frame_Target *target, VkCommandBuffer command_buffer, void *data );
+
+#include "frame_graph.c"
+#include "vector_math.c"
+#include "frustum_culling.c"
+#include "vulkan_gpu_scene.c"
+
+// How the swap chain paces presentation. Each policy lists the modes it wants, best first; FIFO is the
+// only mode every driver has to support, so it always ends the list.
+typedef enum {
+
+	PRESENT_POLICY_LOW_LATENCY,		// MAILBOX, then IMMEDIATE -- newest frame wins, IMMEDIATE can tear
+	PRESENT_POLICY_VSYNC,			// FIFO -- never tears, GPU idles between vblanks, up to a queue of latency
+	PRESENT_POLICY_ADAPTIVE,		// FIFO_RELAXED -- vsync until a frame misses its vblank, then tears instead of stuttering
+	COUNT_OF_PRESENT_POLICIES
+
+} Present_Policy;
+
+char *present_policy_names[COUNT_OF_PRESENT_POLICIES] = {
+	"low_latency",
+	"vsync",
+	"adaptive",
+};
+
+#define MAX_PRESENT_MODE_PREFERENCES 3
+
+VkPresentModeKHR present_policy_preferences[COUNT_OF_PRESENT_POLICIES][MAX_PRESENT_MODE_PREFERENCES] = {
+	{ VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR },
+	{ VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR },
+	{ VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR },
+};
+
+#define MAX_RETIRED_SWAP_CHAINS 4
+
+// A swap chain replaced by a rebuild. It stays alive (and keeps its command buffers) until the last
+// frame submitted against it has completed -- no device-wide idle needed.
+typedef struct {
+
+	VkSwapchainKHR			swap_chain;
+	Vulkan_Swap_Chain_Image *images;
+	uint32_t				count_of_images;
+	uint64_t				last_frame_number;
+
+} Vulkan_Retired_Swap_Chain;
+
+typedef struct {
+
+	VkInstance 			instance;
+	uint32_t			instance_api_version;			// what the application info asked for -- 1.2 if the loader has it
+	VkPhysicalDevice	physical_device;
+	VkPhysicalDeviceProperties	physical_device_properties;
+	VkPhysicalDeviceFeatures	enabled_features;				// filled in by the probes that need features, all off otherwise
+	VkPhysicalDeviceVulkan12Features	enabled_vulkan_12_features;
+	VkDevice			logical_device;
+	Vulkan_Device_Dispatch	dispatch;
+	char				*enabled_device_extensions[MAX_ENABLED_DEVICE_EXTENSIONS];
+	uint32_t			count_of_enabled_device_extensions;
+	VkSurfaceKHR 		surface;
+	Vulkan_Queue_Topology	queue_topology;
+	uint32_t 			queue_family_index;				// graphics -- command pools, barriers, timestamps
+	uint32_t			present_queue_family_index;
+	uint32_t			transfer_queue_family_index;	// same as queue_family_index when there's no dedicated one
+	VkQueue				graphics_queue;
+	VkQueue				present_queue;					// the graphics queue when that family can present
+	VkQueue				transfer_queue;
+	VkSwapchainKHR		swap_chain;
+	VkExtent2D			swap_chain_extent;
+	VkExtent2D			window_extent;				// client area -- 0x0 while minimized
+	bool				swap_chain_needs_rebuild;
+	Present_Policy		present_policy;				// PLAYGROUND_PRESENT_MODE -- switch with set_present_policy()
+	VkPresentModeKHR	present_mode;				// what the policy resolved to on this surface
+	uint32_t			count_of_swap_chain_images;
+	Vulkan_Swap_Chain_Image *swap_chain_images;
+	VkClearColorValue	clear_color;
+
+	Job_System			jobs;
+	Frame_Graph			frame_graph;
+	uint32_t			swap_chain_resource;		// frame graph image bound to the acquired swap chain image
+
+	Vulkan_Retired_Swap_Chain	retired_swap_chains[MAX_RETIRED_SWAP_CHAINS];
+	uint32_t					count_of_retired_swap_chains;
+
+	Vulkan_Frame		frames[FRAME_RING_CAPACITY];
+	uint32_t			max_frames_in_flight;
+	uint32_t			current_frame;
+	uint64_t			count_of_frames_submitted;
+	uint64_t			last_completed_frame_number;
+	uint32_t			frames_currently_in_flight;
+	uint32_t			peak_frames_in_flight;
+
+	bool						validation_enabled;
+	VkDebugUtilsMessengerEXT	debug_messenger;
+	uint32_t					count_of_validation_errors;
+	uint32_t					count_of_validation_warnings;
+
+	Frame_Profiler		profiler;
+	double				target_frames_per_second;		// 0 -- PLAYGROUND_TARGET_FPS, else no frame rate target
+	double				latency_budget_milliseconds;	// 0 -- PLAYGROUND_LATENCY_BUDGET_MS, else no latency target
+	Frame_Pacer			pacer;
+	Vulkan_Memory_Allocator	memory;
+	Vulkan_Uploader		uploader;
+	char				*pipeline_cache_path;			// NULL -- pipeline cache isn't persisted
+	Vulkan_Pipeline_Cache	pipeline_cache;
+	Vulkan_Object_Cache	object_cache;					// render passes, framebuffers, samplers, layouts
+	Vulkan_Descriptor_Allocator	descriptors;
+	bool				bindless_requested;				// also on with PLAYGROUND_BINDLESS
+	Vulkan_Bindless		bindless;						// enabled only if requested and the device has descriptor indexing
+	char				*shader_directory;				// NULL -- PLAYGROUND_SHADER_DIRECTORY, else "shaders"
+	bool				shader_hot_reload;				// watch the shader directory and swap changed shaders in
+	Vulkan_Shader_Cache	shader_cache;
+	uint32_t			gpu_scene_object_count;			// 0 -- PLAYGROUND_GPU_SCENE, still 0 means no GPU driven scene
+	Vulkan_Gpu_Scene	gpu_scene;						// enabled only if asked for and the device has indirect count
+	Asset_Streamer		streamer;
+	char				*stream_assets;					// NULL -- PLAYGROUND_STREAM, "a.mesh;b.bin" requested at startup
+	char				*startup_cache_path;			// NULL -- every start probes from scratch
+	Vulkan_Startup_Cache	startup_cache;
+	char				*device_override;				// NULL -- PLAYGROUND_DEVICE, else the best scored device
+	char				*device_override_source;		// NULL -- "device_override", named in the fallback messages
+	bool				device_benchmark_enabled;		// also on with PLAYGROUND_DEVICE_BENCHMARK
+	Vulkan_Device_Selection	device_selection;
+
+} Vulkan_Context;
+
+
+void 
+load_vulkan_global_functions( void )
+{
+	// Load from global level (no instance required) -- vkGetInstanceProcAddr comes from the platform layer
+	vkCreateInstance                       = (PFN_vkCreateInstance) 					  vkGetInstanceProcAddr( NULL, "vkCreateInstance" );
+	vkEnumerateInstanceExtensionProperties = (PFN_vkEnumerateInstanceExtensionProperties) vkGetInstanceProcAddr( NULL, "vkEnumerateInstanceExtensionProperties" );
+	vkEnumerateInstanceLayerProperties     = (PFN_vkEnumerateInstanceLayerProperties)     vkGetInstanceProcAddr( NULL, "vkEnumerateInstanceLayerProperties" );
+	vkEnumerateInstanceVersion             = (PFN_vkEnumerateInstanceVersion)             vkGetInstanceProcAddr( NULL, "vkEnumerateInstanceVersion" );
+
+	return;
+}
+
+
+void
+verify_instance_supports_required_extensions( Vulkan_Context *vulkan_context ) 
+{
+	VkResult result;
+	uint32_t count_of_available_instance_extensions;
+
+	result = vkEnumerateInstanceExtensionProperties( NULL, &count_of_available_instance_extensions, NULL );
+	if ( result != VK_SUCCESS || count_of_available_instance_extensions == 0 ) {
+		fprintf( stdout, "Unable to enumerate instance extensions\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkExtensionProperties *available_instance_extensions;
+	available_instance_extensions = (VkExtensionProperties *)malloc( count_of_available_instance_extensions * sizeof (VkExtensionProperties) );
+	if ( !available_instance_extensions ) {
+		fprintf( stdout, "Unable to allocate space for available instance extensions\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	result = vkEnumerateInstanceExtensionProperties( NULL, &count_of_available_instance_extensions, available_instance_extensions );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Enumeration of extensions failed\n" );
+		exit( EXIT_FAILURE );
+	}
+
+
+	bool *all_instance_extensions_found;
+	all_instance_extensions_found = (bool *)calloc( count_of_required_instance_extensions, sizeof (bool) );
+	if ( !all_instance_extensions_found ) {
+		fprintf( stdout, "Unable to allocate boolean array to test supported extensions\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	for ( uint32_t i = 0; i < count_of_required_instance_extensions; ++i ) {
+		for ( uint32_t j = 0; j < count_of_available_instance_extensions; ++j ) {
+			if ( strcmp( required_instance_extensions[i], available_instance_extensions[j].extensionName ) == 0 ) {
+				all_instance_extensions_found[i] = true;
+				break;
+			}
+		}
+	}
+
+	for ( uint32_t i = 0; i < count_of_required_instance_extensions; ++i ) {
+		if ( all_instance_extensions_found[i] == false ) {
+			fprintf( stdout, "Required instance extension not found on the system\n" );
+			exit( EXIT_FAILURE );
+		}
+	}	
+
+	free( available_instance_extensions );
+	free( all_instance_extensions_found );
+
+	return;
+}
+
+
+// NOTE: validation is opt-in (PLAYGROUND_VALIDATION=1) -- silently turned off when the layer isn't installed
+void
+verify_instance_supports_validation_layers( Vulkan_Context *vulkan_context )
+{
+	if ( !vulkan_context->validation_enabled ) {
+		return;
+	}
+
+	VkResult result;
+	uint32_t count_of_available_layers;
+
+	result = vkEnumerateInstanceLayerProperties( &count_of_available_layers, NULL );
+	if ( result != VK_SUCCESS || count_of_available_layers == 0 ) {
+		fprintf( stdout, "No instance layers available -- running without validation\n" );
+		vulkan_context->validation_enabled = false;
+		return;
+	}
+
+	VkLayerProperties *available_layers;
+	available_layers = (VkLayerProperties *)malloc( count_of_available_layers * sizeof (VkLayerProperties) );
+	if ( !available_layers ) {
+		fprintf( stdout, "Unable to allocate space for available instance layers\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	vkEnumerateInstanceLayerProperties( &count_of_available_layers, available_layers );
+
+	for ( uint32_t i = 0; i < count_of_validation_layers; ++i ) {
+		bool layer_found = false;
+		for ( uint32_t j = 0; j < count_of_available_layers; ++j ) {
+			if ( strcmp( validation_layers[i], available_layers[j].layerName ) == 0 ) {
+				layer_found = true;
+				break;
+			}
+		}
+
+		if ( !layer_found ) {
+			fprintf( stdout, "Validation layer %s not found -- running without validation\n", validation_layers[i] );
+			vulkan_context->validation_enabled = false;
+			break;
+		}
+	}
+
+	free( available_layers );
+
+	return;
+}
+
+
+VKAPI_ATTR VkBool32 VKAPI_CALL
+vulkan_debug_messenger_callback( VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
+								 VkDebugUtilsMessageTypeFlagsEXT message_types,
+								 const VkDebugUtilsMessengerCallbackDataEXT *callback_data,
+								 void *user_data )
+{
+	Vulkan_Context *vulkan_context;
+	vulkan_context = (Vulkan_Context *)user_data;
+
+	if ( message_severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT ) {
+		vulkan_context->count_of_validation_errors += 1;
+		fprintf( stderr, "[validation error] %s\n", callback_data->pMessage );
+	}
+	else if ( message_severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT ) {
+		vulkan_context->count_of_validation_warnings += 1;
+		fprintf( stderr, "[validation warning] %s\n", callback_data->pMessage );
+	}
+
+	// NOTE: stderr so the messages never end up inside the benchmark's JSON on stdout
+	// returning VK_TRUE would abort the call that triggered the message
+	return VK_FALSE;
+}
+
+VkDebugUtilsMessengerCreateInfoEXT
+fill_debug_messenger_create_info( Vulkan_Context *vulkan_context )
+{
+	VkDebugUtilsMessengerCreateInfoEXT messenger_create_info = { 0 };
+
+	messenger_create_info.sType 		  = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+	messenger_create_info.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	messenger_create_info.messageType     = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT
+										  | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+										  | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+	messenger_create_info.pfnUserCallback = vulkan_debug_messenger_callback;
+	messenger_create_info.pUserData       = vulkan_context;
+
+	return messenger_create_info;
+}
+
+
+// 1.2 when the loader has it (descriptor indexing for bindless), else 1.0 -- a 1.0 loader fails instance
+// creation for anything higher. Devices still report their own version; this is the most we'll use.
+uint32_t
+select_vulkan_instance_api_version( void )
+{
+	uint32_t loader_api_version;
+	if ( !vkEnumerateInstanceVersion || vkEnumerateInstanceVersion( &loader_api_version ) != VK_SUCCESS ) {
+		return VK_API_VERSION_1_0;
+	}
+
+	return ( loader_api_version < VK_API_VERSION_1_2 ) ? loader_api_version : VK_API_VERSION_1_2;
+}
+
+// Could split this out into three separate functions -- chose not to at the moment
+VkInstance 
+create_vulkan_instance( Vulkan_Context *vulkan_context )
+{
+	VkApplicationInfo application_info = { 0 };
+
+	application_info.sType 				= VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	application_info.pApplicationName   = "Hello Triangle";
+	application_info.applicationVersion = VK_MAKE_VERSION(1, 0, 0 );
+	application_info.pEngineName 		= "No Engine";
+	application_info.engineVersion 		= VK_MAKE_VERSION(1, 0, 0);
+	application_info.apiVersion 		= select_vulkan_instance_api_version();
+
+
+	// NOTE: debug utils rides along with the validation layer -- it is the only optional extension so far
+	char *enabled_instance_extensions[16];
+	uint32_t count_of_enabled_instance_extensions;
+
+	count_of_enabled_instance_extensions = 0;
+	for ( uint32_t i = 0; i < count_of_required_instance_extensions; ++i ) {
+		enabled_instance_extensions[count_of_enabled_instance_extensions++] = required_instance_extensions[i];
+	}
+
+	VkDebugUtilsMessengerCreateInfoEXT messenger_create_info;
+	messenger_create_info = fill_debug_messenger_create_info( vulkan_context );
+
+	VkInstanceCreateInfo instance_create_info = { 0 };
+
+	instance_create_info.sType 					 = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instance_create_info.pApplicationInfo        = &application_info;
+
+	if ( vulkan_context->validation_enabled ) {
+		enabled_instance_extensions[count_of_enabled_instance_extensions++] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+
+		// chained so that vkCreateInstance / vkDestroyInstance themselves get validated
+		instance_create_info.pNext 				 = &messenger_create_info;
+		instance_create_info.enabledLayerCount   = count_of_validation_layers;
+		instance_create_info.ppEnabledLayerNames = validation_layers;
+	}
+
+	instance_create_info.enabledExtensionCount   = count_of_enabled_instance_extensions;
+	instance_create_info.ppEnabledExtensionNames = enabled_instance_extensions;	
+
+
+	VkInstance vulkan_instance;
+	VkResult result;
+
+	result = vkCreateInstance( &instance_create_info, NULL, &vulkan_instance );
+	vulkan_context->instance_api_version = application_info.apiVersion;
+
+	// NOTE: nothing was enumerated on a warm start -- let the caller re-probe instead of giving up
+	if ( result != VK_SUCCESS && vulkan_context->startup_cache.instance_warm ) {
+		return VK_NULL_HANDLE;
+	}
+
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a new Vulkan instance\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return vulkan_instance;
+}
+
+
+void
+load_vulkan_instance_functions( Vulkan_Context *vulkan_context ) 
+{
+	vkEnumeratePhysicalDevices     			   = (PFN_vkEnumeratePhysicalDevices)                vkGetInstanceProcAddr( vulkan_context->instance, "vkEnumeratePhysicalDevices" );
+	vkEnumerateDeviceExtensionProperties       = (PFN_vkEnumerateDeviceExtensionProperties)      vkGetInstanceProcAddr( vulkan_context->instance, "vkEnumerateDeviceExtensionProperties" );
+	vkGetPhysicalDeviceProperties  			   = (PFN_vkGetPhysicalDeviceProperties)             vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceProperties" );
+	vkGetPhysicalDeviceFeatures    			   = (PFN_vkGetPhysicalDeviceFeatures)               vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceFeatures" );
+	vkGetPhysicalDeviceMemoryProperties		   = (PFN_vkGetPhysicalDeviceMemoryProperties)       vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceMemoryProperties" );
+	vkGetPhysicalDeviceQueueFamilyProperties   = (PFN_vkGetPhysicalDeviceQueueFamilyProperties)  vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceQueueFamilyProperties" );
+	vkCreateDevice                 			   = (PFN_vkCreateDevice)                            vkGetInstanceProcAddr( vulkan_context->instance, "vkCreateDevice" );
+	vkGetDeviceProcAddr            			   = (PFN_vkGetDeviceProcAddr)                       vkGetInstanceProcAddr( vulkan_context->instance, "vkGetDeviceProcAddr" );
+	vkDestroyInstance              			   = (PFN_vkDestroyInstance)                         vkGetInstanceProcAddr( vulkan_context->instance, "vkDestroyInstance" );
+
+	if ( vulkan_context->instance_api_version >= VK_API_VERSION_1_2 ) {
+		vkGetPhysicalDeviceFeatures2           = (PFN_vkGetPhysicalDeviceFeatures2)              vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceFeatures2" );
+		vkGetPhysicalDeviceProperties2         = (PFN_vkGetPhysicalDeviceProperties2)            vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceProperties2" );
+	}
+
+	return;	
+}
+
+
+void  
+load_vulkan_instance_extension_functions( Vulkan_Context *vulkan_context )
+{
+	vkDestroySurfaceKHR                        = (PFN_vkDestroySurfaceKHR)				   	     vkGetInstanceProcAddr( vulkan_context->instance, "vkDestroySurfaceKHR" );
+	vkGetPhysicalDeviceSurfaceSupportKHR       = (PFN_vkGetPhysicalDeviceSurfaceSupportKHR)	     vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceSurfaceSupportKHR" );
+	vkGetPhysicalDeviceSurfaceFormatsKHR       = (PFN_vkGetPhysicalDeviceSurfaceFormatsKHR)	     vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceSurfaceFormatsKHR" );
+	vkGetPhysicalDeviceSurfacePresentModesKHR  = (PFN_vkGetPhysicalDeviceSurfacePresentModesKHR) vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceSurfacePresentModesKHR" );
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR  = (PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR) vkGetInstanceProcAddr( vulkan_context->instance, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR" );
+	vkCreateHeadlessSurfaceEXT                 = (PFN_vkCreateHeadlessSurfaceEXT)                vkGetInstanceProcAddr( vulkan_context->instance, "vkCreateHeadlessSurfaceEXT" );
+
+	if ( vulkan_context->validation_enabled ) {
+		vkCreateDebugUtilsMessengerEXT         = (PFN_vkCreateDebugUtilsMessengerEXT)            vkGetInstanceProcAddr( vulkan_context->instance, "vkCreateDebugUtilsMessengerEXT" );
+		vkDestroyDebugUtilsMessengerEXT        = (PFN_vkDestroyDebugUtilsMessengerEXT)           vkGetInstanceProcAddr( vulkan_context->instance, "vkDestroyDebugUtilsMessengerEXT" );
+	}
+
+	return;	
+}
+
+VkDebugUtilsMessengerEXT
+create_vulkan_debug_messenger( Vulkan_Context *vulkan_context )
+{
+	if ( !vulkan_context->validation_enabled ) {
+		return VK_NULL_HANDLE;
+	}
+
+	VkDebugUtilsMessengerCreateInfoEXT messenger_create_info;
+	messenger_create_info = fill_debug_messenger_create_info( vulkan_context );
+
+	VkResult result;
+	VkDebugUtilsMessengerEXT debug_messenger;
+
+	result = vkCreateDebugUtilsMessengerEXT( vulkan_context->instance, &messenger_create_info, NULL, &debug_messenger );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create the validation debug messenger\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return debug_messenger;
+}
+
+// NOTE: only usable when the includer picked VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME as its surface extension.
+// Presents go nowhere, but the swap chain / acquire / present path is the real one -- used for benchmarking
+// on machines without a display (or a GPU, with a software ICD like lavapipe)
+VkSurfaceKHR
+create_vulkan_headless_surface( Vulkan_Context *vulkan_context )
+{
+	if ( !vkCreateHeadlessSurfaceEXT ) {
+		fprintf( stdout, "Headless surfaces are not supported by this instance\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkHeadlessSurfaceCreateInfoEXT surface_create_info = { 0 };
+	surface_create_info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+	VkSurfaceKHR surface;
+	VkResult result;
+
+	result = vkCreateHeadlessSurfaceEXT( vulkan_context->instance, &surface_create_info, NULL, &surface );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a headless surface for rendering\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return surface;
+}
+
+
+// NOTE: in/out param -- physical_device_count
+VkPhysicalDevice * 
+find_vulkan_enabled_physical_devices( Vulkan_Context *vulkan_context, uint32_t *physical_device_count ) 
+{
+	VkResult result;
+	result = vkEnumeratePhysicalDevices( vulkan_context->instance, physical_device_count, NULL );
+	if ( result != VK_SUCCESS || *physical_device_count == 0 ) {
+		fprintf( stdout, "Unable to find any available devices\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkPhysicalDevice *physical_devices;
+	physical_devices = (VkPhysicalDevice *)malloc( *physical_device_count * sizeof (VkPhysicalDevice) );
+	if ( !physical_devices ) {
+		fprintf( stdout, "Unable to allocate memory for physical devices\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	result = vkEnumeratePhysicalDevices( vulkan_context->instance, physical_device_count, physical_devices );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to acquire handles to physical devices\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return physical_devices;
+}
+
+// One enumeration for both lists: exits when a required extension is missing, returns a bit per
+// optional_device_extensions entry the device has
+uint32_t
+probe_physical_device_extensions( VkPhysicalDevice selected_device )
+{
+	uint32_t count_of_available_device_extensions;
+	vkEnumerateDeviceExtensionProperties( selected_device, NULL, &count_of_available_device_extensions, NULL );
+			
+	if ( count_of_available_device_extensions == 0 ) {
+		fprintf( stdout, "No device extensions available\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkExtensionProperties *available_device_extensions;
+	available_device_extensions = (VkExtensionProperties *)malloc( count_of_available_device_extensions * sizeof (VkExtensionProperties) );
+	if ( !available_device_extensions ) {
+		fprintf( stdout, "Unable to allocate space for the available device extensions\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	vkEnumerateDeviceExtensionProperties( selected_device, NULL, &count_of_available_device_extensions, available_device_extensions );
+
+	for ( uint32_t i = 0; i < count_of_required_device_extensions; ++i ) {
+		bool extension_found = false;
+		for ( uint32_t j = 0; j < count_of_available_device_extensions; ++j ) {
+			if ( strcmp( required_device_extensions[i], available_device_extensions[j].extensionName ) == 0 ) {
+				extension_found = true;
+				break;
+			}
+		}
+
+		if ( !extension_found ) {
+			fprintf( stdout, "Required device extension %s not found on the system\n", required_device_extensions[i] );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	// NOTE: a bit each -- fine while there are fewer than 32 of them
+	uint32_t optional_extensions_supported = 0;
+	for ( uint32_t i = 0; i < count_of_optional_device_extensions; ++i ) {
+		for ( uint32_t j = 0; j < count_of_available_device_extensions; ++j ) {
+			if ( strcmp( optional_device_extensions[i], available_device_extensions[j].extensionName ) == 0 ) {
+				optional_extensions_supported |= ( 1u << i );
+				break;
+			}
+		}
+	}
+
+	free( available_device_extensions );
+
+	return optional_extensions_supported;
+}
+
+// Both halves -- a 1.2 device behind a 1.0 instance only gets 1.0 (and vkGetPhysicalDeviceFeatures2 isn't loaded)
+bool
+vulkan_device_is_1_2( Vulkan_Context *vulkan_context )
+{
+	return vulkan_context->instance_api_version >= VK_API_VERSION_1_2 &&
+		   vulkan_context->physical_device_properties.apiVersion >= VK_API_VERSION_1_2;
+}
+
+VkDevice 
+create_vulkan_logical_device( Vulkan_Context *vulkan_context ) 
+{
+	VkDeviceCreateInfo device_create_info = { 0 };
+
+	device_create_info.sType 				   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	device_create_info.queueCreateInfoCount    = vulkan_context->queue_topology.count_of_queue_create_infos;
+	device_create_info.pQueueCreateInfos 	   = vulkan_context->queue_topology.queue_create_infos;
+	device_create_info.enabledExtensionCount   = vulkan_context->count_of_enabled_device_extensions;
+	device_create_info.ppEnabledExtensionNames = vulkan_context->enabled_device_extensions;
+
+	// NOTE: 1.2 features only go in through VkPhysicalDeviceFeatures2, and then pEnabledFeatures has to stay NULL
+	VkPhysicalDeviceFeatures2 enabled_features = { 0 };
+	if ( vulkan_device_is_1_2( vulkan_context ) ) {
+		vulkan_context->enabled_vulkan_12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan_context->enabled_vulkan_12_features.pNext = NULL;
+
+		enabled_features.sType    = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		enabled_features.pNext    = &vulkan_context->enabled_vulkan_12_features;
+		enabled_features.features = vulkan_context->enabled_features;
+		device_create_info.pNext  = &enabled_features;
+	}
+	else {
+		device_create_info.pEnabledFeatures = &vulkan_context->enabled_features;
+	}
+
+	VkResult result;
+	VkDevice logical_device;
+
+	logical_device = VK_NULL_HANDLE;
+	result = vkCreateDevice( vulkan_context->physical_device, &device_create_info, NULL, &logical_device );
+
+	// NOTE: extensions / queue families came out of the startup cache -- let the caller re-probe
+	if ( result != VK_SUCCESS && vulkan_context->startup_cache.device_warm ) {
+		return VK_NULL_HANDLE;
+	}
+
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a logical device from the physical device\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return logical_device;	
+}
+
+VkSurfaceCapabilitiesKHR
+acquire_surface_and_swap_chain_capabilities( Vulkan_Context *vulkan_context ) 
+{
+	VkResult result;
+	VkSurfaceCapabilitiesKHR surface_capabilities;
+	result = vkGetPhysicalDeviceSurfaceCapabilitiesKHR( vulkan_context->physical_device, vulkan_context->surface, &surface_capabilities );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to get presentation surface capabilities\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return surface_capabilities;
+}
+
+// NOTE: in/out param -- count_of_surface_formats is the capacity going in. VK_INCOMPLETE just means
+// we keep the first ones, one call and no allocation
+void
+acquire_supported_surface_formats( Vulkan_Context *vulkan_context, VkSurfaceFormatKHR *surface_formats, uint32_t *count_of_surface_formats )
+{
+	VkResult result;
+	result = vkGetPhysicalDeviceSurfaceFormatsKHR( vulkan_context->physical_device, vulkan_context->surface, count_of_surface_formats, surface_formats );
+	if ( ( result != VK_SUCCESS && result != VK_INCOMPLETE ) || *count_of_surface_formats == 0 ) {
+		fprintf( stdout, "Unable to query surface formats\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+// NOTE: in/out param -- count_of_present_modes is the capacity going in, same as above
+void
+acquire_supported_present_modes( Vulkan_Context *vulkan_context, VkPresentModeKHR *present_modes, uint32_t *count_of_present_modes ) 
+{
+	VkResult result;
+	result = vkGetPhysicalDeviceSurfacePresentModesKHR( vulkan_context->physical_device, vulkan_context->surface, count_of_present_modes, present_modes );
+	if ( ( result != VK_SUCCESS && result != VK_INCOMPLETE ) || *count_of_present_modes == 0 ) {
+		fprintf( stdout, "Unable to query present mode for surface\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+// Straight into the startup cache -- swap chain rebuilds and the next start reuse them
+void
+probe_surface_formats_and_present_modes( Vulkan_Context *vulkan_context )
+{
+	Startup_Cache_File *capabilities;
+	capabilities = &vulkan_context->startup_cache.file;
+
+	capabilities->count_of_surface_formats = MAX_CACHED_SURFACE_FORMATS;
+	acquire_supported_surface_formats( vulkan_context, capabilities->surface_formats, &capabilities->count_of_surface_formats );
+
+	capabilities->count_of_present_modes = MAX_CACHED_PRESENT_MODES;
+	acquire_supported_present_modes( vulkan_context, capabilities->present_modes, &capabilities->count_of_present_modes );
+
+	vulkan_context->startup_cache.dirty = true;
+
+	return;
+}
+
+uint32_t
+select_number_of_swap_chain_images( VkSurfaceCapabilitiesKHR *surface_capabilities )
+{
+	// want double buffering -- 2 write buffers while 1 being presented
+	// maxImageCount of 0 means no upper limit (headless surfaces report this)
+	if ( surface_capabilities->maxImageCount == 0 ) {
+		if ( surface_capabilities->minImageCount > 3 ) {
+			return surface_capabilities->minImageCount;
+		}
+
+		return 3;
+	}
+
+	if ( surface_capabilities->maxImageCount < 3 ) {
+		fprintf( stdout, "surface does not support double buffering\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return surface_capabilities->maxImageCount; 
+}
+
+VkSurfaceFormatKHR
+select_format_for_swap_chain_images( VkSurfaceFormatKHR *surface_formats, uint32_t count_of_surface_formats ) 
+{
+	uint32_t desired_format_index;
+	desired_format_index = -1;
+	for ( uint32_t i = 0; i < count_of_surface_formats; ++i ) {
+		if ( surface_formats[i].format == VK_FORMAT_B8G8R8A8_UNORM
+				&& surface_formats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR ) {
+			
+			desired_format_index = i;
+			break;
+		}
+	}
+
+	if ( desired_format_index == -1 ) {
+		fprintf( stdout, "Surface failed to meet desired format specs\n" );
+		exit( EXIT_FAILURE );
+	}
+	
+		return surface_formats[desired_format_index];
+}
+
+VkExtent2D
+select_swap_chain_image_size( VkSurfaceCapabilitiesKHR *surface_capabilities, VkExtent2D window_extent ) 
+{
+	// width and height default to the window's client area (640x480 if we haven't been told yet)
+	VkExtent2D swap_chain_extent;
+	swap_chain_extent.width  = 640;
+	swap_chain_extent.height = 480;
+
+	if ( window_extent.width != 0 && window_extent.height != 0 ) {
+		swap_chain_extent = window_extent;
+	}
+
+	// -1 is a special value that means that the window size will be determined by the swap chain size
+	// however, you must choose a size that is within the surfaces capabilities 
+	if ( surface_capabilities->currentExtent.width == -1 ) {
+	
+		if ( swap_chain_extent.width < surface_capabilities->minImageExtent.width ) {
+			swap_chain_extent.width = surface_capabilities->minImageExtent.width;
+		}
+
+		if ( swap_chain_extent.height < surface_capabilities->minImageExtent.height ) {
+			swap_chain_extent.height = surface_capabilities->minImageExtent.height;	
+		}
+
+		if ( swap_chain_extent.width > surface_capabilities->maxImageExtent.width ) {
+			swap_chain_extent.width = surface_capabilities->maxImageExtent.width;
+		}
+
+		if ( swap_chain_extent.height > surface_capabilities->maxImageExtent.height ) {
+			swap_chain_extent.height = surface_capabilities->maxImageExtent.height;
+		}
+	}
+	else {
+		swap_chain_extent = surface_capabilities->currentExtent;
+	}	
+
+	return swap_chain_extent;
+}
+
+VkImageUsageFlags
+select_swap_chain_usage_flags( VkSurfaceCapabilitiesKHR *surface_capabilities  ) 
+{
+	// Color attachment bit is always supported
+	// NEED transfer destination usage which is required for image clear operation
+	VkImageUsageFlags available_image_usage_flags = 0;
+	VkImageUsageFlags desired_flags[] = {
+	VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+	VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+	VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+	VK_IMAGE_USAGE_SAMPLED_BIT,
+	VK_IMAGE_USAGE_STORAGE_BIT,
+	VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+	VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT
+	};
+
+	uint32_t count_of_desired_flags;
+	count_of_desired_flags = (sizeof desired_flags) / (sizeof desired_flags[0]);
+
+	for ( uint32_t i = 0; i < count_of_desired_flags; ++i ) {
+		if ( surface_capabilities->supportedUsageFlags & desired_flags[i] ) {
+			available_image_usage_flags |= desired_flags[i];
+		}
+	}
+
+	return available_image_usage_flags;
+}
+
+VkSurfaceTransformFlagBitsKHR 
+select_swap_chain_pre_transforms( VkSurfaceCapabilitiesKHR *surface_capabilities ) 
+{
+	// we don't want any transform to account for orientation (like a tablet)
+	if ( surface_capabilities->supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR ) {
+		return VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+	}
+	else {
+		return surface_capabilities->currentTransform;
+	}	
+}
+
+// NOTE: walks the policy's preferences, not the driver's list -- the order the driver reports modes in means nothing
+VkPresentModeKHR 
+select_swap_chain_present_mode( Present_Policy policy, VkPresentModeKHR *present_modes, uint32_t count_of_present_modes ) 
+{
+	for ( uint32_t preference = 0; preference < MAX_PRESENT_MODE_PREFERENCES; ++preference ) {
+		VkPresentModeKHR wanted_present_mode;
+		wanted_present_mode = present_policy_preferences[policy][preference];
+
+		for ( uint32_t i = 0; i < count_of_present_modes; ++i ) {
+			if ( present_modes[i] == wanted_present_mode ) {
+				return wanted_present_mode;
+			}
+		}
+	}
+
+	// FIFO is required by the spec, even if the surface forgot to list it
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+// Accepts the names in present_policy_names. Returns false (and leaves policy alone) for NULL or anything else.
+bool
+parse_present_policy( char *name, Present_Policy *policy )
+{
+	if ( !name ) {
+		return false;
+	}
+
+	for ( uint32_t i = 0; i < COUNT_OF_PRESENT_POLICIES; ++i ) {
+		if ( strcmp( name, present_policy_names[i] ) == 0 ) {
+			*policy = (Present_Policy)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+VkSemaphore
+create_vulkan_semaphore_for_image_availability( Vulkan_Context *vulkan_context ) 
+{
+	VkSemaphoreCreateInfo semaphore_create_info = { 0 };
+	semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkResult result;
+	VkSemaphore image_available;
+
+	result = vulkan_context->dispatch.vkCreateSemaphore( vulkan_context->logical_device, &semaphore_create_info, NULL, &image_available );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a semaphore for image availability\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return image_available;
+}
+
+VkSemaphore
+create_vulkan_semaphore_for_completion_of_rendering( Vulkan_Context *vulkan_context )
+{
+	VkSemaphoreCreateInfo semaphore_create_info = { 0 };
+	semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	VkResult result;
+	VkSemaphore rendering_complete;
+
+	result = vulkan_context->dispatch.vkCreateSemaphore( vulkan_context->logical_device, &semaphore_create_info, NULL, &rendering_complete );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a semaphore for testing rendering completion\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return rendering_complete;
+}
+
+VkFence
+create_vulkan_fence_for_frame_submission( Vulkan_Context *vulkan_context )
+{
+	// created signaled so the first wait on a never-submitted frame slot returns immediately
+	VkFenceCreateInfo fence_create_info = { 0 };
+	fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_create_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	VkResult result;
+	VkFence submit_complete;
+
+	result = vulkan_context->dispatch.vkCreateFence( vulkan_context->logical_device, &fence_create_info, NULL, &submit_complete );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a fence for frame submission\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return submit_complete;
+}
+
+// NOTE: PLAYGROUND_FRAMES_IN_FLIGHT overrides the default, clamped to the ring capacity
+uint32_t
+select_max_frames_in_flight( void )
+{
+	uint32_t max_frames_in_flight;
+	max_frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT;
+
+	char *frames_in_flight_setting;
+	frames_in_flight_setting = getenv( "PLAYGROUND_FRAMES_IN_FLIGHT" );
+	if ( frames_in_flight_setting ) {
+		max_frames_in_flight = (uint32_t)strtoul( frames_in_flight_setting, NULL, 10 );
+	}
+
+	if ( max_frames_in_flight < 1 ) {
+		max_frames_in_flight = 1;
+	}
+
+	if ( max_frames_in_flight > FRAME_RING_CAPACITY ) {
+		max_frames_in_flight = FRAME_RING_CAPACITY;
+	}
+
+	return max_frames_in_flight;
+}
+
+// NOTE: PLAYGROUND_WORKER_THREADS overrides one worker per processor -- counts the render thread, 1 records serially
+uint32_t
+select_count_of_job_workers( void )
+{
+	uint32_t count_of_job_workers;
+	count_of_job_workers = platform_get_count_of_processors();
+
+	char *worker_threads_setting;
+	worker_threads_setting = getenv( "PLAYGROUND_WORKER_THREADS" );
+	if ( worker_threads_setting ) {
+		count_of_job_workers = (uint32_t)strtoul( worker_threads_setting, NULL, 10 );
+	}
+
+	if ( count_of_job_workers < 1 ) {
+		count_of_job_workers = 1;
+	}
+
+	if ( count_of_job_workers > MAX_JOB_WORKERS ) {
+		count_of_job_workers = MAX_JOB_WORKERS;
+	}
+
+	return count_of_job_workers;
+}
+
+// NOTE: TRANSIENT -- everything in here is re-recorded every time the slot comes around
+VkCommandPool
+create_vulkan_frame_command_pool( Vulkan_Context *vulkan_context ) 
+{
+	VkResult result;
+	VkCommandPoolCreateInfo command_pool_create_info = { 0 };
+
+	command_pool_create_info.sType 			  = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_create_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	command_pool_create_info.queueFamilyIndex = vulkan_context->queue_family_index;
+
+	VkCommandPool command_pool;
+	result = vulkan_context->dispatch.vkCreateCommandPool( vulkan_context->logical_device, &command_pool_create_info, NULL, &command_pool );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a command pool\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return command_pool;	
+}
+
+VkCommandBuffer
+allocate_vulkan_command_buffer( Vulkan_Context *vulkan_context, VkCommandPool command_pool, VkCommandBufferLevel level ) 
+{
+	VkCommandBufferAllocateInfo command_buffer_allocate_info = { 0 };
+	command_buffer_allocate_info.sType 			    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	command_buffer_allocate_info.commandPool 		= command_pool;
+	command_buffer_allocate_info.level       		= level;
+	command_buffer_allocate_info.commandBufferCount = 1;
+
+	VkResult result;
+	VkCommandBuffer command_buffer;
+	result = vulkan_context->dispatch.vkAllocateCommandBuffers( vulkan_context->logical_device, &command_buffer_allocate_info, &command_buffer ); 
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to get handles to command buffers\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return command_buffer;
+}
+
+void
+create_vulkan_frames_in_flight( Vulkan_Context *vulkan_context )
+{
+	for ( uint32_t i = 0; i < vulkan_context->max_frames_in_flight; ++i ) {
+		Vulkan_Frame *frame;
+		frame = &vulkan_context->frames[i];
+
+		frame->image_available = create_vulkan_semaphore_for_image_availability( vulkan_context );
+		frame->submit_complete = create_vulkan_fence_for_frame_submission( vulkan_context );
+		frame->frame_number    = 0;
+
+		for ( uint32_t worker_index = 0; worker_index < vulkan_context->jobs.count_of_workers; ++worker_index ) {
+			frame->worker_command_pools[worker_index].command_pool = create_vulkan_frame_command_pool( vulkan_context );
+		}
+
+		frame->command_buffer = allocate_vulkan_command_buffer( vulkan_context, frame->worker_command_pools[0].command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY );
+		frame->query_range 	  = allocate_profiler_query_range( &vulkan_context->profiler );
+	}
+
+	vulkan_context->current_frame = 0;
+
+	return;
+}
+
+void
+destroy_vulkan_frames_in_flight( Vulkan_Context *vulkan_context )
+{
+	for ( uint32_t i = 0; i < vulkan_context->max_frames_in_flight; ++i ) {
+		Vulkan_Frame *frame;
+		frame = &vulkan_context->frames[i];
+
+		vulkan_context->dispatch.vkDestroySemaphore( vulkan_context->logical_device, frame->image_available, NULL );
+		vulkan_context->dispatch.vkDestroyFence( vulkan_context->logical_device, frame->submit_complete, NULL );
+
+		// NOTE: destroying a pool frees its command buffers
+		for ( uint32_t worker_index = 0; worker_index < vulkan_context->jobs.count_of_workers; ++worker_index ) {
+			vulkan_context->dispatch.vkDestroyCommandPool( vulkan_context->logical_device, frame->worker_command_pools[worker_index].command_pool, NULL );
+			destroy_vulkan_descriptor_pool_list( &vulkan_context->descriptors, &frame->descriptor_pools[worker_index] );
+		}
+	}
+
+	return;
+}
+
+/* Function does a lot -- here is a breakdown 
+
+ - acquire surface_and_swap_chain_capabilities
+	- select number of swap chain images     -- uint32_t
+	- select size for swap chain images      -- VkExtent
+	- select swap chain usage flags          -- VkImageUsageFlags	
+	- select_swap_chain_pre_transforms       -- VkSurfaceTransformFlagBitsKHR
+ - acquire supported surface formats and present modes (once, kept in the startup cache)
+	- select format for swap chain images    -- VkSurfaceFormatKHR	
+	- select presentation mode				 -- VkPresentModeKHR
+ -create baby's first swap_chain           	 -- VkSwapchainKHR
+
+*/
+	
+VkSwapchainKHR
+create_vulkan_swap_chain( Vulkan_Context *vulkan_context ) 
+{
+	VkSurfaceCapabilitiesKHR surface_capabilities;
+	surface_capabilities = acquire_surface_and_swap_chain_capabilities( vulkan_context );
+
+	uint32_t _desired_number_of_images;
+	_desired_number_of_images = select_number_of_swap_chain_images( &surface_capabilities );
+	
+	VkExtent2D _desired_extent;
+	_desired_extent = select_swap_chain_image_size( &surface_capabilities, vulkan_context->window_extent );
+
+	VkImageUsageFlags _desired_usage;
+	_desired_usage = select_swap_chain_usage_flags( &surface_capabilities );
+
+	VkSurfaceTransformFlagBitsKHR _desired_pre_transform;
+	_desired_pre_transform = select_swap_chain_pre_transforms( &surface_capabilities );
+
+	
+	
+	// formats and present modes don't change with the window -- probed once, warm starts don't probe at all
+	Startup_Cache_File *capabilities;
+	capabilities = &vulkan_context->startup_cache.file;
+	if ( capabilities->count_of_surface_formats == 0 || capabilities->count_of_present_modes == 0 ) {
+		probe_surface_formats_and_present_modes( vulkan_context );
+	}
+
+	VkSurfaceFormatKHR _desired_format;
+	_desired_format = select_format_for_swap_chain_images( capabilities->surface_formats, capabilities->count_of_surface_formats );
+
+	VkPresentModeKHR _desired_present_mode;
+	_desired_present_mode = select_swap_chain_present_mode( vulkan_context->present_policy, capabilities->present_modes, capabilities->count_of_present_modes );
+
+
+	// NOTE: oldSwapchain -- handing over the swap chain being replaced lets the driver reuse its resources
+	// and keep presenting already queued images while the new one comes up. VK_NULL_HANDLE on first creation.
+	VkSwapchainCreateInfoKHR swap_chain_create_info = { 0 };
+	swap_chain_create_info.sType 		         = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	swap_chain_create_info.surface 	             = vulkan_context->surface;
+	swap_chain_create_info.minImageCount         = _desired_number_of_images;
+	swap_chain_create_info.imageFormat           = _desired_format.format;
+	swap_chain_create_info.imageColorSpace       = _desired_format.colorSpace;
+	swap_chain_create_info.imageExtent           = _desired_extent;
+	swap_chain_create_info.imageArrayLayers      = 1;
+	swap_chain_create_info.imageUsage            = _desired_usage;
+	swap_chain_create_info.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE;
+	swap_chain_create_info.queueFamilyIndexCount = 0;
+	swap_chain_create_info.pQueueFamilyIndices   = NULL;
+
+	// NOTE: rendered on the graphics family, presented from another -- concurrent sharing saves an ownership
+	// transfer per frame on both queues
+	Vulkan_Queue_Role swap_chain_roles[] = { VULKAN_QUEUE_GRAPHICS, VULKAN_QUEUE_PRESENT };
+	uint32_t swap_chain_family_indices[2];
+	uint32_t count_of_swap_chain_families;
+	count_of_swap_chain_families = get_vulkan_queue_families_for_roles( &vulkan_context->queue_topology, swap_chain_roles, 2, swap_chain_family_indices );
+	if ( count_of_swap_chain_families > 1 ) {
+		swap_chain_create_info.imageSharingMode      = VK_SHARING_MODE_CONCURRENT;
+		swap_chain_create_info.queueFamilyIndexCount = count_of_swap_chain_families;
+		swap_chain_create_info.pQueueFamilyIndices   = swap_chain_family_indices;
+	}
+	swap_chain_create_info.preTransform          = _desired_pre_transform;
+	swap_chain_create_info.compositeAlpha        = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	swap_chain_create_info.presentMode		     = _desired_present_mode;
+	swap_chain_create_info.clipped			     = VK_TRUE;
+	swap_chain_create_info.oldSwapchain          = vulkan_context->swap_chain;
+
+		
+	VkResult result;
+	VkSwapchainKHR new_swap_chain;
+	result = vulkan_context->dispatch.vkCreateSwapchainKHR( vulkan_context->logical_device, &swap_chain_create_info, NULL, &new_swap_chain );
+
+	// NOTE: cached format / present mode -- probe the surface for real and try once more
+	if ( result != VK_SUCCESS && vulkan_context->startup_cache.surface_warm ) {
+		invalidate_startup_cache_surface( &vulkan_context->startup_cache );
+		return create_vulkan_swap_chain( vulkan_context );
+	}
+
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create a swap chain\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	vulkan_context->swap_chain_extent = _desired_extent;
+	vulkan_context->present_mode      = _desired_present_mode;
+
+	return new_swap_chain;	
+
+}
+
+uint32_t
+get_count_of_swap_chain_images( Vulkan_Context *vulkan_context )
+{
+	VkResult result;
+	uint32_t count_of_swap_chain_images;
+		
+	result = vulkan_context->dispatch.vkGetSwapchainImagesKHR( vulkan_context->logical_device, vulkan_context->swap_chain, &count_of_swap_chain_images, NULL );	
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Could not retrieve the number of swap chain images!\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( count_of_swap_chain_images == 0 ) {
+		fprintf( stdout, "Number of images tied to swap chain is zero\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return count_of_swap_chain_images;
+}
+
+// NOTE: the only place swap chain image handles are queried -- draw() works entirely out of this cache
+Vulkan_Swap_Chain_Image *
+create_vulkan_swap_chain_images( Vulkan_Context *vulkan_context )
+{
+	VkResult result;
+	VkImage *images;
+
+	images = (VkImage *)malloc( vulkan_context->count_of_swap_chain_images * sizeof (VkImage) );
+	if ( !images ) {
+		fprintf( stdout, "Unable to allocate space to store swap chain image handles\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	result = vulkan_context->dispatch.vkGetSwapchainImagesKHR( vulkan_context->logical_device, vulkan_context->swap_chain, &vulkan_context->count_of_swap_chain_images, images );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to get handles to swap chain images\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	Vulkan_Swap_Chain_Image *swap_chain_images;
+	swap_chain_images = (Vulkan_Swap_Chain_Image *)calloc( vulkan_context->count_of_swap_chain_images, sizeof (Vulkan_Swap_Chain_Image) );
+	if ( !swap_chain_images ) {
+		fprintf( stdout, "Unable to allocate space for the swap chain image cache\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	// NOTE: the render-complete semaphore lives with the image, not the frame slot -- the slot fence only
+	// covers the submit, so a per-slot semaphore could be signaled again before the present consumed it
+	for ( uint32_t i = 0; i < vulkan_context->count_of_swap_chain_images; ++i ) {
+		swap_chain_images[i].image 			    = images[i];
+		swap_chain_images[i].rendering_complete = create_vulkan_semaphore_for_completion_of_rendering( vulkan_context );
+	}
+
+	free( images );
+
+	return swap_chain_images;
+}
+
+void
+destroy_vulkan_swap_chain_images( Vulkan_Context *vulkan_context, Vulkan_Swap_Chain_Image *swap_chain_images, uint32_t count_of_swap_chain_images )
+{
+	for ( uint32_t i = 0; i < count_of_swap_chain_images; ++i ) {
+		vulkan_context->dispatch.vkDestroySemaphore( vulkan_context->logical_device, swap_chain_images[i].rendering_complete, NULL );
+	}
+
+	free( swap_chain_images );
+
+	return;
+}
+
+// NOTE: picked up by the next frame recorded
+void
+set_clear_color( Vulkan_Context *vulkan_context, VkClearColorValue clear_color )
+{
+	vulkan_context->clear_color = clear_color;
+
+	return;
+}
+
+void
+record_clear_task( Vulkan_Frame_Target *target, VkCommandBuffer command_buffer, void *data )
+{
+	VkImageSubresourceRange image_subresource_range = { 0 };
+	image_subresource_range.aspectMask   = VK_IMAGE_ASPECT_COLOR_BIT;
+	image_subresource_range.baseMipLevel = 0;
+	image_subresource_range.levelCount   = 1;
+	image_subresource_range.layerCount   = 1;
+
+	target->dispatch->vkCmdClearColorImage( command_buffer, 
+						  target->image,
+						  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						  &target->clear_color,
+						  1,
+						  &image_subresource_range );
+
+	return;
+}
+
+// Per-frame resets are wholesale: one vkResetCommandPool per worker pool of the slot, and the same for
+// the worker's descriptor pools
+void
+reset_frame_command_pools( Vulkan_Context *vulkan_context, Vulkan_Frame *frame )
+{
+	for ( uint32_t worker_index = 0; worker_index < vulkan_context->jobs.count_of_workers; ++worker_index ) {
+		Vulkan_Worker_Command_Pool *worker_command_pool;
+		worker_command_pool = &frame->worker_command_pools[worker_index];
+
+		vulkan_context->dispatch.vkResetCommandPool( vulkan_context->logical_device, worker_command_pool->command_pool, 0 );
+		worker_command_pool->count_of_command_buffers_used = 0;
+
+		reset_vulkan_descriptor_pool_list( &vulkan_context->descriptors, &frame->descriptor_pools[worker_index] );
+	}
+
+	return;
+}
+
+typedef struct {
+
+	Vulkan_Context			*vulkan_context;
+	Vulkan_Frame			*frame;
+	Vulkan_Frame_Target		*target;
+	Frame_Graph_Pass		*pass;
+	VkCommandBuffer			recorded;					// out
+
+} Recording_Job;
+
+// NOTE: runs on any worker -- only ever touches that worker's pool for the frame, so no pool is shared between threads
+void
+record_task_job( void *data, uint32_t worker_index )
+{
+	Recording_Job *recording_job;
+	recording_job = (Recording_Job *)data;
+
+	Vulkan_Context *vulkan_context;
+	vulkan_context = recording_job->vulkan_context;
+
+	Vulkan_Worker_Command_Pool *worker_command_pool;
+	worker_command_pool = &recording_job->frame->worker_command_pools[worker_index];
+
+	if ( worker_command_pool->count_of_command_buffers_used == worker_command_pool->count_of_command_buffers ) {
+		worker_command_pool->command_buffers[worker_command_pool->count_of_command_buffers++] =
+			allocate_vulkan_command_buffer( vulkan_context, worker_command_pool->command_pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY );
+	}
+
+	VkCommandBuffer command_buffer;
+	command_buffer = worker_command_pool->command_buffers[worker_command_pool->count_of_command_buffers_used++];
+
+	// outside a render pass -- nothing to inherit, but secondaries must still pass the struct
+	VkCommandBufferInheritanceInfo command_buffer_inheritance_info = { 0 };
+	command_buffer_inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+	VkCommandBufferBeginInfo command_buffer_begin_info = { 0 };
+	command_buffer_begin_info.sType 			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	command_buffer_begin_info.flags 			= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	command_buffer_begin_info.pInheritanceInfo 	= &command_buffer_inheritance_info;
+
+	vulkan_context->dispatch.vkBeginCommandBuffer( command_buffer, &command_buffer_begin_info );
+	recording_job->pass->record( recording_job->target, command_buffer, recording_job->pass->data );
+
+	VkResult result;
+	result = vulkan_context->dispatch.vkEndCommandBuffer( command_buffer );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Could not record the %s pass\n", recording_job->pass->name );
+		exit( EXIT_FAILURE );
+	}
+
+	recording_job->recorded = command_buffer;
+
+	return;
+}
+
+// NOTE: PLAYGROUND_FRAME_GRAPH_DUMP names a file the compiled graph is written to, every time it's recompiled
+void
+dump_frame_graph( Frame_Graph *graph )
+{
+	char *dump_path;
+	dump_path = getenv( "PLAYGROUND_FRAME_GRAPH_DUMP" );
+	if ( !dump_path ) {
+		return;
+	}
+
+	FILE *dump_file;
+	dump_file = fopen( dump_path, "w" );
+	if ( !dump_file ) {
+		fprintf( stdout, "Unable to open %s for the frame graph dump\n", dump_path );
+		return;
+	}
+
+	export_frame_graph_as_json( graph, dump_file, "" );
+	fprintf( dump_file, "\n" );
+	fclose( dump_file );
+
+	return;
+}
+
+// NOTE: caller guarantees the frame slot's previous submission has completed (its pools were just reset)
+// and the image's too (draw() waits on swap_chain_image->in_flight)
+void 
+record_frame_command_buffers( Vulkan_Context *vulkan_context, Vulkan_Frame *frame, Vulkan_Swap_Chain_Image *swap_chain_image )
+{
+	VkResult result;
+
+	Vulkan_Frame_Target target = { 0 };
+	target.dispatch 	= &vulkan_context->dispatch;
+	target.image 		= swap_chain_image->image;
+	target.extent 		= vulkan_context->swap_chain_extent;
+	target.clear_color 	= vulkan_context->clear_color;
+	target.frame_number = vulkan_context->count_of_frames_submitted + 1;
+	target.frame_slot 	= vulkan_context->current_frame;
+
+	Frame_Graph *graph;
+	graph = &vulkan_context->frame_graph;
+	if ( !graph->compiled ) {
+		compile_frame_graph( graph );
+		dump_frame_graph( graph );
+	}
+
+	bind_frame_graph_image( graph, vulkan_context->swap_chain_resource, swap_chain_image->image );
+
+	if ( vulkan_context->gpu_scene.enabled ) {
+		// NOTE: camera turns in place at the centre of the scene so the visible set changes from frame to frame
+		float camera_position[3] = { 0.0f, 0.0f, 0.0f };
+		float yaw;
+		yaw = (float)( target.frame_number % 3600 ) * 0.1f * ( MATH_PI / 180.0f );
+
+		float aspect_ratio;
+		aspect_ratio = (float)target.extent.width / (float)( target.extent.height ? target.extent.height : 1 );
+
+		set_gpu_scene_camera( &vulkan_context->gpu_scene, camera_position, yaw, 0.0f, 1.0f, aspect_ratio, 0.1f, 600.0f );
+		bind_gpu_scene_frame( &vulkan_context->gpu_scene, graph, target.frame_slot );
+	}
+
+	// fan the live passes out, the render thread records too while it waits -- culled passes aren't recorded at all
+	Recording_Job recording_jobs[MAX_FRAME_GRAPH_PASSES];
+	Job_Counter recording_counter = { 0 };
+	for ( uint32_t i = 0; i < graph->count_of_live_passes; ++i ) {
+		recording_jobs[i].vulkan_context = vulkan_context;
+		recording_jobs[i].frame 		 = frame;
+		recording_jobs[i].target 		 = &target;
+		recording_jobs[i].pass 			 = &graph->passes[graph->live_passes[i]];
+		recording_jobs[i].recorded 		 = VK_NULL_HANDLE;
+
+		submit_job( &vulkan_context->jobs, 0, record_task_job, &recording_jobs[i], &recording_counter );
+	}
+
+	VkCommandBufferBeginInfo command_buffer_begin_info = { 0 };
+	command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	// NOTE: the primary lives in worker 0's pool -- worker 0 is this thread, so the pool is still only used by one thread
+	VkCommandBuffer command_buffer;
+	command_buffer = frame->command_buffer;
+
+	vulkan_context->dispatch.vkBeginCommandBuffer( command_buffer, &command_buffer_begin_info );
+
+	Frame_Profiler *profiler;
+	profiler = &vulkan_context->profiler;
+
+	record_profiler_reset( profiler, command_buffer, frame->query_range );
+	record_profiler_timestamp( profiler, command_buffer, frame->query_range, GPU_TIMESTAMP_BEGIN, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT );
+
+	wait_for_job_counter( &vulkan_context->jobs, 0, &recording_counter );
+
+	// the last batch has no passes when it only moves exported resources into their final usage
+	uint32_t count_of_pass_batches;
+	count_of_pass_batches = graph->count_of_batches;
+	if ( count_of_pass_batches > 1 && graph->batches[count_of_pass_batches - 1].count_of_passes == 0 ) {
+		count_of_pass_batches -= 1;
+	}
+
+	// batch by batch: its one barrier, then its passes in pass order (not completion order). The profiler's
+	// barrier phase is the first batch's barrier, its clear phase everything up to the final transitions.
+	for ( uint32_t b = 0; b < count_of_pass_batches; ++b ) {
+		Frame_Graph_Batch *batch;
+		batch = &graph->batches[b];
+
+		record_frame_graph_batch_barriers( graph, &vulkan_context->dispatch, command_buffer, b );
+
+		if ( b == 0 ) {
+			record_profiler_timestamp( profiler, command_buffer, frame->query_range, GPU_TIMESTAMP_BARRIER_TO_CLEAR, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT );
+		}
+
+		if ( batch->count_of_passes > 0 ) {
+			VkCommandBuffer secondary_command_buffers[MAX_FRAME_GRAPH_PASSES];
+			for ( uint32_t i = 0; i < batch->count_of_passes; ++i ) {
+				secondary_command_buffers[i] = recording_jobs[batch->first_pass + i].recorded;
+			}
+
+			vulkan_context->dispatch.vkCmdExecuteCommands( command_buffer, batch->count_of_passes, secondary_command_buffers );
+		}
+	}
+
+	record_profiler_timestamp( profiler, command_buffer, frame->query_range, GPU_TIMESTAMP_CLEAR, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT );
+
+	if ( count_of_pass_batches < graph->count_of_batches ) {
+		record_frame_graph_batch_barriers( graph, &vulkan_context->dispatch, command_buffer, count_of_pass_batches );
+	}
+
+	record_profiler_timestamp( profiler, command_buffer, frame->query_range, GPU_TIMESTAMP_END, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT );
+
+	result = vulkan_context->dispatch.vkEndCommandBuffer( command_buffer );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Could not record command buffers\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+// NOTE: frames complete in submission order, so waiting on the oldest slot at or past frame_number is enough
+void
+wait_for_frame_number( Vulkan_Context *vulkan_context, uint64_t frame_number )
+{
+	if ( frame_number <= vulkan_context->last_completed_frame_number ) {
+		return;
+	}
+
+	Vulkan_Frame *oldest_frame = NULL;
+	for ( uint32_t i = 0; i < vulkan_context->max_frames_in_flight; ++i ) {
+		Vulkan_Frame *frame;
+		frame = &vulkan_context->frames[i];
+
+		if ( frame->frame_number < frame_number ) {
+			continue;
+		}
+
+		if ( !oldest_frame || frame->frame_number < oldest_frame->frame_number ) {
+			oldest_frame = frame;
+		}
+	}
+
+	if ( !oldest_frame ) {
+		return;
+	}
+
+	VkResult result;
+	result = vulkan_context->dispatch.vkWaitForFences( vulkan_context->logical_device, 1, &oldest_frame->submit_complete, VK_TRUE, UINT64_MAX );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to wait for frame %llu to complete\n", (unsigned long long)frame_number );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( oldest_frame->frame_number > vulkan_context->last_completed_frame_number ) {
+		vulkan_context->last_completed_frame_number = oldest_frame->frame_number;
+	}
+
+	return;
+}
+
+void
+destroy_retired_swap_chain( Vulkan_Context *vulkan_context, Vulkan_Retired_Swap_Chain *retired_swap_chain )
+{
+	destroy_vulkan_swap_chain_images( vulkan_context, retired_swap_chain->images, retired_swap_chain->count_of_images );
+	vulkan_context->dispatch.vkDestroySwapchainKHR( vulkan_context->logical_device, retired_swap_chain->swap_chain, NULL );
+
+	return;
+}
+
+// NOTE: cheap to call every frame -- only compares frame numbers unless something is ready to go
+void
+destroy_completed_retired_swap_chains( Vulkan_Context *vulkan_context )
+{
+	uint32_t count_of_remaining = 0;
+
+	for ( uint32_t i = 0; i < vulkan_context->count_of_retired_swap_chains; ++i ) {
+		Vulkan_Retired_Swap_Chain *retired_swap_chain;
+		retired_swap_chain = &vulkan_context->retired_swap_chains[i];
+
+		if ( retired_swap_chain->last_frame_number <= vulkan_context->last_completed_frame_number ) {
+			destroy_retired_swap_chain( vulkan_context, retired_swap_chain );
+		}
+		else {
+			vulkan_context->retired_swap_chains[count_of_remaining++] = *retired_swap_chain;
+		}
+	}
+
+	vulkan_context->count_of_retired_swap_chains = count_of_remaining;
+
+	destroy_retired_vulkan_framebuffers( &vulkan_context->object_cache, vulkan_context->last_completed_frame_number );
+
+	return;
+}
+
+/* Rebuild after a resize or OUT_OF_DATE / SUBOPTIMAL
+
+ - the current swap chain is passed as oldSwapchain, then parked on the retired list together with
+   its images until the last frame that used it has completed
+ - only if MAX_RETIRED_SWAP_CHAINS rebuilds pile up inside a single frame ring do we wait,
+   and then only on that one frame's fence
+
+*/
+void
+recreate_vulkan_swap_chain( Vulkan_Context *vulkan_context )
+{
+	VkSurfaceCapabilitiesKHR surface_capabilities;
+	surface_capabilities = acquire_surface_and_swap_chain_capabilities( vulkan_context );
+
+	// minimized -- a zero sized swap chain is invalid, try again once the window comes back
+	if ( surface_capabilities.currentExtent.width == 0 || surface_capabilities.currentExtent.height == 0 ) {
+		return;
+	}
+
+	if ( vulkan_context->count_of_retired_swap_chains == MAX_RETIRED_SWAP_CHAINS ) {
+		wait_for_frame_number( vulkan_context, vulkan_context->retired_swap_chains[0].last_frame_number );
+		destroy_completed_retired_swap_chains( vulkan_context );
+	}
+
+	VkSwapchainKHR new_swap_chain;
+	new_swap_chain = create_vulkan_swap_chain( vulkan_context );
+
+	Vulkan_Retired_Swap_Chain *retired_swap_chain;
+	retired_swap_chain = &vulkan_context->retired_swap_chains[vulkan_context->count_of_retired_swap_chains++];
+	retired_swap_chain->swap_chain        = vulkan_context->swap_chain;
+	retired_swap_chain->images            = vulkan_context->swap_chain_images;
+	retired_swap_chain->count_of_images   = vulkan_context->count_of_swap_chain_images;
+	retired_swap_chain->last_frame_number = vulkan_context->count_of_frames_submitted;
+
+	// cached framebuffers point at the old image views -- retired on the same schedule as the swap chain
+	invalidate_vulkan_framebuffers( &vulkan_context->object_cache, vulkan_context->count_of_frames_submitted );
+
+	vulkan_context->swap_chain 				   = new_swap_chain;
+	vulkan_context->count_of_swap_chain_images = get_count_of_swap_chain_images( vulkan_context );
+	vulkan_context->swap_chain_images 		   = create_vulkan_swap_chain_images( vulkan_context );
+	vulkan_context->swap_chain_needs_rebuild   = false;
+
+	return;
+}
+
+// Runtime switch. Only flags a rebuild (picked up by the next draw) when the new policy resolves to a
+// different mode on this surface -- vsync and adaptive both land on FIFO without FIFO_RELAXED support.
+void
+set_present_policy( Vulkan_Context *vulkan_context, Present_Policy policy )
+{
+	vulkan_context->present_policy = policy;
+
+	if ( vulkan_context->swap_chain == VK_NULL_HANDLE ) {
+		return;
+	}
+
+	Startup_Cache_File *capabilities;
+	capabilities = &vulkan_context->startup_cache.file;
+
+	VkPresentModeKHR present_mode;
+	present_mode = select_swap_chain_present_mode( policy, capabilities->present_modes, capabilities->count_of_present_modes );
+	if ( present_mode != vulkan_context->present_mode ) {
+		vulkan_context->swap_chain_needs_rebuild = true;
+	}
+
+	return;
+}
+
+// Hands the pacer the completion time of every frame whose fence has signaled since the last call.
+// NOTE: frames retire in submission order, so this stops at the oldest one still running
+void
+observe_frame_completions( Vulkan_Context *vulkan_context )
+{
+	for ( ;; ) {
+		Vulkan_Frame *oldest_frame = NULL;
+		for ( uint32_t i = 0; i < vulkan_context->max_frames_in_flight; ++i ) {
+			Vulkan_Frame *frame;
+			frame = &vulkan_context->frames[i];
+
+			if ( frame->completion_pending && ( !oldest_frame || frame->frame_number < oldest_frame->frame_number ) ) {
+				oldest_frame = frame;
+			}
+		}
+
+		if ( !oldest_frame ) {
+			break;
+		}
+
+		if ( vulkan_context->dispatch.vkGetFenceStatus( vulkan_context->logical_device, oldest_frame->submit_complete ) != VK_SUCCESS ) {
+			break;
+		}
+
+		record_frame_pacer_completion( &vulkan_context->pacer, oldest_frame->paced_start, oldest_frame->submitted_at,
+									   oldest_frame->paced_deadline, platform_get_timestamp_in_nanoseconds() );
+		oldest_frame->completion_pending = false;
+	}
+
+	return;
+}
+
+void
+wait_for_frame_to_complete( Vulkan_Context *vulkan_context, Vulkan_Frame *frame )
+{
+	VkResult result;
+	result = vulkan_context->dispatch.vkWaitForFences( vulkan_context->logical_device, 1, &frame->submit_complete, VK_TRUE, UINT64_MAX );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to wait for a frame in flight to complete\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	// frames retire in submission order on the one queue
+	if ( frame->frame_number > vulkan_context->last_completed_frame_number ) {
+		vulkan_context->last_completed_frame_number = frame->frame_number;
+	}
+
+	observe_frame_completions( vulkan_context );
+
+	return;
+}
+
+// how often the pacer checks frame fences while it sleeps -- bounds how late a completion can be timed
+#define FRAME_PACER_POLL_NANOSECONDS	250000ull
+
+// Sleeps until the pacer says the frame should start, polling fences in between so completions are timed
+// close to when they actually happen
+void
+wait_for_paced_frame_start( Vulkan_Context *vulkan_context, Vulkan_Frame *frame )
+{
+	Frame_Pacer *pacer;
+	pacer = &vulkan_context->pacer;
+
+	observe_frame_completions( vulkan_context );
+
+	uint64_t planned_at;
+	planned_at = platform_get_timestamp_in_nanoseconds();
+
+	uint64_t deadline;
+	uint64_t start_at;
+	start_at = plan_frame_pacer_start( pacer, planned_at, &deadline );
+
+	uint64_t now;
+	now = planned_at;
+	while ( now < start_at ) {
+		uint64_t wake_at;
+		wake_at = start_at;
+		if ( wake_at > now + FRAME_PACER_POLL_NANOSECONDS ) {
+			wake_at = now + FRAME_PACER_POLL_NANOSECONDS;
+		}
+
+		platform_sleep_until( wake_at );
+		observe_frame_completions( vulkan_context );
+		now = platform_get_timestamp_in_nanoseconds();
+	}
+
+	record_frame_pacer_start( pacer, planned_at, now );
+	frame->paced_start    = now;
+	frame->paced_deadline = deadline;
+
+	return;
+}
+
+// NOTE: polls (never waits on) the fences of every submitted slot so the count reflects actual GPU progress
+void
+update_frames_in_flight_statistics( Vulkan_Context *vulkan_context )
+{
+	uint32_t frames_in_flight = 0;
+
+	for ( uint32_t i = 0; i < vulkan_context->max_frames_in_flight; ++i ) {
+		Vulkan_Frame *frame;
+		frame = &vulkan_context->frames[i];
+
+		if ( frame->frame_number <= vulkan_context->last_completed_frame_number ) {
+			continue;
+		}
+
+		if ( vulkan_context->dispatch.vkGetFenceStatus( vulkan_context->logical_device, frame->submit_complete ) == VK_SUCCESS ) {
+			if ( frame->frame_number > vulkan_context->last_completed_frame_number ) {
+				vulkan_context->last_completed_frame_number = frame->frame_number;
+			}
+		}
+		else {
+			frames_in_flight += 1;
+		}
+	}
+
+	vulkan_context->frames_currently_in_flight = frames_in_flight;
+	if ( frames_in_flight > vulkan_context->peak_frames_in_flight ) {
+		vulkan_context->peak_frames_in_flight = frames_in_flight;
+	}
+
+	return;
+}
+
+void
+draw( Vulkan_Context *vulkan_context )
+{
+	// nothing to present to while minimized
+	if ( vulkan_context->window_extent.width == 0 || vulkan_context->window_extent.height == 0 ) {
+		return;
+	}
+
+	Frame_Profiler *profiler;
+	profiler = &vulkan_context->profiler;
+	begin_profiler_frame( profiler, vulkan_context->count_of_frames_submitted + 1 );
+
+	Vulkan_Frame *frame;
+	frame = &vulkan_context->frames[vulkan_context->current_frame];
+
+	// only blocks when the GPU is a full ring of frames behind the CPU
+	begin_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_WAIT_FOR_FRAME );
+	wait_for_frame_to_complete( vulkan_context, frame );
+	end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_WAIT_FOR_FRAME );
+
+	// NOTE: after the slot wait -- the slot's previous frame has to be observed before its pacing times are reused
+	wait_for_paced_frame_start( vulkan_context, frame );
+
+	// the slot's last frame is done, so its timestamps are ready and its command buffers are free -- never stalls
+	if ( frame->has_pending_profile ) {
+		resolve_frame_profile( profiler, frame->query_range, &frame->pending_profile );
+		frame->has_pending_profile = false;
+	}
+
+	if ( vulkan_context->gpu_scene.enabled ) {
+		resolve_gpu_scene_counts( &vulkan_context->gpu_scene, vulkan_context->current_frame );
+	}
+
+	reset_frame_command_pools( vulkan_context, frame );
+
+	destroy_completed_retired_swap_chains( vulkan_context );
+
+	// NOTE: frame boundary -- nothing recorded for this frame has looked at a shader yet
+	apply_vulkan_shader_reloads( &vulkan_context->shader_cache );
+
+	if ( vulkan_context->gpu_scene.enabled ) {
+		update_gpu_scene_pipeline( &vulkan_context->gpu_scene, vulkan_context->count_of_frames_submitted, vulkan_context->last_completed_frame_number );
+	}
+
+	if ( vulkan_context->bindless.enabled ) {
+		recycle_bindless_handles( &vulkan_context->bindless, vulkan_context->last_completed_frame_number );
+	}
+
+	if ( vulkan_context->swap_chain_needs_rebuild ) {
+		recreate_vulkan_swap_chain( vulkan_context );
+		if ( vulkan_context->swap_chain_needs_rebuild ) {
+			return;
+		}
+	}
+
+	profiler->current.present_mode = vulkan_context->present_mode;
+
+	VkResult result;
+	uint32_t image_index;
+	begin_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_ACQUIRE );
+	result = vulkan_context->dispatch.vkAcquireNextImageKHR( vulkan_context->logical_device, 
+									vulkan_context->swap_chain, 
+									UINT64_MAX, 
+									frame->image_available,
+									VK_NULL_HANDLE,
+									&image_index );
+	end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_ACQUIRE );
+	switch ( result ) {
+		case VK_SUCCESS: {
+		} break;
+
+		// still presentable -- finish this frame, rebuild before the next one
+		case VK_SUBOPTIMAL_KHR: {
+			vulkan_context->swap_chain_needs_rebuild = true;
+		} break;
+		
+		// NOTE: nothing was acquired so frame->image_available is still unsignaled and the fence untouched,
+		// the slot can be reused as is on the next draw
+		case VK_ERROR_OUT_OF_DATE_KHR: {
+			vulkan_context->swap_chain_needs_rebuild = true;
+			return;
+		} break;
+
+		default: {
+			fprintf( stdout, "unable to swap image\n" );
+			exit( EXIT_FAILURE );
+		} break;
+	}
+
+	Vulkan_Swap_Chain_Image *swap_chain_image;
+	swap_chain_image = &vulkan_context->swap_chain_images[image_index];
+
+	// NOTE: images can come back out of order -- an older slot may still be rendering to this one
+	if ( swap_chain_image->in_flight != VK_NULL_HANDLE && swap_chain_image->in_flight != frame->submit_complete ) {
+		begin_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_WAIT_FOR_FRAME );
+		result = vulkan_context->dispatch.vkWaitForFences( vulkan_context->logical_device, 1, &swap_chain_image->in_flight, VK_TRUE, UINT64_MAX );
+		end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_WAIT_FOR_FRAME );
+		if ( result != VK_SUCCESS ) {
+			fprintf( stdout, "Unable to wait for swap chain image to be released\n" );
+			exit( EXIT_FAILURE );
+		}
+	}
+	swap_chain_image->in_flight = frame->submit_complete;
+
+	begin_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_RECORD );
+	record_frame_command_buffers( vulkan_context, frame, swap_chain_image );
+	end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_RECORD );
+
+	result = vulkan_context->dispatch.vkResetFences( vulkan_context->logical_device, 1, &frame->submit_complete );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to reset the frame fence\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	// finished loads go to the uploader a budget's worth at a time
+	update_asset_streaming( &vulkan_context->streamer, vulkan_context->last_completed_frame_number );
+
+	// uploads recorded since the last frame go out in one transfer submit, and this frame's submit picks up
+	// their semaphores + ownership acquires -- the frame waits on the GPU, never the CPU
+	submit_pending_uploads( &vulkan_context->uploader );
+
+	// resources registered while recording -- update-after-bind, so this is late enough
+	if ( vulkan_context->bindless.enabled ) {
+		flush_bindless_writes( &vulkan_context->bindless );
+	}
+
+	Vulkan_Queue_Submit frame_submit = { 0 };
+	add_submit_wait( &frame_submit, frame->image_available, vulkan_context->frame_graph.resources[vulkan_context->swap_chain_resource].first_use_stage );
+	add_pending_upload_acquires( &vulkan_context->uploader, vulkan_context->count_of_frames_submitted + 1, frame->submit_complete, &frame_submit );
+	add_submit_command_buffer( &frame_submit, frame->command_buffer );
+	add_submit_signal( &frame_submit, swap_chain_image->rendering_complete );
+
+	begin_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_SUBMIT );
+	result = submit_to_queue( &vulkan_context->dispatch, vulkan_context->graphics_queue, &frame_submit, frame->submit_complete );
+	end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_SUBMIT );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Fuck..unable to draw\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	vulkan_context->count_of_frames_submitted += 1;
+	frame->frame_number = vulkan_context->count_of_frames_submitted;
+
+	frame->submitted_at       = platform_get_timestamp_in_nanoseconds();
+	frame->completion_pending = true;
+	record_frame_pacer_submit( &vulkan_context->pacer, frame->paced_start, frame->paced_deadline, frame->submitted_at );
+
+	update_frames_in_flight_statistics( vulkan_context );
+
+	VkPresentInfoKHR present_info = { 0 };
+
+	present_info.sType 				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	present_info.waitSemaphoreCount = 1;
+	present_info.pWaitSemaphores 	= &swap_chain_image->rendering_complete;
+	present_info.swapchainCount     = 1;
+	present_info.pSwapchains		= &vulkan_context->swap_chain;
+	present_info.pImageIndices      = &image_index;
+	present_info.pResults			= NULL;
+
+	vulkan_context->current_frame = (vulkan_context->current_frame + 1) % vulkan_context->max_frames_in_flight;
+
+	begin_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_PRESENT );
+	result = vulkan_context->dispatch.vkQueuePresentKHR( vulkan_context->present_queue, &present_info );
+	end_profiler_cpu_phase( profiler, PROFILE_METRIC_CPU_PRESENT );
+	record_frame_pacer_present( &vulkan_context->pacer, platform_get_timestamp_in_nanoseconds() );
+	switch ( result ) {
+		case VK_SUCCESS: {
+		} break;
+
+		case VK_ERROR_OUT_OF_DATE_KHR:
+		case VK_SUBOPTIMAL_KHR: {
+			vulkan_context->swap_chain_needs_rebuild = true;
+		} break;
+		
+		default: {
+			fprintf( stdout, "Shit is fucked up\n" );
+			exit( EXIT_FAILURE );
+		} break;
+	}
+
+	profiler->current.descriptor_sets = end_frame_descriptor_allocations( &vulkan_context->descriptors, frame->descriptor_pools,
+																		  vulkan_context->jobs.count_of_workers );
+
+	// GPU half gets filled in the next time this slot comes around
+	frame->pending_profile     = end_profiler_frame( profiler );
+	frame->has_pending_profile = profiler->gpu_timing_enabled;
+
+	checkpoint_vulkan_pipeline_cache( &vulkan_context->pipeline_cache );
+}
+
+// NOTE: device must be idle -- collects the GPU half of the frames still parked on the frame ring
+void
+resolve_all_pending_frame_profiles( Vulkan_Context *vulkan_context )
+{
+	for ( uint32_t i = 0; i < vulkan_context->max_frames_in_flight; ++i ) {
+		Vulkan_Frame *frame;
+		frame = &vulkan_context->frames[i];
+
+		if ( frame->has_pending_profile ) {
+			resolve_frame_profile( &vulkan_context->profiler, frame->query_range, &frame->pending_profile );
+			frame->has_pending_profile = false;
+		}
+	}
+
+	return;
+}
+
+/* Startup is split around surface creation, which is the one platform specific step
+
+ - initialize_vulkan_instance                 -- global functions must already be loaded
+	- startup cache / validation layer check / instance / instance functions / debug messenger
+ - <platform creates vulkan_context->surface, sets window_extent>
+ - initialize_vulkan_device_and_swap_chain
+	- physical device (cached or scored) / extensions + queue families / logical device / dispatch table / queues / profiler / memory allocator
+	- frame ring / swap chain / swap chain image cache / startup cache save
+
+ Every phase is timed into vulkan_context->startup_cache.phase_nanoseconds.
+
+*/
+
+// NOTE: warm -- both enumerations are skipped, the cached layer answer stands in for the validation check
+void
+probe_vulkan_instance_capabilities( Vulkan_Context *vulkan_context )
+{
+	Vulkan_Startup_Cache *startup_cache;
+	startup_cache = &vulkan_context->startup_cache;
+
+	if ( !startup_cache->instance_warm ) {
+		verify_instance_supports_required_extensions( vulkan_context );
+	}
+
+	if ( !vulkan_context->validation_enabled ) {
+		return;
+	}
+
+	if ( startup_cache->instance_warm && startup_cache->file.validation_layers_probed ) {
+		vulkan_context->validation_enabled = startup_cache->file.validation_layers_available;
+		if ( !vulkan_context->validation_enabled ) {
+			fprintf( stdout, "Validation layers not installed (cached) -- running without validation\n" );
+		}
+
+		return;
+	}
+
+	verify_instance_supports_validation_layers( vulkan_context );
+	startup_cache->file.validation_layers_probed 	= true;
+	startup_cache->file.validation_layers_available = vulkan_context->validation_enabled;
+	startup_cache->dirty 							= true;
+
+	return;
+}
+
+void
+initialize_vulkan_instance( Vulkan_Context *vulkan_context )
+{
+	Vulkan_Startup_Cache *startup_cache;
+	startup_cache = &vulkan_context->startup_cache;
+
+	load_vulkan_startup_cache( startup_cache, vulkan_context->startup_cache_path );
+
+	bool validation_requested;
+	validation_requested = vulkan_context->validation_enabled;
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_INSTANCE_PROBE );
+	probe_vulkan_instance_capabilities( vulkan_context );
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_CREATE_INSTANCE );
+	vulkan_context->instance = create_vulkan_instance( vulkan_context );
+	if ( vulkan_context->instance == VK_NULL_HANDLE ) {
+		invalidate_startup_cache_instance( startup_cache );
+		vulkan_context->validation_enabled = validation_requested;
+		probe_vulkan_instance_capabilities( vulkan_context );
+		vulkan_context->instance = create_vulkan_instance( vulkan_context );
+	}
+
+	load_vulkan_instance_functions( vulkan_context );
+	load_vulkan_instance_extension_functions( vulkan_context );
+
+	vulkan_context->debug_messenger = create_vulkan_debug_messenger( vulkan_context );
+	end_startup_phase( startup_cache );
+
+	return;
+}
+
+// Enabled extension list and queue topology -- out of the startup cache when the device matched, otherwise
+// one extension enumeration and the full queue family probe, both recorded for the next start
+void
+probe_vulkan_device_capabilities( Vulkan_Context *vulkan_context )
+{
+	Vulkan_Startup_Cache *startup_cache;
+	startup_cache = &vulkan_context->startup_cache;
+
+	if ( !startup_cache->device_warm ) {
+		startup_cache->file.optional_device_extensions_supported = probe_physical_device_extensions( vulkan_context->physical_device );
+	}
+
+	vulkan_context->count_of_enabled_device_extensions = 0;
+	for ( uint32_t i = 0; i < count_of_required_device_extensions; ++i ) {
+		vulkan_context->enabled_device_extensions[vulkan_context->count_of_enabled_device_extensions++] = required_device_extensions[i];
+	}
+
+	for ( uint32_t i = 0; i < count_of_optional_device_extensions; ++i ) {
+		if ( startup_cache->file.optional_device_extensions_supported & ( 1u << i ) ) {
+			vulkan_context->enabled_device_extensions[vulkan_context->count_of_enabled_device_extensions++] = optional_device_extensions[i];
+		}
+	}
+
+	if ( !restore_startup_cache_queue_topology( startup_cache, &vulkan_context->queue_topology, vulkan_context->physical_device, vulkan_context->surface ) ) {
+		select_vulkan_queue_topology( &vulkan_context->queue_topology, vulkan_context->physical_device, vulkan_context->surface );
+		record_startup_cache_queue_families( startup_cache, &vulkan_context->queue_topology );
+		startup_cache->dirty = true;
+	}
+
+	vulkan_context->queue_family_index 			= vulkan_context->queue_topology.roles[VULKAN_QUEUE_GRAPHICS].family_index;
+	vulkan_context->present_queue_family_index 	= vulkan_context->queue_topology.roles[VULKAN_QUEUE_PRESENT].family_index;
+	vulkan_context->transfer_queue_family_index = vulkan_context->queue_topology.roles[VULKAN_QUEUE_TRANSFER].family_index;
+
+	return;
+}
+
+void
+initialize_vulkan_device_and_swap_chain( Vulkan_Context *vulkan_context )
+{
+	Vulkan_Startup_Cache *startup_cache;
+	startup_cache = &vulkan_context->startup_cache;
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_ENUMERATE_DEVICES );
+	VkPhysicalDevice *physical_devices;
+	uint32_t physical_device_count;
+	physical_devices = find_vulkan_enabled_physical_devices( vulkan_context, &physical_device_count );
+	end_startup_phase( startup_cache );
+
+	if ( !vulkan_context->device_override ) {
+		vulkan_context->device_override 	   = getenv( "PLAYGROUND_DEVICE" );
+		vulkan_context->device_override_source = "PLAYGROUND_DEVICE";
+	}
+	else if ( !vulkan_context->device_override_source ) {
+		vulkan_context->device_override_source = "device_override";
+	}
+
+	if ( getenv( "PLAYGROUND_BINDLESS" ) ) {
+		vulkan_context->bindless_requested = true;
+	}
+
+	if ( getenv( "PLAYGROUND_DEVICE_BENCHMARK" ) ) {
+		vulkan_context->device_benchmark_enabled = true;
+	}
+
+	// NOTE: an override or a benchmark run always scores -- the cached device is only the last scored pick
+	begin_startup_phase( startup_cache, STARTUP_PHASE_SELECT_DEVICE );
+	vulkan_context->device_selection.selected_candidate = -1;
+	if ( vulkan_context->device_override || vulkan_context->device_benchmark_enabled ) {
+		vulkan_context->physical_device = select_vulkan_physical_device( &vulkan_context->device_selection, physical_devices, physical_device_count,
+																		 vulkan_context->surface, vulkan_context->device_override, vulkan_context->device_override_source,
+																		 vulkan_context->device_benchmark_enabled );
+
+		// the device half of the cache still applies when the pick is the cached device
+		select_startup_cache_device( startup_cache, &vulkan_context->physical_device, 1 );
+	}
+	else {
+		vulkan_context->physical_device = select_startup_cache_device( startup_cache, physical_devices, physical_device_count );
+		if ( vulkan_context->physical_device == VK_NULL_HANDLE ) {
+			vulkan_context->physical_device = select_vulkan_physical_device( &vulkan_context->device_selection, physical_devices, physical_device_count,
+																			 vulkan_context->surface, NULL, NULL, false );
+		}
+	}
+	free( physical_devices );
+	vkGetPhysicalDeviceProperties( vulkan_context->physical_device, &vulkan_context->physical_device_properties );
+	record_startup_cache_device( startup_cache, &vulkan_context->physical_device_properties );
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_DEVICE_PROBE );
+	probe_vulkan_device_capabilities( vulkan_context );
+	if ( vulkan_context->bindless_requested ) {
+		probe_vulkan_bindless_support( &vulkan_context->bindless.support, vulkan_context->physical_device,
+									   vulkan_context->instance_api_version, vulkan_context->physical_device_properties.apiVersion,
+									   &vulkan_context->enabled_vulkan_12_features );
+		if ( !vulkan_context->bindless.support.supported ) {
+			fprintf( stdout, "Bindless requested but %s -- staying with bound descriptor sets\n", vulkan_context->bindless.support.unsupported_reason );
+		}
+	}
+
+	if ( vulkan_context->gpu_scene_object_count == 0 && getenv( "PLAYGROUND_GPU_SCENE" ) ) {
+		vulkan_context->gpu_scene_object_count = (uint32_t)strtoul( getenv( "PLAYGROUND_GPU_SCENE" ), NULL, 10 );
+	}
+
+	if ( vulkan_context->gpu_scene_object_count > 0 ) {
+		probe_vulkan_gpu_scene_support( &vulkan_context->gpu_scene.support, vulkan_context->physical_device, vulkan_device_is_1_2( vulkan_context ),
+										&vulkan_context->enabled_features, &vulkan_context->enabled_vulkan_12_features );
+		if ( !vulkan_context->gpu_scene.support.supported ) {
+			fprintf( stdout, "GPU scene requested but %s -- skipping it\n", vulkan_context->gpu_scene.support.unsupported_reason );
+		}
+	}
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_CREATE_DEVICE );
+	vulkan_context->logical_device = create_vulkan_logical_device( vulkan_context );
+	if ( vulkan_context->logical_device == VK_NULL_HANDLE ) {
+		invalidate_startup_cache_device( startup_cache );
+		probe_vulkan_device_capabilities( vulkan_context );
+		vulkan_context->logical_device = create_vulkan_logical_device( vulkan_context );
+	}
+
+	uint32_t dispatch_groups;
+	dispatch_groups = VULKAN_DISPATCH_ALL | ( vulkan_device_is_1_2( vulkan_context ) ? VULKAN_DISPATCH_CORE_1_2 : 0 );
+	load_vulkan_device_dispatch( &vulkan_context->dispatch, vulkan_context->logical_device, dispatch_groups,
+								 vulkan_context->enabled_device_extensions, vulkan_context->count_of_enabled_device_extensions );
+
+	get_vulkan_queues( &vulkan_context->queue_topology, &vulkan_context->dispatch );
+	vulkan_context->graphics_queue = vulkan_context->queue_topology.roles[VULKAN_QUEUE_GRAPHICS].queues[0];
+	vulkan_context->present_queue  = vulkan_context->queue_topology.roles[VULKAN_QUEUE_PRESENT].queues[0];
+	vulkan_context->transfer_queue = vulkan_context->queue_topology.roles[VULKAN_QUEUE_TRANSFER].queues[0];
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_DEVICE_SERVICES );
+	create_frame_profiler( &vulkan_context->profiler, &vulkan_context->dispatch, vulkan_context->physical_device, vulkan_context->queue_family_index );
+	create_vulkan_memory_allocator( &vulkan_context->memory, &vulkan_context->dispatch, vulkan_context->physical_device );
+	create_vulkan_uploader( &vulkan_context->uploader, &vulkan_context->dispatch, &vulkan_context->memory,
+							&vulkan_context->last_completed_frame_number,
+							vulkan_context->transfer_queue_family_index, vulkan_context->transfer_queue,
+							vulkan_context->queue_family_index, vulkan_context->graphics_queue );
+
+	// NOTE: requested as early as possible -- the reads overlap the rest of startup, nothing waits for them
+	uint32_t count_of_streaming_threads = 0;
+	if ( getenv( "PLAYGROUND_STREAM_THREADS" ) ) {
+		count_of_streaming_threads = (uint32_t)strtoul( getenv( "PLAYGROUND_STREAM_THREADS" ), NULL, 10 );
+	}
+	create_asset_streamer( &vulkan_context->streamer, &vulkan_context->memory, &vulkan_context->uploader, count_of_streaming_threads );
+
+	if ( !vulkan_context->stream_assets ) {
+		vulkan_context->stream_assets = getenv( "PLAYGROUND_STREAM" );
+	}
+	if ( vulkan_context->stream_assets ) {
+		request_asset_list( &vulkan_context->streamer, vulkan_context->stream_assets );
+	}
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_PIPELINE_CACHE );
+	bool creation_feedback_enabled;
+	creation_feedback_enabled = device_extension_is_enabled( VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME,
+															 vulkan_context->enabled_device_extensions,
+															 vulkan_context->count_of_enabled_device_extensions );
+	create_vulkan_pipeline_cache( &vulkan_context->pipeline_cache, &vulkan_context->dispatch, &vulkan_context->physical_device_properties,
+								  vulkan_context->pipeline_cache_path, creation_feedback_enabled );
+	create_vulkan_object_cache( &vulkan_context->object_cache, &vulkan_context->dispatch );
+
+	if ( !vulkan_context->shader_directory ) {
+		vulkan_context->shader_directory = getenv( "PLAYGROUND_SHADER_DIRECTORY" );
+		if ( !vulkan_context->shader_directory ) {
+			vulkan_context->shader_directory = "shaders";
+		}
+	}
+	create_vulkan_shader_cache( &vulkan_context->shader_cache, &vulkan_context->dispatch, vulkan_context->shader_directory,
+								vulkan_context->shader_hot_reload );
+
+	create_vulkan_descriptor_allocator( &vulkan_context->descriptors, &vulkan_context->dispatch );
+	if ( vulkan_context->bindless.support.supported ) {
+		create_vulkan_bindless( &vulkan_context->bindless, &vulkan_context->dispatch, &vulkan_context->object_cache, &vulkan_context->descriptors );
+	}
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_JOB_SYSTEM );
+	create_job_system( &vulkan_context->jobs, select_count_of_job_workers() );
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_FRAMES );
+	vulkan_context->max_frames_in_flight = select_max_frames_in_flight();
+	create_vulkan_frames_in_flight( vulkan_context );
+
+	if ( vulkan_context->target_frames_per_second == 0.0 && getenv( "PLAYGROUND_TARGET_FPS" ) ) {
+		vulkan_context->target_frames_per_second = strtod( getenv( "PLAYGROUND_TARGET_FPS" ), NULL );
+	}
+
+	if ( vulkan_context->latency_budget_milliseconds == 0.0 && getenv( "PLAYGROUND_LATENCY_BUDGET_MS" ) ) {
+		vulkan_context->latency_budget_milliseconds = strtod( getenv( "PLAYGROUND_LATENCY_BUDGET_MS" ), NULL );
+	}
+
+	create_frame_pacer( &vulkan_context->pacer, vulkan_context->target_frames_per_second, vulkan_context->latency_budget_milliseconds );
+	end_startup_phase( startup_cache );
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_SWAP_CHAIN );
+	vulkan_context->swap_chain 				   = create_vulkan_swap_chain( vulkan_context );		
+	vulkan_context->swap_chain_needs_rebuild   = false;
+	vulkan_context->count_of_swap_chain_images = get_count_of_swap_chain_images( vulkan_context );
+	vulkan_context->swap_chain_images		   = create_vulkan_swap_chain_images( vulkan_context );
+	end_startup_phase( startup_cache );
+
+	VkClearColorValue clear_color = { { 1.0f, 0.8f, 0.4f, 0.0f } };
+	vulkan_context->clear_color = clear_color;
+
+	// NOTE: initial stage 0 -- the image's first use decides where the submit waits on the acquire semaphore
+	Frame_Graph *graph;
+	graph = &vulkan_context->frame_graph;
+	vulkan_context->swap_chain_resource = add_frame_graph_image( graph, "swap_chain", VK_IMAGE_LAYOUT_UNDEFINED, 0, true, FRAME_GRAPH_USAGE_PRESENT );
+
+	uint32_t clear_pass;
+	clear_pass = add_frame_graph_pass( graph, "clear", record_clear_task, NULL );
+	use_frame_graph_resource( graph, clear_pass, vulkan_context->swap_chain_resource, FRAME_GRAPH_USAGE_TRANSFER_WRITE );
+
+	// NOTE: synthetic content until there are assets -- the cull, compaction and read back run for real, there just isn't
+	// a geometry pass drawing the result yet (record_gpu_scene_draws is what it will call)
+	if ( vulkan_context->gpu_scene.support.supported ) {
+		Vulkan_Gpu_Scene *gpu_scene;
+		gpu_scene = &vulkan_context->gpu_scene;
+		create_vulkan_gpu_scene( gpu_scene, &vulkan_context->dispatch, &vulkan_context->memory, &vulkan_context->object_cache,
+								 &vulkan_context->pipeline_cache, &vulkan_context->shader_cache );
+
+		uint32_t count_of_objects;
+		count_of_objects = vulkan_context->gpu_scene_object_count;
+
+		Gpu_Scene_Object *objects;
+		Gpu_Scene_Mesh meshes[16];
+		objects = (Gpu_Scene_Object *)malloc( count_of_objects * sizeof (Gpu_Scene_Object) );
+		if ( !objects ) {
+			fprintf( stdout, "Unable to allocate space for the GPU scene objects\n" );
+			exit( EXIT_FAILURE );
+		}
+		generate_gpu_scene_test_content( objects, count_of_objects, meshes, 16, 8, 1000.0f );
+		upload_gpu_scene( gpu_scene, &vulkan_context->uploader, &vulkan_context->descriptors, vulkan_context->max_frames_in_flight,
+						  objects, count_of_objects, meshes, 16, 8 );
+		free( objects );
+
+		add_gpu_scene_passes( gpu_scene, graph );
+	}
+
+	// NOTE: saved now rather than at shutdown -- short-lived processes are the ones that benefit
+	save_vulkan_startup_cache( startup_cache );
+
+	return;
+}
+
+// 
+//  Doesn't free everything it should, just got tired of tracking through 1100 lines of SETUP CODE ARRRGGGH!!!
+//
+void
+shutdown_vulkan_context( Vulkan_Context *vulkan_context )
+{
+	// shutdown is the one place a full drain is fine
+	vulkan_context->dispatch.vkDeviceWaitIdle( vulkan_context->logical_device );
+	vulkan_context->last_completed_frame_number = vulkan_context->count_of_frames_submitted;
+	destroy_completed_retired_swap_chains( vulkan_context );
+	destroy_vulkan_frames_in_flight( vulkan_context );
+	destroy_vulkan_swap_chain_images( vulkan_context, vulkan_context->swap_chain_images, vulkan_context->count_of_swap_chain_images );
+	save_vulkan_startup_cache( &vulkan_context->startup_cache );		// only if a rebuild had to re-probe
+	destroy_job_system( &vulkan_context->jobs );
+	destroy_frame_profiler( &vulkan_context->profiler );
+	destroy_vulkan_pipeline_cache( &vulkan_context->pipeline_cache );
+	destroy_vulkan_gpu_scene( &vulkan_context->gpu_scene );
+	destroy_vulkan_bindless( &vulkan_context->bindless );
+	destroy_vulkan_shader_cache( &vulkan_context->shader_cache );
+	destroy_vulkan_descriptor_allocator( &vulkan_context->descriptors );
+	destroy_vulkan_object_cache( &vulkan_context->object_cache );
+	destroy_asset_streamer( &vulkan_context->streamer );
+	destroy_vulkan_uploader( &vulkan_context->uploader );
+	destroy_vulkan_memory_allocator( &vulkan_context->memory );
+	destroy_vulkan_device_selection( &vulkan_context->device_selection );
+	vulkan_context->dispatch.vkDestroySwapchainKHR( vulkan_context->logical_device, vulkan_context->swap_chain, NULL );
+	vulkan_context->dispatch.vkDestroyDevice( vulkan_context->logical_device, NULL );
+	vkDestroySurfaceKHR( vulkan_context->instance, vulkan_context->surface, NULL );
+	// NOTE: the messenger goes last so the layer's leak reports at device / instance destruction are still counted
+	if ( vulkan_context->debug_messenger != VK_NULL_HANDLE ) {
+		vkDestroyDebugUtilsMessengerEXT( vulkan_context->instance, vulkan_context->debug_messenger, NULL );
+	}
+	vkDestroyInstance( vulkan_context->instance, NULL );
+
+	return;
+}
@@ -0,0 +1,503 @@
+// SPIR-V shader modules, loaded by name from one directory. get_vulkan_shader( cache, "name.spv" ) hands back a
+// Vulkan_Shader that stays at the same address for the life of the cache -- callers keep the pointer and read
+// ->module when they build a pipeline, ->generation tells them a pipeline built earlier is out of date.
+//
+// Files are memory mapped rather than read into a heap buffer: the driver copies the code out inside
+// vkCreateShaderModule, so the mapping only lives for that call (and a dedupe compare, below). It's unmapped
+// straight after -- keeping it would turn a compiler truncating the file into a SIGBUS.
+// Modules are deduped by content: two names with the same bytes (or a touched but unchanged file) share one
+// VkShaderModule, refcounted by the shaders pointing at it. FNV-1a of the code plus its size finds candidates,
+// and a memcmp against the module's own copy of the code decides -- the driver's copy can't be read back.
+//
+// With hot reload on, a watcher thread waits on the directory (inotify / ReadDirectoryChangesW). Changed files
+// that some shader was loaded from get a new module built on that thread, then queued; the render thread swaps
+// them in with apply_vulkan_shader_reloads() at a frame boundary, so nothing mid-frame sees a module change.
+// A file that doesn't validate (missing, half written, not SPIR-V) keeps the old module and is retried on its next
+// change. Only the directory itself is watched, not subdirectories.
+//
+// Unity built -- included by vulkan_renderer.c, needs the platform layer's file map, directory watch, threads,
+// mutex and atomics.
+
+#define MAX_VULKAN_SHADERS				256
+#define MAX_VULKAN_SHADER_MODULES		( 2 * MAX_VULKAN_SHADERS )		// each shader's current module plus a pending one
+#define VULKAN_SHADER_NAME_CAPACITY		128
+#define VULKAN_SHADER_PATH_CAPACITY		1024
+#define VULKAN_SHADER_WATCH_TIMEOUT		100								// milliseconds -- how long stopping the watcher can take
+#define VULKAN_SHADER_SETTLE_TIMEOUT	50								// milliseconds -- quiet time before a burst of changes is rebuilt
+#define SPIRV_MAGIC_NUMBER				0x07230203
+
+typedef struct {
+
+	VkShaderModule	module;							// VK_NULL_HANDLE -- free slot
+	uint64_t		hash;
+	uint64_t		size;
+	uint8_t			*code;							// size bytes, for the dedupe compare
+	uint32_t		count_of_references;			// shaders using it, current or pending
+
+} Vulkan_Shader_Module;
+
+typedef struct {
+
+	char			name[VULKAN_SHADER_NAME_CAPACITY];
+	VkShaderModule	module;
+	uint64_t		hash;
+	uint32_t		generation;						// bumped every time a reload is swapped in
+
+	uint32_t		module_index;
+	int32_t			pending_module_index;			// -1 -- no reload waiting for the frame boundary
+
+} Vulkan_Shader;
+
+typedef struct {
+
+	Vulkan_Device_Dispatch	*dispatch;
+	char					directory[VULKAN_SHADER_PATH_CAPACITY];
+
+	Platform_Mutex			mutex;					// the tables below -- ->module of a shader is render thread only
+	Vulkan_Shader			shaders[MAX_VULKAN_SHADERS];
+	uint32_t				count_of_shaders;
+	Vulkan_Shader_Module	modules[MAX_VULKAN_SHADER_MODULES];
+	uint32_t				count_of_modules;
+	volatile int32_t		count_of_pending_swaps;
+
+	bool					watching;
+	Platform_Directory_Watch	watch;
+	Platform_Thread			watch_thread;
+	volatile int32_t		stop_watching;
+
+	uint64_t				count_of_loads;			// files mapped and validated
+	uint64_t				count_of_dedupe_hits;	// loads that found their module already made
+	uint64_t				count_of_bytes_mapped;
+	uint64_t				load_nanoseconds;		// map + validate + hash + vkCreateShaderModule
+	uint32_t				count_of_reloads;		// swapped in at a frame boundary
+	uint32_t				count_of_failed_reloads;
+
+} Vulkan_Shader_Cache;
+
+uint64_t
+hash_spirv_code( uint8_t *code, uint64_t size )
+{
+	uint64_t hash = 14695981039346656037ull;
+
+	for ( uint64_t i = 0; i < size; ++i ) {
+		hash ^= code[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+// caller holds the mutex
+void
+release_vulkan_shader_module( Vulkan_Shader_Cache *cache, uint32_t module_index )
+{
+	Vulkan_Shader_Module *module;
+	module = &cache->modules[module_index];
+
+	module->count_of_references -= 1;
+	if ( module->count_of_references == 0 ) {
+		cache->dispatch->vkDestroyShaderModule( cache->dispatch->logical_device, module->module, NULL );
+		free( module->code );
+		memset( module, 0, sizeof (Vulkan_Shader_Module) );
+		cache->count_of_modules -= 1;
+	}
+
+	return;
+}
+
+// caller holds the mutex. -1 if nothing matches.
+int32_t
+find_vulkan_shader_module( Vulkan_Shader_Cache *cache, uint64_t hash, uint8_t *code, uint64_t size )
+{
+	for ( uint32_t i = 0; i < MAX_VULKAN_SHADER_MODULES; ++i ) {
+		Vulkan_Shader_Module *module;
+		module = &cache->modules[i];
+		if ( module->module != VK_NULL_HANDLE && module->hash == hash && module->size == size &&
+			 memcmp( module->code, code, (size_t)size ) == 0 ) {
+			return (int32_t)i;
+		}
+	}
+
+	return -1;
+}
+
+// caller holds the mutex. -1 if nothing matches.
+int32_t
+find_vulkan_shader( Vulkan_Shader_Cache *cache, char *name )
+{
+	for ( uint32_t i = 0; i < cache->count_of_shaders; ++i ) {
+		if ( strcmp( cache->shaders[i].name, name ) == 0 ) {
+			return (int32_t)i;
+		}
+	}
+
+	return -1;
+}
+
+// Maps directory/name and hands back a referenced module index, made or shared. Called without the mutex -- the
+// driver call happens outside it so a reload being built never holds up the render thread. -1 if the file is
+// missing or isn't SPIR-V.
+int32_t
+load_vulkan_shader_module( Vulkan_Shader_Cache *cache, char *name )
+{
+	uint64_t start;
+	start = platform_get_timestamp_in_nanoseconds();
+
+	char path[VULKAN_SHADER_PATH_CAPACITY];
+	if ( snprintf( path, sizeof (path), "%s/%s", cache->directory, name ) >= (int)sizeof (path) ) {
+		return -1;
+	}
+
+	Platform_File_Map file_map;
+	if ( !platform_map_file_for_reading( path, &file_map ) ) {
+		return -1;
+	}
+
+	// NOTE: a file caught mid-write usually fails here -- the next change event brings it back around
+	uint8_t *code;
+	code = (uint8_t *)file_map.data;
+	if ( file_map.size < 20 || ( file_map.size % 4 ) != 0 || *(uint32_t *)code != SPIRV_MAGIC_NUMBER ) {
+		platform_unmap_file( &file_map );
+		return -1;
+	}
+
+	uint64_t hash;
+	hash = hash_spirv_code( code, file_map.size );
+
+	platform_lock_mutex( &cache->mutex );
+	cache->count_of_loads        += 1;
+	cache->count_of_bytes_mapped += file_map.size;
+
+	int32_t module_index;
+	module_index = find_vulkan_shader_module( cache, hash, code, file_map.size );
+	if ( module_index >= 0 ) {
+		cache->modules[module_index].count_of_references += 1;
+		cache->count_of_dedupe_hits += 1;
+		cache->load_nanoseconds     += platform_get_timestamp_in_nanoseconds() - start;
+		platform_unlock_mutex( &cache->mutex );
+		platform_unmap_file( &file_map );
+		return module_index;
+	}
+	platform_unlock_mutex( &cache->mutex );
+
+	VkShaderModuleCreateInfo module_create_info = { 0 };
+	module_create_info.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	module_create_info.codeSize = (size_t)file_map.size;
+	module_create_info.pCode    = (const uint32_t *)code;
+
+	VkShaderModule shader_module;
+	VkResult result;
+	result = cache->dispatch->vkCreateShaderModule( cache->dispatch->logical_device, &module_create_info, NULL, &shader_module );
+	if ( result != VK_SUCCESS ) {
+		platform_unmap_file( &file_map );
+		return -1;
+	}
+
+	uint8_t *code_copy;
+	code_copy = (uint8_t *)malloc( (size_t)file_map.size );
+	if ( !code_copy ) {
+		fprintf( stdout, "Unable to allocate %llu bytes of shader code\n", (unsigned long long)file_map.size );
+		exit( EXIT_FAILURE );
+	}
+	memcpy( code_copy, code, (size_t)file_map.size );
+	platform_unmap_file( &file_map );
+
+	platform_lock_mutex( &cache->mutex );
+
+	// someone else may have made the same module while the lock was dropped -- theirs wins
+	module_index = find_vulkan_shader_module( cache, hash, code_copy, module_create_info.codeSize );
+	if ( module_index >= 0 ) {
+		cache->modules[module_index].count_of_references += 1;
+		cache->count_of_dedupe_hits += 1;
+		cache->dispatch->vkDestroyShaderModule( cache->dispatch->logical_device, shader_module, NULL );
+		free( code_copy );
+	}
+	else {
+		for ( uint32_t i = 0; i < MAX_VULKAN_SHADER_MODULES; ++i ) {
+			if ( cache->modules[i].module == VK_NULL_HANDLE ) {
+				module_index = (int32_t)i;
+				break;
+			}
+		}
+
+		if ( module_index < 0 ) {
+			fprintf( stdout, "Ran out of shader module slots (%u)\n", MAX_VULKAN_SHADER_MODULES );
+			exit( EXIT_FAILURE );
+		}
+
+		Vulkan_Shader_Module *module;
+		module = &cache->modules[module_index];
+		module->module 				= shader_module;
+		module->hash   				= hash;
+		module->size   				= module_create_info.codeSize;
+		module->code 				= code_copy;
+		module->count_of_references = 1;
+		cache->count_of_modules += 1;
+	}
+
+	cache->load_nanoseconds += platform_get_timestamp_in_nanoseconds() - start;
+	platform_unlock_mutex( &cache->mutex );
+
+	return module_index;
+}
+
+// Builds the new module on the watcher thread and leaves it pending -- apply_vulkan_shader_reloads() swaps it in
+void
+reload_vulkan_shader( Vulkan_Shader_Cache *cache, char *name )
+{
+	platform_lock_mutex( &cache->mutex );
+	int32_t shader_index;
+	shader_index = find_vulkan_shader( cache, name );
+	platform_unlock_mutex( &cache->mutex );
+
+	// not something anyone asked for -- it gets loaded when they do
+	if ( shader_index < 0 ) {
+		return;
+	}
+
+	int32_t module_index;
+	module_index = load_vulkan_shader_module( cache, name );
+	if ( module_index < 0 ) {
+		platform_lock_mutex( &cache->mutex );
+		cache->count_of_failed_reloads += 1;
+		platform_unlock_mutex( &cache->mutex );
+		fprintf( stdout, "Shader reload failed for %s -- keeping the old module\n", name );
+		return;
+	}
+
+	platform_lock_mutex( &cache->mutex );
+
+	Vulkan_Shader *shader;
+	shader = &cache->shaders[shader_index];
+
+	if ( shader->pending_module_index >= 0 ) {
+		release_vulkan_shader_module( cache, (uint32_t)shader->pending_module_index );
+		shader->pending_module_index = -1;
+		platform_atomic_add_32( &cache->count_of_pending_swaps, -1 );
+	}
+
+	// saved without changes -- nothing to swap
+	if ( (uint32_t)module_index == shader->module_index ) {
+		release_vulkan_shader_module( cache, (uint32_t)module_index );
+	}
+	else {
+		shader->pending_module_index = module_index;
+		platform_atomic_add_32( &cache->count_of_pending_swaps, 1 );
+	}
+
+	platform_unlock_mutex( &cache->mutex );
+
+	return;
+}
+
+void
+watch_vulkan_shader_directory( void *parameter )
+{
+	Vulkan_Shader_Cache *cache;
+	cache = (Vulkan_Shader_Cache *)parameter;
+
+	char changed_names[16][VULKAN_SHADER_NAME_CAPACITY];
+	uint32_t count_of_changed_names;
+
+	while ( !platform_atomic_load_32( &cache->stop_watching ) ) {
+		char name[VULKAN_SHADER_NAME_CAPACITY];
+		if ( !platform_wait_for_directory_change( &cache->watch, VULKAN_SHADER_WATCH_TIMEOUT, name, sizeof (name) ) ) {
+			// NOTE: a broken watch would fail every call -- give up on hot reload rather than spin
+			if ( cache->watch.broken ) {
+				fprintf( stderr, "Shader directory watch failed, hot reload is off\n" );
+				break;
+			}
+
+			continue;
+		}
+
+		// compilers and editors touch a file several times per save -- wait for the burst to go quiet, then
+		// rebuild each changed name once
+		count_of_changed_names = 0;
+		do {
+			bool already_changed = false;
+			for ( uint32_t i = 0; i < count_of_changed_names; ++i ) {
+				if ( strcmp( changed_names[i], name ) == 0 ) {
+					already_changed = true;
+					break;
+				}
+			}
+
+			// NOTE: past 16 in one burst the rest wait for their next save
+			if ( !already_changed && count_of_changed_names < 16 ) {
+				strcpy( changed_names[count_of_changed_names], name );
+				count_of_changed_names += 1;
+			}
+		} while ( platform_wait_for_directory_change( &cache->watch, VULKAN_SHADER_SETTLE_TIMEOUT, name, sizeof (name) ) );
+
+		for ( uint32_t i = 0; i < count_of_changed_names; ++i ) {
+			reload_vulkan_shader( cache, changed_names[i] );
+		}
+	}
+
+	return;
+}
+
+void
+create_vulkan_shader_cache( Vulkan_Shader_Cache *cache, Vulkan_Device_Dispatch *dispatch, char *directory, bool hot_reload )
+{
+	memset( cache, 0, sizeof (Vulkan_Shader_Cache) );
+	cache->dispatch = dispatch;
+	platform_create_mutex( &cache->mutex );
+
+	if ( snprintf( cache->directory, sizeof (cache->directory), "%s", directory ) >= (int)sizeof (cache->directory) ) {
+		fprintf( stdout, "Shader directory path is too long: %s\n", directory );
+		exit( EXIT_FAILURE );
+	}
+
+	if ( !hot_reload ) {
+		return;
+	}
+
+	// NOTE: not fatal -- shaders still load, they just don't reload
+	if ( !platform_watch_directory( cache->directory, &cache->watch ) ) {
+		fprintf( stdout, "Unable to watch shader directory %s -- hot reload is off\n", cache->directory );
+		return;
+	}
+
+	cache->watching = true;
+	platform_create_thread( &cache->watch_thread, watch_vulkan_shader_directory, cache );
+
+	return;
+}
+
+// Loads on first use. Blocks on the file and the driver, so ask for shaders during setup, not mid-frame.
+Vulkan_Shader *
+get_vulkan_shader( Vulkan_Shader_Cache *cache, char *name )
+{
+	platform_lock_mutex( &cache->mutex );
+	int32_t shader_index;
+	shader_index = find_vulkan_shader( cache, name );
+	platform_unlock_mutex( &cache->mutex );
+
+	if ( shader_index >= 0 ) {
+		return &cache->shaders[shader_index];
+	}
+
+	if ( strlen( name ) >= VULKAN_SHADER_NAME_CAPACITY ) {
+		fprintf( stdout, "Shader name is too long: %s\n", name );
+		exit( EXIT_FAILURE );
+	}
+
+	int32_t module_index;
+	module_index = load_vulkan_shader_module( cache, name );
+	if ( module_index < 0 ) {
+		fprintf( stdout, "Unable to load shader %s/%s\n", cache->directory, name );
+		exit( EXIT_FAILURE );
+	}
+
+	platform_lock_mutex( &cache->mutex );
+
+	// lost a race with another thread loading the same name
+	shader_index = find_vulkan_shader( cache, name );
+	if ( shader_index >= 0 ) {
+		release_vulkan_shader_module( cache, (uint32_t)module_index );
+		platform_unlock_mutex( &cache->mutex );
+		return &cache->shaders[shader_index];
+	}
+
+	if ( cache->count_of_shaders == MAX_VULKAN_SHADERS ) {
+		fprintf( stdout, "Ran out of shader slots (%u)\n", MAX_VULKAN_SHADERS );
+		exit( EXIT_FAILURE );
+	}
+
+	Vulkan_Shader *shader;
+	shader = &cache->shaders[cache->count_of_shaders];
+	strcpy( shader->name, name );
+	shader->module 				 = cache->modules[module_index].module;
+	shader->hash   				 = cache->modules[module_index].hash;
+	shader->module_index 		 = (uint32_t)module_index;
+	shader->pending_module_index = -1;
+	cache->count_of_shaders += 1;
+
+	platform_unlock_mutex( &cache->mutex );
+
+	return shader;
+}
+
+// Frame boundary -- swaps in whatever the watcher finished since last frame. Cheap to call every frame, only
+// reads one counter unless a reload is waiting. Modules can go away as soon as pipelines are built from them,
+// so the replaced one is released right here.
+void
+apply_vulkan_shader_reloads( Vulkan_Shader_Cache *cache )
+{
+	if ( platform_atomic_load_32( &cache->count_of_pending_swaps ) == 0 ) {
+		return;
+	}
+
+	platform_lock_mutex( &cache->mutex );
+
+	for ( uint32_t i = 0; i < cache->count_of_shaders; ++i ) {
+		Vulkan_Shader *shader;
+		shader = &cache->shaders[i];
+		if ( shader->pending_module_index < 0 ) {
+			continue;
+		}
+
+		uint32_t replaced_module_index;
+		replaced_module_index = shader->module_index;
+
+		shader->module_index 		 = (uint32_t)shader->pending_module_index;
+		shader->module 		 		 = cache->modules[shader->module_index].module;
+		shader->hash   		 		 = cache->modules[shader->module_index].hash;
+		shader->generation 			+= 1;
+		shader->pending_module_index = -1;
+
+		release_vulkan_shader_module( cache, replaced_module_index );
+		platform_atomic_add_32( &cache->count_of_pending_swaps, -1 );
+		cache->count_of_reloads += 1;
+	}
+
+	platform_unlock_mutex( &cache->mutex );
+
+	return;
+}
+
+void
+destroy_vulkan_shader_cache( Vulkan_Shader_Cache *cache )
+{
+	if ( cache->watching ) {
+		platform_atomic_store_32( &cache->stop_watching, 1 );
+		platform_join_thread( cache->watch_thread );
+		platform_unwatch_directory( &cache->watch );
+		cache->watching = false;
+	}
+
+	// NOTE: pending reloads hold references too, so this catches every module
+	for ( uint32_t i = 0; i < MAX_VULKAN_SHADER_MODULES; ++i ) {
+		if ( cache->modules[i].module != VK_NULL_HANDLE ) {
+			cache->dispatch->vkDestroyShaderModule( cache->dispatch->logical_device, cache->modules[i].module, NULL );
+			free( cache->modules[i].code );
+		}
+	}
+
+	memset( cache->modules, 0, sizeof (cache->modules) );
+	cache->count_of_modules = 0;
+	platform_destroy_mutex( &cache->mutex );
+
+	return;
+}
+
+void
+export_vulkan_shader_cache_as_json( Vulkan_Shader_Cache *cache, FILE *output, char *indentation )
+{
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"directory\": \"%s\",\n", indentation, cache->directory );
+	fprintf( output, "%s  \"hot_reload\": %s,\n", indentation, cache->watching ? "true" : "false" );
+	fprintf( output, "%s  \"shaders\": %u,\n", indentation, cache->count_of_shaders );
+	fprintf( output, "%s  \"modules\": %u,\n", indentation, cache->count_of_modules );
+	fprintf( output, "%s  \"loads\": %llu,\n", indentation, (unsigned long long)cache->count_of_loads );
+	fprintf( output, "%s  \"dedupe_hits\": %llu,\n", indentation, (unsigned long long)cache->count_of_dedupe_hits );
+	fprintf( output, "%s  \"bytes_mapped\": %llu,\n", indentation, (unsigned long long)cache->count_of_bytes_mapped );
+	fprintf( output, "%s  \"load_ms\": %.3f,\n", indentation, (double)cache->load_nanoseconds / 1000000.0 );
+	fprintf( output, "%s  \"reloads\": %u,\n", indentation, cache->count_of_reloads );
+	fprintf( output, "%s  \"failed_reloads\": %u\n", indentation, cache->count_of_failed_reloads );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
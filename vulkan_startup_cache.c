@@ -0,0 +1,450 @@
+// Startup capability cache and init-phase timers. A short-lived process spends most of its startup asking
+// the loader and driver things that never change between runs: which instance extensions and layers exist,
+// what the device supports, its queue families, the surface formats and present modes. The answers are
+// written to a small file after a cold start and trusted on the next one:
+//
+//  - instance level -- usable when the file was written by a binary asking for the same extensions and
+//    layers (probe_signature), so the extension / layer enumeration is skipped
+//  - device level -- usable when one of the enumerated devices matches the cached vendorID / deviceID /
+//    driverVersion / pipelineCacheUUID, so device selection, extension enumeration, the queue family probe
+//    and the surface format / present mode queries are all skipped
+//
+// Validation is lazy: nothing cached is re-checked up front. When vkCreateInstance / vkCreateDevice /
+// vkCreateSwapchainKHR fails on cached answers, the cache is invalidated, the full probe runs and the call is
+// retried once. The one eager check is a single present-support query on the cached present family.
+//
+// NOTE: physical devices still get enumerated on a warm start -- that's where the handle comes from.
+//
+// Unity built -- included by vulkan_renderer.c after the queue topology, needs the platform file services.
+
+#define STARTUP_CACHE_MAGIC				0x48435356		// "VSCH"
+#define STARTUP_CACHE_VERSION			1
+#define MAX_CACHED_SURFACE_FORMATS		64
+#define MAX_CACHED_PRESENT_MODES		8
+
+typedef enum {
+
+	STARTUP_PHASE_LOAD_CACHE,
+	STARTUP_PHASE_INSTANCE_PROBE,			// instance extensions + validation layers
+	STARTUP_PHASE_CREATE_INSTANCE,			// instance, instance functions, debug messenger
+	STARTUP_PHASE_ENUMERATE_DEVICES,
+	STARTUP_PHASE_SELECT_DEVICE,
+	STARTUP_PHASE_DEVICE_PROBE,				// device extensions + queue families
+	STARTUP_PHASE_CREATE_DEVICE,			// device, dispatch table, queues
+	STARTUP_PHASE_DEVICE_SERVICES,			// profiler, memory allocator, uploader
+	STARTUP_PHASE_PIPELINE_CACHE,
+	STARTUP_PHASE_JOB_SYSTEM,
+	STARTUP_PHASE_FRAMES,
+	STARTUP_PHASE_SWAP_CHAIN,				// including the surface format / present mode probe
+	STARTUP_PHASE_SAVE_CACHE,
+
+	STARTUP_PHASE_COUNT
+
+} Startup_Phase;
+
+char *startup_phase_names[STARTUP_PHASE_COUNT] = {
+	"load_cache",
+	"instance_probe",
+	"create_instance",
+	"enumerate_devices",
+	"select_device",
+	"device_probe",
+	"create_device",
+	"device_services",
+	"pipeline_cache",
+	"job_system",
+	"frames",
+	"swap_chain",
+	"save_cache",
+};
+
+typedef enum {
+
+	STARTUP_CACHE_COLD_NO_FILE,
+	STARTUP_CACHE_COLD_BAD_HEADER,				// other size / magic / version -- other build or torn file
+	STARTUP_CACHE_COLD_OTHER_CONFIGURATION,		// other extension / layer lists or surface kind
+	STARTUP_CACHE_COLD_OTHER_DEVICE_OR_DRIVER,	// instance half was still used
+	STARTUP_CACHE_WARM,
+
+} Startup_Cache_Load_Result;
+
+char *startup_cache_load_result_names[] = {
+	"no_file",
+	"bad_header",
+	"other_configuration",
+	"other_device_or_driver",
+	"warm",
+};
+
+// Written to disk as is -- the size in the header keeps other builds' layouts out
+typedef struct {
+
+	uint32_t			magic;
+	uint32_t			version;
+	uint32_t			size;
+	uint32_t			probe_signature;
+
+	// instance
+	uint32_t			validation_layers_probed;
+	uint32_t			validation_layers_available;
+
+	// device key
+	uint32_t			has_device;
+	uint32_t			vendor_id;
+	uint32_t			device_id;
+	uint32_t			driver_version;
+	uint8_t				pipeline_cache_uuid[VK_UUID_SIZE];
+
+	// device
+	uint32_t			optional_device_extensions_supported;		// bit per optional_device_extensions entry
+	uint32_t			count_of_queue_families;
+	VkQueueFamilyProperties	queue_family_properties[MAX_QUEUE_FAMILIES];
+	uint32_t			graphics_family_index;
+	uint32_t			present_family_index;
+
+	// surface -- count 0 means not probed yet
+	uint32_t			count_of_surface_formats;
+	VkSurfaceFormatKHR	surface_formats[MAX_CACHED_SURFACE_FORMATS];
+	uint32_t			count_of_present_modes;
+	VkPresentModeKHR	present_modes[MAX_CACHED_PRESENT_MODES];
+
+} Startup_Cache_File;
+
+typedef struct {
+
+	char						*path;						// NULL -- nothing persisted, every start probes
+	Startup_Cache_File			file;						// what this run knows, trusted or probed
+	Startup_Cache_Load_Result	load_result;
+	bool						instance_warm;
+	bool						device_warm;
+	bool						surface_warm;				// surface arrays came from disk, not probed this run
+	bool						dirty;
+	uint32_t					count_of_fallbacks;			// cached answers the driver disagreed with
+
+	Startup_Phase				current_phase;
+	uint64_t					phase_start;
+	uint64_t					phase_nanoseconds[STARTUP_PHASE_COUNT];
+
+} Vulkan_Startup_Cache;
+
+
+// NOTE: FNV-1a, chained
+uint32_t
+hash_startup_cache_string( uint32_t hash, char *string )
+{
+	for ( char *c = string; *c; ++c ) {
+		hash ^= (uint8_t)*c;
+		hash *= 16777619u;
+	}
+
+	// separator, so { "ab", "c" } and { "a", "bc" } differ
+	hash ^= 0xff;
+	hash *= 16777619u;
+
+	return hash;
+}
+
+// Everything this binary asks the loader / driver for -- a different list means the cached answers are about other questions
+uint32_t
+compute_startup_cache_probe_signature( void )
+{
+	uint32_t hash = 2166136261u;
+
+	for ( uint32_t i = 0; i < count_of_required_instance_extensions; ++i ) {
+		hash = hash_startup_cache_string( hash, required_instance_extensions[i] );
+	}
+
+	for ( uint32_t i = 0; i < count_of_validation_layers; ++i ) {
+		hash = hash_startup_cache_string( hash, validation_layers[i] );
+	}
+
+	for ( uint32_t i = 0; i < count_of_required_device_extensions; ++i ) {
+		hash = hash_startup_cache_string( hash, required_device_extensions[i] );
+	}
+
+	for ( uint32_t i = 0; i < count_of_optional_device_extensions; ++i ) {
+		hash = hash_startup_cache_string( hash, optional_device_extensions[i] );
+	}
+
+	return hash;
+}
+
+void
+begin_startup_phase( Vulkan_Startup_Cache *startup_cache, Startup_Phase phase )
+{
+	startup_cache->current_phase = phase;
+	startup_cache->phase_start 	 = platform_get_timestamp_in_nanoseconds();
+
+	return;
+}
+
+// NOTE: accumulates -- a phase that falls back and runs again counts both attempts
+void
+end_startup_phase( Vulkan_Startup_Cache *startup_cache )
+{
+	startup_cache->phase_nanoseconds[startup_cache->current_phase] += platform_get_timestamp_in_nanoseconds() - startup_cache->phase_start;
+
+	return;
+}
+
+void
+reset_startup_cache_device( Vulkan_Startup_Cache *startup_cache )
+{
+	Startup_Cache_File *file;
+	file = &startup_cache->file;
+
+	file->has_device 						   = 0;
+	file->optional_device_extensions_supported = 0;
+	file->count_of_queue_families 			   = 0;
+	file->count_of_surface_formats 			   = 0;
+	file->count_of_present_modes 			   = 0;
+
+	startup_cache->device_warm  = false;
+	startup_cache->surface_warm = false;
+
+	return;
+}
+
+void
+load_vulkan_startup_cache( Vulkan_Startup_Cache *startup_cache, char *path )
+{
+	memset( startup_cache, 0, sizeof (Vulkan_Startup_Cache) );
+	startup_cache->path 		= path;
+	startup_cache->load_result 	= STARTUP_CACHE_COLD_NO_FILE;
+	startup_cache->dirty 		= true;
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_LOAD_CACHE );
+
+	uint32_t probe_signature;
+	probe_signature = compute_startup_cache_probe_signature();
+
+	Platform_File_Map file_map = { 0 };
+	if ( path && platform_map_file_for_reading( path, &file_map ) ) {
+		Startup_Cache_File *file;
+		file = (Startup_Cache_File *)file_map.data;
+
+		if ( file_map.size != sizeof (Startup_Cache_File) || file->magic != STARTUP_CACHE_MAGIC ||
+			 file->version != STARTUP_CACHE_VERSION || file->size != sizeof (Startup_Cache_File) ) {
+			startup_cache->load_result = STARTUP_CACHE_COLD_BAD_HEADER;
+		}
+		else if ( file->probe_signature != probe_signature ) {
+			startup_cache->load_result = STARTUP_CACHE_COLD_OTHER_CONFIGURATION;
+		}
+		else {
+			memcpy( &startup_cache->file, file, sizeof (Startup_Cache_File) );
+			startup_cache->instance_warm = true;
+			startup_cache->dirty 		 = false;
+
+			// NOTE: optimistic until the device check -- select_startup_cache_device() has the final say
+			startup_cache->load_result 	 = STARTUP_CACHE_WARM;
+		}
+
+		platform_unmap_file( &file_map );
+	}
+
+	if ( !startup_cache->instance_warm ) {
+		memset( &startup_cache->file, 0, sizeof (Startup_Cache_File) );
+	}
+
+	startup_cache->file.magic 			= STARTUP_CACHE_MAGIC;
+	startup_cache->file.version 		= STARTUP_CACHE_VERSION;
+	startup_cache->file.size 			= sizeof (Startup_Cache_File);
+	startup_cache->file.probe_signature = probe_signature;
+
+	end_startup_phase( startup_cache );
+
+	return;
+}
+
+// A cached answer turned out wrong. Each level drops itself and everything below it, the caller re-probes.
+void
+count_startup_cache_fallback( Vulkan_Startup_Cache *startup_cache, char *what )
+{
+	fprintf( stderr, "Startup cache out of date (%s) -- probing again\n", what );
+
+	startup_cache->dirty 			   = true;
+	startup_cache->count_of_fallbacks += 1;
+
+	return;
+}
+
+void
+invalidate_startup_cache_instance( Vulkan_Startup_Cache *startup_cache )
+{
+	count_startup_cache_fallback( startup_cache, "instance" );
+
+	startup_cache->instance_warm 				 = false;
+	startup_cache->file.validation_layers_probed = false;
+	reset_startup_cache_device( startup_cache );
+
+	return;
+}
+
+// NOTE: keeps the device key -- the device is still the one we want, only what we knew about it was off
+void
+invalidate_startup_cache_device( Vulkan_Startup_Cache *startup_cache )
+{
+	count_startup_cache_fallback( startup_cache, "device" );
+
+	bool has_device;
+	has_device = startup_cache->file.has_device;
+
+	reset_startup_cache_device( startup_cache );
+	startup_cache->file.has_device = has_device;
+
+	return;
+}
+
+void
+invalidate_startup_cache_surface( Vulkan_Startup_Cache *startup_cache )
+{
+	count_startup_cache_fallback( startup_cache, "surface" );
+
+	startup_cache->file.count_of_surface_formats = 0;
+	startup_cache->file.count_of_present_modes 	 = 0;
+	startup_cache->surface_warm 				 = false;
+
+	return;
+}
+
+// Returns the enumerated device the cache was written for, VK_NULL_HANDLE when it isn't there anymore
+// (or the driver was updated) -- the device half of the cache is dropped then
+VkPhysicalDevice
+select_startup_cache_device( Vulkan_Startup_Cache *startup_cache, VkPhysicalDevice *physical_devices, uint32_t physical_device_count )
+{
+	Startup_Cache_File *file;
+	file = &startup_cache->file;
+
+	if ( startup_cache->instance_warm && file->has_device ) {
+		for ( uint32_t i = 0; i < physical_device_count; ++i ) {
+			VkPhysicalDeviceProperties device_properties;
+			vkGetPhysicalDeviceProperties( physical_devices[i], &device_properties );
+
+			if ( device_properties.vendorID == file->vendor_id && device_properties.deviceID == file->device_id &&
+				 device_properties.driverVersion == file->driver_version &&
+				 memcmp( device_properties.pipelineCacheUUID, file->pipeline_cache_uuid, VK_UUID_SIZE ) == 0 ) {
+
+				startup_cache->device_warm  = true;
+				startup_cache->surface_warm = ( file->count_of_surface_formats > 0 && file->count_of_present_modes > 0 );
+
+				return physical_devices[i];
+			}
+		}
+	}
+
+	if ( startup_cache->instance_warm ) {
+		startup_cache->load_result = STARTUP_CACHE_COLD_OTHER_DEVICE_OR_DRIVER;
+	}
+
+	reset_startup_cache_device( startup_cache );
+	startup_cache->dirty = true;
+
+	return VK_NULL_HANDLE;
+}
+
+void
+record_startup_cache_device( Vulkan_Startup_Cache *startup_cache, VkPhysicalDeviceProperties *device_properties )
+{
+	Startup_Cache_File *file;
+	file = &startup_cache->file;
+
+	file->has_device 	 = 1;
+	file->vendor_id 	 = device_properties->vendorID;
+	file->device_id 	 = device_properties->deviceID;
+	file->driver_version = device_properties->driverVersion;
+	memcpy( file->pipeline_cache_uuid, device_properties->pipelineCacheUUID, VK_UUID_SIZE );
+
+	return;
+}
+
+void
+record_startup_cache_queue_families( Vulkan_Startup_Cache *startup_cache, Vulkan_Queue_Topology *topology )
+{
+	Startup_Cache_File *file;
+	file = &startup_cache->file;
+
+	file->count_of_queue_families = topology->count_of_queue_families;
+	memcpy( file->queue_family_properties, topology->queue_family_properties, topology->count_of_queue_families * sizeof (VkQueueFamilyProperties) );
+	file->graphics_family_index = topology->roles[VULKAN_QUEUE_GRAPHICS].family_index;
+	file->present_family_index 	= topology->roles[VULKAN_QUEUE_PRESENT].family_index;
+
+	return;
+}
+
+// Rebuilds the topology from the cached families. false when there's nothing cached or the cached present
+// family can't present to this surface -- the caller runs the full probe then
+bool
+restore_startup_cache_queue_topology( Vulkan_Startup_Cache *startup_cache, Vulkan_Queue_Topology *topology,
+									  VkPhysicalDevice physical_device, VkSurfaceKHR surface )
+{
+	Startup_Cache_File *file;
+	file = &startup_cache->file;
+
+	if ( !startup_cache->device_warm || file->count_of_queue_families == 0 || file->count_of_queue_families > MAX_QUEUE_FAMILIES ||
+		 file->graphics_family_index >= file->count_of_queue_families || file->present_family_index >= file->count_of_queue_families ) {
+		return false;
+	}
+
+	// NOTE: a new surface every run -- the one query that isn't worth trusting to the cache
+	VkBool32 has_presentation_support = VK_FALSE;
+	vkGetPhysicalDeviceSurfaceSupportKHR( physical_device, file->present_family_index, surface, &has_presentation_support );
+	if ( has_presentation_support != VK_TRUE ) {
+		return false;
+	}
+
+	memset( topology, 0, sizeof (Vulkan_Queue_Topology) );
+	topology->count_of_queue_families = file->count_of_queue_families;
+	memcpy( topology->queue_family_properties, file->queue_family_properties, file->count_of_queue_families * sizeof (VkQueueFamilyProperties) );
+
+	assign_vulkan_queue_topology( topology, file->graphics_family_index, file->present_family_index );
+
+	return true;
+}
+
+// NOTE: only writes when this run probed something -- a fully warm start leaves the file alone
+bool
+save_vulkan_startup_cache( Vulkan_Startup_Cache *startup_cache )
+{
+	if ( !startup_cache->path || !startup_cache->dirty ) {
+		return false;
+	}
+
+	begin_startup_phase( startup_cache, STARTUP_PHASE_SAVE_CACHE );
+
+	bool saved;
+	saved = platform_write_file_atomically( startup_cache->path, &startup_cache->file, sizeof (Startup_Cache_File) );
+	if ( saved ) {
+		startup_cache->dirty = false;
+	}
+	else {
+		fprintf( stderr, "Unable to write the startup cache to %s\n", startup_cache->path );
+	}
+
+	end_startup_phase( startup_cache );
+
+	return saved;
+}
+
+void
+export_vulkan_startup_cache_as_json( Vulkan_Startup_Cache *startup_cache, FILE *output, char *indentation )
+{
+	uint64_t total_nanoseconds = 0;
+	for ( uint32_t phase = 0; phase < STARTUP_PHASE_COUNT; ++phase ) {
+		total_nanoseconds += startup_cache->phase_nanoseconds[phase];
+	}
+
+	fprintf( output, "{\n" );
+	fprintf( output, "%s  \"cache\": \"%s\",\n", indentation, startup_cache_load_result_names[startup_cache->load_result] );
+	fprintf( output, "%s  \"device_warm\": %s,\n", indentation, startup_cache->device_warm ? "true" : "false" );
+	fprintf( output, "%s  \"fallbacks\": %u,\n", indentation, startup_cache->count_of_fallbacks );
+	fprintf( output, "%s  \"total_ms\": %.3f,\n", indentation, (double)total_nanoseconds / 1.0e6 );
+	fprintf( output, "%s  \"phases_ms\": {\n", indentation );
+	for ( uint32_t phase = 0; phase < STARTUP_PHASE_COUNT; ++phase ) {
+		fprintf( output, "%s    \"%s\": %.3f%s\n", indentation, startup_phase_names[phase],
+				 (double)startup_cache->phase_nanoseconds[phase] / 1.0e6, phase + 1 < STARTUP_PHASE_COUNT ? "," : "" );
+	}
+	fprintf( output, "%s  }\n", indentation );
+	fprintf( output, "%s}", indentation );
+
+	return;
+}
@@ -0,0 +1,576 @@
+// Asynchronous uploads. Data is copied into a persistently mapped staging ring and the copies are recorded
+// into the current batch, which goes to the transfer queue in one submit (once per frame from draw(), or
+// when the ring fills up). Nothing here makes the render loop wait:
+//
+//  - each batch signals a semaphore that the next graphics submit waits on, together with a small command
+//    buffer that acquires ownership of the uploaded resources on the graphics family (only needed when the
+//    transfer family is a different one -- see record_*_queue_ownership_transfer in vulkan_queues.c)
+//  - each upload returns a ticket, upload_is_complete() answers without blocking
+//  - a batch and its part of the ring are recycled once its transfer fence has signaled and the frame that
+//    consumed its semaphore has completed
+//
+// The only blocking path is the uploader itself running out of ring space or batches -- that stalls the
+// code doing the uploading (a loader), never draw().
+//
+// Unity built -- included by vulkan_renderer.c after the queue topology, before Vulkan_Context.
+
+#define UPLOAD_BATCH_COUNT				4
+#define UPLOAD_STAGING_RING_SIZE		( 32ull * 1024 * 1024 )
+#define UPLOAD_STAGING_ALIGNMENT		16			// covers bufferOffset rules for every texel block size up to 16 bytes
+
+typedef enum {
+
+	UPLOAD_BATCH_FREE,
+	UPLOAD_BATCH_RECORDING,
+	UPLOAD_BATCH_SUBMITTED,			// on the transfer queue, semaphore not yet waited by the graphics queue
+	UPLOAD_BATCH_CONSUMED,			// a graphics submit waits on the semaphore
+
+} Upload_Batch_State;
+
+typedef struct {
+
+	Upload_Batch_State	state;
+	uint64_t			ticket;
+
+	VkCommandPool		transfer_command_pool;
+	VkCommandBuffer		transfer_command_buffer;
+	VkCommandPool		acquire_command_pool;			// graphics family
+	VkCommandBuffer		acquire_command_buffer;
+	bool				has_acquire_commands;
+
+	VkFence				transfer_complete;
+	VkSemaphore			upload_complete;				// waited by the consuming graphics submit
+	VkFence				acquire_complete;				// only used when the uploader consumes its own batch
+	uint64_t			consumed_by_frame;				// 0 -- consumed by the uploader itself (acquire_complete)
+	VkFence				consumer_fence;					// the consuming frame's fence, owned by the frame ring
+
+	VkDeviceSize		ring_end;						// staging ring head when the batch was submitted
+	VkDeviceSize		staging_bytes;					// including padding and the skipped end of the ring
+	uint32_t			count_of_copies;
+
+} Vulkan_Upload_Batch;
+
+typedef struct {
+
+	Vulkan_Device_Dispatch	*dispatch;
+	Vulkan_Memory_Allocator	*memory;
+	uint64_t				*last_completed_frame_number;		// owned by the frame ring
+
+	uint32_t				transfer_queue_family_index;
+	uint32_t				graphics_queue_family_index;
+	VkQueue					transfer_queue;
+	VkQueue					graphics_queue;
+
+	VkBuffer				staging_buffer;
+	Vulkan_Allocation		staging_allocation;
+	uint8_t					*staging_memory;
+	VkDeviceSize			staging_size;
+	VkDeviceSize			staging_head;
+	VkDeviceSize			staging_tail;
+	VkDeviceSize			staging_bytes_in_use;
+	VkDeviceSize			staging_bytes_unsubmitted;		// part of staging_bytes_in_use not handed to a batch yet
+
+	Vulkan_Upload_Batch		batches[UPLOAD_BATCH_COUNT];
+	uint32_t				oldest_batch;
+	uint32_t				current_batch;
+	uint32_t				count_of_batches_in_flight;		// submitted, not recycled -- all of them when oldest == current
+	uint64_t				next_ticket;
+	uint64_t				last_completed_ticket;
+
+	uint64_t				count_of_uploads;
+	uint64_t				count_of_bytes_uploaded;
+	uint64_t				count_of_submits;
+	uint64_t				count_of_stalls;
+
+} Vulkan_Uploader;
+
+
+VkCommandBuffer
+create_upload_command_buffer( Vulkan_Uploader *uploader, uint32_t queue_family_index, VkCommandPool *command_pool )
+{
+	VkDevice logical_device;
+	logical_device = uploader->dispatch->logical_device;
+
+	// NOTE: TRANSIENT + whole pool reset on recycle, the command buffer is re-recorded every time anyway
+	VkCommandPoolCreateInfo command_pool_create_info = { 0 };
+	command_pool_create_info.sType 			  = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	command_pool_create_info.flags 			  = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	command_pool_create_info.queueFamilyIndex = queue_family_index;
+
+	VkResult result;
+	result = uploader->dispatch->vkCreateCommandPool( logical_device, &command_pool_create_info, NULL, command_pool );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to create an upload command pool\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	VkCommandBufferAllocateInfo command_buffer_allocate_info = { 0 };
+	command_buffer_allocate_info.sType 				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	command_buffer_allocate_info.commandPool 		= *command_pool;
+	command_buffer_allocate_info.level 				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	command_buffer_allocate_info.commandBufferCount = 1;
+
+	VkCommandBuffer command_buffer;
+	result = uploader->dispatch->vkAllocateCommandBuffers( logical_device, &command_buffer_allocate_info, &command_buffer );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to allocate an upload command buffer\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return command_buffer;
+}
+
+void
+create_vulkan_uploader( Vulkan_Uploader *uploader, Vulkan_Device_Dispatch *dispatch, Vulkan_Memory_Allocator *memory,
+						uint64_t *last_completed_frame_number,
+						uint32_t transfer_queue_family_index, VkQueue transfer_queue,
+						uint32_t graphics_queue_family_index, VkQueue graphics_queue )
+{
+	memset( uploader, 0, sizeof (Vulkan_Uploader) );
+	uploader->dispatch 					  = dispatch;
+	uploader->memory 					  = memory;
+	uploader->last_completed_frame_number = last_completed_frame_number;
+	uploader->transfer_queue_family_index = transfer_queue_family_index;
+	uploader->transfer_queue 			  = transfer_queue;
+	uploader->graphics_queue_family_index = graphics_queue_family_index;
+	uploader->graphics_queue 			  = graphics_queue;
+	uploader->next_ticket 				  = 1;
+
+	uploader->staging_size   = UPLOAD_STAGING_RING_SIZE;
+	uploader->staging_buffer = create_vulkan_buffer( memory, uploader->staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+													 VULKAN_MEMORY_USAGE_STAGING, &uploader->staging_allocation );
+	uploader->staging_memory = (uint8_t *)uploader->staging_allocation.mapped;
+
+	VkDevice logical_device;
+	logical_device = dispatch->logical_device;
+
+	VkFenceCreateInfo fence_create_info = { 0 };
+	fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkSemaphoreCreateInfo semaphore_create_info = { 0 };
+	semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	for ( uint32_t i = 0; i < UPLOAD_BATCH_COUNT; ++i ) {
+		Vulkan_Upload_Batch *batch;
+		batch = &uploader->batches[i];
+
+		batch->transfer_command_buffer = create_upload_command_buffer( uploader, transfer_queue_family_index, &batch->transfer_command_pool );
+		batch->acquire_command_buffer  = create_upload_command_buffer( uploader, graphics_queue_family_index, &batch->acquire_command_pool );
+
+		VkResult result;
+		result  = dispatch->vkCreateFence( logical_device, &fence_create_info, NULL, &batch->transfer_complete );
+		result |= dispatch->vkCreateFence( logical_device, &fence_create_info, NULL, &batch->acquire_complete );
+		result |= dispatch->vkCreateSemaphore( logical_device, &semaphore_create_info, NULL, &batch->upload_complete );
+		if ( result != VK_SUCCESS ) {
+			fprintf( stdout, "Unable to create upload synchronization objects\n" );
+			exit( EXIT_FAILURE );
+		}
+	}
+
+	return;
+}
+
+// NOTE: device must be idle
+void
+destroy_vulkan_uploader( Vulkan_Uploader *uploader )
+{
+	VkDevice logical_device;
+	logical_device = uploader->dispatch->logical_device;
+
+	for ( uint32_t i = 0; i < UPLOAD_BATCH_COUNT; ++i ) {
+		Vulkan_Upload_Batch *batch;
+		batch = &uploader->batches[i];
+
+		uploader->dispatch->vkDestroyCommandPool( logical_device, batch->transfer_command_pool, NULL );
+		uploader->dispatch->vkDestroyCommandPool( logical_device, batch->acquire_command_pool, NULL );
+		uploader->dispatch->vkDestroyFence( logical_device, batch->transfer_complete, NULL );
+		uploader->dispatch->vkDestroyFence( logical_device, batch->acquire_complete, NULL );
+		uploader->dispatch->vkDestroySemaphore( logical_device, batch->upload_complete, NULL );
+	}
+
+	destroy_vulkan_buffer( uploader->memory, uploader->staging_buffer, &uploader->staging_allocation );
+
+	return;
+}
+
+void
+recycle_upload_batch( Vulkan_Uploader *uploader, Vulkan_Upload_Batch *batch )
+{
+	VkDevice logical_device;
+	logical_device = uploader->dispatch->logical_device;
+
+	uploader->dispatch->vkResetFences( logical_device, 1, &batch->transfer_complete );
+	if ( batch->consumed_by_frame == 0 ) {
+		uploader->dispatch->vkResetFences( logical_device, 1, &batch->acquire_complete );
+	}
+
+	uploader->dispatch->vkResetCommandPool( logical_device, batch->transfer_command_pool, 0 );
+	uploader->dispatch->vkResetCommandPool( logical_device, batch->acquire_command_pool, 0 );
+
+	// batches retire in submission order, so the ring frees front to back too
+	uploader->staging_bytes_in_use -= batch->staging_bytes;
+	uploader->staging_tail 			= batch->ring_end;
+
+	uploader->last_completed_ticket = batch->ticket;
+
+	batch->state 				= UPLOAD_BATCH_FREE;
+	batch->has_acquire_commands = false;
+	batch->count_of_copies 		= 0;
+	batch->consumed_by_frame 	= 0;
+	batch->consumer_fence 		= VK_NULL_HANDLE;
+	batch->staging_bytes 		= 0;
+
+	uploader->oldest_batch 				 = ( uploader->oldest_batch + 1 ) % UPLOAD_BATCH_COUNT;
+	uploader->count_of_batches_in_flight -= 1;
+
+	return;
+}
+
+// Never blocks -- recycles every batch at the front of the queue that is finished on both queues
+void
+retire_completed_upload_batches( Vulkan_Uploader *uploader )
+{
+	VkDevice logical_device;
+	logical_device = uploader->dispatch->logical_device;
+
+	while ( uploader->count_of_batches_in_flight > 0 ) {
+		Vulkan_Upload_Batch *batch;
+		batch = &uploader->batches[uploader->oldest_batch];
+
+		if ( batch->state != UPLOAD_BATCH_CONSUMED ) {
+			break;
+		}
+
+		if ( uploader->dispatch->vkGetFenceStatus( logical_device, batch->transfer_complete ) != VK_SUCCESS ) {
+			break;
+		}
+
+		bool consumer_done;
+		if ( batch->consumed_by_frame == 0 ) {
+			consumer_done = ( uploader->dispatch->vkGetFenceStatus( logical_device, batch->acquire_complete ) == VK_SUCCESS );
+		}
+		else {
+			consumer_done = ( *uploader->last_completed_frame_number >= batch->consumed_by_frame );
+		}
+
+		if ( !consumer_done ) {
+			break;
+		}
+
+		recycle_upload_batch( uploader, batch );
+	}
+
+	return;
+}
+
+void
+begin_upload_batch_if_needed( Vulkan_Uploader *uploader, Vulkan_Upload_Batch *batch )
+{
+	if ( batch->state == UPLOAD_BATCH_RECORDING ) {
+		return;
+	}
+
+	VkCommandBufferBeginInfo command_buffer_begin_info = { 0 };
+	command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	command_buffer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	uploader->dispatch->vkBeginCommandBuffer( batch->transfer_command_buffer, &command_buffer_begin_info );
+	uploader->dispatch->vkBeginCommandBuffer( batch->acquire_command_buffer, &command_buffer_begin_info );
+
+	batch->state  = UPLOAD_BATCH_RECORDING;
+	batch->ticket = uploader->next_ticket++;
+
+	return;
+}
+
+void
+submit_pending_uploads( Vulkan_Uploader *uploader );
+
+// Blocks the uploading thread until the oldest batch is recycled. If no frame has picked up its semaphore,
+// the uploader does the graphics side wait + acquire itself so loading before the first frame can't deadlock.
+void
+wait_for_oldest_upload_batch( Vulkan_Uploader *uploader )
+{
+	VkDevice logical_device;
+	logical_device = uploader->dispatch->logical_device;
+
+	Vulkan_Upload_Batch *batch;
+	batch = &uploader->batches[uploader->oldest_batch];
+
+	uploader->count_of_stalls += 1;
+
+	if ( batch->state == UPLOAD_BATCH_SUBMITTED ) {
+		Vulkan_Queue_Submit acquire_submit = { 0 };
+		add_submit_wait( &acquire_submit, batch->upload_complete, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT );
+		if ( batch->has_acquire_commands ) {
+			add_submit_command_buffer( &acquire_submit, batch->acquire_command_buffer );
+		}
+
+		VkResult result;
+		result = submit_to_queue( uploader->dispatch, uploader->graphics_queue, &acquire_submit, batch->acquire_complete );
+		if ( result != VK_SUCCESS ) {
+			fprintf( stdout, "Unable to submit upload acquire\n" );
+			exit( EXIT_FAILURE );
+		}
+
+		batch->state 			 = UPLOAD_BATCH_CONSUMED;
+		batch->consumed_by_frame = 0;
+	}
+
+	uploader->dispatch->vkWaitForFences( logical_device, 1, &batch->transfer_complete, VK_TRUE, UINT64_MAX );
+	if ( batch->consumed_by_frame == 0 ) {
+		uploader->dispatch->vkWaitForFences( logical_device, 1, &batch->acquire_complete, VK_TRUE, UINT64_MAX );
+	}
+	else if ( *uploader->last_completed_frame_number < batch->consumed_by_frame ) {
+		// NOTE: the frame ring only resets a fence after waiting on it, which moves last_completed_frame_number
+		// past the frame -- so while the frame counts as incomplete its fence is still the one it was submitted with
+		uploader->dispatch->vkWaitForFences( logical_device, 1, &batch->consumer_fence, VK_TRUE, UINT64_MAX );
+	}
+
+	recycle_upload_batch( uploader, batch );
+
+	retire_completed_upload_batches( uploader );
+
+	return;
+}
+
+// Returns the ring offset of size free bytes, submitting / waiting as needed to get them
+VkDeviceSize
+allocate_staging_memory( Vulkan_Uploader *uploader, VkDeviceSize size )
+{
+	if ( size > uploader->staging_size ) {
+		fprintf( stdout, "Upload of %llu bytes doesn't fit the staging ring\n", (unsigned long long)size );
+		exit( EXIT_FAILURE );
+	}
+
+	for ( ;; ) {
+		retire_completed_upload_batches( uploader );
+
+		VkDeviceSize head;
+		head = ( uploader->staging_head + UPLOAD_STAGING_ALIGNMENT - 1 ) & ~( (VkDeviceSize)UPLOAD_STAGING_ALIGNMENT - 1 );
+
+		VkDeviceSize wasted = 0;
+		if ( head + size > uploader->staging_size ) {
+			// skip the tail end and wrap around
+			wasted = uploader->staging_size - uploader->staging_head;
+			head   = 0;
+		}
+		else {
+			wasted = head - uploader->staging_head;
+		}
+
+		VkDeviceSize free_bytes;
+		free_bytes = uploader->staging_size - uploader->staging_bytes_in_use;
+
+		if ( wasted + size <= free_bytes ) {
+			uploader->staging_bytes_in_use 		+= wasted + size;
+			uploader->staging_bytes_unsubmitted += wasted + size;
+			uploader->staging_head 				 = head + size;
+			return head;
+		}
+
+		// the batch being recorded owns part of what we need -- send it so it can be recycled eventually
+		if ( uploader->batches[uploader->current_batch].state == UPLOAD_BATCH_RECORDING ) {
+			submit_pending_uploads( uploader );
+		}
+
+		if ( uploader->count_of_batches_in_flight == 0 ) {
+			fprintf( stdout, "Staging ring is full with nothing in flight\n" );
+			exit( EXIT_FAILURE );
+		}
+
+		wait_for_oldest_upload_batch( uploader );
+	}
+}
+
+// Makes sure there is a batch to record into -- only blocks if all of them are still in flight
+Vulkan_Upload_Batch *
+get_recording_upload_batch( Vulkan_Uploader *uploader )
+{
+	Vulkan_Upload_Batch *batch;
+	batch = &uploader->batches[uploader->current_batch];
+
+	while ( batch->state != UPLOAD_BATCH_FREE && batch->state != UPLOAD_BATCH_RECORDING ) {
+		wait_for_oldest_upload_batch( uploader );
+	}
+
+	begin_upload_batch_if_needed( uploader, batch );
+
+	return batch;
+}
+
+// Queues a copy of size bytes into buffer at offset. Returns the ticket to poll with upload_is_complete().
+uint64_t
+upload_to_buffer( Vulkan_Uploader *uploader, VkBuffer buffer, VkDeviceSize offset, void *data, VkDeviceSize size )
+{
+	VkDeviceSize staging_offset;
+	staging_offset = allocate_staging_memory( uploader, size );
+	memcpy( uploader->staging_memory + staging_offset, data, (size_t)size );
+
+	Vulkan_Upload_Batch *batch;
+	batch = get_recording_upload_batch( uploader );
+
+	VkBufferCopy buffer_copy = { 0 };
+	buffer_copy.srcOffset = staging_offset;
+	buffer_copy.dstOffset = offset;
+	buffer_copy.size 	  = size;
+
+	uploader->dispatch->vkCmdCopyBuffer( batch->transfer_command_buffer, uploader->staging_buffer, buffer, 1, &buffer_copy );
+
+	batch->has_acquire_commands |= record_buffer_queue_ownership_transfer( uploader->dispatch,
+			batch->transfer_command_buffer, uploader->transfer_queue_family_index, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			batch->acquire_command_buffer, uploader->graphics_queue_family_index, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT,
+			buffer, offset, size );
+
+	batch->count_of_copies 			  += 1;
+	uploader->count_of_uploads 		  += 1;
+	uploader->count_of_bytes_uploaded += size;
+
+	return batch->ticket;
+}
+
+// Queues a copy of tightly packed texels into mip 0 / layer 0 of a 2D color image, leaving it in final_layout.
+// NOTE: whole subresource copies are always allowed, whatever minImageTransferGranularity the transfer family has
+uint64_t
+upload_to_image( Vulkan_Uploader *uploader, VkImage image, VkExtent3D extent, void *data, VkDeviceSize size, VkImageLayout final_layout )
+{
+	VkDeviceSize staging_offset;
+	staging_offset = allocate_staging_memory( uploader, size );
+	memcpy( uploader->staging_memory + staging_offset, data, (size_t)size );
+
+	Vulkan_Upload_Batch *batch;
+	batch = get_recording_upload_batch( uploader );
+
+	VkImageSubresourceRange image_subresource_range = { 0 };
+	image_subresource_range.aspectMask 	 = VK_IMAGE_ASPECT_COLOR_BIT;
+	image_subresource_range.baseMipLevel = 0;
+	image_subresource_range.levelCount 	 = 1;
+	image_subresource_range.layerCount 	 = 1;
+
+	VkImageMemoryBarrier barrier_to_transfer_destination = { 0 };
+	barrier_to_transfer_destination.sType 				= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier_to_transfer_destination.srcAccessMask 		= 0;
+	barrier_to_transfer_destination.dstAccessMask 		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier_to_transfer_destination.oldLayout 			= VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier_to_transfer_destination.newLayout 			= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier_to_transfer_destination.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier_to_transfer_destination.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier_to_transfer_destination.image 				= image;
+	barrier_to_transfer_destination.subresourceRange 	= image_subresource_range;
+
+	uploader->dispatch->vkCmdPipelineBarrier( batch->transfer_command_buffer,
+											  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+											  0, 0, NULL, 0, NULL, 1, &barrier_to_transfer_destination );
+
+	VkBufferImageCopy buffer_image_copy = { 0 };
+	buffer_image_copy.bufferOffset 					  = staging_offset;
+	buffer_image_copy.imageSubresource.aspectMask 	  = VK_IMAGE_ASPECT_COLOR_BIT;
+	buffer_image_copy.imageSubresource.mipLevel 	  = 0;
+	buffer_image_copy.imageSubresource.baseArrayLayer = 0;
+	buffer_image_copy.imageSubresource.layerCount 	  = 1;
+	buffer_image_copy.imageExtent 					  = extent;
+
+	uploader->dispatch->vkCmdCopyBufferToImage( batch->transfer_command_buffer, uploader->staging_buffer, image,
+												VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &buffer_image_copy );
+
+	// NOTE: with an ownership transfer the layout change is part of it
+	batch->has_acquire_commands |= record_image_queue_ownership_transfer( uploader->dispatch,
+			batch->transfer_command_buffer, uploader->transfer_queue_family_index, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			batch->acquire_command_buffer, uploader->graphics_queue_family_index, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT,
+			image, image_subresource_range, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, final_layout );
+
+	batch->count_of_copies 			  += 1;
+	uploader->count_of_uploads 		  += 1;
+	uploader->count_of_bytes_uploaded += size;
+
+	return batch->ticket;
+}
+
+// One vkQueueSubmit on the transfer queue for everything recorded since the last call. Cheap when idle.
+void
+submit_pending_uploads( Vulkan_Uploader *uploader )
+{
+	Vulkan_Upload_Batch *batch;
+	batch = &uploader->batches[uploader->current_batch];
+
+	if ( batch->state != UPLOAD_BATCH_RECORDING ) {
+		return;
+	}
+
+	uploader->dispatch->vkEndCommandBuffer( batch->transfer_command_buffer );
+	uploader->dispatch->vkEndCommandBuffer( batch->acquire_command_buffer );
+
+	Vulkan_Queue_Submit transfer_submit = { 0 };
+	add_submit_command_buffer( &transfer_submit, batch->transfer_command_buffer );
+	add_submit_signal( &transfer_submit, batch->upload_complete );
+
+	VkResult result;
+	result = submit_to_queue( uploader->dispatch, uploader->transfer_queue, &transfer_submit, batch->transfer_complete );
+	if ( result != VK_SUCCESS ) {
+		fprintf( stdout, "Unable to submit uploads to the transfer queue\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	batch->state 		 = UPLOAD_BATCH_SUBMITTED;
+	batch->ring_end 	 = uploader->staging_head;
+	batch->staging_bytes = uploader->staging_bytes_unsubmitted;
+
+	uploader->staging_bytes_unsubmitted = 0;
+
+	uploader->count_of_submits 			 += 1;
+	uploader->count_of_batches_in_flight += 1;
+	uploader->current_batch 			  = ( uploader->current_batch + 1 ) % UPLOAD_BATCH_COUNT;
+
+	return;
+}
+
+// Hands every submitted batch to the graphics submit of frame_number -- its semaphores and acquire command buffers
+// are added to that submit, ahead of the frame's own command buffers. frame_fence is what that submit signals.
+void
+add_pending_upload_acquires( Vulkan_Uploader *uploader, uint64_t frame_number, VkFence frame_fence, Vulkan_Queue_Submit *submit )
+{
+	for ( uint32_t n = 0; n < uploader->count_of_batches_in_flight; ++n ) {
+		Vulkan_Upload_Batch *batch;
+		batch = &uploader->batches[( uploader->oldest_batch + n ) % UPLOAD_BATCH_COUNT];
+
+		if ( batch->state != UPLOAD_BATCH_SUBMITTED ) {
+			continue;
+		}
+
+		add_submit_wait( submit, batch->upload_complete, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT );
+		if ( batch->has_acquire_commands ) {
+			add_submit_command_buffer( submit, batch->acquire_command_buffer );
+		}
+
+		batch->state 			 = UPLOAD_BATCH_CONSUMED;
+		batch->consumed_by_frame = frame_number;
+		batch->consumer_fence 	 = frame_fence;
+	}
+
+	return;
+}
+
+// NOTE: never blocks -- a ticket is done once its batch has been recycled
+bool
+upload_is_complete( Vulkan_Uploader *uploader, uint64_t ticket )
+{
+	retire_completed_upload_batches( uploader );
+
+	return ticket <= uploader->last_completed_ticket;
+}
+
+// For loading screens and tools -- blocks until ticket is done
+void
+wait_for_upload( Vulkan_Uploader *uploader, uint64_t ticket )
+{
+	if ( uploader->batches[uploader->current_batch].state == UPLOAD_BATCH_RECORDING &&
+		 uploader->batches[uploader->current_batch].ticket <= ticket ) {
+		submit_pending_uploads( uploader );
+	}
+
+	while ( !upload_is_complete( uploader, ticket ) ) {
+		wait_for_oldest_upload_batch( uploader );
+	}
+
+	return;
+}
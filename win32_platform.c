@@ -0,0 +1,637 @@
+// Win32 platform layer -- the Vulkan loader plus the few OS services the renderer leans on.
+// Unity built: included first by the Win32 entry points (playground.c, benchmark.c on Windows).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <windows.h>
+
+#define VK_USE_PLATFORM_WIN32_KHR
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+
+// Load from the platform -- windows
+PFN_vkGetInstanceProcAddr						vkGetInstanceProcAddr;
+
+typedef HMODULE Platform_Library;
+
+FILE *windows_error_log_file;
+
+void
+get_last_error_as_string( char *function_name )
+{
+	DWORD error_code = GetLastError();
+	if ( error_code == 0 ) {
+		return;
+	}
+
+	char *message_buffer;
+	FormatMessage( FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM,
+				   0, error_code, MAKELANGID( LANG_NEUTRAL, SUBLANG_DEFAULT ),
+				   (LPTSTR)&message_buffer, 0, 0 );
+
+	fprintf( windows_error_log_file, function_name );
+	fprintf( windows_error_log_file, message_buffer );
+	LocalFree( message_buffer );
+
+	return;
+}
+
+// For the recoverable paths -- the caller gets false back, the Win32 error only goes to stderr
+void
+log_last_error( char *function_name )
+{
+	DWORD error_code = GetLastError();
+	if ( error_code == 0 ) {
+		return;
+	}
+
+	char *message_buffer;
+	message_buffer = NULL;
+	FormatMessage( FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM,
+				   0, error_code, MAKELANGID( LANG_NEUTRAL, SUBLANG_DEFAULT ),
+				   (LPTSTR)&message_buffer, 0, 0 );
+
+	fprintf( stderr, "%s%s", function_name, message_buffer ? message_buffer : "unknown error\n" );
+	LocalFree( message_buffer );
+
+	return;
+}
+
+Platform_Library
+load_vulkan_library( void ) 
+{
+	HMODULE vulkan_library_handle;
+	vulkan_library_handle = LoadLibrary( "vulkan-1.dll" );
+	if ( !vulkan_library_handle ) {
+		fprintf( stdout, "Unable to load the vulkan library\n" );
+		exit( EXIT_FAILURE );
+	}
+	
+	return vulkan_library_handle;
+}
+
+void
+load_vulkan_entry_point( Platform_Library vulkan_library_handle )
+{
+	// Load from platform level (windows - GetProcAddress)
+	vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr) GetProcAddress( vulkan_library_handle, "vkGetInstanceProcAddr" );
+	if ( !vkGetInstanceProcAddr ) {
+		fprintf( stdout, "Unable to find vkGetInstanceProcAddr in the vulkan library\n" );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+void
+unload_vulkan_library( Platform_Library vulkan_library_handle )
+{
+	FreeLibrary( vulkan_library_handle );
+
+	return;
+}
+
+uint64_t
+platform_get_timestamp_in_nanoseconds( void )
+{
+	static LARGE_INTEGER counter_frequency;
+	if ( counter_frequency.QuadPart == 0 ) {
+		QueryPerformanceFrequency( &counter_frequency );
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+
+	// split so the multiply doesn't overflow for long uptimes
+	uint64_t seconds;
+	uint64_t remainder;
+	seconds   = counter.QuadPart / counter_frequency.QuadPart;
+	remainder = counter.QuadPart % counter_frequency.QuadPart;
+
+	return seconds * 1000000000ull + (remainder * 1000000000ull) / counter_frequency.QuadPart;
+}
+
+typedef struct {
+
+	void		*data;
+	uint64_t	size;
+	HANDLE		file;
+	HANDLE		mapping;
+
+} Platform_File_Map;
+
+// Read only view of a whole file. false if it doesn't exist / is empty -- callers treat that as "no file".
+bool
+platform_map_file_for_reading( char *path, Platform_File_Map *file_map )
+{
+	memset( file_map, 0, sizeof (Platform_File_Map) );
+
+	HANDLE file;
+	file = CreateFile( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if ( !GetFileSizeEx( file, &file_size ) || file_size.QuadPart == 0 ) {
+		CloseHandle( file );
+		return false;
+	}
+
+	HANDLE mapping;
+	mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( !mapping ) {
+		CloseHandle( file );
+		return false;
+	}
+
+	void *data;
+	data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if ( !data ) {
+		CloseHandle( mapping );
+		CloseHandle( file );
+		return false;
+	}
+
+	file_map->data 	  = data;
+	file_map->size 	  = (uint64_t)file_size.QuadPart;
+	file_map->file 	  = file;
+	file_map->mapping = mapping;
+
+	return true;
+}
+
+void
+platform_unmap_file( Platform_File_Map *file_map )
+{
+	if ( file_map->data ) {
+		UnmapViewOfFile( file_map->data );
+		CloseHandle( file_map->mapping );
+		CloseHandle( file_map->file );
+	}
+
+	memset( file_map, 0, sizeof (Platform_File_Map) );
+
+	return;
+}
+
+// Writes to path.tmp and moves it over path, so a crash mid-write leaves the old file intact
+bool
+platform_write_file_atomically( char *path, void *data, uint64_t size )
+{
+	char temporary_path[MAX_PATH];
+	if ( snprintf( temporary_path, sizeof (temporary_path), "%s.tmp", path ) >= (int)sizeof (temporary_path) ) {
+		return false;
+	}
+
+	HANDLE file;
+	file = CreateFile( temporary_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE ) {
+		return false;
+	}
+
+	uint8_t *bytes;
+	bytes = (uint8_t *)data;
+
+	uint64_t bytes_written = 0;
+	while ( bytes_written < size ) {
+		DWORD chunk_size;
+		chunk_size = ( size - bytes_written > 0x40000000 ) ? 0x40000000 : (DWORD)( size - bytes_written );
+
+		DWORD written;
+		if ( !WriteFile( file, bytes + bytes_written, chunk_size, &written, NULL ) || written == 0 ) {
+			CloseHandle( file );
+			DeleteFile( temporary_path );
+			return false;
+		}
+
+		bytes_written += written;
+	}
+
+	if ( !FlushFileBuffers( file ) ) {
+		CloseHandle( file );
+		DeleteFile( temporary_path );
+		return false;
+	}
+	CloseHandle( file );
+
+	if ( !MoveFileEx( temporary_path, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) ) {
+		log_last_error( "MoveFileEx: " );
+		DeleteFile( temporary_path );
+		return false;
+	}
+
+	return true;
+}
+
+// Directory watch -- tells the caller which files in one directory were written / renamed in. Only non recursive,
+// the shader cache is the only user. One name per call; the rest of a ReadDirectoryChangesW batch stays buffered.
+typedef struct {
+
+	HANDLE		directory;
+	OVERLAPPED	overlapped;
+	bool		read_pending;
+	bool		broken;									// the watch can't be re-armed, the caller stops
+	uint32_t	buffer_size;
+	uint32_t	buffer_offset;
+	DWORD		buffer[1024];							// FILE_NOTIFY_INFORMATION wants DWORD alignment
+
+} Platform_Directory_Watch;
+
+static bool
+platform_issue_directory_read( Platform_Directory_Watch *watch )
+{
+	ResetEvent( watch->overlapped.hEvent );
+
+	// NOTE: LAST_WRITE fires while the compiler is still writing, the caller debounces
+	if ( !ReadDirectoryChangesW( watch->directory, watch->buffer, sizeof (watch->buffer), FALSE,
+								 FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+								 NULL, &watch->overlapped, NULL ) ) {
+		log_last_error( "ReadDirectoryChangesW: " );
+		watch->broken = true;
+		return false;
+	}
+
+	watch->read_pending = true;
+
+	return true;
+}
+
+bool
+platform_watch_directory( char *path, Platform_Directory_Watch *watch )
+{
+	memset( watch, 0, sizeof (Platform_Directory_Watch) );
+
+	watch->directory = CreateFile( path, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+								   NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL );
+	if ( watch->directory == INVALID_HANDLE_VALUE ) {
+		watch->directory = NULL;
+		return false;
+	}
+
+	watch->overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+	if ( !watch->overlapped.hEvent ) {
+		CloseHandle( watch->directory );
+		watch->directory = NULL;
+		return false;
+	}
+
+	if ( !platform_issue_directory_read( watch ) ) {
+		CloseHandle( watch->overlapped.hEvent );
+		CloseHandle( watch->directory );
+		memset( watch, 0, sizeof (Platform_Directory_Watch) );
+		return false;
+	}
+
+	return true;
+}
+
+// false on timeout. name gets the file name relative to the watched directory.
+bool
+platform_wait_for_directory_change( Platform_Directory_Watch *watch, uint32_t timeout_milliseconds, char *name, uint32_t name_capacity )
+{
+	for ( ;; ) {
+		while ( watch->buffer_offset < watch->buffer_size ) {
+			FILE_NOTIFY_INFORMATION *information;
+			information = (FILE_NOTIFY_INFORMATION *)( (uint8_t *)watch->buffer + watch->buffer_offset );
+
+			if ( information->NextEntryOffset == 0 ) {
+				watch->buffer_offset = watch->buffer_size;
+			}
+			else {
+				watch->buffer_offset += information->NextEntryOffset;
+			}
+
+			if ( information->Action != FILE_ACTION_MODIFIED && information->Action != FILE_ACTION_ADDED &&
+				 information->Action != FILE_ACTION_RENAMED_NEW_NAME ) {
+				continue;
+			}
+
+			int name_size;
+			name_size = WideCharToMultiByte( CP_UTF8, 0, information->FileName, (int)( information->FileNameLength / sizeof (WCHAR) ),
+											 name, (int)name_capacity - 1, NULL, NULL );
+			if ( name_size <= 0 ) {
+				continue;
+			}
+
+			name[name_size] = '\0';
+
+			return true;
+		}
+
+		if ( !watch->read_pending && !platform_issue_directory_read( watch ) ) {
+			return false;
+		}
+
+		if ( WaitForSingleObject( watch->overlapped.hEvent, timeout_milliseconds ) != WAIT_OBJECT_0 ) {
+			return false;
+		}
+
+		watch->read_pending = false;
+
+		DWORD bytes_returned;
+		if ( !GetOverlappedResult( watch->directory, &watch->overlapped, &bytes_returned, FALSE ) ) {
+			log_last_error( "GetOverlappedResult: " );
+			watch->broken = true;
+			return false;
+		}
+
+		// NOTE: 0 bytes means the buffer overflowed and the batch was dropped -- nothing to hand out, just re-arm
+		watch->buffer_size   = bytes_returned;
+		watch->buffer_offset = 0;
+
+		// NOTE: after the first read the system keeps collecting changes for the handle, so re-arming only once
+		// this batch is drained doesn't lose anything
+	}
+}
+
+void
+platform_unwatch_directory( Platform_Directory_Watch *watch )
+{
+	if ( watch->directory ) {
+		if ( watch->read_pending ) {
+			CancelIoEx( watch->directory, &watch->overlapped );
+			DWORD bytes_returned;
+			GetOverlappedResult( watch->directory, &watch->overlapped, &bytes_returned, TRUE );
+		}
+
+		CloseHandle( watch->overlapped.hEvent );
+		CloseHandle( watch->directory );
+	}
+
+	memset( watch, 0, sizeof (Platform_Directory_Watch) );
+
+	return;
+}
+
+// Threads -- only what the job system needs. The trampoline carries the function + parameter into the new
+// thread and frees itself there.
+typedef HANDLE Platform_Thread;
+typedef void Platform_Thread_Function( void *parameter );
+
+typedef struct {
+
+	Platform_Thread_Function	*function;
+	void						*parameter;
+
+} Platform_Thread_Start;
+
+DWORD WINAPI
+platform_thread_trampoline( LPVOID start_as_void )
+{
+	Platform_Thread_Start start;
+	start = *(Platform_Thread_Start *)start_as_void;
+	free( start_as_void );
+
+	start.function( start.parameter );
+
+	return 0;
+}
+
+bool
+platform_create_thread( Platform_Thread *thread, Platform_Thread_Function *function, void *parameter )
+{
+	Platform_Thread_Start *start;
+	start = (Platform_Thread_Start *)malloc( sizeof (Platform_Thread_Start) );
+	if ( !start ) {
+		return false;
+	}
+
+	start->function  = function;
+	start->parameter = parameter;
+
+	*thread = CreateThread( NULL, 0, platform_thread_trampoline, start, 0, NULL );
+	if ( !*thread ) {
+		log_last_error( "CreateThread: " );
+		free( start );
+		return false;
+	}
+
+	return true;
+}
+
+void
+platform_join_thread( Platform_Thread thread )
+{
+	WaitForSingleObject( thread, INFINITE );
+	CloseHandle( thread );
+
+	return;
+}
+
+void
+platform_yield_thread( void )
+{
+	SwitchToThread();
+
+	return;
+}
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION	0x00000002
+#endif
+
+// ordinary waitable timers can wake a whole scheduler tick late -- the last bit of the sleep is spent yielding
+#define PLATFORM_SLEEP_SPIN_NANOSECONDS			2000000ull
+
+// Sleeps until platform_get_timestamp_in_nanoseconds() reaches timestamp -- returns right away if it already has.
+// NOTE: one timer per thread, high resolution where the OS has them (Windows 10 1803+)
+void
+platform_sleep_until( uint64_t timestamp_in_nanoseconds )
+{
+	static __declspec( thread ) HANDLE sleep_timer;
+	static __declspec( thread ) bool sleep_timer_is_high_resolution;
+	if ( !sleep_timer ) {
+		sleep_timer = CreateWaitableTimerExW( NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS );
+		sleep_timer_is_high_resolution = ( sleep_timer != NULL );
+		if ( !sleep_timer ) {
+			sleep_timer = CreateWaitableTimerExW( NULL, NULL, 0, TIMER_ALL_ACCESS );
+		}
+	}
+
+	uint64_t spin_nanoseconds;
+	spin_nanoseconds = sleep_timer_is_high_resolution ? 0 : PLATFORM_SLEEP_SPIN_NANOSECONDS;
+
+	uint64_t now;
+	now = platform_get_timestamp_in_nanoseconds();
+	if ( sleep_timer && now + spin_nanoseconds < timestamp_in_nanoseconds ) {
+		// negative -- relative, in 100ns units
+		LARGE_INTEGER due_time;
+		due_time.QuadPart = -(LONGLONG)( ( timestamp_in_nanoseconds - spin_nanoseconds - now ) / 100 );
+
+		if ( SetWaitableTimer( sleep_timer, &due_time, 0, NULL, NULL, FALSE ) ) {
+			WaitForSingleObject( sleep_timer, INFINITE );
+		}
+	}
+
+	while ( platform_get_timestamp_in_nanoseconds() < timestamp_in_nanoseconds ) {
+		SwitchToThread();
+	}
+
+	return;
+}
+
+uint32_t
+platform_get_count_of_processors( void )
+{
+	SYSTEM_INFO system_info;
+	GetSystemInfo( &system_info );
+
+	return ( system_info.dwNumberOfProcessors < 1 ) ? 1 : (uint32_t)system_info.dwNumberOfProcessors;
+}
+
+typedef HANDLE Platform_Semaphore;
+
+void
+platform_create_semaphore( Platform_Semaphore *semaphore, uint32_t initial_count )
+{
+	*semaphore = CreateSemaphore( NULL, initial_count, 0x7fffffff, NULL );
+	if ( !*semaphore ) {
+		get_last_error_as_string( "CreateSemaphore: " );
+		exit( EXIT_FAILURE );
+	}
+
+	return;
+}
+
+void
+platform_destroy_semaphore( Platform_Semaphore *semaphore )
+{
+	CloseHandle( *semaphore );
+
+	return;
+}
+
+void
+platform_signal_semaphore( Platform_Semaphore *semaphore, uint32_t count )
+{
+	ReleaseSemaphore( *semaphore, count, NULL );
+
+	return;
+}
+
+void
+platform_wait_semaphore( Platform_Semaphore *semaphore )
+{
+	WaitForSingleObject( *semaphore, INFINITE );
+
+	return;
+}
+
+// NOTE: slim reader / writer lock, only ever taken exclusive -- no kernel object, nothing to close
+typedef SRWLOCK Platform_Mutex;
+
+void
+platform_create_mutex( Platform_Mutex *mutex )
+{
+	InitializeSRWLock( mutex );
+
+	return;
+}
+
+void
+platform_destroy_mutex( Platform_Mutex *mutex )
+{
+	return;
+}
+
+void
+platform_lock_mutex( Platform_Mutex *mutex )
+{
+	AcquireSRWLockExclusive( mutex );
+
+	return;
+}
+
+void
+platform_unlock_mutex( Platform_Mutex *mutex )
+{
+	ReleaseSRWLockExclusive( mutex );
+
+	return;
+}
+
+// Atomics. Loads are acquire, stores are release, read-modify-writes and the barrier are sequentially consistent.
+// NOTE: the Interlocked* calls are full barriers; plain volatile accesses are acquire / release under MSVC's
+// default /volatile:ms on x86 / x64, the compiler barriers keep the optimizer from moving things around them
+int32_t
+platform_atomic_load_32( volatile int32_t *value )
+{
+	int32_t result;
+	result = *value;
+	_ReadWriteBarrier();
+
+	return result;
+}
+
+void
+platform_atomic_store_32( volatile int32_t *value, int32_t new_value )
+{
+	_ReadWriteBarrier();
+	*value = new_value;
+
+	return;
+}
+
+// returns the new value
+int32_t
+platform_atomic_add_32( volatile int32_t *value, int32_t addend )
+{
+	return (int32_t)InterlockedAdd( (volatile LONG *)value, addend );
+}
+
+int64_t
+platform_atomic_load_64( volatile int64_t *value )
+{
+	int64_t result;
+	result = *value;
+	_ReadWriteBarrier();
+
+	return result;
+}
+
+void
+platform_atomic_store_64( volatile int64_t *value, int64_t new_value )
+{
+	_ReadWriteBarrier();
+	*value = new_value;
+
+	return;
+}
+
+bool
+platform_atomic_compare_exchange_64( volatile int64_t *value, int64_t expected, int64_t desired )
+{
+	return InterlockedCompareExchange64( (volatile LONG64 *)value, desired, expected ) == expected;
+}
+
+void *
+platform_atomic_load_pointer( void * volatile *pointer )
+{
+	void *result;
+	result = *pointer;
+	_ReadWriteBarrier();
+
+	return result;
+}
+
+void
+platform_atomic_store_pointer( void * volatile *pointer, void *new_pointer )
+{
+	_ReadWriteBarrier();
+	*pointer = new_pointer;
+
+	return;
+}
+
+void
+platform_memory_barrier( void )
+{
+	MemoryBarrier();
+
+	return;
+}